@@ -0,0 +1,704 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "../src/includes/fieldbitboard.hpp"
+#include "../src/includes/fixedfieldgame.hpp"
+#include "../src/includes/levelgenerator.hpp"
+#include "../src/includes/quickgame.hpp"
+#include "../src/includes/quickgamescene.hpp"
+
+
+	namespace snake {
+
+		namespace SnakeBench {
+
+			// Each measurement runs for at least this long, and the fastest of the repeats is kept
+			const double MIN_BATCH_NANOSECONDS = 20000000.0;
+			const int MEASUREMENT_REPEATS = 5;
+
+			// Default allowed slowdown against the baseline before a benchmark counts as a regression
+			const double DEFAULT_REGRESSION_THRESHOLD = 0.15;
+
+			// Parameters the benchmarks are run over
+			const int SNAKE_LENGTHS[] = { 4, 64, 512 };
+			const sf::Vector2i FIELD_SIZES[] = { sf::Vector2i(50, 25), sf::Vector2i(100, 50), sf::Vector2i(200, 100) };
+			const float FILL_RATIOS[] = { 0.1f, 0.5f, 0.9f };
+			const int FOOD_COUNTS[] = { 100, 1000, 4000 };
+
+			typedef struct Snake_BenchResult {
+				std::string name;
+				long long iterations;
+				double nanosecondsPerOp;
+			} BenchResult;
+
+			// Runs a batch of the given number of iterations and returns the nanoseconds it took
+			typedef double (*BatchFunction)(void* context, long long iterations);
+
+			// Keeps results alive so the optimizer cannot drop the measured work
+			volatile int benchSink = 0;
+
+			double resolveNanosecondsSince(std::chrono::steady_clock::time_point start) {
+				return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			}
+
+			// Grow the batch until it runs long enough to time, then keep the fastest of several repeats
+			BenchResult measure(const std::string& name, BatchFunction batchFunction, void* context) {
+				long long iterations = 1;
+				double elapsed = batchFunction(context, iterations);
+				while (elapsed < MIN_BATCH_NANOSECONDS) {
+					iterations *= 2;
+					elapsed = batchFunction(context, iterations);
+				}
+
+				double bestNanosecondsPerOp = elapsed / (double)iterations;
+				for (int repeatIndex = 1; repeatIndex < MEASUREMENT_REPEATS; repeatIndex++) {
+					double nanosecondsPerOp = batchFunction(context, iterations) / (double)iterations;
+					if (nanosecondsPerOp < bestNanosecondsPerOp) {
+						bestNanosecondsPerOp = nanosecondsPerOp;
+					}
+				}
+
+				BenchResult result;
+				result.name = name;
+				result.iterations = iterations;
+				result.nanosecondsPerOp = bestNanosecondsPerOp;
+
+				fprintf(stderr, "%-64s %12.1f ns/op\n", name.c_str(), bestNanosecondsPerOp);
+				return result;
+			}
+
+			// Build a cycle visiting every interior cell of the field, so a snake following it never dies.
+			// The first three cells are in a straight line, so a length 3 snake can start on them.
+			std::vector<sf::Vector2i> buildInteriorCycle(sf::Vector2i fieldSize) {
+				std::vector<sf::Vector2i> result;
+
+				int interiorWidth = fieldSize.x - 2;
+				int interiorHeight = fieldSize.y - 2;
+				bool transposed = (interiorHeight % 2) != 0;
+				if (transposed) {
+					int swap = interiorWidth;
+					interiorWidth = interiorHeight;
+					interiorHeight = swap;
+				}
+
+				// Along the first row, snake back and forth over the other rows, then back up the first column
+				for (int x = 1; x <= interiorWidth; x++) {
+					result.push_back(sf::Vector2i(x, 1));
+				}
+				for (int y = 2; y <= interiorHeight; y++) {
+					if ((y % 2) == 0) {
+						for (int x = interiorWidth; x >= 2; x--) {
+							result.push_back(sf::Vector2i(x, y));
+						}
+					} else {
+						for (int x = 2; x <= interiorWidth; x++) {
+							result.push_back(sf::Vector2i(x, y));
+						}
+					}
+				}
+				for (int y = interiorHeight; y >= 2; y--) {
+					result.push_back(sf::Vector2i(1, y));
+				}
+
+				if (transposed) {
+					for (size_t cellIndex = 0; cellIndex < result.size(); cellIndex++) {
+						result[cellIndex] = sf::Vector2i(result[cellIndex].y, result[cellIndex].x);
+					}
+				}
+
+				return result;
+			}
+
+			ObjectDirection resolveDirection(sf::Vector2i from, sf::Vector2i to) {
+				ObjectDirection result = ObjectDirection::NONE;
+				if (to.x > from.x) {
+					result = ObjectDirection::RIGHT;
+				} else if (to.x < from.x) {
+					result = ObjectDirection::LEFT;
+				} else if (to.y > from.y) {
+					result = ObjectDirection::DOWN;
+				} else if (to.y < from.y) {
+					result = ObjectDirection::UP;
+				}
+				return result;
+			}
+
+			// Direction to leave every cell of the field in to keep following the cycle
+			std::vector<ObjectDirection> buildCycleDirections(sf::Vector2i fieldSize, const std::vector<sf::Vector2i>& cycle) {
+				std::vector<ObjectDirection> result(fieldSize.x * fieldSize.y, ObjectDirection::NONE);
+				for (size_t cellIndex = 0; cellIndex < cycle.size(); cellIndex++) {
+					sf::Vector2i from = cycle[cellIndex];
+					sf::Vector2i to = cycle[(cellIndex + 1) % cycle.size()];
+					result[from.y * fieldSize.x + from.x] = resolveDirection(from, to);
+				}
+				return result;
+			}
+
+			// Game definition with a length 3 snake at the start of the cycle, moving every frame
+			QuickGameDefn createGameDefn(sf::Vector2i fieldSize, const std::vector<sf::Vector2i>& cycle) {
+				QuickGameDefn result;
+				result.fieldSize = fieldSize;
+				result.snakeSpeedTilesPerSecond = 60.0f;
+				result.snakeStartDefn.headPosition = cycle[2];
+				result.snakeStartDefn.facingDirection = resolveDirection(cycle[1], cycle[2]);
+				result.snakeStartDefn.length = 3;
+				result.randomSeed = 12345;
+				return result;
+			}
+
+			// Grow a snake along the cycle until it reaches the requested length
+			void growAlongCycle(Snake& snake, sf::Vector2i fieldSize, const std::vector<ObjectDirection>& cycleDirections, int length) {
+				while (snake.getLength() < length) {
+					sf::Vector2i headPosition = snake.getHead().position;
+					snake.growForward(cycleDirections[headPosition.y * fieldSize.x + headPosition.x]);
+				}
+			}
+
+			// State shared by the snake benchmarks
+			typedef struct Snake_SnakeBenchContext {
+				sf::Vector2i fieldSize;
+				int snakeLength;
+				std::vector<sf::Vector2i> cycle;
+				std::vector<ObjectDirection> cycleDirections;
+				std::vector<sf::Vector2i> queryPositions;
+				QuickGameDefn gameDefn;
+				QuickGame* game;
+				FieldBitboard* bitboard;
+				sf::Texture* texture;
+				sf::Sprite sprite;
+			} SnakeBenchContext;
+
+			// Put the context's game back to a snake of the context's length
+			void resetGame(SnakeBenchContext* context) {
+				context->game->reset(&context->gameDefn);
+				growAlongCycle(*context->game->getSnake(), context->fieldSize, context->cycleDirections, context->snakeLength);
+			}
+
+			double benchMoveForward(void* contextPointer, long long iterations) {
+				SnakeBenchContext* context = (SnakeBenchContext*)contextPointer;
+				Snake* snake = context->game->getSnake();
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (long long iteration = 0; iteration < iterations; iteration++) {
+					sf::Vector2i headPosition = snake->getHead().position;
+					snake->moveForward(context->cycleDirections[headPosition.y * context->fieldSize.x + headPosition.x]);
+				}
+				return resolveNanosecondsSince(start);
+			}
+
+			double benchGrowForward(void* contextPointer, long long iterations) {
+				SnakeBenchContext* context = (SnakeBenchContext*)contextPointer;
+				double result = 0.0;
+
+				// Growing makes the snake longer, so long batches are split into chunks that stay near the requested length,
+				// with an untimed reset between them
+				long long growthPerChunk = (long long)context->cycle.size() - context->snakeLength - 1;
+				long long lengthBoundPerChunk = context->snakeLength > 64 ? context->snakeLength : 64;
+				if (growthPerChunk > lengthBoundPerChunk) {
+					growthPerChunk = lengthBoundPerChunk;
+				}
+				while (iterations > 0) {
+					resetGame(context);
+					Snake* snake = context->game->getSnake();
+
+					long long chunkIterations = iterations < growthPerChunk ? iterations : growthPerChunk;
+					std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+					for (long long iteration = 0; iteration < chunkIterations; iteration++) {
+						sf::Vector2i headPosition = snake->getHead().position;
+						snake->growForward(context->cycleDirections[headPosition.y * context->fieldSize.x + headPosition.x]);
+					}
+					result += resolveNanosecondsSince(start);
+
+					iterations -= chunkIterations;
+				}
+
+				return result;
+			}
+
+			double benchBodyOccupiesPosition(void* contextPointer, long long iterations) {
+				SnakeBenchContext* context = (SnakeBenchContext*)contextPointer;
+				Snake* snake = context->game->getSnake();
+				size_t queryMask = context->queryPositions.size() - 1;
+				int hits = 0;
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (long long iteration = 0; iteration < iterations; iteration++) {
+					hits += snake->bodyOccupiesPosition(context->queryPositions[iteration & queryMask]) ? 1 : 0;
+				}
+				double result = resolveNanosecondsSince(start);
+
+				benchSink = hits;
+				return result;
+			}
+
+			double benchUpdate(void* contextPointer, long long iterations) {
+				SnakeBenchContext* context = (SnakeBenchContext*)contextPointer;
+				int resetLength = (int)(context->cycle.size() * 9 / 10);
+				QuickGameInputRequest input;
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (long long iteration = 0; iteration < iterations; iteration++) {
+					// Following the cycle never hits anything, restart before the field fills up
+					Snake* snake = context->game->getSnake();
+					sf::Vector2i headPosition = snake->getHead().position;
+					input.snakeMovementInput = context->cycleDirections[headPosition.y * context->fieldSize.x + headPosition.x];
+
+					QuickGameUpdateResult updateResult = context->game->update(&input);
+					if (updateResult.snakeHitBarrierFlag || (snake->getLength() >= resetLength)) {
+						context->game->reset(&context->gameDefn);
+					}
+				}
+				return resolveNanosecondsSince(start);
+			}
+
+			// A snake bench context with the engine compiled for its field size
+			template <int Width, int Height>
+			struct FixedFieldBenchContext {
+				SnakeBenchContext* context;
+				FixedFieldGame<Width, Height>* game;
+			};
+
+			// Same moves as benchUpdate, on the engine compiled for the context's field size
+			template <int Width, int Height>
+			double benchFixedFieldUpdate(void* contextPointer, long long iterations) {
+				FixedFieldBenchContext<Width, Height>* fixedContext = (FixedFieldBenchContext<Width, Height>*)contextPointer;
+				SnakeBenchContext* context = fixedContext->context;
+				FixedFieldGame<Width, Height>* game = fixedContext->game;
+				int resetLength = (int)(context->cycle.size() * 9 / 10);
+				QuickGameInputRequest input;
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (long long iteration = 0; iteration < iterations; iteration++) {
+					sf::Vector2i headPosition = game->getHeadPosition();
+					input.snakeMovementInput = context->cycleDirections[headPosition.y * Width + headPosition.x];
+
+					QuickGameUpdateResult updateResult = game->update(&input);
+					if (updateResult.snakeHitBarrierFlag || (game->getSnakeLength() >= resetLength)) {
+						game->reset(&context->gameDefn);
+					}
+				}
+				return resolveNanosecondsSince(start);
+			}
+
+			// Visitor measuring FixedFieldGame::update, fields without a compiled engine are skipped
+			typedef struct Snake_FixedFieldUpdateBench {
+				SnakeBenchContext* context;
+				std::string name;
+				std::vector<BenchResult>* results;
+
+				int operator()(QuickGame&) {
+					return 0;
+				}
+
+				template <int Width, int Height>
+				int operator()(FixedFieldGame<Width, Height>& game) {
+					FixedFieldBenchContext<Width, Height> fixedContext;
+					fixedContext.context = this->context;
+					fixedContext.game = &game;
+					this->results->push_back(measure(this->name, benchFixedFieldUpdate<Width, Height>, &fixedContext));
+					return 1;
+				}
+			} FixedFieldUpdateBench;
+
+			double benchResolveNewApplePosition(void* contextPointer, long long iterations) {
+				SnakeBenchContext* context = (SnakeBenchContext*)contextPointer;
+				int sum = 0;
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (long long iteration = 0; iteration < iterations; iteration++) {
+					sf::Vector2i applePosition = context->game->resolveNewApplePosition();
+					sum += applePosition.x;
+				}
+				double result = resolveNanosecondsSince(start);
+
+				benchSink = sum;
+				return result;
+			}
+
+			double benchLoadBitboard(void* contextPointer, long long iterations) {
+				SnakeBenchContext* context = (SnakeBenchContext*)contextPointer;
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (long long iteration = 0; iteration < iterations; iteration++) {
+					context->bitboard->loadFromGame(*context->game);
+				}
+				return resolveNanosecondsSince(start);
+			}
+
+			double benchMeasureMove(void* contextPointer, long long iterations) {
+				SnakeBenchContext* context = (SnakeBenchContext*)contextPointer;
+				sf::Vector2i headPosition = context->game->getSnake()->getHead().position;
+				ObjectDirection direction = context->cycleDirections[headPosition.y * context->fieldSize.x + headPosition.x];
+				context->bitboard->loadFromGame(*context->game);
+				int sum = 0;
+
+				// One iteration is the flood fill a bot makes for one candidate move
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (long long iteration = 0; iteration < iterations; iteration++) {
+					FieldMoveReachability reachability = context->bitboard->measureMove(*context->game, direction);
+					sum += reachability.reachableCellCount;
+				}
+				double result = resolveNanosecondsSince(start);
+
+				benchSink = sum;
+				return result;
+			}
+
+			double benchBuildSnakeSprites(void* contextPointer, long long iterations) {
+				SnakeBenchContext* context = (SnakeBenchContext*)contextPointer;
+				Snake* snake = context->game->getSnake();
+
+				// One iteration sets up the sprites for the whole snake, like QuickGameRenderer::renderSnake does per frame
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (long long iteration = 0; iteration < iterations; iteration++) {
+					SnakeSegment tail = snake->getTail();
+					QuickGameRendererUtils::initSnakeTailSprite(context->sprite, *context->texture, tail.exitDirection);
+					context->sprite.setPosition((float)tail.position.x, (float)tail.position.y);
+
+					int bodyLength = snake->getBodyLength();
+					for (int segmentIndex = bodyLength - 1; segmentIndex >= 0; segmentIndex--) {
+						SnakeSegment body = snake->getBody(segmentIndex);
+						QuickGameRendererUtils::initSnakeBodySprite(context->sprite, *context->texture, body.enterDirection, body.exitDirection);
+						context->sprite.setPosition((float)body.position.x, (float)body.position.y);
+					}
+
+					SnakeSegment head = snake->getHead();
+					QuickGameRendererUtils::initSnakeHeadSprite(context->sprite, *context->texture, head.enterDirection);
+					context->sprite.setPosition((float)head.position.x, (float)head.position.y);
+				}
+				return resolveNanosecondsSince(start);
+			}
+
+			// State for generating levels, a new seed every iteration
+			typedef struct Snake_LevelGeneratorBenchContext {
+				QuickGameDefn gameDefn;
+				LevelGenerator* generator;
+				Level* level;
+				unsigned int seed;
+			} LevelGeneratorBenchContext;
+
+			double benchGenerateLevel(void* contextPointer, long long iterations) {
+				LevelGeneratorBenchContext* context = (LevelGeneratorBenchContext*)contextPointer;
+				int sum = 0;
+
+				// One iteration is the whole level the background generator makes before a game, validation included
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (long long iteration = 0; iteration < iterations; iteration++) {
+					context->generator->generate(context->gameDefn, context->seed++, *context->level);
+					sum += context->level->getOpenCellCount();
+				}
+				double result = resolveNanosecondsSince(start);
+
+				benchSink = sum;
+				return result;
+			}
+
+			// Set up a context for a field, with positions to query spread over the whole field
+			void initContext(SnakeBenchContext& context, sf::Vector2i fieldSize, int snakeLength, sf::Texture* texture) {
+				context.fieldSize = fieldSize;
+				context.snakeLength = snakeLength;
+				context.cycle = buildInteriorCycle(fieldSize);
+				context.cycleDirections = buildCycleDirections(fieldSize, context.cycle);
+				context.gameDefn = createGameDefn(fieldSize, context.cycle);
+				context.game = new QuickGame(&context.gameDefn);
+				context.bitboard = new FieldBitboard();
+				context.texture = texture;
+
+				std::default_random_engine queryRandomizer(7);
+				std::uniform_int_distribution<int> xDistribution(0, fieldSize.x - 1);
+				std::uniform_int_distribution<int> yDistribution(0, fieldSize.y - 1);
+				context.queryPositions.resize(1024);
+				for (size_t queryIndex = 0; queryIndex < context.queryPositions.size(); queryIndex++) {
+					context.queryPositions[queryIndex] = sf::Vector2i(xDistribution(queryRandomizer), yDistribution(queryRandomizer));
+				}
+
+				resetGame(&context);
+			}
+
+			std::string formatFieldSize(sf::Vector2i fieldSize) {
+				return std::to_string(fieldSize.x) + "x" + std::to_string(fieldSize.y);
+			}
+
+			bool matchesFilter(const std::string& name, const char* filter) {
+				return (filter == nullptr) || (name.find(filter) != std::string::npos);
+			}
+
+			// Run every benchmark whose name contains the filter
+			std::vector<BenchResult> runAll(const char* filter) {
+				std::vector<BenchResult> results;
+				sf::Texture texture;
+
+				for (const sf::Vector2i& fieldSize : FIELD_SIZES) {
+					std::string fieldName = "field=" + formatFieldSize(fieldSize);
+					int interiorCellCount = (fieldSize.x - 2) * (fieldSize.y - 2);
+
+					for (int snakeLength : SNAKE_LENGTHS) {
+						if (snakeLength >= interiorCellCount / 2) {
+							continue;
+						}
+
+						SnakeBenchContext context;
+						initContext(context, fieldSize, snakeLength, &texture);
+						std::string suffix = "/length=" + std::to_string(snakeLength) + "/" + fieldName;
+
+						struct { const char* name; BatchFunction batchFunction; } snakeBenchmarks[] = {
+							{ "Snake::moveForward", benchMoveForward },
+							{ "Snake::growForward", benchGrowForward },
+							{ "Snake::bodyOccupiesPosition", benchBodyOccupiesPosition },
+							{ "QuickGameRenderer::buildSnakeSprites", benchBuildSnakeSprites },
+							{ "FieldBitboard::loadFromGame", benchLoadBitboard },
+							{ "FieldBitboard::measureMove", benchMeasureMove },
+						};
+						for (auto& benchmark : snakeBenchmarks) {
+							std::string name = benchmark.name + suffix;
+							if (matchesFilter(name, filter)) {
+								resetGame(&context);
+								results.push_back(measure(name, benchmark.batchFunction, &context));
+							}
+						}
+
+						delete context.game;
+						delete context.bitboard;
+					}
+
+					{
+						SnakeBenchContext context;
+						initContext(context, fieldSize, 3, &texture);
+						std::string name = "QuickGame::update/" + fieldName;
+						if (matchesFilter(name, filter)) {
+							results.push_back(measure(name, benchUpdate, &context));
+						}
+
+						FixedFieldUpdateBench fixedBench;
+						fixedBench.context = &context;
+						fixedBench.name = "FixedFieldGame::update/" + fieldName;
+						fixedBench.results = &results;
+						if (matchesFilter(fixedBench.name, filter)) {
+							FixedFieldUtils::visitGame(context.gameDefn, fixedBench);
+						}
+						std::string levelName = "LevelGenerator::generate/" + fieldName;
+						if (matchesFilter(levelName, filter)) {
+							LevelGeneratorBenchContext levelContext;
+							levelContext.gameDefn = context.gameDefn;
+							levelContext.generator = new LevelGenerator(LevelGenerator::resolveDefaultSettings());
+							levelContext.level = new Level();
+							levelContext.seed = 1;
+							results.push_back(measure(levelName, benchGenerateLevel, &levelContext));
+							delete levelContext.level;
+							delete levelContext.generator;
+						}
+						delete context.game;
+						delete context.bitboard;
+					}
+
+					// The many-food mode should update as fast as the single apple whatever the number of foods
+					for (int foodCount : FOOD_COUNTS) {
+						if (foodCount > interiorCellCount / 4) {
+							continue;
+						}
+
+						SnakeBenchContext context;
+						initContext(context, fieldSize, 3, &texture);
+						context.game->setFoodCount(foodCount);
+						std::string name = "QuickGame::update/foods=" + std::to_string(foodCount) + "/" + fieldName;
+						if (matchesFilter(name, filter)) {
+							results.push_back(measure(name, benchUpdate, &context));
+						}
+						delete context.game;
+						delete context.bitboard;
+					}
+
+					for (float fillRatio : FILL_RATIOS) {
+						SnakeBenchContext context;
+						initContext(context, fieldSize, (int)(interiorCellCount * fillRatio), &texture);
+						std::string name = "QuickGame::resolveNewApplePosition/fill=" + std::to_string((int)(fillRatio * 100.0f)) + "%/" + fieldName;
+						if (matchesFilter(name, filter)) {
+							results.push_back(measure(name, benchResolveNewApplePosition, &context));
+						}
+						delete context.game;
+						delete context.bitboard;
+					}
+				}
+
+				return results;
+			}
+
+			// Write the results as JSON, one benchmark per line so the baseline can be read back without a JSON library
+			bool writeResults(const char* path, const std::vector<BenchResult>& results) {
+				FILE* file = fopen(path, "w");
+				if (file == nullptr) {
+					return false;
+				}
+
+				fprintf(file, "{\n  \"benchmarks\": [\n");
+				for (size_t resultIndex = 0; resultIndex < results.size(); resultIndex++) {
+					const BenchResult& result = results[resultIndex];
+					fprintf(file, "    {\"name\": \"%s\", \"iterations\": %lld, \"nanoseconds_per_op\": %.3f}%s\n",
+						result.name.c_str(), result.iterations, result.nanosecondsPerOp, (resultIndex + 1 < results.size()) ? "," : "");
+				}
+				fprintf(file, "  ]\n}\n");
+
+				fclose(file);
+				return true;
+			}
+
+			// Read back a results file written by writeResults()
+			bool readResults(const char* path, std::vector<BenchResult>& results) {
+				FILE* file = fopen(path, "r");
+				if (file == nullptr) {
+					return false;
+				}
+
+				const char* NAME_KEY = "\"name\": \"";
+				const char* NANOSECONDS_KEY = "\"nanoseconds_per_op\": ";
+
+				char line[1024];
+				while (fgets(line, sizeof(line), file) != nullptr) {
+					const char* nameStart = strstr(line, NAME_KEY);
+					const char* nanosecondsStart = strstr(line, NANOSECONDS_KEY);
+					if ((nameStart == nullptr) || (nanosecondsStart == nullptr)) {
+						continue;
+					}
+
+					nameStart += strlen(NAME_KEY);
+					const char* nameEnd = strchr(nameStart, '"');
+					if (nameEnd == nullptr) {
+						continue;
+					}
+
+					BenchResult result;
+					result.name = std::string(nameStart, nameEnd - nameStart);
+					result.iterations = 0;
+					result.nanosecondsPerOp = strtod(nanosecondsStart + strlen(NANOSECONDS_KEY), nullptr);
+					results.push_back(result);
+				}
+
+				fclose(file);
+				return true;
+			}
+
+			// Compare against the baseline and return the number of benchmarks that got slower than the threshold allows
+			int compareWithBaseline(const std::vector<BenchResult>& results, const std::vector<BenchResult>& baseline, double threshold) {
+				int regressionCount = 0;
+
+				for (const BenchResult& result : results) {
+					for (const BenchResult& baselineResult : baseline) {
+						if (baselineResult.name != result.name) {
+							continue;
+						}
+
+						double change = (result.nanosecondsPerOp / baselineResult.nanosecondsPerOp) - 1.0;
+						bool regressed = change > threshold;
+						if (regressed) {
+							regressionCount++;
+						}
+						fprintf(stderr, "%-64s %+7.1f%%%s\n", result.name.c_str(), change * 100.0, regressed ? "  REGRESSION" : "");
+						break;
+					}
+				}
+
+				return regressionCount;
+			}
+
+			// Print how much faster every benchmark is than the baseline, with the geometric mean for the simulation and render groups
+			void reportSpeedups(const std::vector<BenchResult>& results, const std::vector<BenchResult>& baseline) {
+				const char* RENDER_PREFIX = "QuickGameRenderer::";
+
+				double logSpeedupSum[2] = { 0.0, 0.0 };
+				int speedupCount[2] = { 0, 0 };
+
+				for (const BenchResult& result : results) {
+					for (const BenchResult& baselineResult : baseline) {
+						if (baselineResult.name != result.name) {
+							continue;
+						}
+
+						double speedup = baselineResult.nanosecondsPerOp / result.nanosecondsPerOp;
+						int groupIndex = (result.name.compare(0, strlen(RENDER_PREFIX), RENDER_PREFIX) == 0) ? 1 : 0;
+						logSpeedupSum[groupIndex] += log(speedup);
+						speedupCount[groupIndex]++;
+
+						fprintf(stderr, "%-64s %7.2fx\n", result.name.c_str(), speedup);
+						break;
+					}
+				}
+
+				const char* GROUP_NAMES[2] = { "simulation", "render" };
+				for (int groupIndex = 0; groupIndex < 2; groupIndex++) {
+					if (speedupCount[groupIndex] > 0) {
+						fprintf(stderr, "%s geometric mean speedup: %.2fx over %d benchmark(s)\n",
+							GROUP_NAMES[groupIndex], exp(logSpeedupSum[groupIndex] / speedupCount[groupIndex]), speedupCount[groupIndex]);
+					}
+				}
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	const char* outputPath = "bin/bench-results.json";
+	const char* baselinePath = nullptr;
+	const char* filter = nullptr;
+	bool reportOnly = false;
+	double threshold = snake::SnakeBench::DEFAULT_REGRESSION_THRESHOLD;
+
+	// Parse command line options
+	for (int argIndex = 1; argIndex < argc; argIndex++) {
+		if (strcmp(argv[argIndex], "--report") == 0) {
+			reportOnly = true;
+			continue;
+		}
+		if (argIndex + 1 >= argc) {
+			break;
+		}
+
+		if (strcmp(argv[argIndex], "--output") == 0) {
+			outputPath = argv[argIndex + 1];
+		} else if (strcmp(argv[argIndex], "--baseline") == 0) {
+			baselinePath = argv[argIndex + 1];
+		} else if (strcmp(argv[argIndex], "--threshold") == 0) {
+			threshold = atof(argv[argIndex + 1]);
+		} else if (strcmp(argv[argIndex], "--filter") == 0) {
+			filter = argv[argIndex + 1];
+		}
+		argIndex++;
+	}
+
+	std::vector<snake::SnakeBench::BenchResult> results = snake::SnakeBench::runAll(filter);
+	if (!snake::SnakeBench::writeResults(outputPath, results)) {
+		fprintf(stderr, "Could not write %s\n", outputPath);
+		return 1;
+	}
+
+	// Without a baseline the run only records results
+	if (baselinePath == nullptr) {
+		return 0;
+	}
+
+	// A comparison that was asked for and cannot be made fails, or a missing baseline would pass every run unchecked
+	std::vector<snake::SnakeBench::BenchResult> baseline;
+	if (!snake::SnakeBench::readResults(baselinePath, baseline)) {
+		fprintf(stderr, "No baseline at %s, record one with make bench-baseline\n", baselinePath);
+		return 1;
+	}
+
+	// A report compares build profiles, so it never fails
+	if (reportOnly) {
+		snake::SnakeBench::reportSpeedups(results, baseline);
+		return 0;
+	}
+
+	int regressionCount = snake::SnakeBench::compareWithBaseline(results, baseline, threshold);
+	if (regressionCount > 0) {
+		fprintf(stderr, "%d benchmark(s) regressed by more than %.0f%%\n", regressionCount, threshold * 100.0);
+		return 1;
+	}
+
+	return 0;
+}
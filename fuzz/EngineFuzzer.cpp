@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "reference/referencegame.hpp"
+#include "../src/includes/quickgame.hpp"
+#include "../src/includes/fixedfieldgame.hpp"
+
+
+	namespace snake {
+
+		namespace EngineFuzzer {
+
+			// Bytes at the start of every input that describe the game instead of its inputs
+			const size_t FUZZ_HEADER_SIZE = 11;
+
+			// Longest game played for one input, so a single input cannot stall the fuzzer
+			const int FUZZ_MAX_FRAMES = 100000;
+
+			// Snake speeds the fuzzer picks from, fast speeds move the snake on more frames
+			const float FUZZ_SNAKE_SPEEDS[] = { 60.0f, 30.0f, 20.0f, 10.0f };
+
+			// Fixed field engine played alongside the other two, inputs with the top bit of their speed byte set are played on its field
+			typedef FixedFieldGame<50, 25> FuzzFixedFieldGame;
+
+			// Fold one value into an FNV-1a hash
+			uint64_t hashValue(uint64_t hash, int value) {
+				uint32_t bits = (uint32_t)value;
+				for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
+					hash ^= (bits >> (byteIndex * 8)) & 0xFF;
+					hash *= 1099511628211ULL;
+				}
+				return hash;
+			}
+
+			uint64_t hashSegment(uint64_t hash, const SnakeSegment& segment) {
+				hash = hashValue(hash, (int)segment.segmentType);
+				hash = hashValue(hash, segment.position.x);
+				hash = hashValue(hash, segment.position.y);
+				hash = hashValue(hash, (int)segment.enterDirection);
+				hash = hashValue(hash, (int)segment.exitDirection);
+				return hash;
+			}
+
+			// Fold in the apple and what the frame reported
+			template <typename GameType>
+			uint64_t hashAppleAndResult(uint64_t hash, const GameType& game, const QuickGameUpdateResult& updateResult) {
+				uint64_t result = hash;
+				result = hashValue(result, game.getAppleExists() ? 1 : 0);
+				result = hashValue(result, game.getApplePosition().x);
+				result = hashValue(result, game.getApplePosition().y);
+
+				result = hashValue(result, (int)updateResult.snakeMovementResult);
+				result = hashValue(result, updateResult.snakeHitBarrierFlag ? 1 : 0);
+				result = hashValue(result, updateResult.snakeAteAppleFlag ? 1 : 0);
+				result = hashValue(result, updateResult.snakeGrewFlag ? 1 : 0);
+				result = hashValue(result, updateResult.appleSpawnedFlag ? 1 : 0);
+				return result;
+			}
+
+			// Hash everything a player can observe after a frame: every segment, the apple and what the frame reported
+			template <typename GameType>
+			uint64_t hashGameState(const GameType& game, const QuickGameUpdateResult& updateResult) {
+				uint64_t result = 14695981039346656037ULL;
+
+				auto snake = game.getSnake();
+				result = hashSegment(result, snake->getHead());
+				for (int bodyIndex = 0; bodyIndex < snake->getBodyLength(); bodyIndex++) {
+					result = hashSegment(result, snake->getBody(bodyIndex));
+				}
+				result = hashSegment(result, snake->getTail());
+				result = hashValue(result, snake->getLength());
+
+				return hashAppleAndResult(result, game, updateResult);
+			}
+
+			// Get the cell of a segment counted from the head, for engines keeping segments and for the fixed field engine keeping only cells
+			sf::Vector2i resolveSegmentPosition(const QuickGame& game, int segmentIndex) {
+				auto snake = game.getSnake();
+				if (segmentIndex == 0) {
+					return snake->getHead().position;
+				}
+				if (segmentIndex == snake->getLength() - 1) {
+					return snake->getTail().position;
+				}
+				return snake->getBody(segmentIndex - 1).position;
+			}
+
+			sf::Vector2i resolveSegmentPosition(const FuzzFixedFieldGame& game, int segmentIndex) {
+				return game.getSegmentPosition(segmentIndex);
+			}
+
+			// Hash the cells of every segment from the head, the apple and what the frame reported, everything the fixed field engine can observe
+			template <typename GameType>
+			uint64_t hashCellState(const GameType& game, int snakeLength, const QuickGameUpdateResult& updateResult) {
+				uint64_t result = 14695981039346656037ULL;
+
+				for (int segmentIndex = 0; segmentIndex < snakeLength; segmentIndex++) {
+					sf::Vector2i position = resolveSegmentPosition(game, segmentIndex);
+					result = hashValue(result, position.x);
+					result = hashValue(result, position.y);
+				}
+				result = hashValue(result, snakeLength);
+
+				return hashAppleAndResult(result, game, updateResult);
+			}
+
+			// Pick a start inside the walls with the whole snake behind its head, games always start at length three or more
+			QuickGameDefn decodeGameDefn(const uint8_t* data) {
+				QuickGameDefn result;
+				result.randomSeed = (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+				result.fieldSize = sf::Vector2i(5 + (data[4] % 46), 5 + (data[5] % 26));
+				if ((data[6] & 0x80) != 0) {
+					result.fieldSize = FuzzFixedFieldGame::getFieldSize();
+				}
+				result.snakeSpeedTilesPerSecond = FUZZ_SNAKE_SPEEDS[data[6] % 4];
+
+				ObjectDirection facingDirection = (ObjectDirection)(1 + (data[7] % 4));
+				sf::Vector2i facingVector = SnakeUtils::directionToVector(facingDirection);
+				int extentAlongFacing = (facingVector.x != 0) ? (result.fieldSize.x - 2) : (result.fieldSize.y - 2);
+				int length = 3 + (data[8] % (extentAlongFacing - 2));
+
+				// The head has to be length - 1 cells ahead of the wall behind it
+				sf::Vector2i minimumHead(1, 1);
+				sf::Vector2i maximumHead(result.fieldSize.x - 2, result.fieldSize.y - 2);
+				if (facingVector.x > 0) { minimumHead.x = length; }
+				if (facingVector.x < 0) { maximumHead.x = result.fieldSize.x - 1 - length; }
+				if (facingVector.y > 0) { minimumHead.y = length; }
+				if (facingVector.y < 0) { maximumHead.y = result.fieldSize.y - 1 - length; }
+
+				result.snakeStartDefn.headPosition.x = minimumHead.x + (data[9] % (maximumHead.x - minimumHead.x + 1));
+				result.snakeStartDefn.headPosition.y = minimumHead.y + (data[10] % (maximumHead.y - minimumHead.y + 1));
+				result.snakeStartDefn.facingDirection = facingDirection;
+				result.snakeStartDefn.length = length;
+				return result;
+			}
+
+			template <typename SnakeType>
+			void printSnake(const char* engineName, const SnakeType* snake) {
+				fprintf(stderr, "%s: head (%d, %d) tail (%d, %d) length %d\n", engineName,
+					snake->getHead().position.x, snake->getHead().position.y,
+					snake->getTail().position.x, snake->getTail().position.y, snake->getLength());
+			}
+
+			void printFixedFieldSnake(const FuzzFixedFieldGame& game) {
+				fprintf(stderr, "fixed field: head (%d, %d) tail (%d, %d) length %d\n",
+					game.getHeadPosition().x, game.getHeadPosition().y,
+					game.getTailPosition().x, game.getTailPosition().y, game.getSnakeLength());
+			}
+
+			// The production games are built once and reset for every input, so their reuse paths are fuzzed too
+			QuickGame* productionGame = nullptr;
+			FuzzFixedFieldGame* fixedFieldGame = nullptr;
+
+			// Play one input through every engine for its field and abort on the first frame their states differ
+			void runInput(const uint8_t* data, size_t size) {
+				if (size < FUZZ_HEADER_SIZE) {
+					return;
+				}
+
+				QuickGameDefn gameDefn = decodeGameDefn(data);
+				reference::QuickGame referenceGame(&gameDefn);
+				if (productionGame == nullptr) {
+					productionGame = new QuickGame(&gameDefn);
+				} else {
+					productionGame->reset(&gameDefn);
+				}
+
+				// The fixed field engine only plays the field it is compiled for
+				bool fixedFieldFlag = gameDefn.fieldSize == FuzzFixedFieldGame::getFieldSize();
+				if (fixedFieldFlag) {
+					if (fixedFieldGame == nullptr) {
+						fixedFieldGame = new FuzzFixedFieldGame(&gameDefn);
+					} else {
+						fixedFieldGame->reset(&gameDefn);
+					}
+				}
+
+				int interiorCellCount = (gameDefn.fieldSize.x - 2) * (gameDefn.fieldSize.y - 2);
+				int frame = 0;
+
+				// Every input byte holds a direction in its low three bits (5 to 7 meaning no input) and how many frames to hold it
+				for (size_t dataIndex = FUZZ_HEADER_SIZE; dataIndex < size; dataIndex++) {
+					QuickGameInputRequest input;
+					int directionBits = data[dataIndex] & 0x7;
+					input.snakeMovementInput = (directionBits <= 4) ? (ObjectDirection)directionBits : ObjectDirection::NONE;
+					int holdFrames = 1 + (data[dataIndex] >> 3);
+
+					for (int holdIndex = 0; holdIndex < holdFrames; holdIndex++) {
+						// A snake filling the whole field leaves nowhere to place the next apple
+						bool fieldFull = !referenceGame.getAppleExists() && (referenceGame.getSnake()->getLength() >= interiorCellCount);
+						if (fieldFull || (frame >= FUZZ_MAX_FRAMES)) {
+							return;
+						}
+
+						QuickGameUpdateResult referenceResult = referenceGame.update(&input);
+						QuickGameUpdateResult productionResult = productionGame->update(&input);
+						frame++;
+
+						uint64_t referenceHash = hashGameState(referenceGame, referenceResult);
+						uint64_t productionHash = hashGameState(*productionGame, productionResult);
+						if (referenceHash != productionHash) {
+							fprintf(stderr, "Engines diverged on frame %d (seed %u, field %dx%d, input %d)\n",
+								frame, gameDefn.randomSeed, gameDefn.fieldSize.x, gameDefn.fieldSize.y, (int)input.snakeMovementInput);
+							printSnake("reference", referenceGame.getSnake());
+							printSnake("production", productionGame->getSnake());
+							abort();
+						}
+
+						if (fixedFieldFlag) {
+							QuickGameUpdateResult fixedFieldResult = fixedFieldGame->update(&input);
+							uint64_t productionCellHash = hashCellState(*productionGame, productionGame->getSnake()->getLength(), productionResult);
+							uint64_t fixedFieldCellHash = hashCellState(*fixedFieldGame, fixedFieldGame->getSnakeLength(), fixedFieldResult);
+							if ((productionCellHash != fixedFieldCellHash) || (productionGame->getStateHash() != fixedFieldGame->getStateHash())) {
+								fprintf(stderr, "Fixed field engine diverged on frame %d (seed %u, input %d)\n",
+									frame, gameDefn.randomSeed, (int)input.snakeMovementInput);
+								printSnake("production", productionGame->getSnake());
+								printFixedFieldSnake(*fixedFieldGame);
+								abort();
+							}
+						}
+
+						if (referenceResult.snakeHitBarrierFlag) {
+							return;
+						}
+					}
+				}
+			}
+
+		}
+
+	}
+
+
+// Entry point called by libFuzzer, and by the standalone driver when libFuzzer is not available
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	snake::EngineFuzzer::runInput(data, size);
+	return 0;
+}
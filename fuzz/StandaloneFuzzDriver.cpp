@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <random>
+#include <vector>
+
+// Implemented by the fuzz target
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+
+	namespace snake {
+
+		namespace StandaloneFuzzDriver {
+
+			const int DEFAULT_ITERATIONS = 10000;
+			const int DEFAULT_MAX_INPUT_SIZE = 4096;
+
+			// Run a crash or corpus file through the fuzz target
+			bool runFile(const char* path) {
+				FILE* file = fopen(path, "rb");
+				if (file == nullptr) {
+					fprintf(stderr, "Could not open %s\n", path);
+					return false;
+				}
+
+				std::vector<uint8_t> data;
+				uint8_t buffer[4096];
+				size_t readCount;
+				while ((readCount = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+					data.insert(data.end(), buffer, buffer + readCount);
+				}
+				fclose(file);
+
+				LLVMFuzzerTestOneInput(data.data(), data.size());
+				return true;
+			}
+
+			// Feed random inputs to the fuzz target, for machines without libFuzzer
+			void runRandom(int iterations, unsigned int seed, int maxInputSize) {
+				std::mt19937 randomizer(seed);
+				std::uniform_int_distribution<int> sizeDistribution(0, maxInputSize);
+				std::uniform_int_distribution<int> byteDistribution(0, 255);
+
+				std::vector<uint8_t> data;
+				for (int iteration = 0; iteration < iterations; iteration++) {
+					data.resize(sizeDistribution(randomizer));
+					for (uint8_t& value : data) {
+						value = (uint8_t)byteDistribution(randomizer);
+					}
+
+					LLVMFuzzerTestOneInput(data.data(), data.size());
+				}
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	int iterations = snake::StandaloneFuzzDriver::DEFAULT_ITERATIONS;
+	unsigned int seed = 1;
+	int maxInputSize = snake::StandaloneFuzzDriver::DEFAULT_MAX_INPUT_SIZE;
+	int fileCount = 0;
+
+	// Options set up random runs, any other argument is an input file to replay
+	for (int argIndex = 1; argIndex < argc; argIndex++) {
+		if ((strcmp(argv[argIndex], "--iterations") == 0) && (argIndex + 1 < argc)) {
+			iterations = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--seed") == 0) && (argIndex + 1 < argc)) {
+			seed = (unsigned int)strtoul(argv[++argIndex], nullptr, 10);
+		} else if ((strcmp(argv[argIndex], "--max-size") == 0) && (argIndex + 1 < argc)) {
+			maxInputSize = atoi(argv[++argIndex]);
+		} else {
+			if (!snake::StandaloneFuzzDriver::runFile(argv[argIndex])) {
+				return 1;
+			}
+			fileCount++;
+		}
+	}
+
+	if (fileCount == 0) {
+		snake::StandaloneFuzzDriver::runRandom(iterations, seed, maxInputSize);
+		fprintf(stderr, "%d random input(s) matched the reference engine\n", iterations);
+	} else {
+		fprintf(stderr, "%d input file(s) matched the reference engine\n", fileCount);
+	}
+
+	return 0;
+}
@@ -0,0 +1,134 @@
+#include "referencegame.hpp"
+
+
+	namespace snake {
+
+		namespace reference {
+
+			// Constructor for the reference QuickGame
+			QuickGame::QuickGame(const QuickGameDefn* quickGameDefn) : snake(quickGameDefn->snakeStartDefn) {
+				this->randomizer.seed(quickGameDefn->randomSeed);
+
+				this->fieldSize = quickGameDefn->fieldSize;
+				this->snakeSpeedTilesPerSecond = quickGameDefn->snakeSpeedTilesPerSecond;
+
+				this->appleExistsFlag = false;
+				this->applePosition = sf::Vector2i(0, 0);
+
+				this->framesSinceSnakeMoved = 0;
+				this->queuedSnakeInput = ObjectDirection::NONE;
+				this->queuedSnakeGrowth = 0;
+			}
+
+			// Get the size of the game field
+			sf::Vector2i QuickGame::getFieldSize() const {
+				return this->fieldSize;
+			}
+
+			// Get the snake
+			const Snake* QuickGame::getSnake() const {
+				return &this->snake;
+			}
+
+			// Check if the apple currently exists
+			bool QuickGame::getAppleExists() const {
+				return this->appleExistsFlag;
+			}
+
+			// Get the position of the apple
+			sf::Vector2i QuickGame::getApplePosition() const {
+				return this->applePosition;
+			}
+
+			// Advance the game by one frame
+			QuickGameUpdateResult QuickGame::update(const QuickGameInputRequest* input) {
+				QuickGameUpdateResult result;
+				result.snakeMovementResult = ObjectDirection::NONE;
+				result.snakeHitBarrierFlag = false;
+				result.snakeAteAppleFlag = false;
+				result.snakeGrewFlag = false;
+				result.appleSpawnedFlag = false;
+
+				// An apple is placed at the start of the frame after the last one was eaten
+				if (!this->appleExistsFlag) {
+					this->applePosition = this->resolveNewApplePosition();
+					this->appleExistsFlag = true;
+					result.appleSpawnedFlag = true;
+				}
+
+				this->framesSinceSnakeMoved++;
+
+				// The latest valid input wins, validity is judged against the direction the head last moved
+				if (this->snake.isValidMovementDirection(input->snakeMovementInput)) {
+					this->queuedSnakeInput = input->snakeMovementInput;
+				}
+
+				if (this->framesSinceSnakeMoved >= (60.0f / this->snakeSpeedTilesPerSecond)) {
+					ObjectDirection directionToMoveSnake = this->queuedSnakeInput;
+					if (directionToMoveSnake == ObjectDirection::NONE) {
+						directionToMoveSnake = this->snake.getHead().enterDirection;
+					}
+
+					if (this->snakeWouldHitBarrier(directionToMoveSnake)) {
+						result.snakeHitBarrierFlag = true;
+					} else {
+						// Each eaten apple grows the snake on the next two moves
+						if (this->queuedSnakeGrowth > 0) {
+							this->snake.growForward(directionToMoveSnake);
+							this->queuedSnakeGrowth--;
+							result.snakeGrewFlag = true;
+						}
+						else {
+							this->snake.moveForward(directionToMoveSnake);
+						}
+
+						result.snakeMovementResult = directionToMoveSnake;
+
+						if (this->snake.getHead().position == this->applePosition) {
+							result.snakeAteAppleFlag = true;
+
+							this->appleExistsFlag = false;
+							this->queuedSnakeGrowth += 2;
+						}
+					}
+
+					this->framesSinceSnakeMoved = 0;
+				}
+
+				return result;
+			}
+
+			// Draw random interior cells until one is free of the snake
+			sf::Vector2i QuickGame::resolveNewApplePosition() {
+				sf::Vector2i result;
+
+				std::uniform_int_distribution<int> xPositionDistribution(1, this->fieldSize.x - 2);
+				std::uniform_int_distribution<int> yPositionDistribution(1, this->fieldSize.y - 2);
+
+				bool foundFreePositionFlag = false;
+				while (!foundFreePositionFlag) {
+					result.x = xPositionDistribution(this->randomizer);
+					result.y = yPositionDistribution(this->randomizer);
+
+					foundFreePositionFlag = !this->snake.occupiesPosition(result);
+				}
+
+				return result;
+			}
+
+			// The walls are the outermost ring of cells, the head and tail cells are not obstacles
+			bool QuickGame::snakeWouldHitBarrier(ObjectDirection direction) const {
+				sf::Vector2i newHeadPosition = this->snake.getHead().position + SnakeUtils::directionToVector(direction);
+
+				bool result =
+					(newHeadPosition.x <= 0) ||
+					(newHeadPosition.x >= (this->fieldSize.x - 1)) ||
+					(newHeadPosition.y <= 0) ||
+					(newHeadPosition.y >= (this->fieldSize.y - 1)) ||
+					this->snake.bodyOccupiesPosition(newHeadPosition);
+				return result;
+			}
+
+		}
+
+	}
@@ -0,0 +1,187 @@
+#include "referencegame.hpp"
+
+
+	namespace snake {
+
+		namespace reference {
+
+			namespace SnakeUtils {
+
+				// Convert a direction to a vector offset
+				sf::Vector2i directionToVector(const ObjectDirection& direction) {
+					sf::Vector2i result(0, 0);
+
+					switch (direction) {
+					case ObjectDirection::UP:
+						result.y--;
+						break;
+					case ObjectDirection::RIGHT:
+						result.x++;
+						break;
+					case ObjectDirection::DOWN:
+						result.y++;
+						break;
+					case ObjectDirection::LEFT:
+						result.x--;
+						break;
+					default:
+						break;
+					}
+
+					return result;
+				}
+
+			}
+
+			// Constructor for the reference Snake, laying the body out behind the head
+			Snake::Snake(const SnakeStartDefn& startDefn) {
+				sf::Vector2i nextSegmentPosition = startDefn.headPosition;
+				sf::Vector2i adjustVector = sf::Vector2i(0, 0) - SnakeUtils::directionToVector(startDefn.facingDirection);
+
+				this->head.segmentType = SnakeSegmentType::HEAD;
+				this->head.position = nextSegmentPosition;
+				this->head.enterDirection = startDefn.facingDirection;
+				this->head.exitDirection = ObjectDirection::NONE;
+
+				int bodyCount = startDefn.length - 2;
+				for (int currBodyPos = 0; currBodyPos < bodyCount; currBodyPos++) {
+					nextSegmentPosition += adjustVector;
+
+					SnakeSegment currBodySegment;
+					currBodySegment.segmentType = SnakeSegmentType::BODY;
+					currBodySegment.position = nextSegmentPosition;
+					currBodySegment.enterDirection = startDefn.facingDirection;
+					currBodySegment.exitDirection = startDefn.facingDirection;
+
+					this->bodyList.push_back(currBodySegment);
+				}
+
+				nextSegmentPosition += adjustVector;
+
+				this->tail.segmentType = SnakeSegmentType::TAIL;
+				this->tail.position = nextSegmentPosition;
+				this->tail.enterDirection = ObjectDirection::NONE;
+				this->tail.exitDirection = startDefn.facingDirection;
+			}
+
+			// Get the head segment of the snake
+			SnakeSegment Snake::getHead() const {
+				return this->head;
+			}
+
+			// Get the number of body segments
+			int Snake::getBodyLength() const {
+				return (int)this->bodyList.size();
+			}
+
+			// Get a body segment, counted from the head
+			SnakeSegment Snake::getBody(int segmentIndex) const {
+				return this->bodyList.at(segmentIndex);
+			}
+
+			// Get the tail segment of the snake
+			SnakeSegment Snake::getTail() const {
+				return this->tail;
+			}
+
+			// Get the total length of the snake (head, body, and tail)
+			int Snake::getLength() const {
+				return (int)this->bodyList.size() + 2;
+			}
+
+			// Any direction except none and straight back is valid
+			bool Snake::isValidMovementDirection(ObjectDirection direction) const {
+				bool result = false;
+
+				switch (this->head.enterDirection) {
+				case ObjectDirection::UP:
+					result = (direction != ObjectDirection::NONE) && (direction != ObjectDirection::DOWN);
+					break;
+				case ObjectDirection::RIGHT:
+					result = (direction != ObjectDirection::NONE) && (direction != ObjectDirection::LEFT);
+					break;
+				case ObjectDirection::DOWN:
+					result = (direction != ObjectDirection::NONE) && (direction != ObjectDirection::UP);
+					break;
+				case ObjectDirection::LEFT:
+					result = (direction != ObjectDirection::NONE) && (direction != ObjectDirection::RIGHT);
+					break;
+				default:
+					break;
+				}
+
+				return result;
+			}
+
+			// Check if any segment occupies a position
+			bool Snake::occupiesPosition(sf::Vector2i position) const {
+				bool result =
+					(this->head.position == position) ||
+					this->bodyOccupiesPosition(position) ||
+					(this->tail.position == position);
+				return result;
+			}
+
+			// Check if a body segment occupies a position, the head and tail do not count
+			bool Snake::bodyOccupiesPosition(sf::Vector2i position) const {
+				for (const SnakeSegment& currBodySegment : this->bodyList) {
+					if (currBodySegment.position == position) {
+						return true;
+					}
+				}
+				return false;
+			}
+
+			// Move every segment one cell along the snake
+			void Snake::moveForward(ObjectDirection direction) {
+				this->moveHeadForward(direction);
+				this->moveBodyForward();
+				this->moveTailForward();
+			}
+
+			// Move the head and body, and add a body segment where the last one was so the tail stays put
+			void Snake::growForward(ObjectDirection direction) {
+				this->moveHeadForward(direction);
+				this->moveBodyForward();
+
+				SnakeSegment lastBodySegment = this->bodyList.back();
+
+				SnakeSegment extraBodySegment;
+				extraBodySegment.segmentType = SnakeSegmentType::BODY;
+				extraBodySegment.position = lastBodySegment.position - SnakeUtils::directionToVector(lastBodySegment.enterDirection);
+				extraBodySegment.exitDirection = lastBodySegment.enterDirection;
+				extraBodySegment.enterDirection = this->tail.exitDirection;
+
+				this->bodyList.push_back(extraBodySegment);
+			}
+
+			// Move the head one cell in a direction
+			void Snake::moveHeadForward(ObjectDirection direction) {
+				this->head.position += SnakeUtils::directionToVector(direction);
+				this->head.enterDirection = direction;
+			}
+
+			// Move every body segment one cell along its exit direction
+			void Snake::moveBodyForward() {
+				ObjectDirection previousSegmentEnterDirection = this->head.enterDirection;
+
+				for (SnakeSegment& currBodySegment : this->bodyList) {
+					currBodySegment.position += SnakeUtils::directionToVector(currBodySegment.exitDirection);
+					currBodySegment.enterDirection = currBodySegment.exitDirection;
+					currBodySegment.exitDirection = previousSegmentEnterDirection;
+
+					previousSegmentEnterDirection = currBodySegment.enterDirection;
+				}
+			}
+
+			// Move the tail one cell after the last body segment
+			void Snake::moveTailForward() {
+				ObjectDirection newExitDirection = this->bodyList.back().enterDirection;
+
+				this->tail.position += SnakeUtils::directionToVector(this->tail.exitDirection);
+				this->tail.exitDirection = newExitDirection;
+			}
+
+		}
+
+	}
@@ -0,0 +1,99 @@
+//This header file defines the reference snake engine, a frozen copy of the straightforward game logic the optimized engine is checked against.
+//Do not optimize this code: it is the specification. It shares the production data types so both engines can be fed the same inputs.
+#include <random>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "../../src/includes/quickgame.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		namespace reference {
+
+			namespace SnakeUtils {
+				//Reference copy of the direction to offset conversion.
+				sf::Vector2i directionToVector(const ObjectDirection& direction);
+
+			}
+
+			class Snake;
+			class QuickGame;
+
+			//Reference snake, keeping its body in a vector and scanning it for every occupancy check.
+			class Snake {
+
+			private:
+				SnakeSegment head;
+				std::vector<SnakeSegment> bodyList;
+				SnakeSegment tail;
+
+			public:
+				Snake(const SnakeStartDefn& startDefn);
+
+			public:
+				SnakeSegment getHead() const;
+				int getBodyLength() const;
+				SnakeSegment getBody(int segmentIndex) const;
+				SnakeSegment getTail() const;
+				int getLength() const;
+
+			public:
+				bool isValidMovementDirection(ObjectDirection direction) const;
+				bool occupiesPosition(sf::Vector2i position) const;
+				bool bodyOccupiesPosition(sf::Vector2i position) const;
+
+			public:
+				void moveForward(ObjectDirection direction);
+				void growForward(ObjectDirection direction);
+
+			private:
+				void moveHeadForward(ObjectDirection direction);
+				void moveBodyForward();
+				void moveTailForward();
+
+			};
+
+			//Reference quick game, advanced one frame at a time by update() exactly like the production QuickGame.
+			class QuickGame {
+
+			private:
+				std::default_random_engine randomizer;
+
+			private:
+				sf::Vector2i fieldSize;
+				float snakeSpeedTilesPerSecond;
+				Snake snake;
+
+			private:
+				bool appleExistsFlag;
+				sf::Vector2i applePosition;
+
+			private:
+				int framesSinceSnakeMoved;
+				ObjectDirection queuedSnakeInput;
+				int queuedSnakeGrowth;
+
+			public:
+				QuickGame(const QuickGameDefn* quickGameDefn);
+
+			public:
+				sf::Vector2i getFieldSize() const;
+				const Snake* getSnake() const;
+				bool getAppleExists() const;
+				sf::Vector2i getApplePosition() const;
+
+			public:
+				QuickGameUpdateResult update(const QuickGameInputRequest* input);
+
+			private:
+				sf::Vector2i resolveNewApplePosition();
+				bool snakeWouldHitBarrier(ObjectDirection direction) const;
+
+			};
+
+		}
+
+	}
+
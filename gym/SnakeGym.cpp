@@ -0,0 +1,269 @@
+#include <string.h>
+#include "snakegym.h"
+#include "../src/includes/quickgame.hpp"
+
+
+	namespace snake {
+
+		namespace SnakeGymUtils {
+
+			// Snakes move every frame, so one step is one update
+			const float GYM_SNAKE_SPEED = 60.0f;
+
+			// Smallest field the snake starts in the middle of
+			const int GYM_MIN_FIELD_SIZE = 8;
+
+			// Rewards written for each step
+			const float GYM_APPLE_REWARD = 1.0f;
+			const float GYM_DEATH_REWARD = -1.0f;
+
+			// Struct for one game and the cells its observation last showed, which is what the next step has to rewrite
+			typedef struct Snake_GymEnv {
+				QuickGame* game;
+				sf::Vector2i shownHeadPosition;
+				sf::Vector2i shownTailPosition;
+				sf::Vector2i shownApplePosition;
+				int stepCount;
+				int episodeCount;
+			} GymEnv;
+
+		}
+
+	}
+
+
+	// Struct behind the opaque handle
+	struct SnakeGym {
+		SnakeGymConfig config;
+		SnakeGymBuffers buffers;
+		snake::QuickGameDefn gameDefn;
+		snake::SnakeGymUtils::GymEnv* envs;
+		size_t observationSize;
+		//observation of an empty field, copied in when an episode starts before the snake and apple are drawn
+		unsigned char* emptyObservation;
+		unsigned int seed;
+	};
+
+
+	namespace snake {
+
+		namespace SnakeGymUtils {
+
+			// Get the observation of a game inside the caller's buffer
+			unsigned char* resolveObservation(SnakeGym* gym, int envIndex) {
+				return gym->buffers.observations + ((size_t)envIndex * gym->observationSize);
+			}
+
+			// Set one cell of one plane of an observation
+			void setCell(SnakeGym* gym, unsigned char* observation, int plane, sf::Vector2i position, unsigned char value) {
+				int planeSize = gym->config.fieldWidth * gym->config.fieldHeight;
+				observation[(plane * planeSize) + (position.y * gym->config.fieldWidth) + position.x] = value;
+			}
+
+			// Write a game's whole observation, only done when an episode starts
+			void writeObservation(SnakeGym* gym, int envIndex) {
+				GymEnv& env = gym->envs[envIndex];
+				Snake* snake = env.game->getSnake();
+				unsigned char* observation = resolveObservation(gym, envIndex);
+				memcpy(observation, gym->emptyObservation, gym->observationSize);
+
+				setCell(gym, observation, SNAKE_GYM_PLANE_BODY, snake->getHead().position, 1);
+				setCell(gym, observation, SNAKE_GYM_PLANE_BODY, snake->getTail().position, 1);
+				for (int bodyIndex = 0; bodyIndex < snake->getBodyLength(); bodyIndex++) {
+					setCell(gym, observation, SNAKE_GYM_PLANE_BODY, snake->getBody(bodyIndex).position, 1);
+				}
+				setCell(gym, observation, SNAKE_GYM_PLANE_HEAD, snake->getHead().position, 1);
+				setCell(gym, observation, SNAKE_GYM_PLANE_APPLE, env.game->getApplePosition(), 1);
+
+				env.shownHeadPosition = snake->getHead().position;
+				env.shownTailPosition = snake->getTail().position;
+				env.shownApplePosition = env.game->getApplePosition();
+			}
+
+			// Start a game's next episode, every game and episode gets its own seed
+			void startEpisode(SnakeGym* gym, int envIndex) {
+				GymEnv& env = gym->envs[envIndex];
+				gym->gameDefn.randomSeed = gym->seed + (unsigned int)envIndex + ((unsigned int)env.episodeCount * (unsigned int)gym->config.envCount);
+				env.game->reset(&gym->gameDefn);
+				env.stepCount = 0;
+
+				// The apple is placed now instead of on the first step so the first observation shows it
+				env.game->spawnAppleIfMissing();
+				writeObservation(gym, envIndex);
+			}
+
+			// Rewrite the cells one move changed: the new head, the old head and tail, and the apple when it moved
+			void updateObservation(SnakeGym* gym, int envIndex) {
+				GymEnv& env = gym->envs[envIndex];
+				Snake* snake = env.game->getSnake();
+				unsigned char* observation = resolveObservation(gym, envIndex);
+
+				sf::Vector2i headPosition = snake->getHead().position;
+				setCell(gym, observation, SNAKE_GYM_PLANE_HEAD, env.shownHeadPosition, 0);
+				setCell(gym, observation, SNAKE_GYM_PLANE_HEAD, headPosition, 1);
+				setCell(gym, observation, SNAKE_GYM_PLANE_BODY, headPosition, 1);
+				env.shownHeadPosition = headPosition;
+
+				// A growing snake keeps its tail where it was, and the head may have moved onto the cell the tail left
+				if (!snake->occupiesPosition(env.shownTailPosition)) {
+					setCell(gym, observation, SNAKE_GYM_PLANE_BODY, env.shownTailPosition, 0);
+				}
+				env.shownTailPosition = snake->getTail().position;
+
+				if (env.game->getApplePosition() != env.shownApplePosition) {
+					setCell(gym, observation, SNAKE_GYM_PLANE_APPLE, env.shownApplePosition, 0);
+					setCell(gym, observation, SNAKE_GYM_PLANE_APPLE, env.game->getApplePosition(), 1);
+					env.shownApplePosition = env.game->getApplePosition();
+				}
+			}
+
+			// Draw the walls into an observation that is otherwise empty
+			void writeEmptyObservation(SnakeGym* gym, unsigned char* observation) {
+				memset(observation, 0, gym->observationSize);
+				for (int y = 0; y < gym->config.fieldHeight; y++) {
+					for (int x = 0; x < gym->config.fieldWidth; x++) {
+						bool wallFlag = (x == 0) || (y == 0) || (x == gym->config.fieldWidth - 1) || (y == gym->config.fieldHeight - 1);
+						if (wallFlag) {
+							setCell(gym, observation, SNAKE_GYM_PLANE_WALL, sf::Vector2i(x, y), 1);
+						}
+					}
+				}
+			}
+
+			// Turn an action into the direction the game is given, anything unknown keeps the snake going
+			ObjectDirection resolveActionDirection(int action) {
+				if ((action < SNAKE_GYM_ACTION_NONE) || (action > SNAKE_GYM_ACTION_LEFT)) {
+					return ObjectDirection::NONE;
+				}
+				return (ObjectDirection)action;
+			}
+
+			// Check a config describes games the engine can play
+			bool isValidConfig(const SnakeGymConfig* config) {
+				bool result =
+					(config->envCount >= 1) &&
+					(config->fieldWidth >= GYM_MIN_FIELD_SIZE) &&
+					(config->fieldHeight >= GYM_MIN_FIELD_SIZE) &&
+					(config->startLength >= 2) &&
+					(config->startLength <= (config->fieldHeight / 2)) &&
+					(config->maxEpisodeSteps >= 0);
+				return result;
+			}
+
+		}
+
+	}
+
+
+	// Get the bytes one observation takes
+	size_t snake_gym_observation_size(const SnakeGymConfig* config) {
+		return (size_t)SNAKE_GYM_PLANE_COUNT * (size_t)config->fieldWidth * (size_t)config->fieldHeight;
+	}
+
+	// Create the games, each with its own arena, and write their first observations
+	SnakeGym* snake_gym_create(const SnakeGymConfig* config, const SnakeGymBuffers* buffers) {
+		if ((config == nullptr) || (buffers == nullptr) || !snake::SnakeGymUtils::isValidConfig(config)) {
+			return nullptr;
+		}
+		if ((buffers->observations == nullptr) || (buffers->rewards == nullptr) || (buffers->terminated == nullptr) || (buffers->truncated == nullptr)) {
+			return nullptr;
+		}
+
+		SnakeGym* result = new SnakeGym;
+		result->config = *config;
+		result->buffers = *buffers;
+		result->observationSize = snake_gym_observation_size(config);
+		result->seed = 0;
+		result->emptyObservation = new unsigned char[result->observationSize];
+		snake::SnakeGymUtils::writeEmptyObservation(result, result->emptyObservation);
+
+		// The snake starts in the middle of the field heading down, with its body trailing up from there
+		result->gameDefn.fieldSize = sf::Vector2i(config->fieldWidth, config->fieldHeight);
+		result->gameDefn.snakeSpeedTilesPerSecond = snake::SnakeGymUtils::GYM_SNAKE_SPEED;
+		result->gameDefn.snakeStartDefn.headPosition = sf::Vector2i(config->fieldWidth / 2, config->fieldHeight / 2);
+		result->gameDefn.snakeStartDefn.facingDirection = snake::ObjectDirection::DOWN;
+		result->gameDefn.snakeStartDefn.length = config->startLength;
+		result->gameDefn.randomSeed = 0;
+
+		result->envs = new snake::SnakeGymUtils::GymEnv[config->envCount];
+		for (int envIndex = 0; envIndex < config->envCount; envIndex++) {
+			result->envs[envIndex].game = new snake::QuickGame(&result->gameDefn);
+		}
+
+		snake_gym_reset(result, 0);
+		return result;
+	}
+
+	// Free the games, the caller's buffers are left alone
+	void snake_gym_destroy(SnakeGym* gym) {
+		if (gym == nullptr) {
+			return;
+		}
+
+		for (int envIndex = 0; envIndex < gym->config.envCount; envIndex++) {
+			delete gym->envs[envIndex].game;
+		}
+		delete[] gym->envs;
+		delete[] gym->emptyObservation;
+		delete gym;
+	}
+
+	// Start every game's first episode from the seed
+	void snake_gym_reset(SnakeGym* gym, unsigned int seed) {
+		gym->seed = seed;
+		for (int envIndex = 0; envIndex < gym->config.envCount; envIndex++) {
+			gym->envs[envIndex].episodeCount = 0;
+			snake::SnakeGymUtils::startEpisode(gym, envIndex);
+
+			gym->buffers.rewards[envIndex] = 0.0f;
+			gym->buffers.terminated[envIndex] = 0;
+			gym->buffers.truncated[envIndex] = 0;
+		}
+	}
+
+	// Advance every game by one move, writing straight into the caller's buffers
+	void snake_gym_step(SnakeGym* gym, const int* actions) {
+		for (int envIndex = 0; envIndex < gym->config.envCount; envIndex++) {
+			snake::SnakeGymUtils::GymEnv& env = gym->envs[envIndex];
+
+			snake::QuickGameInputRequest input;
+			input.snakeMovementInput = snake::SnakeGymUtils::resolveActionDirection(actions[envIndex]);
+			snake::QuickGameUpdateResult updateResult = env.game->update(&input);
+			env.stepCount++;
+
+			float reward = 0.0f;
+			bool terminatedFlag = false;
+			if (updateResult.snakeHitBarrierFlag) {
+				reward = snake::SnakeGymUtils::GYM_DEATH_REWARD;
+				terminatedFlag = true;
+			} else {
+				if (updateResult.snakeAteAppleFlag) {
+					reward = snake::SnakeGymUtils::GYM_APPLE_REWARD;
+				}
+
+				// No apple can be placed on a full field, which ends the episode as a win
+				if (env.game->getFieldFull()) {
+					terminatedFlag = true;
+				} else {
+					env.game->spawnAppleIfMissing();
+					snake::SnakeGymUtils::updateObservation(gym, envIndex);
+				}
+			}
+
+			bool truncatedFlag = !terminatedFlag && (gym->config.maxEpisodeSteps > 0) && (env.stepCount >= gym->config.maxEpisodeSteps);
+
+			gym->buffers.rewards[envIndex] = reward;
+			gym->buffers.terminated[envIndex] = terminatedFlag ? 1 : 0;
+			gym->buffers.truncated[envIndex] = truncatedFlag ? 1 : 0;
+
+			if (terminatedFlag || truncatedFlag) {
+				env.episodeCount++;
+				snake::SnakeGymUtils::startEpisode(gym, envIndex);
+			}
+		}
+	}
+
+	// Get the length of a game's snake
+	int snake_gym_get_snake_length(const SnakeGym* gym, int envIndex) {
+		return gym->envs[envIndex].game->getSnake()->getLength();
+	}
@@ -0,0 +1,85 @@
+//This header file defines the C interface of the gym library, which runs many quick games side by side for training agents on the real game logic.
+#include <stddef.h>
+#pragma once
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	//Functions the library exports, everything else in it stays hidden. The library itself is built with SNAKE_GYM_BUILD.
+	#if defined(_WIN32) && defined(SNAKE_GYM_BUILD)
+		#define SNAKE_GYM_API __declspec(dllexport)
+	#elif defined(_WIN32)
+		#define SNAKE_GYM_API __declspec(dllimport)
+	#else
+		#define SNAKE_GYM_API __attribute__((visibility("default")))
+	#endif
+
+	//Version of this interface, bumped whenever a struct or function changes.
+	#define SNAKE_GYM_API_VERSION 1
+
+	//Observation planes, each fieldHeight rows of fieldWidth cells holding 0 or 1, in this order.
+	#define SNAKE_GYM_PLANE_BODY 0
+	#define SNAKE_GYM_PLANE_HEAD 1
+	#define SNAKE_GYM_PLANE_APPLE 2
+	#define SNAKE_GYM_PLANE_WALL 3
+	#define SNAKE_GYM_PLANE_COUNT 4
+
+	//Actions, NONE keeps the snake going the way it last moved and so does reversing into itself.
+	#define SNAKE_GYM_ACTION_NONE 0
+	#define SNAKE_GYM_ACTION_UP 1
+	#define SNAKE_GYM_ACTION_RIGHT 2
+	#define SNAKE_GYM_ACTION_DOWN 3
+	#define SNAKE_GYM_ACTION_LEFT 4
+
+	//Struct for the games a gym runs, every game has the same settings.
+	typedef struct SnakeGymConfig {
+		int envCount;
+		//field size including the walls around it, at least 8x8
+		int fieldWidth;
+		int fieldHeight;
+		//snake length at the start of every episode, at least 2 and short enough to fit below the middle of the field
+		int startLength;
+		//steps after which an episode is cut short and reported as truncated, 0 for no limit
+		int maxEpisodeSteps;
+	} SnakeGymConfig;
+
+	//Struct for the caller owned memory the gym writes its results into, it has to stay valid until the gym is destroyed.
+	typedef struct SnakeGymBuffers {
+		//envCount observations of snake_gym_observation_size() bytes each, laid out env, plane, row, column
+		unsigned char* observations;
+		//envCount rewards of the last step: 1 for eating an apple, -1 for dying, 0 otherwise
+		float* rewards;
+		//envCount flags set when the last step ended its episode by dying or filling the field
+		unsigned char* terminated;
+		//envCount flags set when the last step ended its episode at maxEpisodeSteps
+		unsigned char* truncated;
+	} SnakeGymBuffers;
+
+	//Opaque handle to a set of games.
+	typedef struct SnakeGym SnakeGym;
+
+	//Bytes of one game's observation, SNAKE_GYM_PLANE_COUNT planes of fieldWidth * fieldHeight cells.
+	SNAKE_GYM_API size_t snake_gym_observation_size(const SnakeGymConfig* config);
+
+	//Create the games and start writing into the buffers, as if snake_gym_reset() was called with seed 0. Returns NULL when the config is invalid.
+	SNAKE_GYM_API SnakeGym* snake_gym_create(const SnakeGymConfig* config, const SnakeGymBuffers* buffers);
+	SNAKE_GYM_API void snake_gym_destroy(SnakeGym* gym);
+
+	//Start every game over, game i from seed + i, and write their first observations. Rewards and flags are cleared.
+	SNAKE_GYM_API void snake_gym_reset(SnakeGym* gym, unsigned int seed);
+
+	//Move every game's snake one cell with envCount actions and write the results. A game whose episode ended starts
+	//its next episode straight away from a new seed, its observation is then the first one of that episode.
+	//Only the cells that changed are rewritten, so the observations must not be modified between steps.
+	SNAKE_GYM_API void snake_gym_step(SnakeGym* gym, const int* actions);
+
+	//Length of a game's snake, for logging how well an agent does.
+	SNAKE_GYM_API int snake_gym_get_snake_length(const SnakeGym* gym, int envIndex);
+
+#ifdef __cplusplus
+}
+#endif
+
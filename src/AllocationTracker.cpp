@@ -0,0 +1,224 @@
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+#include "includes/alloctracker.hpp"
+
+#if defined(_WIN32)
+	#include <malloc.h>
+#endif
+
+
+	namespace snake {
+
+		// Names of the subsystems, indexed by AllocationSubsystem
+		const char* ALLOCATION_SUBSYSTEM_NAMES[(int)AllocationSubsystem::COUNT] = {
+			"other",
+			"events",
+			"simulation",
+			"render",
+			"audio",
+		};
+
+		// Only the thread inside beginFrame()/endFrame() counts, so streaming threads owned by SFML are ignored
+		thread_local bool allocationTrackingActive = false;
+		thread_local AllocationSubsystem currentAllocationSubsystem = AllocationSubsystem::OTHER;
+
+		AllocationFrameStats currentAllocationFrameStats;
+
+		// Every thread counts here, for work handed to worker threads that never enter beginFrame()
+		std::atomic<long long> processAllocationCount(0);
+
+		namespace AllocationTracker {
+
+			// Check whether allocation tracking is compiled in
+			bool isEnabled() {
+#ifdef SNAKE_TRACK_ALLOCATIONS
+				return true;
+#else
+				return false;
+#endif
+			}
+
+			// Reset the frame counters and start counting on the calling thread
+			void beginFrame() {
+				for (int currSubsystemIndex = 0; currSubsystemIndex < (int)AllocationSubsystem::COUNT; currSubsystemIndex++) {
+					currentAllocationFrameStats.allocationCount[currSubsystemIndex] = 0;
+					currentAllocationFrameStats.allocatedBytes[currSubsystemIndex] = 0;
+				}
+				currentAllocationFrameStats.freeCount = 0;
+
+				allocationTrackingActive = true;
+			}
+
+			// Stop counting and return the frame counters
+			const AllocationFrameStats& endFrame() {
+				allocationTrackingActive = false;
+				return currentAllocationFrameStats;
+			}
+
+			// Sum the allocations of every subsystem in a frame
+			int getTotalAllocationCount(const AllocationFrameStats& frameStats) {
+				int result = 0;
+				for (int currSubsystemIndex = 0; currSubsystemIndex < (int)AllocationSubsystem::COUNT; currSubsystemIndex++) {
+					result += frameStats.allocationCount[currSubsystemIndex];
+				}
+				return result;
+			}
+
+			// Get the number of allocations made by every thread so far
+			long long getProcessAllocationCount() {
+				return processAllocationCount.load(std::memory_order_relaxed);
+			}
+
+			// Get the printable name of a subsystem
+			const char* getSubsystemName(AllocationSubsystem subsystem) {
+				return ALLOCATION_SUBSYSTEM_NAMES[(int)subsystem];
+			}
+
+			// Count one allocation for the process, and against the current subsystem while a frame is tracked
+			void recordAllocation(std::size_t size) {
+				processAllocationCount.fetch_add(1, std::memory_order_relaxed);
+				if (allocationTrackingActive) {
+					currentAllocationFrameStats.allocationCount[(int)currentAllocationSubsystem]++;
+					currentAllocationFrameStats.allocatedBytes[(int)currentAllocationSubsystem] += size;
+				}
+			}
+
+			// Count one free
+			void recordFree() {
+				if (allocationTrackingActive) {
+					currentAllocationFrameStats.freeCount++;
+				}
+			}
+
+		}
+
+		// Constructor for AllocationScope
+		AllocationScope::AllocationScope(AllocationSubsystem subsystem) {
+			this->previousSubsystem = currentAllocationSubsystem;
+			currentAllocationSubsystem = subsystem;
+		}
+
+		// Destructor for AllocationScope
+		AllocationScope::~AllocationScope() {
+			currentAllocationSubsystem = this->previousSubsystem;
+		}
+
+	}
+
+
+#ifdef SNAKE_TRACK_ALLOCATIONS
+
+	// Replacement global allocation functions, forwarding to malloc/free after counting
+
+	void* operator new(std::size_t size) {
+		snake::AllocationTracker::recordAllocation(size);
+		void* result = malloc(size == 0 ? 1 : size);
+		if (result == nullptr) {
+			throw std::bad_alloc();
+		}
+		return result;
+	}
+
+	void* operator new[](std::size_t size) {
+		return operator new(size);
+	}
+
+	void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+		snake::AllocationTracker::recordAllocation(size);
+		return malloc(size == 0 ? 1 : size);
+	}
+
+	void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+		return operator new(size, tag);
+	}
+
+	void operator delete(void* pointer) noexcept {
+		if (pointer != nullptr) {
+			snake::AllocationTracker::recordFree();
+			free(pointer);
+		}
+	}
+
+	void operator delete[](void* pointer) noexcept {
+		operator delete(pointer);
+	}
+
+	void operator delete(void* pointer, std::size_t) noexcept {
+		operator delete(pointer);
+	}
+
+	void operator delete[](void* pointer, std::size_t) noexcept {
+		operator delete(pointer);
+	}
+
+	void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+		operator delete(pointer);
+	}
+
+	void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+		operator delete(pointer);
+	}
+
+	// Over-aligned types come through their own overloads, which would otherwise go to the library's allocator uncounted
+
+	void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+		snake::AllocationTracker::recordAllocation(size);
+		std::size_t alignmentBytes = (std::size_t)alignment;
+#if defined(_WIN32)
+		return _aligned_malloc(size == 0 ? 1 : size, alignmentBytes);
+#else
+		// aligned_alloc wants the size to be a multiple of the alignment
+		std::size_t alignedSize = ((size == 0 ? 1 : size) + alignmentBytes - 1) & ~(alignmentBytes - 1);
+		return aligned_alloc(alignmentBytes, alignedSize);
+#endif
+	}
+
+	void* operator new(std::size_t size, std::align_val_t alignment) {
+		void* result = operator new(size, alignment, std::nothrow);
+		if (result == nullptr) {
+			throw std::bad_alloc();
+		}
+		return result;
+	}
+
+	void* operator new[](std::size_t size, std::align_val_t alignment) {
+		return operator new(size, alignment);
+	}
+
+	void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+		return operator new(size, alignment, tag);
+	}
+
+	void operator delete(void* pointer, std::align_val_t) noexcept {
+		if (pointer != nullptr) {
+			snake::AllocationTracker::recordFree();
+#if defined(_WIN32)
+			_aligned_free(pointer);
+#else
+			free(pointer);
+#endif
+		}
+	}
+
+	void operator delete[](void* pointer, std::align_val_t alignment) noexcept {
+		operator delete(pointer, alignment);
+	}
+
+	void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept {
+		operator delete(pointer, alignment);
+	}
+
+	void operator delete[](void* pointer, std::size_t, std::align_val_t alignment) noexcept {
+		operator delete(pointer, alignment);
+	}
+
+	void operator delete(void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+		operator delete(pointer, alignment);
+	}
+
+	void operator delete[](void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+		operator delete(pointer, alignment);
+	}
+
+#endif
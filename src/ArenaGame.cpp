@@ -0,0 +1,581 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <chrono>
+#include "includes/arenagame.hpp"
+
+
+	namespace snake {
+
+		// Values of the occupancy grid for cells no snake covers
+		const int ARENA_EMPTY_CELL = -1;
+		const int ARENA_WALL_CELL = -2;
+
+		// Moves a snake grows on for every apple it eats, like the quick game
+		const int ARENA_APPLE_GROWTH = 2;
+
+		// Random cells tried when looking for room for a snake or an apple before giving up until the next tick
+		const int ARENA_SPAWN_ATTEMPTS = 64;
+
+		// Cells either side of the head a bot looks for apples in, and how far away it wanders when it sees none
+		const int ARENA_BOT_SIGHT_RADIUS = 6;
+		const int ARENA_BOT_WANDER_RADIUS = 24;
+		// A bot looks around again on average once every this many ticks, and always when it reaches where it was going
+		const std::uint32_t ARENA_BOT_RETHINK_MASK = 15;
+		// Score a bot takes off a move for every other head next to the cell it moves into
+		const int ARENA_BOT_HEAD_ON_PENALTY = 20;
+
+		// Phases of a tick, each one is run over every region before the next starts
+		const int ARENA_PHASE_CLAIM = 0;
+		const int ARENA_PHASE_RESOLVE = 1;
+		const int ARENA_PHASE_MOVE = 2;
+
+		// Directions in clockwise order, turning right moves one along and turning left one back
+		const ObjectDirection ARENA_CLOCKWISE_DIRECTIONS[] = { ObjectDirection::UP, ObjectDirection::RIGHT, ObjectDirection::DOWN, ObjectDirection::LEFT };
+
+		// Step a xorshift generator, every snake has its own so bots decide the same whichever worker runs them
+		std::uint32_t nextArenaRandom(std::uint32_t& state) {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+
+		// Derive a non zero generator state from the arena's seed and a snake's index
+		std::uint32_t resolveArenaRandomState(unsigned int seed, int index) {
+			std::uint64_t mixed = ((std::uint64_t)seed << 32) + (std::uint64_t)(index + 1) * 0x9E3779B97F4A7C15ULL;
+			mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+			std::uint32_t result = (std::uint32_t)(mixed ^ (mixed >> 31));
+			return (result == 0) ? 1 : result;
+		}
+
+		// Turn a direction a quarter clockwise, or anticlockwise with a negative count
+		ObjectDirection turnArenaDirection(ObjectDirection direction, int quarterTurns) {
+			int directionIndex = (int)direction - (int)ObjectDirection::UP;
+			return ARENA_CLOCKWISE_DIRECTIONS[(directionIndex + quarterTurns + 4) % 4];
+		}
+
+		// Constructor for ArenaGame, lays out the walls and spawns every snake and apple in index order
+		ArenaGame::ArenaGame(const ArenaGameDefn& defn) {
+			assert((defn.fieldSize.x >= 3) && (defn.fieldSize.y >= 3));
+			assert((defn.snakeStartLength >= 2) && (defn.snakeMaxLength >= defn.snakeStartLength));
+			assert((defn.regionCount > 0) && (defn.workerCount > 0));
+
+			this->defn = defn;
+			this->pool = new WorkStealingPool(defn.workerCount, defn.regionCount);
+
+			int cellCount = defn.fieldSize.x * defn.fieldSize.y;
+			this->cellOwners = new int[cellCount];
+			this->cellClaims = new std::atomic<int>[cellCount];
+			this->appleCells = new std::uint8_t[cellCount];
+			this->spawnedAppleCells = new int[(defn.appleCount > 0) ? defn.appleCount : 1];
+			this->spawnedAppleCount = 0;
+			for (int cellIndex = 0; cellIndex < cellCount; cellIndex++) {
+				sf::Vector2i position = this->resolvePosition(cellIndex);
+				bool wallFlag = (position.x == 0) || (position.y == 0) || (position.x == defn.fieldSize.x - 1) || (position.y == defn.fieldSize.y - 1);
+				this->cellOwners[cellIndex] = wallFlag ? ARENA_WALL_CELL : ARENA_EMPTY_CELL;
+				this->cellClaims[cellIndex].store(0, std::memory_order_relaxed);
+				this->appleCells[cellIndex] = 0;
+			}
+
+			this->snakes = new ArenaSnake[defn.snakeCount];
+			this->snakeCells = new int[(std::size_t)defn.snakeCount * defn.snakeMaxLength];
+			this->regionSnakes = new int[defn.snakeCount];
+			this->regionStarts = new int[defn.regionCount + 1];
+			this->regionTasks = new int[defn.regionCount];
+			for (int regionIndex = 0; regionIndex < defn.regionCount; regionIndex++) {
+				this->regionTasks[regionIndex] = regionIndex;
+			}
+			this->phase = ARENA_PHASE_CLAIM;
+
+			this->deathCount.store(0);
+			this->headOnDeathCount.store(0);
+			this->applesEatenCount.store(0);
+
+			this->randomState = resolveArenaRandomState(defn.randomSeed, -1);
+			this->tickCount = 0;
+
+			for (int snakeIndex = 0; snakeIndex < defn.snakeCount; snakeIndex++) {
+				ArenaSnake& snake = this->snakes[snakeIndex];
+				snake.randomState = resolveArenaRandomState(defn.randomSeed, snakeIndex);
+				snake.aliveFlag = false;
+				snake.dyingFlag = false;
+				snake.respawnTicks = 0;
+				snake.applesEaten = 0;
+				snake.input = ObjectDirection::NONE;
+				this->spawnSnake(snakeIndex);
+			}
+			for (int appleIndex = 0; appleIndex < defn.appleCount; appleIndex++) {
+				this->spawnApple();
+			}
+			this->spawnedAppleCount = 0;
+
+			this->sortSnakesByRegion();
+		}
+
+		// Destructor for ArenaGame, the threads stop before the board they work on is freed
+		ArenaGame::~ArenaGame() {
+			delete this->pool;
+
+			delete[] this->cellOwners;
+			delete[] this->cellClaims;
+			delete[] this->appleCells;
+			delete[] this->spawnedAppleCells;
+			delete[] this->snakes;
+			delete[] this->snakeCells;
+			delete[] this->regionSnakes;
+			delete[] this->regionStarts;
+			delete[] this->regionTasks;
+		}
+
+		// Set a player snake's next direction, straight back is ignored like in the quick game
+		void ArenaGame::setSnakeInput(int snakeIndex, ObjectDirection direction) {
+			assert((snakeIndex >= 0) && (snakeIndex < this->defn.playerSnakeCount));
+			this->snakes[snakeIndex].input = direction;
+		}
+
+		// Run the three phases of a tick on the pool, then respawn snakes and apples and regroup the snakes by region
+		ArenaTickStats ArenaGame::update() {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			this->deathCount.store(0, std::memory_order_relaxed);
+			this->headOnDeathCount.store(0, std::memory_order_relaxed);
+			this->applesEatenCount.store(0, std::memory_order_relaxed);
+			this->spawnedAppleCount = 0;
+
+			this->runPhase(ARENA_PHASE_CLAIM);
+			this->runPhase(ARENA_PHASE_RESOLVE);
+			this->runPhase(ARENA_PHASE_MOVE);
+
+			ArenaTickStats result;
+			result.deathCount = this->deathCount.load(std::memory_order_relaxed);
+			result.headOnDeathCount = this->headOnDeathCount.load(std::memory_order_relaxed);
+			result.applesEaten = this->applesEatenCount.load(std::memory_order_relaxed);
+			result.respawnCount = 0;
+
+			// Everything random from here on is drawn in snake index order, so it does not depend on the workers either
+			for (int snakeIndex = 0; snakeIndex < this->defn.snakeCount; snakeIndex++) {
+				ArenaSnake& snake = this->snakes[snakeIndex];
+				if (snake.dyingFlag) {
+					snake.dyingFlag = false;
+					snake.aliveFlag = false;
+					snake.respawnTicks = (this->defn.respawnDelayTicks > 0) ? this->defn.respawnDelayTicks : -1;
+				} else if (!snake.aliveFlag && (snake.respawnTicks >= 0)) {
+					if (snake.respawnTicks > 0) {
+						snake.respawnTicks--;
+					}
+					if ((snake.respawnTicks == 0) && this->spawnSnake(snakeIndex)) {
+						result.respawnCount++;
+					}
+				}
+			}
+			for (int appleIndex = 0; appleIndex < result.applesEaten; appleIndex++) {
+				this->spawnApple();
+			}
+
+			this->sortSnakesByRegion();
+			this->tickCount++;
+
+			result.aliveSnakeCount = this->getAliveSnakeCount();
+			result.tickSeconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / 1e9;
+			return result;
+		}
+
+		// Get the definition the arena was made from
+		const ArenaGameDefn& ArenaGame::getDefn() const {
+			return this->defn;
+		}
+
+		// Get the number of ticks played
+		int ArenaGame::getTickCount() const {
+			return this->tickCount;
+		}
+
+		// Get the number of snakes on the field, the region lists only ever hold live snakes
+		int ArenaGame::getAliveSnakeCount() const {
+			return this->regionStarts[this->defn.regionCount];
+		}
+
+		// Get one of the snakes
+		const ArenaSnake& ArenaGame::getSnake(int snakeIndex) const {
+			return this->snakes[snakeIndex];
+		}
+
+		// Get a cell of a snake counting back from its head, which is segment 0
+		sf::Vector2i ArenaGame::getSnakeCell(int snakeIndex, int segmentIndex) const {
+			const ArenaSnake& snake = this->snakes[snakeIndex];
+			int slot = snake.headSlot - segmentIndex;
+			if (slot < 0) {
+				slot += this->defn.snakeMaxLength;
+			}
+			return this->resolvePosition(this->snakeCells[((std::size_t)snakeIndex * this->defn.snakeMaxLength) + slot]);
+		}
+
+		// Get the snake covering a cell
+		int ArenaGame::getCellOwner(sf::Vector2i position) const {
+			int owner = this->cellOwners[this->resolveCellIndex(position)];
+			return (owner >= 0) ? owner : -1;
+		}
+
+		// Check if there is an apple on a cell
+		bool ArenaGame::getAppleAt(sf::Vector2i position) const {
+			return this->appleCells[this->resolveCellIndex(position)] != 0;
+		}
+
+		// Get the number of apples the last tick spawned
+		int ArenaGame::getSpawnedAppleCount() const {
+			return this->spawnedAppleCount;
+		}
+
+		// Get one of the apples the last tick spawned
+		sf::Vector2i ArenaGame::getSpawnedApple(int appleIndex) const {
+			assert((appleIndex >= 0) && (appleIndex < this->spawnedAppleCount));
+			return this->resolvePosition(this->spawnedAppleCells[appleIndex]);
+		}
+
+		// Hash the whole arena with FNV-1a, for checking that runs on different worker counts match
+		std::uint64_t ArenaGame::computeStateHash() const {
+			std::uint64_t result = 0xCBF29CE484222325ULL;
+			auto mix = [&result](std::uint64_t value) {
+				result = (result ^ value) * 0x100000001B3ULL;
+			};
+
+			for (int snakeIndex = 0; snakeIndex < this->defn.snakeCount; snakeIndex++) {
+				const ArenaSnake& snake = this->snakes[snakeIndex];
+				mix(snake.aliveFlag ? 1 : 0);
+				if (!snake.aliveFlag) {
+					continue;
+				}
+				mix((std::uint64_t)snake.direction);
+				mix((std::uint64_t)snake.length);
+				for (int segmentIndex = 0; segmentIndex < snake.length; segmentIndex++) {
+					sf::Vector2i position = this->getSnakeCell(snakeIndex, segmentIndex);
+					mix((std::uint64_t)this->resolveCellIndex(position));
+				}
+			}
+
+			int cellCount = this->defn.fieldSize.x * this->defn.fieldSize.y;
+			for (int cellIndex = 0; cellIndex < cellCount; cellIndex++) {
+				if (this->appleCells[cellIndex] != 0) {
+					mix((std::uint64_t)cellIndex);
+				}
+			}
+			return result;
+		}
+
+		// Run one region's snakes through the current phase
+		void ArenaGame::runTask(WorkStealingPool&, int, int taskArgument) {
+			int regionEnd = this->regionStarts[taskArgument + 1];
+			for (int listIndex = this->regionStarts[taskArgument]; listIndex < regionEnd; listIndex++) {
+				int snakeIndex = this->regionSnakes[listIndex];
+				if (this->phase == ARENA_PHASE_CLAIM) {
+					this->claimTarget(snakeIndex);
+				} else if (this->phase == ARENA_PHASE_RESOLVE) {
+					this->resolveTarget(snakeIndex);
+				} else {
+					this->moveHead(snakeIndex);
+				}
+			}
+		}
+
+		// Convert a position to a cell index
+		int ArenaGame::resolveCellIndex(sf::Vector2i position) const {
+			return (position.y * this->defn.fieldSize.x) + position.x;
+		}
+
+		// Convert a cell index back to a position
+		sf::Vector2i ArenaGame::resolvePosition(int cellIndex) const {
+			return sf::Vector2i(cellIndex % this->defn.fieldSize.x, cellIndex / this->defn.fieldSize.x);
+		}
+
+		// Get how far a cell index moves for one step in a direction
+		int ArenaGame::resolveDirectionOffset(ObjectDirection direction) const {
+			sf::Vector2i step = SnakeUtils::directionToVector(direction);
+			return (step.y * this->defn.fieldSize.x) + step.x;
+		}
+
+		// Pick a random cell inside the walls
+		int ArenaGame::resolveRandomInteriorCell(std::uint32_t& randomState) const {
+			int x = 1 + (int)(nextArenaRandom(randomState) % (std::uint32_t)(this->defn.fieldSize.x - 2));
+			int y = 1 + (int)(nextArenaRandom(randomState) % (std::uint32_t)(this->defn.fieldSize.y - 2));
+			return this->resolveCellIndex(sf::Vector2i(x, y));
+		}
+
+		// Pick a random cell inside the walls with no snake or apple on it, -1 when none turned up
+		int ArenaGame::resolveRandomFreeCell(std::uint32_t& randomState) const {
+			for (int attempt = 0; attempt < ARENA_SPAWN_ATTEMPTS; attempt++) {
+				int cellIndex = this->resolveRandomInteriorCell(randomState);
+				if ((this->cellOwners[cellIndex] == ARENA_EMPTY_CELL) && (this->appleCells[cellIndex] == 0)) {
+					return cellIndex;
+				}
+			}
+			return -1;
+		}
+
+		// Lay a snake out in a straight line on free cells, returns false when no room was found
+		bool ArenaGame::spawnSnake(int snakeIndex) {
+			ArenaSnake& snake = this->snakes[snakeIndex];
+			int length = this->defn.snakeStartLength;
+
+			for (int attempt = 0; attempt < ARENA_SPAWN_ATTEMPTS; attempt++) {
+				int headCell = this->resolveRandomInteriorCell(this->randomState);
+				ObjectDirection direction = ARENA_CLOCKWISE_DIRECTIONS[nextArenaRandom(this->randomState) % 4];
+				int backOffset = -this->resolveDirectionOffset(direction);
+
+				// The body trails away behind the head, every cell of it has to be free and the cell ahead too
+				bool roomFlag = this->cellOwners[headCell + this->resolveDirectionOffset(direction)] == ARENA_EMPTY_CELL;
+				for (int segmentIndex = 0; roomFlag && (segmentIndex < length); segmentIndex++) {
+					int cellIndex = headCell + (backOffset * segmentIndex);
+					roomFlag = (this->cellOwners[cellIndex] == ARENA_EMPTY_CELL) && (this->appleCells[cellIndex] == 0);
+				}
+				if (!roomFlag) {
+					continue;
+				}
+
+				int* ring = this->snakeCells + ((std::size_t)snakeIndex * this->defn.snakeMaxLength);
+				for (int segmentIndex = 0; segmentIndex < length; segmentIndex++) {
+					int cellIndex = headCell + (backOffset * segmentIndex);
+					ring[length - 1 - segmentIndex] = cellIndex;
+					this->cellOwners[cellIndex] = snakeIndex;
+				}
+				snake.tailSlot = 0;
+				snake.headSlot = length - 1;
+				snake.length = length;
+				snake.queuedGrowth = 0;
+				snake.direction = direction;
+				snake.input = ObjectDirection::NONE;
+				snake.targetCell = headCell;
+				snake.wanderCell = headCell;
+				snake.aliveFlag = true;
+				snake.dyingFlag = false;
+				snake.respawnTicks = 0;
+				return true;
+			}
+			return false;
+		}
+
+		// Put an apple on a random free cell, it is skipped when the field is too crowded to find one
+		void ArenaGame::spawnApple() {
+			int cellIndex = this->resolveRandomFreeCell(this->randomState);
+			if (cellIndex >= 0) {
+				this->appleCells[cellIndex] = 1;
+				this->spawnedAppleCells[this->spawnedAppleCount] = cellIndex;
+				this->spawnedAppleCount++;
+			}
+		}
+
+		// Take every cell of a snake off the board
+		void ArenaGame::removeSnake(int snakeIndex) {
+			ArenaSnake& snake = this->snakes[snakeIndex];
+			const int* ring = this->snakeCells + ((std::size_t)snakeIndex * this->defn.snakeMaxLength);
+			int slot = snake.tailSlot;
+			for (int segmentIndex = 0; segmentIndex < snake.length; segmentIndex++) {
+				this->cellOwners[ring[slot]] = ARENA_EMPTY_CELL;
+				slot = (slot + 1 == this->defn.snakeMaxLength) ? 0 : slot + 1;
+			}
+		}
+
+		// Counting sort the live snakes by the band of rows their head is in, in snake index order within each band
+		void ArenaGame::sortSnakesByRegion() {
+			int regionCount = this->defn.regionCount;
+			int rowsPerRegion = (this->defn.fieldSize.y + regionCount - 1) / regionCount;
+
+			for (int regionIndex = 0; regionIndex <= regionCount; regionIndex++) {
+				this->regionStarts[regionIndex] = 0;
+			}
+			for (int snakeIndex = 0; snakeIndex < this->defn.snakeCount; snakeIndex++) {
+				if (this->snakes[snakeIndex].aliveFlag) {
+					this->regionStarts[this->getSnakeCell(snakeIndex, 0).y / rowsPerRegion]++;
+				}
+			}
+
+			// Turn the counts into where each region starts and fill the regions forwards, which leaves every entry at the start of the next region
+			int regionStart = 0;
+			for (int regionIndex = 0; regionIndex < regionCount; regionIndex++) {
+				int count = this->regionStarts[regionIndex];
+				this->regionStarts[regionIndex] = regionStart;
+				regionStart += count;
+			}
+			for (int snakeIndex = 0; snakeIndex < this->defn.snakeCount; snakeIndex++) {
+				if (this->snakes[snakeIndex].aliveFlag) {
+					int regionIndex = this->getSnakeCell(snakeIndex, 0).y / rowsPerRegion;
+					this->regionSnakes[this->regionStarts[regionIndex]] = snakeIndex;
+					this->regionStarts[regionIndex]++;
+				}
+			}
+			for (int regionIndex = regionCount; regionIndex > 0; regionIndex--) {
+				this->regionStarts[regionIndex] = this->regionStarts[regionIndex - 1];
+			}
+			this->regionStarts[0] = 0;
+		}
+
+		// Run one phase over every region on the pool, returning when all of them are done
+		void ArenaGame::runPhase(int phase) {
+			this->phase = phase;
+			this->pool->run(*this, this->regionTasks, this->defn.regionCount);
+		}
+
+		// Choose where a bot snake goes: towards an apple it can see, otherwise towards a random spot nearby,
+		// never into a cell it would die in when there is another way and preferring cells with room around them
+		ObjectDirection ArenaGame::resolveBotDirection(int snakeIndex) {
+			ArenaSnake& snake = this->snakes[snakeIndex];
+			int headCell = this->snakeCells[((std::size_t)snakeIndex * this->defn.snakeMaxLength) + snake.headSlot];
+			sf::Vector2i head = this->resolvePosition(headCell);
+
+			if ((headCell == snake.wanderCell) || ((nextArenaRandom(snake.randomState) & ARENA_BOT_RETHINK_MASK) == 0)) {
+				int nearestDistance = -1;
+				for (int y = head.y - ARENA_BOT_SIGHT_RADIUS; y <= head.y + ARENA_BOT_SIGHT_RADIUS; y++) {
+					for (int x = head.x - ARENA_BOT_SIGHT_RADIUS; x <= head.x + ARENA_BOT_SIGHT_RADIUS; x++) {
+						if ((x <= 0) || (y <= 0) || (x >= this->defn.fieldSize.x - 1) || (y >= this->defn.fieldSize.y - 1)) {
+							continue;
+						}
+						int cellIndex = this->resolveCellIndex(sf::Vector2i(x, y));
+						int distance = abs(x - head.x) + abs(y - head.y);
+						if ((this->appleCells[cellIndex] != 0) && ((nearestDistance < 0) || (distance < nearestDistance))) {
+							nearestDistance = distance;
+							snake.wanderCell = cellIndex;
+						}
+					}
+				}
+				if (nearestDistance < 0) {
+					int spread = (ARENA_BOT_WANDER_RADIUS * 2) + 1;
+					int x = head.x - ARENA_BOT_WANDER_RADIUS + (int)(nextArenaRandom(snake.randomState) % (std::uint32_t)spread);
+					int y = head.y - ARENA_BOT_WANDER_RADIUS + (int)(nextArenaRandom(snake.randomState) % (std::uint32_t)spread);
+					x = (x < 1) ? 1 : ((x > this->defn.fieldSize.x - 2) ? this->defn.fieldSize.x - 2 : x);
+					y = (y < 1) ? 1 : ((y > this->defn.fieldSize.y - 2) ? this->defn.fieldSize.y - 2 : y);
+					snake.wanderCell = this->resolveCellIndex(sf::Vector2i(x, y));
+				}
+			}
+			sf::Vector2i wander = this->resolvePosition(snake.wanderCell);
+
+			ObjectDirection result = snake.direction;
+			int bestScore = 0;
+			bool foundFlag = false;
+			for (int quarterTurns = -1; quarterTurns <= 1; quarterTurns++) {
+				ObjectDirection direction = turnArenaDirection(snake.direction, quarterTurns);
+				int nextCell = headCell + this->resolveDirectionOffset(direction);
+				if (!this->cellIsFreeFor(nextCell)) {
+					continue;
+				}
+
+				// Closer to the target scores higher, every free cell around the next one keeps the snake out of pockets,
+				// and another head next to it could move in too and kill both snakes
+				sf::Vector2i next = this->resolvePosition(nextCell);
+				int score = -(abs(next.x - wander.x) + abs(next.y - wander.y)) * 4;
+				for (const ObjectDirection& around : ARENA_CLOCKWISE_DIRECTIONS) {
+					int aroundCell = nextCell + this->resolveDirectionOffset(around);
+					if (aroundCell == headCell) {
+						continue;
+					}
+					if (this->cellIsFreeFor(aroundCell)) {
+						score += 3;
+					} else if (this->cellIsHead(aroundCell)) {
+						score -= ARENA_BOT_HEAD_ON_PENALTY;
+					}
+				}
+				score += (int)(nextArenaRandom(snake.randomState) & 1);
+
+				if (!foundFlag || (score > bestScore)) {
+					result = direction;
+					bestScore = score;
+					foundFlag = true;
+				}
+			}
+			return result;
+		}
+
+		// Check if a head moving into a cell this tick survives it, judged against the board at the start of the tick.
+		// A tail only counts as leaving its cell when its snake is not growing, a dying snake's cells are cleared anyway.
+		bool ArenaGame::cellIsFreeFor(int cellIndex) const {
+			int owner = this->cellOwners[cellIndex];
+			if (owner == ARENA_EMPTY_CELL) {
+				return true;
+			}
+			if (owner == ARENA_WALL_CELL) {
+				return false;
+			}
+
+			const ArenaSnake& occupant = this->snakes[owner];
+			bool tailLeavesFlag = (occupant.queuedGrowth == 0) || (occupant.length >= this->defn.snakeMaxLength);
+			int tailCell = this->snakeCells[((std::size_t)owner * this->defn.snakeMaxLength) + occupant.tailSlot];
+			return tailLeavesFlag && (cellIndex == tailCell);
+		}
+
+		// Check if a cell holds a snake's head
+		bool ArenaGame::cellIsHead(int cellIndex) const {
+			int owner = this->cellOwners[cellIndex];
+			if (owner < 0) {
+				return false;
+			}
+			return this->snakeCells[((std::size_t)owner * this->defn.snakeMaxLength) + this->snakes[owner].headSlot] == cellIndex;
+		}
+
+		// Work out the cell a snake moves into, mark it dying when that cell is taken and claim it otherwise
+		void ArenaGame::claimTarget(int snakeIndex) {
+			ArenaSnake& snake = this->snakes[snakeIndex];
+
+			ObjectDirection direction = snake.direction;
+			if (snakeIndex >= this->defn.playerSnakeCount) {
+				direction = this->resolveBotDirection(snakeIndex);
+			} else if ((snake.input != ObjectDirection::NONE) && (turnArenaDirection(snake.input, 2) != snake.direction)) {
+				direction = snake.input;
+			}
+			snake.input = direction;
+
+			int headCell = this->snakeCells[((std::size_t)snakeIndex * this->defn.snakeMaxLength) + snake.headSlot];
+			snake.targetCell = headCell + this->resolveDirectionOffset(direction);
+			snake.dyingFlag = !this->cellIsFreeFor(snake.targetCell);
+			if (!snake.dyingFlag) {
+				this->cellClaims[snake.targetCell].fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		// Kill snakes whose cell another head claimed too, then take the tail off the board for every snake that is not growing
+		void ArenaGame::resolveTarget(int snakeIndex) {
+			ArenaSnake& snake = this->snakes[snakeIndex];
+
+			if (!snake.dyingFlag && (this->cellClaims[snake.targetCell].load(std::memory_order_relaxed) > 1)) {
+				snake.dyingFlag = true;
+				this->headOnDeathCount.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			if (snake.dyingFlag) {
+				this->deathCount.fetch_add(1, std::memory_order_relaxed);
+				this->removeSnake(snakeIndex);
+				return;
+			}
+
+			if ((snake.queuedGrowth > 0) && (snake.length < this->defn.snakeMaxLength)) {
+				snake.queuedGrowth--;
+				snake.length++;
+			} else {
+				snake.queuedGrowth = 0;
+				int* ring = this->snakeCells + ((std::size_t)snakeIndex * this->defn.snakeMaxLength);
+				this->cellOwners[ring[snake.tailSlot]] = ARENA_EMPTY_CELL;
+				snake.tailSlot = (snake.tailSlot + 1 == this->defn.snakeMaxLength) ? 0 : snake.tailSlot + 1;
+			}
+		}
+
+		// Move a surviving head into the cell it claimed and eat the apple there, and clear the claim for the next tick
+		void ArenaGame::moveHead(int snakeIndex) {
+			ArenaSnake& snake = this->snakes[snakeIndex];
+			this->cellClaims[snake.targetCell].store(0, std::memory_order_relaxed);
+			if (snake.dyingFlag) {
+				return;
+			}
+
+			int* ring = this->snakeCells + ((std::size_t)snakeIndex * this->defn.snakeMaxLength);
+			snake.headSlot = (snake.headSlot + 1 == this->defn.snakeMaxLength) ? 0 : snake.headSlot + 1;
+			ring[snake.headSlot] = snake.targetCell;
+			this->cellOwners[snake.targetCell] = snakeIndex;
+			snake.direction = snake.input;
+
+			if (this->appleCells[snake.targetCell] != 0) {
+				this->appleCells[snake.targetCell] = 0;
+				snake.queuedGrowth += ARENA_APPLE_GROWTH;
+				snake.applesEaten++;
+				this->applesEatenCount.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+	}
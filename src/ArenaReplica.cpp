@@ -0,0 +1,259 @@
+#include <assert.h>
+#include "includes/arenareplica.hpp"
+
+
+	namespace snake {
+
+		// Values of the occupancy grid for cells no snake covers, the same as on the arena
+		const int ARENA_REPLICA_EMPTY_CELL = -1;
+		const int ARENA_REPLICA_WALL_CELL = -2;
+
+		// Constructor for ArenaReplica
+		ArenaReplica::ArenaReplica(const NetArenaShape& shape) {
+			assert((shape.fieldSize.x >= 3) && (shape.fieldSize.y >= 3));
+			assert((shape.snakeCount > 0) && (shape.snakeMaxLength >= 2));
+
+			this->shape = shape;
+			int cellCount = shape.fieldSize.x * shape.fieldSize.y;
+			this->cellOwners = new int[cellCount];
+			this->appleCells = new std::uint8_t[cellCount];
+			this->snakes = new ArenaReplicaSnake[shape.snakeCount];
+			this->snakeCells = new int[(std::size_t)shape.snakeCount * shape.snakeMaxLength];
+			this->clear();
+		}
+
+		// Destructor for ArenaReplica
+		ArenaReplica::~ArenaReplica() {
+			delete[] this->cellOwners;
+			delete[] this->appleCells;
+			delete[] this->snakes;
+			delete[] this->snakeCells;
+		}
+
+		// Put the walls back and drop every snake and apple
+		void ArenaReplica::clear() {
+			int cellCount = this->shape.fieldSize.x * this->shape.fieldSize.y;
+			for (int cellIndex = 0; cellIndex < cellCount; cellIndex++) {
+				sf::Vector2i position = this->resolvePosition(cellIndex);
+				bool wallFlag = (position.x == 0) || (position.y == 0) || (position.x == this->shape.fieldSize.x - 1) || (position.y == this->shape.fieldSize.y - 1);
+				this->cellOwners[cellIndex] = wallFlag ? ARENA_REPLICA_WALL_CELL : ARENA_REPLICA_EMPTY_CELL;
+				this->appleCells[cellIndex] = 0;
+			}
+
+			for (int snakeIndex = 0; snakeIndex < this->shape.snakeCount; snakeIndex++) {
+				ArenaReplicaSnake& snake = this->snakes[snakeIndex];
+				snake.headSlot = 0;
+				snake.tailSlot = 0;
+				snake.length = 0;
+				snake.direction = ObjectDirection::NONE;
+				snake.aliveFlag = false;
+			}
+		}
+
+		// Clear every cell of a snake from its tail to its head
+		void ArenaReplica::removeSnake(int snakeIndex) {
+			ArenaReplicaSnake& snake = this->snakes[snakeIndex];
+			if (!snake.aliveFlag) {
+				return;
+			}
+
+			const int* ring = this->snakeCells + ((std::size_t)snakeIndex * this->shape.snakeMaxLength);
+			int slot = snake.tailSlot;
+			for (int segmentIndex = 0; segmentIndex < snake.length; segmentIndex++) {
+				this->cellOwners[ring[slot]] = ARENA_REPLICA_EMPTY_CELL;
+				slot = (slot + 1 == this->shape.snakeMaxLength) ? 0 : slot + 1;
+			}
+			snake.aliveFlag = false;
+			snake.length = 0;
+		}
+
+		// Clear the tail cell and let the next segment be the tail
+		void ArenaReplica::moveTail(int snakeIndex) {
+			ArenaReplicaSnake& snake = this->snakes[snakeIndex];
+			if (!snake.aliveFlag || (snake.length <= 1)) {
+				return;
+			}
+
+			const int* ring = this->snakeCells + ((std::size_t)snakeIndex * this->shape.snakeMaxLength);
+			this->cellOwners[ring[snake.tailSlot]] = ARENA_REPLICA_EMPTY_CELL;
+			snake.tailSlot = (snake.tailSlot + 1 == this->shape.snakeMaxLength) ? 0 : snake.tailSlot + 1;
+			snake.length--;
+		}
+
+		// Step the head into the next cell, a head never moves into a wall on the arena so one from the network is dropped
+		void ArenaReplica::moveHead(int snakeIndex, ObjectDirection direction) {
+			ArenaReplicaSnake& snake = this->snakes[snakeIndex];
+			if (!snake.aliveFlag || (snake.length >= this->shape.snakeMaxLength)) {
+				return;
+			}
+
+			int* ring = this->snakeCells + ((std::size_t)snakeIndex * this->shape.snakeMaxLength);
+			sf::Vector2i step = SnakeUtils::directionToVector(direction);
+			int targetCell = ring[snake.headSlot] + (step.y * this->shape.fieldSize.x) + step.x;
+			if (!this->isInteriorCell(targetCell)) {
+				return;
+			}
+
+			snake.headSlot = (snake.headSlot + 1 == this->shape.snakeMaxLength) ? 0 : snake.headSlot + 1;
+			ring[snake.headSlot] = targetCell;
+			snake.length++;
+			snake.direction = direction;
+			this->cellOwners[targetCell] = snakeIndex;
+			this->appleCells[targetCell] = 0;
+		}
+
+		// Walk the steps from the head back, filling the ring from its tail end so the head lands in the last slot
+		void ArenaReplica::placeSnake(int snakeIndex, int headCell, ObjectDirection direction, int length, const std::uint8_t* stepBits) {
+			assert((length >= 1) && (length <= this->shape.snakeMaxLength));
+			this->removeSnake(snakeIndex);
+
+			ArenaReplicaSnake& snake = this->snakes[snakeIndex];
+			int* ring = this->snakeCells + ((std::size_t)snakeIndex * this->shape.snakeMaxLength);
+			int cellIndex = headCell;
+			for (int segmentIndex = 0; segmentIndex < length; segmentIndex++) {
+				if (!this->isInteriorCell(cellIndex)) {
+					// A body running into the wall is not from the server, the snake is left off the field
+					return;
+				}
+				ring[length - 1 - segmentIndex] = cellIndex;
+				if (segmentIndex + 1 < length) {
+					int directionBits = (stepBits[segmentIndex / 4] >> ((segmentIndex % 4) * 2)) & 3;
+					sf::Vector2i step = SnakeUtils::directionToVector(NetUtils::decodeDirection(directionBits));
+					cellIndex += (step.y * this->shape.fieldSize.x) + step.x;
+				}
+			}
+
+			for (int slot = 0; slot < length; slot++) {
+				this->cellOwners[ring[slot]] = snakeIndex;
+			}
+			snake.tailSlot = 0;
+			snake.headSlot = length - 1;
+			snake.length = length;
+			snake.direction = direction;
+			snake.aliveFlag = true;
+		}
+
+		// Lay the snake out backwards from its head, the opposite way to the direction it faces
+		void ArenaReplica::spawnSnake(int snakeIndex, int headCell, ObjectDirection direction, int length) {
+			assert((length >= 1) && (length <= this->shape.snakeMaxLength));
+			this->removeSnake(snakeIndex);
+
+			sf::Vector2i step = SnakeUtils::directionToVector(direction);
+			int backOffset = -((step.y * this->shape.fieldSize.x) + step.x);
+			for (int segmentIndex = 0; segmentIndex < length; segmentIndex++) {
+				if (!this->isInteriorCell(headCell + (backOffset * segmentIndex))) {
+					return;
+				}
+			}
+
+			ArenaReplicaSnake& snake = this->snakes[snakeIndex];
+			int* ring = this->snakeCells + ((std::size_t)snakeIndex * this->shape.snakeMaxLength);
+			for (int segmentIndex = 0; segmentIndex < length; segmentIndex++) {
+				int cellIndex = headCell + (backOffset * segmentIndex);
+				ring[length - 1 - segmentIndex] = cellIndex;
+				this->cellOwners[cellIndex] = snakeIndex;
+			}
+			snake.tailSlot = 0;
+			snake.headSlot = length - 1;
+			snake.length = length;
+			snake.direction = direction;
+			snake.aliveFlag = true;
+		}
+
+		// Put an apple on a cell
+		void ArenaReplica::setApple(int cellIndex) {
+			if (this->isInteriorCell(cellIndex)) {
+				this->appleCells[cellIndex] = 1;
+			}
+		}
+
+		// Get the shape of the arena the replica mirrors
+		const NetArenaShape& ArenaReplica::getShape() const {
+			return this->shape;
+		}
+
+		// Check whether a snake is on the field
+		bool ArenaReplica::getSnakeAlive(int snakeIndex) const {
+			return this->snakes[snakeIndex].aliveFlag;
+		}
+
+		// Get the direction a snake last moved in
+		ObjectDirection ArenaReplica::getSnakeDirection(int snakeIndex) const {
+			return this->snakes[snakeIndex].direction;
+		}
+
+		// Get the number of cells a snake covers
+		int ArenaReplica::getSnakeLength(int snakeIndex) const {
+			return this->snakes[snakeIndex].length;
+		}
+
+		// Get a cell of a snake counting back from its head
+		sf::Vector2i ArenaReplica::getSnakeCell(int snakeIndex, int segmentIndex) const {
+			const ArenaReplicaSnake& snake = this->snakes[snakeIndex];
+			int slot = snake.headSlot - segmentIndex;
+			if (slot < 0) {
+				slot += this->shape.snakeMaxLength;
+			}
+			return this->resolvePosition(this->snakeCells[((std::size_t)snakeIndex * this->shape.snakeMaxLength) + slot]);
+		}
+
+		// Check whether moving into a cell hits a wall or a snake
+		bool ArenaReplica::getCellBlocked(sf::Vector2i position) const {
+			return this->cellOwners[this->resolveCellIndex(position)] != ARENA_REPLICA_EMPTY_CELL;
+		}
+
+		// Check if there is an apple on a cell
+		bool ArenaReplica::getAppleAt(sf::Vector2i position) const {
+			return this->appleCells[this->resolveCellIndex(position)] != 0;
+		}
+
+		// Hash every snake and then every apple with FNV-1a, in the order ArenaGame::computeStateHash() does
+		std::uint64_t ArenaReplica::computeStateHash() const {
+			std::uint64_t result = 0xCBF29CE484222325ULL;
+			auto mix = [&result](std::uint64_t value) {
+				result = (result ^ value) * 0x100000001B3ULL;
+			};
+
+			for (int snakeIndex = 0; snakeIndex < this->shape.snakeCount; snakeIndex++) {
+				const ArenaReplicaSnake& snake = this->snakes[snakeIndex];
+				mix(snake.aliveFlag ? 1 : 0);
+				if (!snake.aliveFlag) {
+					continue;
+				}
+				mix((std::uint64_t)snake.direction);
+				mix((std::uint64_t)snake.length);
+				for (int segmentIndex = 0; segmentIndex < snake.length; segmentIndex++) {
+					sf::Vector2i position = this->getSnakeCell(snakeIndex, segmentIndex);
+					mix((std::uint64_t)this->resolveCellIndex(position));
+				}
+			}
+
+			int cellCount = this->shape.fieldSize.x * this->shape.fieldSize.y;
+			for (int cellIndex = 0; cellIndex < cellCount; cellIndex++) {
+				if (this->appleCells[cellIndex] != 0) {
+					mix((std::uint64_t)cellIndex);
+				}
+			}
+			return result;
+		}
+
+		// Convert a position to a cell index
+		int ArenaReplica::resolveCellIndex(sf::Vector2i position) const {
+			return (position.y * this->shape.fieldSize.x) + position.x;
+		}
+
+		// Convert a cell index back to a position
+		sf::Vector2i ArenaReplica::resolvePosition(int cellIndex) const {
+			return sf::Vector2i(cellIndex % this->shape.fieldSize.x, cellIndex / this->shape.fieldSize.x);
+		}
+
+		// Check a cell index is on the field and not in the walls
+		bool ArenaReplica::isInteriorCell(int cellIndex) const {
+			if ((cellIndex < 0) || (cellIndex >= this->shape.fieldSize.x * this->shape.fieldSize.y)) {
+				return false;
+			}
+			sf::Vector2i position = this->resolvePosition(cellIndex);
+			return (position.x > 0) && (position.y > 0) && (position.x < this->shape.fieldSize.x - 1) && (position.y < this->shape.fieldSize.y - 1);
+		}
+
+	}
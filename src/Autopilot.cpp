@@ -0,0 +1,658 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <chrono>
+#include "includes/autopilot.hpp"
+
+
+	namespace snake {
+
+		// Cost of a step into or out of a blocked cell, small enough that adding path lengths cannot overflow
+		const int AUTOPILOT_INFINITE_COST = 1 << 28;
+
+		// Directions the snake can move in
+		const ObjectDirection AUTOPILOT_DIRECTIONS[] = { ObjectDirection::UP, ObjectDirection::RIGHT, ObjectDirection::DOWN, ObjectDirection::LEFT };
+
+		// Constructor for Autopilot, the grids are allocated when the first game is seen
+		Autopilot::Autopilot(std::int64_t budgetMicroseconds) {
+			this->fieldSize = sf::Vector2i(0, 0);
+			this->cellCount = 0;
+
+			this->blocked = nullptr;
+			this->costToGoal = nullptr;
+			this->lookaheadCost = nullptr;
+			this->queueCells = nullptr;
+			this->queueKeys = nullptr;
+			this->queuePosition = nullptr;
+			this->queueLength = 0;
+			this->keyModifier = 0;
+			this->goalPosition = sf::Vector2i(-1, -1);
+			this->lastStartPosition = sf::Vector2i(-1, -1);
+
+			this->searchQueue = nullptr;
+			this->searchDistance = nullptr;
+			this->searchStamp = nullptr;
+			this->currentSearchStamp = 0;
+
+			this->virtualCells = nullptr;
+			this->virtualSavedBlocked = nullptr;
+
+			this->trackingFlag = false;
+			this->lastFrameCount = 0;
+			this->lastStateHash = 0;
+			this->lastHeadPosition = sf::Vector2i(-1, -1);
+			this->lastTailPosition = sf::Vector2i(-1, -1);
+			this->plannedDirection = ObjectDirection::NONE;
+
+			this->budgetMicroseconds = budgetMicroseconds;
+			this->resetStats();
+		}
+
+		// Destructor for Autopilot
+		Autopilot::~Autopilot() {
+			this->resizeForField(sf::Vector2i(0, 0));
+		}
+
+		// Choose the input for the next update, planning again only when the board changed since the last call
+		QuickGameInputRequest Autopilot::resolveInput(const QuickGame& game) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			// A frame count that did not advance by one means a new game, or frames the autopilot did not see
+			bool continuingFlag = this->trackingFlag && (game.getFrameCount() == this->lastFrameCount + 1);
+			bool boardChangedFlag = !continuingFlag || (game.getStateHash() != this->lastStateHash);
+			if (!continuingFlag) {
+				this->trackingFlag = false;
+			}
+
+			if (boardChangedFlag) {
+				this->plannedDirection = this->plan(game);
+				this->stats.planCount++;
+			}
+			this->lastFrameCount = game.getFrameCount();
+			this->lastStateHash = game.getStateHash();
+
+			// The game keeps the last valid input, so the planned direction is given every frame
+			QuickGameInputRequest result;
+			result.snakeMovementInput = this->plannedDirection;
+
+			std::int64_t elapsedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+			this->stats.tickCount++;
+			this->stats.lastMicroseconds = elapsedMicroseconds;
+			this->stats.totalMicroseconds += elapsedMicroseconds;
+			if (elapsedMicroseconds > this->stats.maxMicroseconds) {
+				this->stats.maxMicroseconds = elapsedMicroseconds;
+			}
+			if (elapsedMicroseconds > this->budgetMicroseconds) {
+				this->stats.overBudgetCount++;
+			}
+
+			return result;
+		}
+
+		// Get the planning time statistics
+		const AutopilotStats& Autopilot::getStats() const {
+			return this->stats;
+		}
+
+		// Clear the planning time statistics
+		void Autopilot::resetStats() {
+			this->stats.tickCount = 0;
+			this->stats.planCount = 0;
+			this->stats.overBudgetCount = 0;
+			this->stats.lastMicroseconds = 0;
+			this->stats.maxMicroseconds = 0;
+			this->stats.totalMicroseconds = 0;
+		}
+
+		// Bring the occupancy grid and the search up to date, then pick a direction
+		ObjectDirection Autopilot::plan(const QuickGame& game) {
+			Snake* snake = game.getSnake();
+			SnakeSegment head = snake->getHead();
+
+			// Follow a single move incrementally, anything else rebuilds the grid
+			if (!this->trackingFlag || (game.getFieldSize() != this->fieldSize)) {
+				this->rebuild(game);
+			} else if (head.position != this->lastHeadPosition) {
+				sf::Vector2i followingPosition = (snake->getBodyLength() > 0) ? snake->getBody(0).position : snake->getTail().position;
+				if (followingPosition == this->lastHeadPosition) {
+					this->syncAfterMove(game);
+				} else {
+					this->rebuild(game);
+				}
+			}
+			this->lastHeadPosition = head.position;
+			this->lastTailPosition = snake->getTail().position;
+
+			// The search is rooted at the apple, so a new apple starts a new search
+			bool goalActiveFlag = game.getAppleExists();
+			if (goalActiveFlag && (game.getApplePosition() != this->goalPosition)) {
+				this->resetSearch(game.getApplePosition(), head.position);
+			}
+
+			// Step towards the apple when the shortest path exists and the snake can still reach its tail afterwards
+			if (goalActiveFlag) {
+				this->computeShortestPath();
+
+				int headCellIndex = this->resolveCellIndex(head.position);
+				ObjectDirection pathDirection = ObjectDirection::NONE;
+				int pathCost = AUTOPILOT_INFINITE_COST;
+				for (ObjectDirection direction : AUTOPILOT_DIRECTIONS) {
+					sf::Vector2i next = head.position + SnakeUtils::directionToVector(direction);
+					if (!snake->isValidMovementDirection(direction) || this->isLethal(game, next)) {
+						continue;
+					}
+
+					int nextCellIndex = this->resolveCellIndex(next);
+					int cost = this->resolveStepCost(headCellIndex, nextCellIndex) + this->costToGoal[nextCellIndex];
+					if (cost < pathCost) {
+						pathCost = cost;
+						pathDirection = direction;
+					}
+				}
+
+				if ((pathDirection != ObjectDirection::NONE) && (pathCost < AUTOPILOT_INFINITE_COST) && this->isPathSafe(game, pathDirection)) {
+					return pathDirection;
+				}
+			}
+
+			// Otherwise stall by taking the longest way round to the tail, or failing that the move with the most room
+			ObjectDirection result = head.enterDirection;
+			int bestTailDistance = -1;
+			int bestRoom = -1;
+			for (ObjectDirection direction : AUTOPILOT_DIRECTIONS) {
+				sf::Vector2i next = head.position + SnakeUtils::directionToVector(direction);
+				if (!snake->isValidMovementDirection(direction) || this->isLethal(game, next)) {
+					continue;
+				}
+
+				int tailDistance = this->measureTailDistance(game, next);
+				if (tailDistance > bestTailDistance) {
+					bestTailDistance = tailDistance;
+					result = direction;
+				}
+				if (bestTailDistance < 0) {
+					int room = this->measureReachableCells(game, next);
+					if (room > bestRoom) {
+						bestRoom = room;
+						result = direction;
+					}
+				}
+			}
+
+			return result;
+		}
+
+		// Reallocate the grids for a field of another size, a zero size frees them
+		void Autopilot::resizeForField(sf::Vector2i fieldSize) {
+			delete[] this->blocked;
+			delete[] this->costToGoal;
+			delete[] this->lookaheadCost;
+			delete[] this->queueCells;
+			delete[] this->queueKeys;
+			delete[] this->queuePosition;
+			delete[] this->searchQueue;
+			delete[] this->searchDistance;
+			delete[] this->searchStamp;
+			delete[] this->virtualCells;
+			delete[] this->virtualSavedBlocked;
+
+			this->fieldSize = fieldSize;
+			this->cellCount = fieldSize.x * fieldSize.y;
+			if (this->cellCount == 0) {
+				this->blocked = nullptr;
+				this->costToGoal = nullptr;
+				this->lookaheadCost = nullptr;
+				this->queueCells = nullptr;
+				this->queueKeys = nullptr;
+				this->queuePosition = nullptr;
+				this->searchQueue = nullptr;
+				this->searchDistance = nullptr;
+				this->searchStamp = nullptr;
+				this->virtualCells = nullptr;
+				this->virtualSavedBlocked = nullptr;
+				return;
+			}
+
+			this->blocked = new unsigned char[this->cellCount];
+			this->costToGoal = new int[this->cellCount];
+			this->lookaheadCost = new int[this->cellCount];
+			this->queueCells = new int[this->cellCount];
+			this->queueKeys = new AutopilotKey[this->cellCount];
+			this->queuePosition = new int[this->cellCount];
+			this->searchQueue = new int[this->cellCount];
+			this->searchDistance = new int[this->cellCount];
+			this->searchStamp = new int[this->cellCount];
+			this->virtualCells = new int[this->cellCount * 2];
+			this->virtualSavedBlocked = new unsigned char[this->cellCount * 2];
+
+			for (int cellIndex = 0; cellIndex < this->cellCount; cellIndex++) {
+				this->searchStamp[cellIndex] = 0;
+			}
+			this->currentSearchStamp = 0;
+		}
+
+		// Mark the walls and the snake's body as blocked and drop the search
+		void Autopilot::rebuild(const QuickGame& game) {
+			if (game.getFieldSize() != this->fieldSize) {
+				this->resizeForField(game.getFieldSize());
+			}
+
+			for (int cellIndex = 0; cellIndex < this->cellCount; cellIndex++) {
+				sf::Vector2i position = this->resolvePosition(cellIndex);
+				bool wallFlag = (position.x <= 0) || (position.y <= 0) || (position.x >= this->fieldSize.x - 1) || (position.y >= this->fieldSize.y - 1);
+				this->blocked[cellIndex] = wallFlag ? 1 : 0;
+			}
+
+			Snake* snake = game.getSnake();
+			for (int bodyIndex = 0; bodyIndex < snake->getBodyLength(); bodyIndex++) {
+				this->blocked[this->resolveCellIndex(snake->getBody(bodyIndex).position)] = 1;
+			}
+			this->blocked[this->resolveCellIndex(snake->getHead().position)] = 0;
+			this->blocked[this->resolveCellIndex(snake->getTail().position)] = 0;
+
+			this->goalPosition = sf::Vector2i(-1, -1);
+			this->queueLength = 0;
+			this->lastStartPosition = snake->getHead().position;
+			this->trackingFlag = true;
+		}
+
+		// Apply one move of the snake: the old head cell is now body, and the cell the tail moved onto is no longer body
+		void Autopilot::syncAfterMove(const QuickGame& game) {
+			Snake* snake = game.getSnake();
+			sf::Vector2i headPosition = snake->getHead().position;
+			sf::Vector2i tailPosition = snake->getTail().position;
+
+			// D* Lite keeps old queue keys valid by raising the bound on every later key by how far the start moved
+			bool searchActiveFlag = (this->goalPosition.x >= 0);
+			if (searchActiveFlag) {
+				this->keyModifier += abs(headPosition.x - this->lastStartPosition.x) + abs(headPosition.y - this->lastStartPosition.y);
+			}
+			this->lastStartPosition = headPosition;
+
+			// Segments can share a cell while the snake unfolds from its start, so ask the snake rather than assume
+			this->setBlocked(this->resolveCellIndex(this->lastHeadPosition), snake->bodyOccupiesPosition(this->lastHeadPosition));
+			if (tailPosition != this->lastTailPosition) {
+				this->setBlocked(this->resolveCellIndex(this->lastTailPosition), snake->bodyOccupiesPosition(this->lastTailPosition));
+				this->setBlocked(this->resolveCellIndex(tailPosition), false);
+			}
+		}
+
+		// Change whether a cell is blocked and repair the search around it
+		void Autopilot::setBlocked(int cellIndex, bool blockedFlag) {
+			if ((this->blocked[cellIndex] != 0) == blockedFlag) {
+				return;
+			}
+			this->blocked[cellIndex] = blockedFlag ? 1 : 0;
+
+			// Every step into and out of the cell changed cost
+			if (this->goalPosition.x >= 0) {
+				this->updateVertex(cellIndex);
+				this->updateNeighbourVertices(cellIndex);
+			}
+		}
+
+		// Start a new search rooted at the goal
+		void Autopilot::resetSearch(sf::Vector2i goalPosition, sf::Vector2i startPosition) {
+			for (int cellIndex = 0; cellIndex < this->cellCount; cellIndex++) {
+				this->costToGoal[cellIndex] = AUTOPILOT_INFINITE_COST;
+				this->lookaheadCost[cellIndex] = AUTOPILOT_INFINITE_COST;
+				this->queuePosition[cellIndex] = -1;
+			}
+			this->queueLength = 0;
+			this->keyModifier = 0;
+			this->goalPosition = goalPosition;
+			this->lastStartPosition = startPosition;
+
+			int goalCellIndex = this->resolveCellIndex(goalPosition);
+			this->lookaheadCost[goalCellIndex] = 0;
+			this->queuePush(goalCellIndex, this->calculateKey(goalCellIndex));
+		}
+
+		// A step costs one unless it enters or leaves a blocked cell
+		int Autopilot::resolveStepCost(int fromCellIndex, int toCellIndex) const {
+			return (this->blocked[fromCellIndex] || this->blocked[toCellIndex]) ? AUTOPILOT_INFINITE_COST : 1;
+		}
+
+		// Queue priority of a cell, the Manhattan distance to the snake's head is the heuristic
+		AutopilotKey Autopilot::calculateKey(int cellIndex) const {
+			int bestCost = this->costToGoal[cellIndex];
+			if (this->lookaheadCost[cellIndex] < bestCost) {
+				bestCost = this->lookaheadCost[cellIndex];
+			}
+
+			sf::Vector2i position = this->resolvePosition(cellIndex);
+			int heuristic = abs(position.x - this->lastStartPosition.x) + abs(position.y - this->lastStartPosition.y);
+
+			AutopilotKey result;
+			result.primary = bestCost + heuristic + this->keyModifier;
+			result.secondary = bestCost;
+			return result;
+		}
+
+		// Recompute a cell's one step lookahead and queue it when it disagrees with its cost
+		void Autopilot::updateVertex(int cellIndex) {
+			if (cellIndex != this->resolveCellIndex(this->goalPosition)) {
+				sf::Vector2i position = this->resolvePosition(cellIndex);
+
+				int bestCost = AUTOPILOT_INFINITE_COST;
+				for (ObjectDirection direction : AUTOPILOT_DIRECTIONS) {
+					int neighbourIndex = this->resolveCellIndex(position + SnakeUtils::directionToVector(direction));
+					if (neighbourIndex < 0) {
+						continue;
+					}
+
+					int cost = this->resolveStepCost(cellIndex, neighbourIndex) + this->costToGoal[neighbourIndex];
+					if (cost < bestCost) {
+						bestCost = cost;
+					}
+				}
+				this->lookaheadCost[cellIndex] = bestCost;
+			}
+
+			if (this->queuePosition[cellIndex] >= 0) {
+				this->queueRemove(cellIndex);
+			}
+			if (this->costToGoal[cellIndex] != this->lookaheadCost[cellIndex]) {
+				this->queuePush(cellIndex, this->calculateKey(cellIndex));
+			}
+		}
+
+		// Update every cell next to a cell
+		void Autopilot::updateNeighbourVertices(int cellIndex) {
+			sf::Vector2i position = this->resolvePosition(cellIndex);
+			for (ObjectDirection direction : AUTOPILOT_DIRECTIONS) {
+				int neighbourIndex = this->resolveCellIndex(position + SnakeUtils::directionToVector(direction));
+				if (neighbourIndex >= 0) {
+					this->updateVertex(neighbourIndex);
+				}
+			}
+		}
+
+		// Settle queued cells until the head's cost is final, only cells affected by changes since the last call are revisited
+		void Autopilot::computeShortestPath() {
+			int startCellIndex = this->resolveCellIndex(this->lastStartPosition);
+
+			while (this->queueLength > 0) {
+				bool startConsistentFlag = (this->costToGoal[startCellIndex] == this->lookaheadCost[startCellIndex]);
+				if (!this->queueKeyLess(this->queueKeys[0], this->calculateKey(startCellIndex)) && startConsistentFlag) {
+					break;
+				}
+
+				int cellIndex = this->queueCells[0];
+				AutopilotKey oldKey = this->queueKeys[0];
+				AutopilotKey newKey = this->calculateKey(cellIndex);
+
+				if (this->queueKeyLess(oldKey, newKey)) {
+					// The key went stale as the head moved, requeue with the current one
+					this->queueRemove(cellIndex);
+					this->queuePush(cellIndex, newKey);
+				} else if (this->costToGoal[cellIndex] > this->lookaheadCost[cellIndex]) {
+					// The cell got cheaper, settle it and tell its neighbours
+					this->costToGoal[cellIndex] = this->lookaheadCost[cellIndex];
+					this->queueRemove(cellIndex);
+					this->updateNeighbourVertices(cellIndex);
+				} else {
+					// The cell got more expensive, reopen it and its neighbours
+					this->costToGoal[cellIndex] = AUTOPILOT_INFINITE_COST;
+					this->updateVertex(cellIndex);
+					this->updateNeighbourVertices(cellIndex);
+				}
+			}
+		}
+
+		// Compare two queue keys
+		bool Autopilot::queueKeyLess(const AutopilotKey& left, const AutopilotKey& right) const {
+			return (left.primary < right.primary) || ((left.primary == right.primary) && (left.secondary < right.secondary));
+		}
+
+		// Add a cell to the queue, which is a binary heap that knows each cell's slot so cells can be removed
+		void Autopilot::queuePush(int cellIndex, AutopilotKey key) {
+			int slot = this->queueLength;
+			this->queueLength++;
+
+			this->queueCells[slot] = cellIndex;
+			this->queueKeys[slot] = key;
+			this->queuePosition[cellIndex] = slot;
+			this->queueSiftUp(slot);
+		}
+
+		// Remove a cell from anywhere in the queue
+		void Autopilot::queueRemove(int cellIndex) {
+			int slot = this->queuePosition[cellIndex];
+			assert(slot >= 0);
+
+			int lastSlot = this->queueLength - 1;
+			this->queueSwap(slot, lastSlot);
+			this->queueLength--;
+			this->queuePosition[cellIndex] = -1;
+
+			if (slot < this->queueLength) {
+				this->queueSiftUp(slot);
+				this->queueSiftDown(slot);
+			}
+		}
+
+		// Swap two queue slots
+		void Autopilot::queueSwap(int leftSlot, int rightSlot) {
+			int leftCell = this->queueCells[leftSlot];
+			AutopilotKey leftKey = this->queueKeys[leftSlot];
+
+			this->queueCells[leftSlot] = this->queueCells[rightSlot];
+			this->queueKeys[leftSlot] = this->queueKeys[rightSlot];
+			this->queueCells[rightSlot] = leftCell;
+			this->queueKeys[rightSlot] = leftKey;
+
+			this->queuePosition[this->queueCells[leftSlot]] = leftSlot;
+			this->queuePosition[this->queueCells[rightSlot]] = rightSlot;
+		}
+
+		// Move a slot towards the top while it is smaller than its parent
+		void Autopilot::queueSiftUp(int slot) {
+			while (slot > 0) {
+				int parentSlot = (slot - 1) / 2;
+				if (!this->queueKeyLess(this->queueKeys[slot], this->queueKeys[parentSlot])) {
+					break;
+				}
+				this->queueSwap(slot, parentSlot);
+				slot = parentSlot;
+			}
+		}
+
+		// Move a slot towards the bottom while a child is smaller
+		void Autopilot::queueSiftDown(int slot) {
+			while (true) {
+				int smallestSlot = slot;
+				int leftSlot = (slot * 2) + 1;
+				int rightSlot = leftSlot + 1;
+				if ((leftSlot < this->queueLength) && this->queueKeyLess(this->queueKeys[leftSlot], this->queueKeys[smallestSlot])) {
+					smallestSlot = leftSlot;
+				}
+				if ((rightSlot < this->queueLength) && this->queueKeyLess(this->queueKeys[rightSlot], this->queueKeys[smallestSlot])) {
+					smallestSlot = rightSlot;
+				}
+				if (smallestSlot == slot) {
+					break;
+				}
+				this->queueSwap(slot, smallestSlot);
+				slot = smallestSlot;
+			}
+		}
+
+		// Check whether moving the head onto a cell ends the game, using the same rule as QuickGame
+		bool Autopilot::isLethal(const QuickGame& game, sf::Vector2i position) const {
+			sf::Vector2i gameFieldSize = game.getFieldSize();
+			bool result =
+				(position.x <= 0) ||
+				(position.y <= 0) ||
+				(position.x >= gameFieldSize.x - 1) ||
+				(position.y >= gameFieldSize.y - 1) ||
+				game.getSnake()->bodyOccupiesPosition(position);
+			return result;
+		}
+
+		// Play the shortest path to the apple out on the grid and check the head could still reach the tail once it has eaten
+		bool Autopilot::isPathSafe(const QuickGame& game, ObjectDirection firstDirection) {
+			Snake* snake = game.getSnake();
+			int goalCellIndex = this->resolveCellIndex(this->goalPosition);
+
+			// The snake's cells from tail to head, then the path cells in the order the head will enter them
+			int sequenceLength = 0;
+			this->virtualCells[sequenceLength++] = this->resolveCellIndex(snake->getTail().position);
+			for (int bodyIndex = snake->getBodyLength() - 1; bodyIndex >= 0; bodyIndex--) {
+				this->virtualCells[sequenceLength++] = this->resolveCellIndex(snake->getBody(bodyIndex).position);
+			}
+			this->virtualCells[sequenceLength++] = this->resolveCellIndex(snake->getHead().position);
+
+			int cellIndex = this->resolveCellIndex(snake->getHead().position + SnakeUtils::directionToVector(firstDirection));
+			this->virtualCells[sequenceLength++] = cellIndex;
+			int pathLength = 1;
+			while ((cellIndex != goalCellIndex) && (pathLength < this->cellCount)) {
+				// Walk down the cost-to-apple values the search left behind
+				sf::Vector2i position = this->resolvePosition(cellIndex);
+				int nextCellIndex = -1;
+				int nextCost = AUTOPILOT_INFINITE_COST;
+				for (ObjectDirection direction : AUTOPILOT_DIRECTIONS) {
+					int neighbourIndex = this->resolveCellIndex(position + SnakeUtils::directionToVector(direction));
+					if ((neighbourIndex >= 0) && !this->blocked[neighbourIndex] && (this->costToGoal[neighbourIndex] < nextCost)) {
+						nextCost = this->costToGoal[neighbourIndex];
+						nextCellIndex = neighbourIndex;
+					}
+				}
+				if (nextCellIndex < 0) {
+					return false;
+				}
+
+				cellIndex = nextCellIndex;
+				this->virtualCells[sequenceLength++] = cellIndex;
+				pathLength++;
+			}
+			if (cellIndex != goalCellIndex) {
+				return false;
+			}
+
+			// The snake keeps its length plus whatever growth is still queued while it follows the path
+			int queuedGrowth = game.getQueuedSnakeGrowth();
+			int virtualLength = snake->getLength() + ((queuedGrowth < pathLength) ? queuedGrowth : pathLength);
+			int virtualTailIndex = sequenceLength - virtualLength;
+
+			// Lay the snake down where it will be, remembering the grid so it can be put back
+			for (int sequenceIndex = 0; sequenceIndex < sequenceLength; sequenceIndex++) {
+				this->virtualSavedBlocked[sequenceIndex] = this->blocked[this->virtualCells[sequenceIndex]];
+			}
+			for (int sequenceIndex = 0; sequenceIndex < sequenceLength; sequenceIndex++) {
+				this->blocked[this->virtualCells[sequenceIndex]] = 0;
+			}
+			for (int sequenceIndex = virtualTailIndex + 1; sequenceIndex < sequenceLength - 1; sequenceIndex++) {
+				this->blocked[this->virtualCells[sequenceIndex]] = 1;
+			}
+
+			bool result = this->search(this->goalPosition, this->virtualCells[virtualTailIndex], nullptr) >= 0;
+
+			for (int sequenceIndex = sequenceLength - 1; sequenceIndex >= 0; sequenceIndex--) {
+				this->blocked[this->virtualCells[sequenceIndex]] = this->virtualSavedBlocked[sequenceIndex];
+			}
+
+			return result;
+		}
+
+		// Steps from the next head cell to where the tail will be after the move, or -1 when the snake would cut itself off
+		int Autopilot::measureTailDistance(const QuickGame& game, sf::Vector2i nextHeadPosition) {
+			Snake* snake = game.getSnake();
+			sf::Vector2i headPosition = snake->getHead().position;
+			int headCellIndex = this->resolveCellIndex(headPosition);
+
+			// While growing the tail stays put, otherwise it moves onto the last body cell
+			bool growingFlag = game.getQueuedSnakeGrowth() > 0;
+			int bodyLength = snake->getBodyLength();
+			sf::Vector2i targetPosition = snake->getTail().position;
+			if (!growingFlag) {
+				targetPosition = (bodyLength > 0) ? snake->getBody(bodyLength - 1).position : headPosition;
+			}
+			int targetCellIndex = this->resolveCellIndex(targetPosition);
+
+			// Apply the move to the grid for the search only, the planner's view is left alone
+			unsigned char headBlocked = this->blocked[headCellIndex];
+			unsigned char targetBlocked = this->blocked[targetCellIndex];
+			if (targetCellIndex != headCellIndex) {
+				this->blocked[headCellIndex] = 1;
+			}
+			this->blocked[targetCellIndex] = 0;
+
+			int result = this->search(nextHeadPosition, targetCellIndex, nullptr);
+
+			this->blocked[headCellIndex] = headBlocked;
+			this->blocked[targetCellIndex] = targetBlocked;
+
+			return result;
+		}
+
+		// Count the cells reachable from the next head cell once the current head cell has become body
+		int Autopilot::measureReachableCells(const QuickGame& game, sf::Vector2i nextHeadPosition) {
+			int headCellIndex = this->resolveCellIndex(game.getSnake()->getHead().position);
+			unsigned char headBlocked = this->blocked[headCellIndex];
+			this->blocked[headCellIndex] = 1;
+
+			int result = 0;
+			this->search(nextHeadPosition, -1, &result);
+
+			this->blocked[headCellIndex] = headBlocked;
+			return result;
+		}
+
+		// Breadth first search over unblocked cells, returns the distance to the target cell or -1 when it is not reached
+		int Autopilot::search(sf::Vector2i startPosition, int targetCellIndex, int* reachedCount) {
+			// Stamps mark visited cells without clearing the grid before every search
+			this->currentSearchStamp++;
+			if (this->currentSearchStamp == 0) {
+				for (int cellIndex = 0; cellIndex < this->cellCount; cellIndex++) {
+					this->searchStamp[cellIndex] = 0;
+				}
+				this->currentSearchStamp = 1;
+			}
+
+			int startCellIndex = this->resolveCellIndex(startPosition);
+			int queueHead = 0;
+			int queueTail = 0;
+			this->searchQueue[queueTail++] = startCellIndex;
+			this->searchStamp[startCellIndex] = this->currentSearchStamp;
+			this->searchDistance[startCellIndex] = 0;
+
+			int result = -1;
+			while (queueHead < queueTail) {
+				int cellIndex = this->searchQueue[queueHead++];
+				if (cellIndex == targetCellIndex) {
+					result = this->searchDistance[cellIndex];
+					break;
+				}
+
+				sf::Vector2i position = this->resolvePosition(cellIndex);
+				for (ObjectDirection direction : AUTOPILOT_DIRECTIONS) {
+					int neighbourIndex = this->resolveCellIndex(position + SnakeUtils::directionToVector(direction));
+					if ((neighbourIndex < 0) || this->blocked[neighbourIndex] || (this->searchStamp[neighbourIndex] == this->currentSearchStamp)) {
+						continue;
+					}
+					this->searchStamp[neighbourIndex] = this->currentSearchStamp;
+					this->searchDistance[neighbourIndex] = this->searchDistance[cellIndex] + 1;
+					this->searchQueue[queueTail++] = neighbourIndex;
+				}
+			}
+
+			if (reachedCount != nullptr) {
+				*reachedCount = queueTail;
+			}
+			return result;
+		}
+
+		// Convert a position to a cell index, -1 when it is off the field
+		int Autopilot::resolveCellIndex(sf::Vector2i position) const {
+			if ((position.x < 0) || (position.y < 0) || (position.x >= this->fieldSize.x) || (position.y >= this->fieldSize.y)) {
+				return -1;
+			}
+			return (position.y * this->fieldSize.x) + position.x;
+		}
+
+		// Convert a cell index back to a position
+		sf::Vector2i Autopilot::resolvePosition(int cellIndex) const {
+			return sf::Vector2i(cellIndex % this->fieldSize.x, cellIndex / this->fieldSize.x);
+		}
+
+	}
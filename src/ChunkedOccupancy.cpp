@@ -0,0 +1,259 @@
+#include <assert.h>
+#include <string.h>
+#include "includes/chunkedoccupancy.hpp"
+
+
+	namespace snake {
+
+		// Table slots a fresh occupancy starts with
+		const int CHUNKED_OCCUPANCY_INITIAL_SLOTS = 64;
+		// Released chunks kept for reuse, anything beyond this goes back to the heap
+		const int CHUNKED_OCCUPANCY_SPARE_CHUNKS = 16;
+		const int CHUNK_CELL_MASK = OCCUPANCY_CHUNK_SIZE - 1;
+
+		// Constructor for the ChunkedOccupancy class
+		ChunkedOccupancy::ChunkedOccupancy(sf::Vector2i fieldSize) {
+			this->slotCapacity = CHUNKED_OCCUPANCY_INITIAL_SLOTS;
+			this->slots = new OccupancyChunk*[this->slotCapacity];
+			memset(this->slots, 0, sizeof(OccupancyChunk*) * this->slotCapacity);
+			this->chunkCount = 0;
+			this->freeChunks = nullptr;
+			this->freeChunkCount = 0;
+			this->allocatedChunkCount = 0;
+			this->fieldSize = fieldSize;
+			this->chunksPerRow = ((std::int64_t)fieldSize.x + OCCUPANCY_CHUNK_SIZE - 1) >> OCCUPANCY_CHUNK_SHIFT;
+		}
+
+		// Destructor for the ChunkedOccupancy class
+		ChunkedOccupancy::~ChunkedOccupancy() {
+			for (int slotIndex = 0; slotIndex < this->slotCapacity; slotIndex++) {
+				delete this->slots[slotIndex];
+			}
+			delete[] this->slots;
+
+			while (this->freeChunks != nullptr) {
+				OccupancyChunk* nextFreeChunk = this->freeChunks->nextFreeChunk;
+				delete this->freeChunks;
+				this->freeChunks = nextFreeChunk;
+			}
+		}
+
+		// Clear every count, live chunks are kept for reuse up to the spare limit
+		void ChunkedOccupancy::reset(sf::Vector2i fieldSize) {
+			for (int slotIndex = 0; slotIndex < this->slotCapacity; slotIndex++) {
+				OccupancyChunk* chunk = this->slots[slotIndex];
+				if (chunk == nullptr) {
+					continue;
+				}
+				this->slots[slotIndex] = nullptr;
+
+				if (this->freeChunkCount < CHUNKED_OCCUPANCY_SPARE_CHUNKS) {
+					chunk->nextFreeChunk = this->freeChunks;
+					this->freeChunks = chunk;
+					this->freeChunkCount++;
+				} else {
+					delete chunk;
+					this->allocatedChunkCount--;
+				}
+			}
+			this->chunkCount = 0;
+			this->fieldSize = fieldSize;
+			this->chunksPerRow = ((std::int64_t)fieldSize.x + OCCUPANCY_CHUNK_SIZE - 1) >> OCCUPANCY_CHUNK_SHIFT;
+		}
+
+		// Copy another occupancy's chunks, clearing this one first
+		void ChunkedOccupancy::copyFrom(const ChunkedOccupancy& other) {
+			this->reset(other.fieldSize);
+
+			for (int slotIndex = 0; slotIndex < other.slotCapacity; slotIndex++) {
+				const OccupancyChunk* otherChunk = other.slots[slotIndex];
+				if (otherChunk == nullptr) {
+					continue;
+				}
+
+				OccupancyChunk* chunk = this->acquireChunk(otherChunk->key);
+				chunk->occupiedCellCount = otherChunk->occupiedCellCount;
+				memcpy(chunk->cellCounts, otherChunk->cellCounts, sizeof(chunk->cellCounts));
+			}
+		}
+
+		// Get how many segments cover a cell
+		unsigned char ChunkedOccupancy::getCount(sf::Vector2i position) const {
+			bool insideFlag = (position.x >= 0) && (position.x < this->fieldSize.x) && (position.y >= 0) && (position.y < this->fieldSize.y);
+			if (!insideFlag) {
+				return 0;
+			}
+
+			const OccupancyChunk* chunk = this->findChunk(this->resolveChunkKey(position));
+			unsigned char result = (chunk != nullptr) ? chunk->cellCounts[this->resolveCellIndex(position)] : 0;
+			return result;
+		}
+
+		// Count one more segment on a cell, making its chunk when it has none
+		void ChunkedOccupancy::increment(sf::Vector2i position) {
+			assert((position.x >= 0) && (position.x < this->fieldSize.x) && (position.y >= 0) && (position.y < this->fieldSize.y));
+
+			std::int64_t key = this->resolveChunkKey(position);
+			OccupancyChunk* chunk = this->findChunk(key);
+			if (chunk == nullptr) {
+				chunk = this->acquireChunk(key);
+			}
+
+			unsigned char& cellCount = chunk->cellCounts[this->resolveCellIndex(position)];
+			if (cellCount == 0) {
+				chunk->occupiedCellCount++;
+			}
+			cellCount++;
+		}
+
+		// Count one segment less on a cell, releasing its chunk once nothing in it is covered
+		void ChunkedOccupancy::decrement(sf::Vector2i position) {
+			std::int64_t key = this->resolveChunkKey(position);
+			OccupancyChunk* chunk = this->findChunk(key);
+			assert(chunk != nullptr);
+
+			unsigned char& cellCount = chunk->cellCounts[this->resolveCellIndex(position)];
+			assert(cellCount > 0);
+			cellCount--;
+			if (cellCount == 0) {
+				chunk->occupiedCellCount--;
+				if (chunk->occupiedCellCount == 0) {
+					this->releaseChunk(key);
+				}
+			}
+		}
+
+		// Get the size of the field counted
+		sf::Vector2i ChunkedOccupancy::getFieldSize() const {
+			return this->fieldSize;
+		}
+
+		// Get the number of chunks with an occupied cell
+		int ChunkedOccupancy::getChunkCount() const {
+			return this->chunkCount;
+		}
+
+		// Get the bytes held by chunks and the table
+		std::size_t ChunkedOccupancy::getAllocatedBytes() const {
+			std::size_t result = sizeof(OccupancyChunk) * (std::size_t)this->allocatedChunkCount;
+			result += sizeof(OccupancyChunk*) * (std::size_t)this->slotCapacity;
+			return result;
+		}
+
+		// Get the key of the chunk holding a cell, chunks are numbered in rows
+		std::int64_t ChunkedOccupancy::resolveChunkKey(sf::Vector2i position) const {
+			std::int64_t result = (std::int64_t)(position.y >> OCCUPANCY_CHUNK_SHIFT) * this->chunksPerRow + (position.x >> OCCUPANCY_CHUNK_SHIFT);
+			return result;
+		}
+
+		// Get the slot a key is looked up from, a multiplicative hash so neighbouring chunks spread over the table
+		int ChunkedOccupancy::resolveHomeSlot(std::int64_t key) const {
+			std::uint64_t hash = (std::uint64_t)key * 0x9E3779B97F4A7C15ULL;
+			int result = (int)(hash >> 32) & (this->slotCapacity - 1);
+			return result;
+		}
+
+		// Get the index of a cell inside its chunk
+		int ChunkedOccupancy::resolveCellIndex(sf::Vector2i position) const {
+			int result = ((position.y & CHUNK_CELL_MASK) << OCCUPANCY_CHUNK_SHIFT) | (position.x & CHUNK_CELL_MASK);
+			return result;
+		}
+
+		// Find the chunk with a key, nullptr when none of its cells are covered
+		OccupancyChunk* ChunkedOccupancy::findChunk(std::int64_t key) const {
+			int slotMask = this->slotCapacity - 1;
+			for (int slotIndex = this->resolveHomeSlot(key); this->slots[slotIndex] != nullptr; slotIndex = (slotIndex + 1) & slotMask) {
+				if (this->slots[slotIndex]->key == key) {
+					return this->slots[slotIndex];
+				}
+			}
+			return nullptr;
+		}
+
+		// Add a cleared chunk for a key that has none, growing the table first when it would be over half full
+		OccupancyChunk* ChunkedOccupancy::acquireChunk(std::int64_t key) {
+			if ((this->chunkCount + 1) * 2 > this->slotCapacity) {
+				this->growSlots();
+			}
+
+			OccupancyChunk* result = this->freeChunks;
+			if (result != nullptr) {
+				this->freeChunks = result->nextFreeChunk;
+				this->freeChunkCount--;
+			} else {
+				result = new OccupancyChunk;
+				this->allocatedChunkCount++;
+			}
+			result->key = key;
+			result->occupiedCellCount = 0;
+			result->nextFreeChunk = nullptr;
+			memset(result->cellCounts, 0, sizeof(result->cellCounts));
+
+			int slotMask = this->slotCapacity - 1;
+			int slotIndex = this->resolveHomeSlot(key);
+			while (this->slots[slotIndex] != nullptr) {
+				slotIndex = (slotIndex + 1) & slotMask;
+			}
+			this->slots[slotIndex] = result;
+			this->chunkCount++;
+			return result;
+		}
+
+		// Take a chunk out of the table, shifting later chunks of its probe run back so lookups need no tombstones
+		void ChunkedOccupancy::releaseChunk(std::int64_t key) {
+			int slotMask = this->slotCapacity - 1;
+			int emptySlot = this->resolveHomeSlot(key);
+			while (this->slots[emptySlot]->key != key) {
+				emptySlot = (emptySlot + 1) & slotMask;
+			}
+
+			OccupancyChunk* chunk = this->slots[emptySlot];
+			this->slots[emptySlot] = nullptr;
+			this->chunkCount--;
+
+			// Move back every following chunk whose home slot is not between the hole and its own slot
+			for (int slotIndex = (emptySlot + 1) & slotMask; this->slots[slotIndex] != nullptr; slotIndex = (slotIndex + 1) & slotMask) {
+				int homeSlot = this->resolveHomeSlot(this->slots[slotIndex]->key);
+				bool reachableFlag = (((slotIndex - homeSlot) & slotMask) >= ((slotIndex - emptySlot) & slotMask));
+				if (reachableFlag) {
+					this->slots[emptySlot] = this->slots[slotIndex];
+					this->slots[slotIndex] = nullptr;
+					emptySlot = slotIndex;
+				}
+			}
+
+			if (this->freeChunkCount < CHUNKED_OCCUPANCY_SPARE_CHUNKS) {
+				chunk->nextFreeChunk = this->freeChunks;
+				this->freeChunks = chunk;
+				this->freeChunkCount++;
+			} else {
+				delete chunk;
+				this->allocatedChunkCount--;
+			}
+		}
+
+		// Double the table and put every chunk back in its new home
+		void ChunkedOccupancy::growSlots() {
+			OccupancyChunk** oldSlots = this->slots;
+			int oldSlotCapacity = this->slotCapacity;
+
+			this->slotCapacity = oldSlotCapacity * 2;
+			this->slots = new OccupancyChunk*[this->slotCapacity];
+			memset(this->slots, 0, sizeof(OccupancyChunk*) * this->slotCapacity);
+
+			int slotMask = this->slotCapacity - 1;
+			for (int oldSlotIndex = 0; oldSlotIndex < oldSlotCapacity; oldSlotIndex++) {
+				OccupancyChunk* chunk = oldSlots[oldSlotIndex];
+				if (chunk == nullptr) {
+					continue;
+				}
+				int slotIndex = this->resolveHomeSlot(chunk->key);
+				while (this->slots[slotIndex] != nullptr) {
+					slotIndex = (slotIndex + 1) & slotMask;
+				}
+				this->slots[slotIndex] = chunk;
+			}
+			delete[] oldSlots;
+		}
+
+	}
@@ -0,0 +1,395 @@
+#include <assert.h>
+#include <string.h>
+#include "includes/fieldbitboard.hpp"
+#include "includes/level.hpp"
+
+
+	namespace snake {
+
+		// Cells in one word of a layer
+		const int FIELD_BITBOARD_WORD_BITS = 64;
+
+		// Count the set bits of a word
+		int countWordBits(std::uint64_t word) {
+#if defined(__GNUC__)
+			return __builtin_popcountll(word);
+#else
+			word = word - ((word >> 1) & 0x5555555555555555ULL);
+			word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+			word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+			return (int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+		}
+
+		// Index of the lowest set bit of a word that is not zero
+		int findLowestWordBit(std::uint64_t word) {
+#if defined(__GNUC__)
+			return __builtin_ctzll(word);
+#else
+			int result = 0;
+			while ((word & 1) == 0) {
+				word >>= 1;
+				result++;
+			}
+			return result;
+#endif
+		}
+
+		// Spread set bits towards higher bits, which are cells further right, through runs of mask bits
+		std::uint64_t spreadWordRight(std::uint64_t bits, std::uint64_t mask) {
+			bits |= mask & (bits << 1);
+			mask &= mask << 1;
+			bits |= mask & (bits << 2);
+			mask &= mask << 2;
+			bits |= mask & (bits << 4);
+			mask &= mask << 4;
+			bits |= mask & (bits << 8);
+			mask &= mask << 8;
+			bits |= mask & (bits << 16);
+			mask &= mask << 16;
+			bits |= mask & (bits << 32);
+			return bits;
+		}
+
+		// Spread set bits towards lower bits, which are cells further left, through runs of mask bits
+		std::uint64_t spreadWordLeft(std::uint64_t bits, std::uint64_t mask) {
+			bits |= mask & (bits >> 1);
+			mask &= mask >> 1;
+			bits |= mask & (bits >> 2);
+			mask &= mask >> 2;
+			bits |= mask & (bits >> 4);
+			mask &= mask >> 4;
+			bits |= mask & (bits >> 8);
+			mask &= mask >> 8;
+			bits |= mask & (bits >> 16);
+			mask &= mask >> 16;
+			bits |= mask & (bits >> 32);
+			return bits;
+		}
+
+		// Constructor for FieldBitboard
+		FieldBitboard::FieldBitboard() {
+			this->fieldSize = sf::Vector2i(0, 0);
+			this->wordsPerRow = 0;
+			this->wordCount = 0;
+			this->wallBits = nullptr;
+			this->snakeBits = nullptr;
+			this->appleBits = nullptr;
+			this->openBits = nullptr;
+			this->levelWallsFlag = false;
+			this->filledBits = nullptr;
+			this->unclaimedBits = nullptr;
+		}
+
+		// Destructor for FieldBitboard
+		FieldBitboard::~FieldBitboard() {
+			delete[] this->wallBits;
+			delete[] this->snakeBits;
+			delete[] this->appleBits;
+			delete[] this->openBits;
+			delete[] this->filledBits;
+			delete[] this->unclaimedBits;
+		}
+
+		// Copy the game's walls, snake and apple into the layers
+		void FieldBitboard::loadFromGame(const QuickGame& game) {
+			sf::Vector2i gameFieldSize = game.getFieldSize();
+			if (gameFieldSize != this->fieldSize) {
+				this->resize(gameFieldSize);
+			}
+
+			// A level's walls are copied every time, the border is only laid again after a level replaced it
+			if (game.getLevel() != nullptr) {
+				this->loadLevelWalls(*game.getLevel());
+			} else if (this->levelWallsFlag) {
+				this->loadBorderWalls();
+			}
+
+			memset(this->snakeBits, 0, this->wordCount * sizeof(std::uint64_t));
+			memset(this->appleBits, 0, this->wordCount * sizeof(std::uint64_t));
+
+			Snake* snake = game.getSnake();
+			this->setBit(this->snakeBits, snake->getHead().position, true);
+			for (int bodyIndex = 0; bodyIndex < snake->getBodyLength(); bodyIndex++) {
+				this->setBit(this->snakeBits, snake->getBody(bodyIndex).position, true);
+			}
+			this->setBit(this->snakeBits, snake->getTail().position, true);
+
+			if (game.getAppleExists()) {
+				this->setBit(this->appleBits, game.getApplePosition(), true);
+			}
+
+			this->updateOpenBits();
+		}
+
+		// Copy a level's bitmap as the walls of an empty board
+		void FieldBitboard::loadFromLevel(const Level& level) {
+			if (level.getFieldSize() != this->fieldSize) {
+				this->resize(level.getFieldSize());
+			}
+
+			this->loadLevelWalls(level);
+			memset(this->snakeBits, 0, this->wordCount * sizeof(std::uint64_t));
+			memset(this->appleBits, 0, this->wordCount * sizeof(std::uint64_t));
+			this->updateOpenBits();
+		}
+
+		// Mark a cell as snake or open, walls stay closed either way
+		void FieldBitboard::setSnakeCell(sf::Vector2i position, bool snakeFlag) {
+			this->setBit(this->snakeBits, position, snakeFlag);
+			this->setBit(this->openBits, position, !snakeFlag && !this->getBit(this->wallBits, position));
+		}
+
+		// Get the size of the field the layers were loaded for
+		sf::Vector2i FieldBitboard::getFieldSize() const {
+			return this->fieldSize;
+		}
+
+		// Check whether a cell is a wall, cells off the field count as walls
+		bool FieldBitboard::isWall(sf::Vector2i position) const {
+			bool onFieldFlag = (position.x >= 0) && (position.y >= 0) && (position.x < this->fieldSize.x) && (position.y < this->fieldSize.y);
+			return !onFieldFlag || this->getBit(this->wallBits, position);
+		}
+
+		// Check whether any snake segment is on a cell
+		bool FieldBitboard::isSnake(sf::Vector2i position) const {
+			return this->getBit(this->snakeBits, position);
+		}
+
+		// Check whether the apple is on a cell
+		bool FieldBitboard::isApple(sf::Vector2i position) const {
+			return this->getBit(this->appleBits, position);
+		}
+
+		// Check whether a cell is neither wall nor snake
+		bool FieldBitboard::isOpen(sf::Vector2i position) const {
+			return this->getBit(this->openBits, position);
+		}
+
+		// Check whether the last flood fill reached a cell
+		bool FieldBitboard::isFilled(sf::Vector2i position) const {
+			return this->getBit(this->filledBits, position);
+		}
+
+		// Flood fill the open cells connected to the start cell
+		int FieldBitboard::floodFill(sf::Vector2i startPosition) {
+			memset(this->filledBits, 0, this->wordCount * sizeof(std::uint64_t));
+			if (!this->isOpen(startPosition)) {
+				return 0;
+			}
+
+			this->setBit(this->filledBits, startPosition, true);
+			return this->expandFill(this->openBits);
+		}
+
+		// Fill from the first unclaimed open cell until every open cell belongs to a region
+		int FieldBitboard::countRegions(int* largestRegionCellCount) {
+			memcpy(this->unclaimedBits, this->openBits, this->wordCount * sizeof(std::uint64_t));
+
+			int result = 0;
+			int largestCellCount = 0;
+			int wordIndex = 0;
+			while (wordIndex < this->wordCount) {
+				if (this->unclaimedBits[wordIndex] == 0) {
+					wordIndex++;
+					continue;
+				}
+
+				// Filling only through unclaimed cells is enough, the claimed ones belong to other regions
+				memset(this->filledBits, 0, this->wordCount * sizeof(std::uint64_t));
+				this->filledBits[wordIndex] = 1ULL << findLowestWordBit(this->unclaimedBits[wordIndex]);
+				int cellCount = this->expandFill(this->unclaimedBits);
+				for (int claimWordIndex = wordIndex; claimWordIndex < this->wordCount; claimWordIndex++) {
+					this->unclaimedBits[claimWordIndex] &= ~this->filledBits[claimWordIndex];
+				}
+
+				result++;
+				if (cellCount > largestCellCount) {
+					largestCellCount = cellCount;
+				}
+			}
+
+			if (largestRegionCellCount != nullptr) {
+				*largestRegionCellCount = largestCellCount;
+			}
+			return result;
+		}
+
+		// Move the snake on the board the way QuickGame would, flood fill from the new head cell, then put the board back
+		FieldMoveReachability FieldBitboard::measureMove(const QuickGame& game, ObjectDirection direction) {
+			Snake* snake = game.getSnake();
+			sf::Vector2i headPosition = snake->getHead().position;
+			sf::Vector2i nextHeadPosition = headPosition + SnakeUtils::directionToVector(direction);
+
+			FieldMoveReachability result;
+			result.lethalFlag = this->isWall(nextHeadPosition) || snake->bodyOccupiesPosition(nextHeadPosition);
+			result.reachableCellCount = 0;
+			result.tailReachableFlag = false;
+			if (result.lethalFlag) {
+				return result;
+			}
+
+			// While growing the tail stays put, otherwise it moves onto the last body cell and its old cell opens up
+			sf::Vector2i tailPosition = snake->getTail().position;
+			sf::Vector2i nextTailPosition = tailPosition;
+			bool tailLeavesFlag = game.getQueuedSnakeGrowth() == 0;
+			if (tailLeavesFlag) {
+				int bodyLength = snake->getBodyLength();
+				nextTailPosition = (bodyLength > 0) ? snake->getBody(bodyLength - 1).position : headPosition;
+			}
+			bool tailCellOpensFlag = tailLeavesFlag && (tailPosition != headPosition) && !snake->bodyOccupiesPosition(tailPosition);
+
+			// The head can follow the tail onto its cell, so the next tail cell counts as open for the fill
+			bool nextHeadOpenFlag = this->isOpen(nextHeadPosition);
+			bool tailOpenFlag = this->isOpen(tailPosition);
+			bool nextTailOpenFlag = this->isOpen(nextTailPosition);
+			this->setBit(this->openBits, nextHeadPosition, true);
+			if (tailCellOpensFlag) {
+				this->setBit(this->openBits, tailPosition, true);
+			}
+			if (nextTailPosition != headPosition) {
+				this->setBit(this->openBits, nextTailPosition, true);
+			}
+
+			result.reachableCellCount = this->floodFill(nextHeadPosition);
+			result.tailReachableFlag = this->isFilled(nextTailPosition);
+
+			this->setBit(this->openBits, nextTailPosition, nextTailOpenFlag);
+			this->setBit(this->openBits, tailPosition, tailOpenFlag);
+			this->setBit(this->openBits, nextHeadPosition, nextHeadOpenFlag);
+
+			return result;
+		}
+
+		// Reallocate the layers for a new field size and draw its walls
+		void FieldBitboard::resize(sf::Vector2i fieldSize) {
+			delete[] this->wallBits;
+			delete[] this->snakeBits;
+			delete[] this->appleBits;
+			delete[] this->openBits;
+			delete[] this->filledBits;
+			delete[] this->unclaimedBits;
+
+			this->fieldSize = fieldSize;
+			this->wordsPerRow = (fieldSize.x + FIELD_BITBOARD_WORD_BITS - 1) / FIELD_BITBOARD_WORD_BITS;
+			this->wordCount = this->wordsPerRow * fieldSize.y;
+			this->wallBits = new std::uint64_t[this->wordCount]();
+			this->snakeBits = new std::uint64_t[this->wordCount]();
+			this->appleBits = new std::uint64_t[this->wordCount]();
+			this->openBits = new std::uint64_t[this->wordCount]();
+			this->filledBits = new std::uint64_t[this->wordCount]();
+			this->unclaimedBits = new std::uint64_t[this->wordCount]();
+			this->loadBorderWalls();
+		}
+
+		// Lay the field's border as the walls, the same cells QuickGame treats as barriers on an open field
+		void FieldBitboard::loadBorderWalls() {
+			memset(this->wallBits, 0, this->wordCount * sizeof(std::uint64_t));
+			for (int x = 0; x < this->fieldSize.x; x++) {
+				this->setBit(this->wallBits, sf::Vector2i(x, 0), true);
+				this->setBit(this->wallBits, sf::Vector2i(x, this->fieldSize.y - 1), true);
+			}
+			for (int y = 0; y < this->fieldSize.y; y++) {
+				this->setBit(this->wallBits, sf::Vector2i(0, y), true);
+				this->setBit(this->wallBits, sf::Vector2i(this->fieldSize.x - 1, y), true);
+			}
+			this->levelWallsFlag = false;
+		}
+
+		// Copy a level's collision bitmap as the walls, its rows are laid out in words just like the layers
+		void FieldBitboard::loadLevelWalls(const Level& level) {
+			assert(level.getFieldSize() == this->fieldSize);
+			memcpy(this->wallBits, level.getCollisionBits(), this->wordCount * sizeof(std::uint64_t));
+			this->levelWallsFlag = true;
+		}
+
+		// Open every cell that is neither wall nor snake
+		void FieldBitboard::updateOpenBits() {
+			for (int wordIndex = 0; wordIndex < this->wordCount; wordIndex++) {
+				this->openBits[wordIndex] = ~(this->wallBits[wordIndex] | this->snakeBits[wordIndex]);
+			}
+
+			// Cells past the field's width in each row's last word stay closed
+			int lastWordBits = this->fieldSize.x % FIELD_BITBOARD_WORD_BITS;
+			if (lastWordBits != 0) {
+				std::uint64_t lastWordMask = (1ULL << lastWordBits) - 1;
+				for (int rowIndex = 0; rowIndex < this->fieldSize.y; rowIndex++) {
+					this->openBits[(rowIndex * this->wordsPerRow) + this->wordsPerRow - 1] &= lastWordMask;
+				}
+			}
+		}
+
+		// Set or clear one cell's bit in a layer
+		void FieldBitboard::setBit(std::uint64_t* bits, sf::Vector2i position, bool valueFlag) {
+			assert((position.x >= 0) && (position.y >= 0) && (position.x < this->fieldSize.x) && (position.y < this->fieldSize.y));
+			std::uint64_t& word = bits[(position.y * this->wordsPerRow) + (position.x / FIELD_BITBOARD_WORD_BITS)];
+			std::uint64_t mask = 1ULL << (position.x % FIELD_BITBOARD_WORD_BITS);
+			if (valueFlag) {
+				word |= mask;
+			} else {
+				word &= ~mask;
+			}
+		}
+
+		// Get one cell's bit in a layer, cells off the field are clear
+		bool FieldBitboard::getBit(const std::uint64_t* bits, sf::Vector2i position) const {
+			if ((position.x < 0) || (position.y < 0) || (position.x >= this->fieldSize.x) || (position.y >= this->fieldSize.y)) {
+				return false;
+			}
+			std::uint64_t word = bits[(position.y * this->wordsPerRow) + (position.x / FIELD_BITBOARD_WORD_BITS)];
+			return ((word >> (position.x % FIELD_BITBOARD_WORD_BITS)) & 1) != 0;
+		}
+
+		// Grow the filled cells through the mask until they stop changing, and count them
+		int FieldBitboard::expandFill(const std::uint64_t* maskBits) {
+			// Each sweep hands every row's fill to the next row straight away, so one pass down and one back up
+			// covers every region that is not winding back on itself
+			bool changedFlag = true;
+			while (changedFlag) {
+				changedFlag = false;
+				for (int rowIndex = 0; rowIndex < this->fieldSize.y; rowIndex++) {
+					changedFlag = this->fillRow(rowIndex, rowIndex - 1, maskBits) || changedFlag;
+				}
+				for (int rowIndex = this->fieldSize.y - 1; rowIndex >= 0; rowIndex--) {
+					changedFlag = this->fillRow(rowIndex, rowIndex + 1, maskBits) || changedFlag;
+				}
+			}
+
+			int result = 0;
+			for (int wordIndex = 0; wordIndex < this->wordCount; wordIndex++) {
+				result += countWordBits(this->filledBits[wordIndex]);
+			}
+			return result;
+		}
+
+		// Take the fill of a neighbouring row into a row and spread it along the row's runs, returns whether the row changed
+		bool FieldBitboard::fillRow(int rowIndex, int neighbourRowIndex, const std::uint64_t* maskBits) {
+			std::uint64_t* rowBits = this->filledBits + (rowIndex * this->wordsPerRow);
+			const std::uint64_t* rowMask = maskBits + (rowIndex * this->wordsPerRow);
+			bool neighbourFlag = (neighbourRowIndex >= 0) && (neighbourRowIndex < this->fieldSize.y);
+			const std::uint64_t* neighbourBits = this->filledBits + ((neighbourFlag ? neighbourRowIndex : rowIndex) * this->wordsPerRow);
+
+			bool result = false;
+			std::uint64_t carry = 0;
+			for (int wordIndex = 0; wordIndex < this->wordsPerRow; wordIndex++) {
+				std::uint64_t bits = rowBits[wordIndex] | (neighbourBits[wordIndex] & rowMask[wordIndex]) | (carry & rowMask[wordIndex]);
+				bits = spreadWordRight(bits, rowMask[wordIndex]);
+				carry = bits >> (FIELD_BITBOARD_WORD_BITS - 1);
+				result = result || (bits != rowBits[wordIndex]);
+				rowBits[wordIndex] = bits;
+			}
+
+			// Runs that cross a word boundary carry back to the words before them
+			carry = 0;
+			for (int wordIndex = this->wordsPerRow - 1; wordIndex >= 0; wordIndex--) {
+				std::uint64_t bits = rowBits[wordIndex] | ((carry << (FIELD_BITBOARD_WORD_BITS - 1)) & rowMask[wordIndex]);
+				bits = spreadWordLeft(bits, rowMask[wordIndex]);
+				carry = bits & 1;
+				result = result || (bits != rowBits[wordIndex]);
+				rowBits[wordIndex] = bits;
+			}
+
+			return result;
+		}
+
+	}
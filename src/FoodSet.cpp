@@ -0,0 +1,180 @@
+#include <assert.h>
+#include "includes/foodset.hpp"
+
+
+	namespace snake {
+
+		// Moves a snake grows on for each kind of food, apples grow it like the single apple does
+		const int FOOD_TYPE_GROWTH[FOOD_TYPE_COUNT] = { 2, 2, 2, 1, 3, 2, 2, 3 };
+
+		// Top left pixel of each kind of food's tile in the food tileset
+		const int FOOD_TYPE_TILESET_LEFT[FOOD_TYPE_COUNT] = { 0, 75, 150, 225, 300, 375, 0, 75 };
+		const int FOOD_TYPE_TILESET_TOP[FOOD_TYPE_COUNT] = { 0, 0, 0, 0, 0, 0, 75, 75 };
+
+		namespace FoodSetUtils {
+
+			// Look up the growth of a kind of food
+			int resolveGrowth(FoodType foodType) {
+				return FOOD_TYPE_GROWTH[(int)foodType];
+			}
+
+			// Look up the tile of a kind of food
+			sf::Vector2i resolveTilesetPosition(FoodType foodType) {
+				sf::Vector2i result(FOOD_TYPE_TILESET_LEFT[(int)foodType], FOOD_TYPE_TILESET_TOP[(int)foodType]);
+				return result;
+			}
+
+		}
+
+		// Constructor for the FoodSet class
+		FoodSet::FoodSet() {
+			this->fieldSize = sf::Vector2i(0, 0);
+			this->items = nullptr;
+			this->itemCount = 0;
+			this->capacity = 0;
+			this->itemAllocation = 0;
+			this->cellSlots = nullptr;
+			this->cellAllocation = 0;
+			this->changeCount = 0;
+		}
+
+		// Destructor for the FoodSet class
+		FoodSet::~FoodSet() {
+			delete[] this->items;
+			delete[] this->cellSlots;
+		}
+
+		// Clear the set, only the cells of the foods left over are cleared when the field size is the same
+		void FoodSet::reset(sf::Vector2i fieldSize, int capacity) {
+			assert((long long)fieldSize.x * (long long)fieldSize.y <= FOOD_SET_MAX_CELL_COUNT);
+			assert(capacity >= 0);
+
+			int cellCount = fieldSize.x * fieldSize.y;
+			bool clearAllCellsFlag = (fieldSize != this->fieldSize);
+			if (cellCount > this->cellAllocation) {
+				delete[] this->cellSlots;
+				this->cellSlots = new int[cellCount];
+				this->cellAllocation = cellCount;
+			}
+
+			if (clearAllCellsFlag) {
+				for (int cellIndex = 0; cellIndex < cellCount; cellIndex++) {
+					this->cellSlots[cellIndex] = -1;
+				}
+			} else {
+				for (int itemIndex = 0; itemIndex < this->itemCount; itemIndex++) {
+					this->cellSlots[this->resolveCellIndex(this->items[itemIndex].position)] = -1;
+				}
+			}
+			this->fieldSize = fieldSize;
+
+			if (capacity > this->itemAllocation) {
+				delete[] this->items;
+				this->items = new FoodItem[capacity];
+				this->itemAllocation = capacity;
+			}
+			this->capacity = capacity;
+			this->itemCount = 0;
+			this->changeCount++;
+		}
+
+		// Replace this set's foods with the other set's, clearing and setting only the cells either set has food on
+		void FoodSet::copyFrom(const FoodSet& other) {
+			assert(this->fieldSize == other.fieldSize);
+			assert(this->capacity == other.capacity);
+
+			for (int itemIndex = 0; itemIndex < this->itemCount; itemIndex++) {
+				this->cellSlots[this->resolveCellIndex(this->items[itemIndex].position)] = -1;
+			}
+			for (int itemIndex = 0; itemIndex < other.itemCount; itemIndex++) {
+				this->items[itemIndex] = other.items[itemIndex];
+				this->cellSlots[this->resolveCellIndex(other.items[itemIndex].position)] = itemIndex;
+			}
+			this->itemCount = other.itemCount;
+			this->changeCount++;
+		}
+
+		// Append a food to the list and point its cell at it
+		bool FoodSet::add(sf::Vector2i position, FoodType foodType) {
+			int cellIndex = this->resolveCellIndex(position);
+			if ((this->itemCount >= this->capacity) || (this->cellSlots[cellIndex] >= 0)) {
+				return false;
+			}
+
+			FoodItem& item = this->items[this->itemCount];
+			item.position = position;
+			item.foodType = foodType;
+			this->cellSlots[cellIndex] = this->itemCount;
+			this->itemCount++;
+			this->changeCount++;
+			return true;
+		}
+
+		// Take a food out of the list by moving the last food into its slot
+		bool FoodSet::remove(sf::Vector2i position, FoodItem& item) {
+			int cellIndex = this->resolveCellIndex(position);
+			int slot = this->cellSlots[cellIndex];
+			if (slot < 0) {
+				return false;
+			}
+
+			item = this->items[slot];
+			this->cellSlots[cellIndex] = -1;
+			this->itemCount--;
+			if (slot != this->itemCount) {
+				this->items[slot] = this->items[this->itemCount];
+				this->cellSlots[this->resolveCellIndex(this->items[slot].position)] = slot;
+			}
+			this->changeCount++;
+			return true;
+		}
+
+		// Check if there is a food on a cell
+		bool FoodSet::occupiesPosition(sf::Vector2i position) const {
+			return this->cellSlots[this->resolveCellIndex(position)] >= 0;
+		}
+
+		// Look up the food on a cell through its slot
+		bool FoodSet::findAt(sf::Vector2i position, FoodType& foodType) const {
+			int slot = this->cellSlots[this->resolveCellIndex(position)];
+			if (slot < 0) {
+				return false;
+			}
+
+			foodType = this->items[slot].foodType;
+			return true;
+		}
+
+		// Get the number of foods on the field
+		int FoodSet::getCount() const {
+			return this->itemCount;
+		}
+
+		// Get the number of foods the set holds at most
+		int FoodSet::getCapacity() const {
+			return this->capacity;
+		}
+
+		// Check whether the set holds as many foods as it can
+		bool FoodSet::getFull() const {
+			return this->itemCount >= this->capacity;
+		}
+
+		// Get a food by its slot in the list
+		const FoodItem& FoodSet::getItem(int itemIndex) const {
+			assert((itemIndex >= 0) && (itemIndex < this->itemCount));
+			return this->items[itemIndex];
+		}
+
+		// Get the number of changes made to the set so far
+		std::uint64_t FoodSet::getChangeCount() const {
+			return this->changeCount;
+		}
+
+		// Get the index of a cell in the slot grid
+		int FoodSet::resolveCellIndex(sf::Vector2i position) const {
+			assert((position.x >= 0) && (position.y >= 0) && (position.x < this->fieldSize.x) && (position.y < this->fieldSize.y));
+			return (position.y * this->fieldSize.x) + position.x;
+		}
+
+	}
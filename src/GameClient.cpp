@@ -1,8 +1,10 @@
 
+#include <stdio.h>
 #include <chrono>
 #include <thread>
 #include <SFML/Graphics.hpp>
 
+#include "includes/alloctracker.hpp"
 #include "includes/client.hpp"
 #include "includes/splashscene.hpp"
 #include "includes/quickgamescene.hpp"
@@ -24,8 +26,13 @@
 		// time duration in us for each frame
 		const sf::Int64 MICROSECONDS_PER_FRAME = 1000000 / 45;
 
-		GameClient::GameClient()
+		// frames a game has to run before its frames are expected to be allocation free
+		const int ALLOCATION_WARMUP_FRAMES = 45;
+
+		GameClient::GameClient(const GameClientOptions &options)
 		{
+			this->options = options;
+
 			// sets initial mode to splashscreen
 			this->mode = ClientMode::SPLASH_SCREEN;
 
@@ -38,19 +45,46 @@
 				this->window.setIcon(icon.getSize().x, icon.getSize().y, icon.getPixelsPtr());
 			}
 
-			// initialization of controllers using DMA
-			this->splashSceneController = new SplashSceneController(this->window);
-			this->quickGameController = new QuickGameController(this->window);
+			this->steadyStateAllocationFrameCount = 0;
+
+			// controllers are constructed on first use
+			this->splashSceneController = nullptr;
+			this->quickGameController = nullptr;
+
+			// optionally construct the quick game while the splash screen is showing, so entering it does not hitch
+			if (options.prewarmScenes)
+			{
+				this->quickGamePrewarmThread = std::thread([this]()
+				{
+					// the controller's textures and fonts are made on this thread, so it gets a GL context of its own sharing with the window's,
+					// and SFML flushes every texture upload so the window's context sees them once the thread is joined
+					sf::Context prewarmContext;
+					this->quickGameController = new QuickGameController(this->window, this->resolveQuickGameControllerOptions());
+					prewarmContext.setActive(false);
+				});
+			}
 
 			// starts the splashSceneController
-			this->splashSceneController->start();
+			this->ensureSplashSceneController()->start();
 		}
 
 		GameClient::~GameClient()
 		{
+			// Waits for a prewarm still in flight so its controller is freed below
+			if (this->quickGamePrewarmThread.joinable())
+			{
+				this->quickGamePrewarmThread.join();
+			}
+
 			// Frees the dynamically allocated memory for splashSceneController and quickGameController to avoid memory leaks.
-			delete this->splashSceneController;
-			delete this->quickGameController;
+			if (this->splashSceneController != nullptr)
+			{
+				delete this->splashSceneController;
+			}
+			if (this->quickGameController != nullptr)
+			{
+				delete this->quickGameController;
+			}
 		}
 
 		void GameClient::run()
@@ -58,14 +92,22 @@
 			// creates sf::clock to measure time
 			sf::Clock clock;
 
+			// number of consecutive frames the current game has been running
+			int runningGameFrameCount = 0;
+
 			// continues running the application as long as game window is open
 			while (window.isOpen())
 			{
 				// restarts the clock at the beginning of each frame
 				clock.restart();
 
+				// counts the allocations made during this frame when built with allocation tracking
+				AllocationTracker::beginFrame();
+				bool gameRunningAtFrameStart = this->isQuickGameRunning();
+
 				sf::Event event;
 				// Polls for events (like keyboard and mouse inputs) and processes them based on the current mode of the game.
+				AllocationScope eventsAllocationScope(AllocationSubsystem::EVENTS);
 				while (window.pollEvent(event))
 				{
 					switch (this->mode)
@@ -85,13 +127,35 @@
 					switch (this->mode)
 					{
 					case ClientMode::SPLASH_SCREEN:
+					{
+						AllocationScope renderAllocationScope(AllocationSubsystem::RENDER);
 						this->splashSceneController->render();
 						break;
+					}
 					case ClientMode::QUICK_GAME:
-						this->quickGameController->update();
+					{
+						AllocationScope updateAllocationScope(AllocationSubsystem::OTHER);
+						this->ensureQuickGameController()->update();
+						AllocationScope renderAllocationScope(AllocationSubsystem::RENDER);
 						this->quickGameController->render();
 						break;
 					}
+					}
+				}
+
+				// A frame is steady state once the same game has been running for the warm-up period
+				const AllocationFrameStats &frameStats = AllocationTracker::endFrame();
+				if (gameRunningAtFrameStart && this->isQuickGameRunning())
+				{
+					runningGameFrameCount++;
+				}
+				else
+				{
+					runningGameFrameCount = 0;
+				}
+				if (runningGameFrameCount > ALLOCATION_WARMUP_FRAMES)
+				{
+					this->checkSteadyStateAllocations(frameStats);
 				}
 
 				// Calculates the time elapsed since the last frame
@@ -105,9 +169,83 @@
 			}
 		}
 
+		int GameClient::getSteadyStateAllocationFrameCount() const
+		{
+			return this->steadyStateAllocationFrameCount;
+		}
+
+		bool GameClient::isQuickGameRunning() const
+		{
+			return (this->mode == ClientMode::QUICK_GAME) &&
+				   (this->quickGameController != nullptr) &&
+				   this->quickGameController->isGameRunning();
+		}
+
+		void GameClient::checkSteadyStateAllocations(const AllocationFrameStats &frameStats)
+		{
+			if (AllocationTracker::getTotalAllocationCount(frameStats) == 0)
+			{
+				return;
+			}
+
+			// reports which subsystems allocated so the regression can be found
+			this->steadyStateAllocationFrameCount++;
+			fprintf(stderr, "steady state frame allocated:");
+			for (int subsystemIndex = 0; subsystemIndex < (int)AllocationSubsystem::COUNT; subsystemIndex++)
+			{
+				if (frameStats.allocationCount[subsystemIndex] > 0)
+				{
+					fprintf(stderr, " %s=%d (%zu bytes)", AllocationTracker::getSubsystemName((AllocationSubsystem)subsystemIndex), frameStats.allocationCount[subsystemIndex], frameStats.allocatedBytes[subsystemIndex]);
+				}
+			}
+			fprintf(stderr, "\n");
+		}
+
+		SplashSceneController *GameClient::ensureSplashSceneController()
+		{
+			if (this->splashSceneController == nullptr)
+			{
+				this->splashSceneController = new SplashSceneController(this->window);
+			}
+
+			return this->splashSceneController;
+		}
+
+		QuickGameController *GameClient::ensureQuickGameController()
+		{
+			// a prewarm in flight owns construction, wait for it instead of building a second controller
+			if (this->quickGamePrewarmThread.joinable())
+			{
+				this->quickGamePrewarmThread.join();
+			}
+
+			if (this->quickGameController == nullptr)
+			{
+				this->quickGameController = new QuickGameController(this->window, this->resolveQuickGameControllerOptions());
+			}
+
+			return this->quickGameController;
+		}
+
+		QuickGameControllerOptions GameClient::resolveQuickGameControllerOptions() const
+		{
+			QuickGameControllerOptions result;
+			result.replayDirectory = this->options.replayDirectory;
+			result.autopilotFlag = this->options.autopilot;
+			result.perfectPlayFlag = this->options.perfectPlay;
+			result.mctsFlag = this->options.mcts;
+			result.mctsDifficulty = this->options.mctsDifficulty;
+			result.fieldSize = this->options.fieldSize;
+			result.levelPath = this->options.levelPath;
+			result.generatedLevelsFlag = this->options.generatedLevels;
+			result.foodCount = this->options.foodCount;
+			result.broadcastName = this->options.broadcastName;
+			return result;
+		}
+
 		void GameClient::processSplashScreenEvent(sf::Event &event)
 		{
-			SplashSceneClientRequest request = this->splashSceneController->processEvent(event);
+			SplashSceneClientRequest request = this->ensureSplashSceneController()->processEvent(event);
 
 			switch (request)
 			{
@@ -117,6 +255,7 @@
 				break;
 			case SplashSceneClientRequest::START_QUICK_GAME:
 				this->splashSceneController->finish();
+				this->ensureQuickGameController();
 				this->mode = ClientMode::QUICK_GAME;
 				break;
 			}
@@ -124,7 +263,7 @@
 
 		void GameClient::processQuickGameEvent(sf::Event &event)
 		{
-			QuickGameSceneClientRequest request = this->quickGameController->processEvent(event);
+			QuickGameSceneClientRequest request = this->ensureQuickGameController()->processEvent(event);
 
 			switch (request)
 			{
@@ -133,7 +272,7 @@
 				break;
 			case QuickGameSceneClientRequest::RETURN_TO_SPLASH_SCREEN:
 				this->mode = ClientMode::SPLASH_SCREEN;
-				this->splashSceneController->start();
+				this->ensureSplashSceneController()->start();
 				break;
 			}
 		}
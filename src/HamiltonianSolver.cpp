@@ -0,0 +1,350 @@
+#include <stdio.h>
+#include <string.h>
+#include <filesystem>
+#include "includes/hamiltoniansolver.hpp"
+
+
+	namespace snake {
+
+		// Every cycle cache file starts with these bytes
+		const char HAMILTONIAN_CACHE_MAGIC[4] = { 'S', 'N', 'K', 'C' };
+		// Version of the cache layout, bumped whenever the layout or the cycle construction changes
+		const unsigned int HAMILTONIAN_CACHE_VERSION = 1;
+		// Size of the header: magic, version and field size, followed by one cycle index per cell
+		const int HAMILTONIAN_CACHE_HEADER_SIZE = 4 + (4 * 3);
+
+		// Segments an apple adds to the snake, as in QuickGame::update()
+		const int HAMILTONIAN_APPLE_GROWTH = 2;
+
+		// Share of the cycle the snake may cover and still take shortcuts, past it the snake only follows the cycle.
+		// Cells jumped over stay empty behind the head until the tail passes them, and every apple eaten before then costs room
+		// ahead of the head that those cells do not give back, which a long snake cannot afford.
+		const float HAMILTONIAN_SHORTCUT_FILL_LIMIT = 0.5f;
+
+		// Directions the snake can move in
+		const ObjectDirection HAMILTONIAN_DIRECTIONS[] = { ObjectDirection::UP, ObjectDirection::RIGHT, ObjectDirection::DOWN, ObjectDirection::LEFT };
+
+		// Write a 32 bit value in little endian order
+		void writeCycleWord(unsigned char* bytes, unsigned int value) {
+			bytes[0] = (unsigned char)(value & 0xFF);
+			bytes[1] = (unsigned char)((value >> 8) & 0xFF);
+			bytes[2] = (unsigned char)((value >> 16) & 0xFF);
+			bytes[3] = (unsigned char)((value >> 24) & 0xFF);
+		}
+
+		// Read a 32 bit value in little endian order
+		unsigned int readCycleWord(const unsigned char* bytes) {
+			unsigned int result =
+				((unsigned int)bytes[0]) |
+				((unsigned int)bytes[1] << 8) |
+				((unsigned int)bytes[2] << 16) |
+				((unsigned int)bytes[3] << 24);
+			return result;
+		}
+
+		// Constructor for HamiltonianSolver, the cycle is made by prepare()
+		HamiltonianSolver::HamiltonianSolver(bool shortcutsFlag) {
+			this->fieldSize = sf::Vector2i(0, 0);
+			this->cycleLength = 0;
+			this->cycleIndex = nullptr;
+			this->cycleDirection = nullptr;
+
+			this->shortcutsFlag = shortcutsFlag;
+
+			this->alignedFlag = false;
+			this->lastFrameCount = 0;
+		}
+
+		// Destructor for HamiltonianSolver
+		HamiltonianSolver::~HamiltonianSolver() {
+			this->resizeForField(sf::Vector2i(0, 0));
+		}
+
+		// A grid graph has a Hamiltonian cycle when it is at least two cells each way and has an even number of cells
+		bool HamiltonianSolver::hasCycle(sf::Vector2i fieldSize) {
+			sf::Vector2i interiorSize = fieldSize - sf::Vector2i(2, 2);
+			bool result = (interiorSize.x >= 2) && (interiorSize.y >= 2) && (((interiorSize.x % 2) == 0) || ((interiorSize.y % 2) == 0));
+			return result;
+		}
+
+		// Load or build the cycle for a field size
+		bool HamiltonianSolver::prepare(sf::Vector2i fieldSize, const char* cacheDirectory) {
+			if (!HamiltonianSolver::hasCycle(fieldSize)) {
+				return false;
+			}
+			if (fieldSize == this->fieldSize) {
+				return true;
+			}
+
+			char cachePath[1024];
+			snprintf(cachePath, sizeof(cachePath), "%s/cycle-%dx%d.snkc", cacheDirectory, fieldSize.x, fieldSize.y);
+
+			this->resizeForField(fieldSize);
+			if (!this->loadFromFile(cachePath)) {
+				this->build();
+
+				// A cache that cannot be written only costs building the cycle again next time
+				std::error_code errorCode;
+				std::filesystem::create_directories(cacheDirectory, errorCode);
+				if (!this->saveToFile(cachePath)) {
+					fprintf(stderr, "Could not save cycle cache %s\n", cachePath);
+				}
+			}
+
+			this->alignedFlag = false;
+			return true;
+		}
+
+		// Choose the input for the next update, looking only at the cells around the head once the snake is aligned with the cycle
+		QuickGameInputRequest HamiltonianSolver::resolveInput(const QuickGame& game) {
+			QuickGameInputRequest result;
+			result.snakeMovementInput = ObjectDirection::NONE;
+			if (game.getFieldSize() != this->fieldSize) {
+				return result;
+			}
+
+			// A frame count that did not go up means a new game, whose snake starts wherever its definition put it
+			if (game.getFrameCount() <= this->lastFrameCount) {
+				this->alignedFlag = false;
+			}
+			this->lastFrameCount = game.getFrameCount();
+
+			Snake* snake = game.getSnake();
+			sf::Vector2i headPosition = snake->getHead().position;
+			int headCycleIndex = this->cycleIndex[this->resolveCellIndex(headPosition)];
+
+			// Until the body lies in cycle order, the nearest body cell ahead of the head bounds how far it can jump
+			if (!this->alignedFlag) {
+				this->alignedFlag = this->isAligned(game);
+			}
+			// Following the cycle needs no checks at all once the snake is on it
+			if (this->alignedFlag && !this->shortcutsFlag) {
+				result.snakeMovementInput = this->cycleDirection[this->resolveCellIndex(headPosition)];
+				return result;
+			}
+
+			int clearance = this->alignedFlag ?
+				this->resolveForwardDistance(headCycleIndex, this->cycleIndex[this->resolveCellIndex(snake->getTail().position)]) :
+				this->measureBodyClearance(game, headCycleIndex);
+
+			int appleDistance = 1;
+			if (game.getAppleExists()) {
+				appleDistance = this->resolveForwardDistance(headCycleIndex, this->cycleIndex[this->resolveCellIndex(game.getApplePosition())]);
+			}
+			int growthReserve = game.getQueuedSnakeGrowth() + HAMILTONIAN_APPLE_GROWTH + 1;
+			bool shortcutAllowedFlag = this->shortcutsFlag && ((float)(snake->getLength() + growthReserve) < (HAMILTONIAN_SHORTCUT_FILL_LIMIT * (float)this->cycleLength));
+
+			// Follow the cycle, or jump furthest along it without passing the apple. A jump has to leave room ahead for the growth to come
+			// and for at least as many cells as will then be empty behind the head, measured by the length alone so each step stays O(1).
+			ObjectDirection bestDirection = ObjectDirection::NONE;
+			int bestDistance = 0;
+			ObjectDirection fallbackDirection = ObjectDirection::NONE;
+			for (ObjectDirection direction : HAMILTONIAN_DIRECTIONS) {
+				sf::Vector2i next = headPosition + SnakeUtils::directionToVector(direction);
+				int nextCycleIndex = this->cycleIndex[this->resolveCellIndex(next)];
+				if ((nextCycleIndex < 0) || !snake->isValidMovementDirection(direction) || snake->bodyOccupiesPosition(next)) {
+					continue;
+				}
+				fallbackDirection = direction;
+
+				int distance = this->resolveForwardDistance(headCycleIndex, nextCycleIndex);
+				int aheadAfter = clearance - distance - 1;
+				int hiddenAfter = (this->cycleLength - snake->getLength()) - aheadAfter;
+				bool allowedFlag = (distance == 1) || (shortcutAllowedFlag && (distance <= appleDistance) && (aheadAfter - growthReserve >= hiddenAfter));
+				if (allowedFlag && (distance > bestDistance)) {
+					bestDistance = distance;
+					bestDirection = direction;
+				}
+			}
+
+			// Only a snake that has not joined the cycle yet can find the way along it blocked
+			result.snakeMovementInput = (bestDirection != ObjectDirection::NONE) ? bestDirection : fallbackDirection;
+			return result;
+		}
+
+		// Get the field size the cycle was made for
+		sf::Vector2i HamiltonianSolver::getFieldSize() const {
+			return this->fieldSize;
+		}
+
+		// Get the number of cells on the cycle
+		int HamiltonianSolver::getCycleLength() const {
+			return this->cycleLength;
+		}
+
+		// Reallocate the cycle for a field of another size, a zero size frees it
+		void HamiltonianSolver::resizeForField(sf::Vector2i fieldSize) {
+			delete[] this->cycleIndex;
+			delete[] this->cycleDirection;
+
+			this->fieldSize = fieldSize;
+			this->cycleLength = (fieldSize.x - 2) * (fieldSize.y - 2);
+			int cellCount = fieldSize.x * fieldSize.y;
+			if (cellCount == 0) {
+				this->cycleLength = 0;
+				this->cycleIndex = nullptr;
+				this->cycleDirection = nullptr;
+				return;
+			}
+
+			this->cycleIndex = new int[cellCount];
+			this->cycleDirection = new ObjectDirection[cellCount];
+		}
+
+		// Build the cycle: a boustrophedon across every row but the first column, closed by running back up the first column.
+		// With an odd number of rows the field is walked by columns instead, which then must be even in number.
+		void HamiltonianSolver::build() {
+			sf::Vector2i interiorSize = this->fieldSize - sf::Vector2i(2, 2);
+			bool byRowsFlag = (interiorSize.y % 2) == 0;
+			int laneCount = byRowsFlag ? interiorSize.y : interiorSize.x;
+			int laneLength = byRowsFlag ? interiorSize.x : interiorSize.y;
+
+			for (int cellIndex = 0; cellIndex < this->fieldSize.x * this->fieldSize.y; cellIndex++) {
+				this->cycleIndex[cellIndex] = -1;
+			}
+
+			// Lanes are rows when walking by rows and columns otherwise, steps run along a lane and step 0 is kept for the way back
+			int nextCycleIndex = 1;
+			for (int lane = 0; lane < laneCount; lane++) {
+				for (int step = 1; step < laneLength; step++) {
+					int laneStep = ((lane % 2) == 0) ? step : (laneLength - step);
+					sf::Vector2i position = byRowsFlag ? sf::Vector2i(laneStep + 1, lane + 1) : sf::Vector2i(lane + 1, laneStep + 1);
+					this->cycleIndex[this->resolveCellIndex(position)] = nextCycleIndex++;
+				}
+			}
+			for (int lane = laneCount - 1; lane > 0; lane--) {
+				sf::Vector2i position = byRowsFlag ? sf::Vector2i(1, lane + 1) : sf::Vector2i(lane + 1, 1);
+				this->cycleIndex[this->resolveCellIndex(position)] = nextCycleIndex++;
+			}
+			this->cycleIndex[this->resolveCellIndex(sf::Vector2i(1, 1))] = 0;
+
+			this->resolveDirections();
+		}
+
+		// Load a cycle cached by saveToFile(), rejecting it unless it is a cycle through every interior cell of this field
+		bool HamiltonianSolver::loadFromFile(const char* path) {
+			FILE* file = fopen(path, "rb");
+			if (file == nullptr) {
+				return false;
+			}
+
+			unsigned char header[HAMILTONIAN_CACHE_HEADER_SIZE];
+			bool result = (fread(header, 1, HAMILTONIAN_CACHE_HEADER_SIZE, file) == (size_t)HAMILTONIAN_CACHE_HEADER_SIZE);
+			result = result && (memcmp(header, HAMILTONIAN_CACHE_MAGIC, 4) == 0);
+			result = result && (readCycleWord(header + 4) == HAMILTONIAN_CACHE_VERSION);
+			result = result && ((int)readCycleWord(header + 8) == this->fieldSize.x) && ((int)readCycleWord(header + 12) == this->fieldSize.y);
+
+			unsigned char word[4];
+			for (int cellIndex = 0; result && (cellIndex < this->fieldSize.x * this->fieldSize.y); cellIndex++) {
+				result = (fread(word, 1, 4, file) == 4);
+				this->cycleIndex[cellIndex] = (int)readCycleWord(word);
+			}
+			fclose(file);
+
+			result = result && this->resolveDirections();
+			return result;
+		}
+
+		// Save the cycle as its index for every cell of the field, walls included
+		bool HamiltonianSolver::saveToFile(const char* path) const {
+			FILE* file = fopen(path, "wb");
+			if (file == nullptr) {
+				return false;
+			}
+
+			unsigned char header[HAMILTONIAN_CACHE_HEADER_SIZE];
+			memcpy(header, HAMILTONIAN_CACHE_MAGIC, 4);
+			writeCycleWord(header + 4, HAMILTONIAN_CACHE_VERSION);
+			writeCycleWord(header + 8, (unsigned int)this->fieldSize.x);
+			writeCycleWord(header + 12, (unsigned int)this->fieldSize.y);
+			bool result = (fwrite(header, 1, HAMILTONIAN_CACHE_HEADER_SIZE, file) == (size_t)HAMILTONIAN_CACHE_HEADER_SIZE);
+
+			unsigned char word[4];
+			for (int cellIndex = 0; result && (cellIndex < this->fieldSize.x * this->fieldSize.y); cellIndex++) {
+				writeCycleWord(word, (unsigned int)this->cycleIndex[cellIndex]);
+				result = (fwrite(word, 1, 4, file) == 4);
+			}
+
+			result = (fclose(file) == 0) && result;
+			return result;
+		}
+
+		// Find the direction from every cell to the next along the cycle, failing when the indices do not form a cycle
+		bool HamiltonianSolver::resolveDirections() {
+			int cellCount = this->fieldSize.x * this->fieldSize.y;
+			int interiorCount = 0;
+			bool result = true;
+
+			for (int cellIndex = 0; result && (cellIndex < cellCount); cellIndex++) {
+				this->cycleDirection[cellIndex] = ObjectDirection::NONE;
+				if (this->cycleIndex[cellIndex] < 0) {
+					continue;
+				}
+				interiorCount++;
+
+				sf::Vector2i position(cellIndex % this->fieldSize.x, cellIndex / this->fieldSize.x);
+				int followingCycleIndex = (this->cycleIndex[cellIndex] + 1) % this->cycleLength;
+				for (ObjectDirection direction : HAMILTONIAN_DIRECTIONS) {
+					int neighbourIndex = this->resolveCellIndex(position + SnakeUtils::directionToVector(direction));
+					if ((neighbourIndex >= 0) && (this->cycleIndex[neighbourIndex] == followingCycleIndex)) {
+						this->cycleDirection[cellIndex] = direction;
+					}
+				}
+				result = (this->cycleIndex[cellIndex] < this->cycleLength) && (this->cycleDirection[cellIndex] != ObjectDirection::NONE);
+			}
+
+			// Every index having a neighbour with the next one, and as many indices as interior cells, makes a single cycle
+			result = result && (interiorCount == this->cycleLength);
+			return result;
+		}
+
+		// Check that every segment from the tail to the head is at or after the one before it along the cycle
+		bool HamiltonianSolver::isAligned(const QuickGame& game) const {
+			Snake* snake = game.getSnake();
+			int tailCycleIndex = this->cycleIndex[this->resolveCellIndex(snake->getTail().position)];
+
+			int previousCycleIndex = tailCycleIndex;
+			int walkedDistance = 0;
+			for (int bodyIndex = snake->getBodyLength() - 1; bodyIndex >= -1; bodyIndex--) {
+				sf::Vector2i position = (bodyIndex >= 0) ? snake->getBody(bodyIndex).position : snake->getHead().position;
+				int segmentCycleIndex = this->cycleIndex[this->resolveCellIndex(position)];
+				walkedDistance += (segmentCycleIndex - previousCycleIndex + this->cycleLength) % this->cycleLength;
+				previousCycleIndex = segmentCycleIndex;
+			}
+
+			int headCycleIndex = this->cycleIndex[this->resolveCellIndex(snake->getHead().position)];
+			bool result = walkedDistance == ((headCycleIndex - tailCycleIndex + this->cycleLength) % this->cycleLength);
+			return result;
+		}
+
+		// Distance along the cycle from the head to the nearest body or tail cell ahead of it
+		int HamiltonianSolver::measureBodyClearance(const QuickGame& game, int headCycleIndex) const {
+			Snake* snake = game.getSnake();
+			int result = this->resolveForwardDistance(headCycleIndex, this->cycleIndex[this->resolveCellIndex(snake->getTail().position)]);
+			for (int bodyIndex = 0; bodyIndex < snake->getBodyLength(); bodyIndex++) {
+				int distance = this->resolveForwardDistance(headCycleIndex, this->cycleIndex[this->resolveCellIndex(snake->getBody(bodyIndex).position)]);
+				if (distance < result) {
+					result = distance;
+				}
+			}
+			return result;
+		}
+
+		// Steps along the cycle from one index to another, a full lap when they are the same
+		int HamiltonianSolver::resolveForwardDistance(int fromCycleIndex, int toCycleIndex) const {
+			int result = (toCycleIndex - fromCycleIndex + this->cycleLength) % this->cycleLength;
+			if (result == 0) {
+				result = this->cycleLength;
+			}
+			return result;
+		}
+
+		// Convert a position to a cell index, -1 when it is off the field
+		int HamiltonianSolver::resolveCellIndex(sf::Vector2i position) const {
+			if ((position.x < 0) || (position.y < 0) || (position.x >= this->fieldSize.x) || (position.y >= this->fieldSize.y)) {
+				return -1;
+			}
+			return (position.y * this->fieldSize.x) + position.x;
+		}
+
+	}
@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "includes/level.hpp"
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+	namespace snake {
+
+		// Offsets of the header words after the magic
+		const int LEVEL_VERSION_OFFSET = 4;
+		const int LEVEL_FIELD_SIZE_OFFSET = 8;
+		const int LEVEL_SNAKE_START_OFFSET = 16;
+		const int LEVEL_OPEN_CELL_COUNT_OFFSET = 32;
+		const int LEVEL_COLLISION_ROW_WORDS_OFFSET = 36;
+		const int LEVEL_COLLISION_OFFSET_OFFSET = 40;
+		const int LEVEL_TILE_OFFSET_OFFSET = 44;
+		const int LEVEL_FILE_SIZE_OFFSET = 48;
+
+		// Write a 32 bit value in little endian order
+		void writeLevelWord(unsigned char* bytes, unsigned int value) {
+			bytes[0] = (unsigned char)(value & 0xFF);
+			bytes[1] = (unsigned char)((value >> 8) & 0xFF);
+			bytes[2] = (unsigned char)((value >> 16) & 0xFF);
+			bytes[3] = (unsigned char)((value >> 24) & 0xFF);
+		}
+
+		// Read a 32 bit value in little endian order
+		unsigned int readLevelWord(const unsigned char* bytes) {
+			unsigned int result =
+				((unsigned int)bytes[0]) |
+				((unsigned int)bytes[1] << 8) |
+				((unsigned int)bytes[2] << 16) |
+				((unsigned int)bytes[3] << 24);
+			return result;
+		}
+
+		// Constructor for the Level class, nothing is mapped until load()
+		Level::Level() {
+			this->mappedBytes = nullptr;
+			this->mappedByteCount = 0;
+			this->ownedFlag = false;
+			this->fileHandle = nullptr;
+			this->mappingHandle = nullptr;
+			this->fieldSize = sf::Vector2i(0, 0);
+			this->openCellCount = 0;
+			this->collisionRowWords = 0;
+			this->collisionRows = nullptr;
+			this->tiles = nullptr;
+		}
+
+		// Destructor for the Level class
+		Level::~Level() {
+			this->unload();
+		}
+
+		// Map a compiled level in one go, only the header is read, the bitmap and tiles are pointed at where they lie in the mapping
+		bool Level::load(const char* path) {
+			this->unload();
+
+#if defined(_WIN32)
+			HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file == INVALID_HANDLE_VALUE) {
+				return false;
+			}
+			LARGE_INTEGER fileSize;
+			HANDLE mapping = NULL;
+			const void* view = NULL;
+			if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart >= LEVEL_HEADER_SIZE)) {
+				mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			}
+			if (mapping != NULL) {
+				view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			}
+			if (view == NULL) {
+				if (mapping != NULL) {
+					CloseHandle(mapping);
+				}
+				CloseHandle(file);
+				return false;
+			}
+			this->fileHandle = file;
+			this->mappingHandle = mapping;
+			this->mappedBytes = (const unsigned char*)view;
+			this->mappedByteCount = (std::size_t)fileSize.QuadPart;
+#else
+			int file = open(path, O_RDONLY);
+			if (file < 0) {
+				return false;
+			}
+			struct stat fileStat;
+			void* view = MAP_FAILED;
+			if ((fstat(file, &fileStat) == 0) && (fileStat.st_size >= LEVEL_HEADER_SIZE)) {
+				view = mmap(nullptr, (std::size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+			}
+			// The mapping stays valid once the descriptor is closed
+			close(file);
+			if (view == MAP_FAILED) {
+				return false;
+			}
+			this->mappedBytes = (const unsigned char*)view;
+			this->mappedByteCount = (std::size_t)fileStat.st_size;
+#endif
+
+			return this->readHeader();
+		}
+
+		// Lay the level out in the level's own memory, reusing it when it is large enough
+		bool Level::build(sf::Vector2i fieldSize, const SnakeStartDefn& snakeStartDefn, const LevelTile* tiles) {
+			this->unload();
+
+			LevelUtils::layoutLevel(fieldSize, snakeStartDefn, tiles, this->ownedBytes);
+			this->mappedBytes = this->ownedBytes.data();
+			this->mappedByteCount = this->ownedBytes.size();
+			this->ownedFlag = true;
+			return this->readHeader();
+		}
+
+		// Check the header of the bytes in view and point at the sections, unloading when it does not hold up
+		bool Level::readHeader() {
+			const unsigned char* header = this->mappedBytes;
+			bool result =
+				(memcmp(header, LEVEL_MAGIC, 4) == 0) &&
+				(readLevelWord(header + LEVEL_VERSION_OFFSET) == LEVEL_VERSION) &&
+				(readLevelWord(header + LEVEL_FILE_SIZE_OFFSET) == this->mappedByteCount);
+
+			std::size_t width = readLevelWord(header + LEVEL_FIELD_SIZE_OFFSET);
+			std::size_t height = readLevelWord(header + LEVEL_FIELD_SIZE_OFFSET + 4);
+			result = result && (width >= 8) && (height >= 8) && ((long long)(width * height) <= LEVEL_MAX_CELL_COUNT);
+
+			// The sections have to be where the header says and fit in the file, the bitmap aligned for reading its words in place
+			std::size_t collisionRowWords = readLevelWord(header + LEVEL_COLLISION_ROW_WORDS_OFFSET);
+			std::size_t collisionOffset = readLevelWord(header + LEVEL_COLLISION_OFFSET_OFFSET);
+			std::size_t tileOffset = readLevelWord(header + LEVEL_TILE_OFFSET_OFFSET);
+			result = result &&
+				(collisionRowWords == ((width + 63) / 64)) &&
+				(collisionOffset >= (std::size_t)LEVEL_HEADER_SIZE) && ((collisionOffset % sizeof(std::uint64_t)) == 0) &&
+				(collisionOffset + (height * collisionRowWords * sizeof(std::uint64_t)) <= tileOffset) &&
+				(tileOffset + (width * height) <= this->mappedByteCount);
+
+			if (!result) {
+				this->unload();
+				return false;
+			}
+
+			this->fieldSize = sf::Vector2i((int)width, (int)height);
+			this->snakeStartDefn.headPosition.x = (int)readLevelWord(header + LEVEL_SNAKE_START_OFFSET);
+			this->snakeStartDefn.headPosition.y = (int)readLevelWord(header + LEVEL_SNAKE_START_OFFSET + 4);
+			this->snakeStartDefn.facingDirection = (ObjectDirection)readLevelWord(header + LEVEL_SNAKE_START_OFFSET + 8);
+			this->snakeStartDefn.length = (int)readLevelWord(header + LEVEL_SNAKE_START_OFFSET + 12);
+			this->openCellCount = (int)readLevelWord(header + LEVEL_OPEN_CELL_COUNT_OFFSET);
+			this->collisionRowWords = (int)collisionRowWords;
+			// Bitmap words are read in host order, which matches the file on the little endian machines the game runs on
+			this->collisionRows = (const std::uint64_t*)(this->mappedBytes + collisionOffset);
+			this->tiles = this->mappedBytes + tileOffset;
+
+			// The game lays the snake out and ends on a full field trusting these, so they have to agree with the bitmap
+			if (!this->validateSnakeStart() || (this->openCellCount != this->countOpenCells())) {
+				this->unload();
+				return false;
+			}
+			return true;
+		}
+
+		// Check that the snake starts facing a direction, at least two segments long, with every segment on an open cell
+		bool Level::validateSnakeStart() const {
+			const SnakeStartDefn& startDefn = this->snakeStartDefn;
+			if ((startDefn.facingDirection < ObjectDirection::UP) || (startDefn.facingDirection > ObjectDirection::LEFT) || (startDefn.length < 2)) {
+				return false;
+			}
+
+			// A segment off the field counts as blocked, so a long start stops at the edge of the field
+			sf::Vector2i facingVector = SnakeUtils::directionToVector(startDefn.facingDirection);
+			for (int segmentIndex = 0; segmentIndex < startDefn.length; segmentIndex++) {
+				if (this->isBlocked(startDefn.headPosition - (facingVector * segmentIndex))) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Count the cells whose bit in the collision bitmap is clear
+		int Level::countOpenCells() const {
+			int result = 0;
+			for (int y = 0; y < this->fieldSize.y; y++) {
+				for (int x = 0; x < this->fieldSize.x; x++) {
+					result += this->isBlocked(sf::Vector2i(x, y)) ? 0 : 1;
+				}
+			}
+			return result;
+		}
+
+		// Unmap the level, if one is mapped
+		void Level::unload() {
+			if ((this->mappedBytes != nullptr) && !this->ownedFlag) {
+#if defined(_WIN32)
+				UnmapViewOfFile(this->mappedBytes);
+				CloseHandle((HANDLE)this->mappingHandle);
+				CloseHandle((HANDLE)this->fileHandle);
+#else
+				munmap((void*)this->mappedBytes, this->mappedByteCount);
+#endif
+			}
+
+			this->mappedBytes = nullptr;
+			this->mappedByteCount = 0;
+			this->ownedFlag = false;
+			this->fileHandle = nullptr;
+			this->mappingHandle = nullptr;
+			this->collisionRows = nullptr;
+			this->tiles = nullptr;
+		}
+
+		// Check whether a level is mapped
+		bool Level::isLoaded() const {
+			return this->mappedBytes != nullptr;
+		}
+
+		// Get the size of the level's field, walls included
+		sf::Vector2i Level::getFieldSize() const {
+			return this->fieldSize;
+		}
+
+		// Get where the snake starts on the level
+		SnakeStartDefn Level::getSnakeStartDefn() const {
+			return this->snakeStartDefn;
+		}
+
+		// Get the number of cells the snake can move through
+		int Level::getOpenCellCount() const {
+			return this->openCellCount;
+		}
+
+		// Check a cell's bit in the collision bitmap
+		bool Level::isBlocked(sf::Vector2i position) const {
+			bool insideField = (position.x >= 0) && (position.x < this->fieldSize.x) && (position.y >= 0) && (position.y < this->fieldSize.y);
+			if (!insideField) {
+				return true;
+			}
+
+			std::uint64_t word = this->collisionRows[(position.y * this->collisionRowWords) + (position.x >> 6)];
+			bool result = ((word >> (position.x & 63)) & 1) != 0;
+			return result;
+		}
+
+		// Get the tile drawn on a cell
+		LevelTile Level::getTile(sf::Vector2i position) const {
+			LevelTile result = (LevelTile)this->tiles[(position.y * this->fieldSize.x) + position.x];
+			return result;
+		}
+
+		// Get the collision bitmap where it lies
+		const std::uint64_t* Level::getCollisionBits() const {
+			return this->collisionRows;
+		}
+
+		namespace LevelUtils {
+
+			// Lay the level out in memory exactly as it is stored
+			void layoutLevel(sf::Vector2i fieldSize, const SnakeStartDefn& snakeStartDefn, const LevelTile* tiles, std::vector<unsigned char>& bytes) {
+				std::size_t cellCount = (std::size_t)fieldSize.x * (std::size_t)fieldSize.y;
+				std::size_t collisionRowWords = ((std::size_t)fieldSize.x + 63) / 64;
+				std::size_t collisionOffset = LEVEL_HEADER_SIZE;
+				std::size_t tileOffset = collisionOffset + ((std::size_t)fieldSize.y * collisionRowWords * sizeof(std::uint64_t));
+				std::size_t fileSize = tileOffset + cellCount;
+
+				bytes.assign(fileSize, 0);
+				unsigned char* collisionBytes = bytes.data() + collisionOffset;
+				unsigned char* tileBytes = bytes.data() + tileOffset;
+
+				// Every tile but grass blocks, and sets its bit in the little endian word of its row
+				int openCellCount = 0;
+				for (int y = 0; y < fieldSize.y; y++) {
+					for (int x = 0; x < fieldSize.x; x++) {
+						LevelTile tile = tiles[(y * fieldSize.x) + x];
+						tileBytes[(y * fieldSize.x) + x] = (unsigned char)tile;
+						if (tile == LevelTile::GRASS) {
+							openCellCount++;
+						} else {
+							std::size_t wordOffset = ((y * collisionRowWords) + (x >> 6)) * sizeof(std::uint64_t);
+							collisionBytes[wordOffset + ((x & 63) >> 3)] |= (unsigned char)(1 << (x & 7));
+						}
+					}
+				}
+
+				unsigned char* header = bytes.data();
+				memcpy(header, LEVEL_MAGIC, 4);
+				writeLevelWord(header + LEVEL_VERSION_OFFSET, LEVEL_VERSION);
+				writeLevelWord(header + LEVEL_FIELD_SIZE_OFFSET, (unsigned int)fieldSize.x);
+				writeLevelWord(header + LEVEL_FIELD_SIZE_OFFSET + 4, (unsigned int)fieldSize.y);
+				writeLevelWord(header + LEVEL_SNAKE_START_OFFSET, (unsigned int)snakeStartDefn.headPosition.x);
+				writeLevelWord(header + LEVEL_SNAKE_START_OFFSET + 4, (unsigned int)snakeStartDefn.headPosition.y);
+				writeLevelWord(header + LEVEL_SNAKE_START_OFFSET + 8, (unsigned int)snakeStartDefn.facingDirection);
+				writeLevelWord(header + LEVEL_SNAKE_START_OFFSET + 12, (unsigned int)snakeStartDefn.length);
+				writeLevelWord(header + LEVEL_OPEN_CELL_COUNT_OFFSET, (unsigned int)openCellCount);
+				writeLevelWord(header + LEVEL_COLLISION_ROW_WORDS_OFFSET, (unsigned int)collisionRowWords);
+				writeLevelWord(header + LEVEL_COLLISION_OFFSET_OFFSET, (unsigned int)collisionOffset);
+				writeLevelWord(header + LEVEL_TILE_OFFSET_OFFSET, (unsigned int)tileOffset);
+				writeLevelWord(header + LEVEL_FILE_SIZE_OFFSET, (unsigned int)fileSize);
+			}
+
+			// Lay the level out in memory and write it with one call
+			bool saveLevel(const char* path, sf::Vector2i fieldSize, const SnakeStartDefn& snakeStartDefn, const LevelTile* tiles) {
+				std::vector<unsigned char> bytes;
+				layoutLevel(fieldSize, snakeStartDefn, tiles, bytes);
+				std::size_t fileSize = bytes.size();
+
+				FILE* file = fopen(path, "wb");
+				if (file == nullptr) {
+					return false;
+				}
+				bool result = (fwrite(bytes.data(), 1, fileSize, file) == fileSize);
+				result = (fclose(file) == 0) && result;
+				return result;
+			}
+
+		}
+
+	}
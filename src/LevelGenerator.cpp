@@ -0,0 +1,215 @@
+#include <assert.h>
+#include <chrono>
+#include <algorithm>
+#include "includes/levelgenerator.hpp"
+
+
+	namespace snake {
+
+		// Cells ahead of the snake's head kept clear, so a new game never opens facing an obstacle
+		const int LEVEL_GENERATOR_CLEAR_RUN = 5;
+		// Longest shrub wall as a share of the shorter side of the field, and at most, so large fields get more walls rather than longer ones
+		const int LEVEL_GENERATOR_WALL_LENGTH_DIVISOR = 4;
+		const int LEVEL_GENERATOR_MAX_WALL_LENGTH = 12;
+		// Obstacles tried per cell inside the walls before a layout stops short of its obstacle count
+		const int LEVEL_GENERATOR_PLACEMENT_TRIES_PER_CELL = 4;
+
+		// Constructor for the LevelGenerator class
+		LevelGenerator::LevelGenerator(const LevelGeneratorSettings& settings) {
+			this->settings = settings;
+			this->lastStats.elapsedMicroseconds = 0;
+			this->lastStats.attemptCount = 0;
+			this->lastStats.fallbackFlag = false;
+		}
+
+		// Try layouts until one passes validation, the attempts run out or the budget is spent, then fall back to the open field
+		void LevelGenerator::generate(const QuickGameDefn& gameDefn, unsigned int seed, Level& level) {
+			sf::Vector2i fieldSize = gameDefn.fieldSize;
+			assert((fieldSize.x >= 8) && (fieldSize.y >= 8));
+			assert((long long)fieldSize.x * (long long)fieldSize.y <= LEVEL_MAX_CELL_COUNT);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			std::mt19937 randomizer(seed);
+			this->tiles.resize((std::size_t)fieldSize.x * (std::size_t)fieldSize.y);
+
+			bool validFlag = false;
+			int attemptCount = 0;
+			std::int64_t elapsedMicroseconds = 0;
+			while (!validFlag && (attemptCount < this->settings.maxAttempts) && (elapsedMicroseconds < this->settings.budgetMicroseconds)) {
+				this->layOutObstacles(gameDefn, randomizer);
+				validFlag = this->validate(gameDefn, level);
+				attemptCount++;
+				elapsedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+			}
+
+			// The open field always passes, the snake starts on it the same way it does on any field
+			if (!validFlag) {
+				this->layOutOpenField(fieldSize);
+				level.build(fieldSize, gameDefn.snakeStartDefn, this->tiles.data());
+				elapsedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+			}
+
+			this->lastStats.elapsedMicroseconds = elapsedMicroseconds;
+			this->lastStats.attemptCount = attemptCount;
+			this->lastStats.fallbackFlag = !validFlag;
+		}
+
+		// Get how the last level was generated
+		LevelGeneratorStats LevelGenerator::getLastStats() const {
+			return this->lastStats;
+		}
+
+		// Settings for levels that leave most of the field open and are generated well inside a 60 frames per second frame
+		LevelGeneratorSettings LevelGenerator::resolveDefaultSettings() {
+			LevelGeneratorSettings result;
+			result.obstacleFraction = 0.08f;
+			result.minOpenFraction = 0.8f;
+			result.maxAttempts = 16;
+			result.budgetMicroseconds = 16667;
+			return result;
+		}
+
+		// Scatter shrub walls, spike clusters and single red spikes over the field until they cover the obstacle share
+		void LevelGenerator::layOutObstacles(const QuickGameDefn& gameDefn, std::mt19937& randomizer) {
+			sf::Vector2i fieldSize = gameDefn.fieldSize;
+			this->layOutOpenField(fieldSize);
+
+			int innerCellCount = (fieldSize.x - 2) * (fieldSize.y - 2);
+			int targetObstacleCount = (int)(innerCellCount * this->settings.obstacleFraction);
+			int maxWallLength = std::min(std::max(3, std::min(fieldSize.x, fieldSize.y) / LEVEL_GENERATOR_WALL_LENGTH_DIVISOR), LEVEL_GENERATOR_MAX_WALL_LENGTH);
+
+			std::uniform_int_distribution<int> xDistribution(1, fieldSize.x - 2);
+			std::uniform_int_distribution<int> yDistribution(1, fieldSize.y - 2);
+			std::uniform_int_distribution<int> kindDistribution(0, 19);
+			std::uniform_int_distribution<int> wallLengthDistribution(2, maxWallLength);
+
+			int obstacleCount = 0;
+			int placementTries = innerCellCount * LEVEL_GENERATOR_PLACEMENT_TRIES_PER_CELL;
+			for (int tryIndex = 0; (tryIndex < placementTries) && (obstacleCount < targetObstacleCount); tryIndex++) {
+				sf::Vector2i position(xDistribution(randomizer), yDistribution(randomizer));
+				int kind = kindDistribution(randomizer);
+
+				if (kind < 12) {
+					// A straight shrub wall running right or down from the position
+					sf::Vector2i step = ((kind & 1) == 0) ? sf::Vector2i(1, 0) : sf::Vector2i(0, 1);
+					int wallLength = wallLengthDistribution(randomizer);
+					for (int cellIndex = 0; cellIndex < wallLength; cellIndex++) {
+						this->setObstacle(gameDefn, position, LevelTile::SHRUB, obstacleCount);
+						position += step;
+					}
+				} else if (kind < 17) {
+					// A square of spikes, one or two cells a side
+					int clusterSize = (kind < 15) ? 2 : 1;
+					for (int offsetY = 0; offsetY < clusterSize; offsetY++) {
+						for (int offsetX = 0; offsetX < clusterSize; offsetX++) {
+							this->setObstacle(gameDefn, position + sf::Vector2i(offsetX, offsetY), LevelTile::SPIKES, obstacleCount);
+						}
+					}
+				} else {
+					this->setObstacle(gameDefn, position, LevelTile::RED_SPIKES, obstacleCount);
+				}
+			}
+		}
+
+		// Grass inside a shrub border, the field every layout starts from
+		void LevelGenerator::layOutOpenField(sf::Vector2i fieldSize) {
+			for (int y = 0; y < fieldSize.y; y++) {
+				for (int x = 0; x < fieldSize.x; x++) {
+					bool edgeFlag = (x == 0) || (y == 0) || (x == fieldSize.x - 1) || (y == fieldSize.y - 1);
+					this->tiles[(y * fieldSize.x) + x] = edgeFlag ? LevelTile::SHRUB : LevelTile::GRASS;
+				}
+			}
+		}
+
+		// Put an obstacle on a grass cell inside the walls, unless it is in the clear area around the snake's start
+		void LevelGenerator::setObstacle(const QuickGameDefn& gameDefn, sf::Vector2i position, LevelTile tile, int& obstacleCount) {
+			sf::Vector2i fieldSize = gameDefn.fieldSize;
+			bool insideFlag = (position.x > 0) && (position.y > 0) && (position.x < fieldSize.x - 1) && (position.y < fieldSize.y - 1);
+			if (!insideFlag) {
+				return;
+			}
+
+			// The snake starts in a straight line, so it and the run ahead of its head fit in a rectangle, kept a cell away from obstacles
+			const SnakeStartDefn& startDefn = gameDefn.snakeStartDefn;
+			sf::Vector2i facingVector = SnakeUtils::directionToVector(startDefn.facingDirection);
+			sf::Vector2i tailPosition = startDefn.headPosition - (facingVector * (startDefn.length - 1));
+			sf::Vector2i runEndPosition = startDefn.headPosition + (facingVector * LEVEL_GENERATOR_CLEAR_RUN);
+			bool clearFlag =
+				(position.x >= std::min(tailPosition.x, runEndPosition.x) - 1) && (position.x <= std::max(tailPosition.x, runEndPosition.x) + 1) &&
+				(position.y >= std::min(tailPosition.y, runEndPosition.y) - 1) && (position.y <= std::max(tailPosition.y, runEndPosition.y) + 1);
+			if (clearFlag) {
+				return;
+			}
+
+			LevelTile& fieldTile = this->tiles[(position.y * fieldSize.x) + position.x];
+			if (fieldTile == LevelTile::GRASS) {
+				fieldTile = tile;
+				obstacleCount++;
+			}
+		}
+
+		// Flood fill the layout from the snake's head, fill in the open cells it cannot reach and check enough of the field is left open
+		bool LevelGenerator::validate(const QuickGameDefn& gameDefn, Level& level) {
+			sf::Vector2i fieldSize = gameDefn.fieldSize;
+			if (!level.build(fieldSize, gameDefn.snakeStartDefn, this->tiles.data())) {
+				return false;
+			}
+
+			this->bitboard.loadFromLevel(level);
+			int reachableCellCount = this->bitboard.floodFill(gameDefn.snakeStartDefn.headPosition);
+			if (reachableCellCount < level.getOpenCellCount()) {
+				// Pockets walled off from the snake become shrubs, so no apple can spawn out of reach
+				for (int y = 1; y < fieldSize.y - 1; y++) {
+					for (int x = 1; x < fieldSize.x - 1; x++) {
+						sf::Vector2i position(x, y);
+						if (this->bitboard.isOpen(position) && !this->bitboard.isFilled(position)) {
+							this->tiles[(y * fieldSize.x) + x] = LevelTile::SHRUB;
+						}
+					}
+				}
+				level.build(fieldSize, gameDefn.snakeStartDefn, this->tiles.data());
+			}
+
+			int innerCellCount = (fieldSize.x - 2) * (fieldSize.y - 2);
+			bool result = level.getOpenCellCount() >= (int)(innerCellCount * this->settings.minOpenFraction);
+			return result;
+		}
+
+		// Constructor for the BackgroundLevelGenerator class, nothing runs until the first request
+		BackgroundLevelGenerator::BackgroundLevelGenerator(const LevelGeneratorSettings& settings) : generator(settings) {
+			this->nextLevelIndex = 0;
+			this->requestedFlag = false;
+		}
+
+		// Destructor for the BackgroundLevelGenerator class
+		BackgroundLevelGenerator::~BackgroundLevelGenerator() {
+			if (this->thread.joinable()) {
+				this->thread.join();
+			}
+		}
+
+		// Generate the next level on a worker thread, into the slot the last level handed out is not in
+		void BackgroundLevelGenerator::request(const QuickGameDefn& gameDefn, unsigned int seed) {
+			assert(!this->requestedFlag); // Every request has to be taken before the next one
+
+			Level* level = &this->levels[this->nextLevelIndex];
+			this->thread = std::thread([this, gameDefn, seed, level]() {
+				this->generator.generate(gameDefn, seed, *level);
+			});
+			this->requestedFlag = true;
+		}
+
+		// Wait for the worker to finish the requested level
+		const Level* BackgroundLevelGenerator::take(LevelGeneratorStats& stats) {
+			assert(this->requestedFlag);
+
+			this->thread.join();
+			this->requestedFlag = false;
+			stats = this->generator.getLastStats();
+
+			const Level* result = &this->levels[this->nextLevelIndex];
+			this->nextLevelIndex = 1 - this->nextLevelIndex;
+			return result;
+		}
+
+	}
@@ -0,0 +1,502 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <thread>
+#include "includes/mctsbot.hpp"
+
+
+	namespace snake {
+
+		// Directions the snake can move in, in the order of a node's children
+		const ObjectDirection MCTS_DIRECTIONS[] = { ObjectDirection::UP, ObjectDirection::RIGHT, ObjectDirection::DOWN, ObjectDirection::LEFT };
+
+		// Fixed point scale of the rewards summed into the tree
+		const std::int64_t MCTS_REWARD_SCALE = 1 << 20;
+
+		// Deepest a playout walks down the tree before it switches to a random rollout
+		const int MCTS_MAX_TREE_DEPTH = 64;
+
+		// Playouts a worker runs between looks at the clock
+		const int MCTS_BATCH_PLAYOUTS = 4;
+
+		// Deque size per worker, a search only ever queues about log2 of the worker count
+		const int MCTS_QUEUE_CAPACITY = 64;
+
+		// Rewards: a playout that survives scores at least MCTS_SURVIVAL_REWARD, one that dies at most MCTS_DEATH_REWARD,
+		// sooner apples and longer lives score higher within those, and ending nearer the apple counts for part of an apple
+		// so apples further away than a playout reaches still pull the snake towards them
+		const float MCTS_SURVIVAL_REWARD = 0.5f;
+		const float MCTS_DEATH_REWARD = 0.4f;
+		const float MCTS_APPLE_DISCOUNT = 0.97f;
+		const float MCTS_APPLE_PROXIMITY_WEIGHT = 0.5f;
+		const float MCTS_SURVIVAL_DECAY = 0.9f;
+
+		// Settings of the difficulty tiers, a worker count of 0 means one per hardware thread and -1 half of them
+		const MctsBotSettings MCTS_DIFFICULTY_SETTINGS[] = {
+			{ 1, 2000, 1 << 14, 20, 1.0f },
+			{ -1, 6000, 1 << 16, 40, 0.7f },
+			{ 0, 12000, 1 << 18, 60, 0.5f },
+		};
+
+		// Constructor for MctsBot, the scratch games are made when the first game is seen
+		MctsBot::MctsBot(const MctsBotSettings& settings) {
+			assert(settings.workerCount > 0);
+			assert(settings.nodeCapacity > 0);
+
+			this->settings = settings;
+			this->pool = new WorkStealingPool(settings.workerCount, MCTS_QUEUE_CAPACITY);
+
+			this->fieldSize = sf::Vector2i(0, 0);
+			this->workers = new MctsWorker[settings.workerCount];
+			for (int workerIndex = 0; workerIndex < settings.workerCount; workerIndex++) {
+				MctsWorker& worker = this->workers[workerIndex];
+				worker.game = nullptr;
+				worker.randomizer.seed((unsigned int)(workerIndex + 1) * 7919u);
+				worker.pathNodes = new int[MCTS_MAX_TREE_DEPTH + 1];
+				worker.rolloutCount = 0;
+				worker.rolloutMoveCount = 0;
+			}
+
+			this->nodes = new MctsNode[settings.nodeCapacity];
+			this->nodeCount = 0;
+
+			this->rootGame = nullptr;
+			this->deadline = std::chrono::steady_clock::now();
+
+			this->trackingFlag = false;
+			this->lastFrameCount = 0;
+			this->lastStateHash = 0;
+			this->plannedDirection = ObjectDirection::NONE;
+
+			this->resetStats();
+		}
+
+		// Destructor for MctsBot, the threads stop before the state they search is freed
+		MctsBot::~MctsBot() {
+			delete this->pool;
+
+			for (int workerIndex = 0; workerIndex < this->settings.workerCount; workerIndex++) {
+				delete this->workers[workerIndex].game;
+				delete[] this->workers[workerIndex].pathNodes;
+			}
+			delete[] this->workers;
+			delete[] this->nodes;
+		}
+
+		// Get the settings of a difficulty tier, with the worker count resolved for this machine
+		MctsBotSettings MctsBot::resolveDifficultySettings(MctsDifficulty difficulty) {
+			MctsBotSettings result = MCTS_DIFFICULTY_SETTINGS[(int)difficulty];
+
+			int hardwareThreadCount = (int)std::thread::hardware_concurrency();
+			if (hardwareThreadCount < 1) {
+				hardwareThreadCount = 1;
+			}
+			if (result.workerCount == 0) {
+				result.workerCount = hardwareThreadCount;
+			} else if (result.workerCount < 0) {
+				result.workerCount = (hardwareThreadCount > 1) ? (hardwareThreadCount / 2) : 1;
+			}
+
+			return result;
+		}
+
+		// Search again whenever the board changed and hold the chosen direction in between
+		QuickGameInputRequest MctsBot::resolveInput(const QuickGame& game) {
+			// A frame count that did not advance by one means a new game, or frames the bot did not see
+			bool continuingFlag = this->trackingFlag && (game.getFrameCount() == this->lastFrameCount + 1);
+			if (!continuingFlag || (game.getStateHash() != this->lastStateHash)) {
+				this->plannedDirection = this->search(game);
+			}
+			this->trackingFlag = true;
+			this->lastFrameCount = game.getFrameCount();
+			this->lastStateHash = game.getStateHash();
+
+			// The game keeps the last valid input, so the chosen direction is given every frame
+			QuickGameInputRequest result;
+			result.snakeMovementInput = this->plannedDirection;
+			return result;
+		}
+
+		// Run the workers on a fresh tree until the move budget is spent, then take the root's most visited move
+		ObjectDirection MctsBot::search(const QuickGame& game) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			if (game.getFieldSize() != this->fieldSize) {
+				this->resizeForField(game.getFieldSize());
+			}
+
+			this->rootGame = &game;
+			this->nodeCount = 1;
+			this->resetNode(0);
+			this->deadline = start + std::chrono::microseconds(this->settings.moveBudgetMicroseconds);
+
+			// One task spread over every worker, it splits in halves that the idle workers steal
+			int initialTask = this->settings.workerCount;
+			this->pool->resetStats();
+			this->pool->run(*this, &initialTask, 1);
+			this->rootGame = nullptr;
+
+			ObjectDirection result = ObjectDirection::NONE;
+			int bestVisitCount = 0;
+			for (int directionIndex = 0; directionIndex < 4; directionIndex++) {
+				int childIndex = this->nodes[0].children[directionIndex].load();
+				if (childIndex < 0) {
+					continue;
+				}
+
+				int visitCount = this->nodes[childIndex].visitCount.load();
+				if (visitCount > bestVisitCount) {
+					bestVisitCount = visitCount;
+					result = MCTS_DIRECTIONS[directionIndex];
+				}
+			}
+			if (result == ObjectDirection::NONE) {
+				// The budget ran out before any playout finished, or every move dies
+				result = resolveFallbackDirection(game);
+			}
+
+			for (int workerIndex = 0; workerIndex < this->settings.workerCount; workerIndex++) {
+				MctsWorker& worker = this->workers[workerIndex];
+				const WorkStealingWorkerStats& workerStats = this->pool->getWorkerStats(workerIndex);
+				this->stats.rolloutCount += worker.rolloutCount;
+				this->stats.rolloutMoveCount += worker.rolloutMoveCount;
+				this->stats.taskCount += workerStats.taskCount;
+				this->stats.stolenTaskCount += workerStats.stolenTaskCount;
+				worker.rolloutCount = 0;
+				worker.rolloutMoveCount = 0;
+			}
+
+			int nodesUsed = this->nodeCount.load();
+			if (nodesUsed > this->settings.nodeCapacity) {
+				nodesUsed = this->settings.nodeCapacity;
+			}
+			if (nodesUsed > this->stats.maxNodesUsed) {
+				this->stats.maxNodesUsed = nodesUsed;
+			}
+			this->stats.searchCount++;
+			this->stats.searchSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			return result;
+		}
+
+		// Get the settings the bot searches with
+		const MctsBotSettings& MctsBot::getSettings() const {
+			return this->settings;
+		}
+
+		// Get the search statistics
+		const MctsBotStats& MctsBot::getStats() const {
+			return this->stats;
+		}
+
+		// Clear the search statistics
+		void MctsBot::resetStats() {
+			this->stats.searchCount = 0;
+			this->stats.rolloutCount = 0;
+			this->stats.rolloutMoveCount = 0;
+			this->stats.stolenTaskCount = 0;
+			this->stats.taskCount = 0;
+			this->stats.maxNodesUsed = 0;
+			this->stats.searchSeconds = 0.0;
+		}
+
+		// A task spread over several workers hands half of them off until it is down to one, which plays until the deadline
+		void MctsBot::runTask(WorkStealingPool& pool, int workerIndex, int taskArgument) {
+			int spreadWorkerCount = taskArgument;
+			while (spreadWorkerCount > 1) {
+				int handedOffCount = spreadWorkerCount / 2;
+				if (!pool.push(workerIndex, handedOffCount)) {
+					break;
+				}
+				spreadWorkerCount -= handedOffCount;
+			}
+
+			MctsWorker& worker = this->workers[workerIndex];
+			while (std::chrono::steady_clock::now() < this->deadline) {
+				for (int playoutIndex = 0; playoutIndex < MCTS_BATCH_PLAYOUTS; playoutIndex++) {
+					this->runPlayout(worker);
+				}
+			}
+		}
+
+		// Make one scratch game per worker for the new field size
+		void MctsBot::resizeForField(sf::Vector2i fieldSize) {
+			this->fieldSize = fieldSize;
+
+			// The scratch games are overwritten by every playout, so any start that fits the field will do
+			QuickGameDefn gameDefn;
+			gameDefn.fieldSize = fieldSize;
+			gameDefn.snakeSpeedTilesPerSecond = 10.0f;
+			gameDefn.snakeStartDefn.headPosition = sf::Vector2i(fieldSize.x / 2, fieldSize.y / 2);
+			gameDefn.snakeStartDefn.facingDirection = ObjectDirection::DOWN;
+			gameDefn.snakeStartDefn.length = 3;
+			gameDefn.randomSeed = 1;
+
+			for (int workerIndex = 0; workerIndex < this->settings.workerCount; workerIndex++) {
+				delete this->workers[workerIndex].game;
+				this->workers[workerIndex].game = new QuickGame(&gameDefn);
+			}
+		}
+
+		// Clear a node before it is linked into the tree
+		void MctsBot::resetNode(int nodeIndex) {
+			MctsNode& node = this->nodes[nodeIndex];
+			node.visitCount.store(0, std::memory_order_relaxed);
+			node.virtualLoss.store(0, std::memory_order_relaxed);
+			node.totalReward.store(0, std::memory_order_relaxed);
+			for (int directionIndex = 0; directionIndex < 4; directionIndex++) {
+				node.children[directionIndex].store(-1, std::memory_order_relaxed);
+			}
+		}
+
+		// Walk down the tree from a fresh copy of the root, play a rollout from the first unvisited node and add its reward along the path
+		void MctsBot::runPlayout(MctsWorker& worker) {
+			QuickGame& game = *worker.game;
+			game.copyFrom(*this->rootGame);
+			game.reseedRandomizer((unsigned int)worker.randomizer());
+
+			int pathLength = 0;
+			int nodeIndex = 0;
+			worker.pathNodes[pathLength++] = nodeIndex;
+			this->nodes[nodeIndex].virtualLoss.fetch_add(1, std::memory_order_relaxed);
+
+			int movesPlayed = 0;
+			float appleScore = 0.0f;
+			float appleWeight = 1.0f;
+			bool diedFlag = false;
+			while (!game.getFieldFull()) {
+				ObjectDirection direction = ObjectDirection::NONE;
+				int childIndex = this->selectChild(worker, nodeIndex, &direction);
+				if (direction == ObjectDirection::NONE) {
+					diedFlag = true;
+					break;
+				}
+
+				QuickGameUpdateResult updateResult = playMove(game, direction);
+				if (updateResult.snakeAteAppleFlag) {
+					appleScore += appleWeight;
+				}
+				appleWeight *= MCTS_APPLE_DISCOUNT;
+				movesPlayed++;
+
+				// Out of nodes, the rollout starts below the last node there is
+				if (childIndex < 0) {
+					break;
+				}
+
+				worker.pathNodes[pathLength++] = childIndex;
+				this->nodes[childIndex].virtualLoss.fetch_add(1, std::memory_order_relaxed);
+				nodeIndex = childIndex;
+
+				if ((this->nodes[childIndex].visitCount.load(std::memory_order_relaxed) == 0) || (pathLength > MCTS_MAX_TREE_DEPTH)) {
+					break;
+				}
+			}
+
+			float reward = 1.0f;
+			if (diedFlag) {
+				reward = this->resolveReward(game, true, movesPlayed, appleScore);
+			} else if (!game.getFieldFull()) {
+				reward = this->runRollout(worker, movesPlayed, appleScore);
+			}
+
+			std::int64_t fixedReward = (std::int64_t)(reward * (float)MCTS_REWARD_SCALE);
+			for (int pathIndex = 0; pathIndex < pathLength; pathIndex++) {
+				MctsNode& node = this->nodes[worker.pathNodes[pathIndex]];
+				node.totalReward.fetch_add(fixedReward, std::memory_order_relaxed);
+				node.visitCount.fetch_add(1, std::memory_order_relaxed);
+				node.virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+			}
+
+			worker.rolloutCount++;
+		}
+
+		// Pick a node's child by UCT, counting the virtual losses of playouts still below it, and create it when it does not exist yet
+		int MctsBot::selectChild(MctsWorker& worker, int nodeIndex, ObjectDirection* direction) {
+			MctsNode& node = this->nodes[nodeIndex];
+			Snake* snake = worker.game->getSnake();
+
+			int parentVisitCount = node.visitCount.load(std::memory_order_relaxed) + node.virtualLoss.load(std::memory_order_relaxed);
+			float logParentVisitCount = logf((float)((parentVisitCount > 1) ? parentVisitCount : 1));
+
+			// Moves are looked at from a random start so ties and untried moves do not always favour the same direction
+			int firstDirectionIndex = (int)(worker.randomizer() % 4);
+			int bestDirectionIndex = -1;
+			float bestScore = -1.0f;
+			for (int directionOffset = 0; directionOffset < 4; directionOffset++) {
+				int directionIndex = (firstDirectionIndex + directionOffset) % 4;
+				ObjectDirection candidateDirection = MCTS_DIRECTIONS[directionIndex];
+				if (!snake->isValidMovementDirection(candidateDirection) || isLethal(*worker.game, candidateDirection)) {
+					continue;
+				}
+
+				int childIndex = node.children[directionIndex].load(std::memory_order_acquire);
+				if (childIndex < 0) {
+					bestDirectionIndex = directionIndex;
+					break;
+				}
+
+				MctsNode& child = this->nodes[childIndex];
+				int childVisitCount = child.visitCount.load(std::memory_order_relaxed) + child.virtualLoss.load(std::memory_order_relaxed);
+				if (childVisitCount == 0) {
+					bestDirectionIndex = directionIndex;
+					break;
+				}
+
+				float meanReward = ((float)child.totalReward.load(std::memory_order_relaxed) / (float)MCTS_REWARD_SCALE) / (float)childVisitCount;
+				float score = meanReward + (this->settings.exploration * sqrtf(logParentVisitCount / (float)childVisitCount));
+				if (score > bestScore) {
+					bestScore = score;
+					bestDirectionIndex = directionIndex;
+				}
+			}
+
+			if (bestDirectionIndex < 0) {
+				*direction = ObjectDirection::NONE;
+				return -1;
+			}
+			*direction = MCTS_DIRECTIONS[bestDirectionIndex];
+
+			int result = node.children[bestDirectionIndex].load(std::memory_order_acquire);
+			if (result >= 0) {
+				return result;
+			}
+
+			// Claim a node from the pool, the counter keeps climbing past the capacity once it is used up
+			if (this->nodeCount.load(std::memory_order_relaxed) >= this->settings.nodeCapacity) {
+				return -1;
+			}
+			int newNodeIndex = this->nodeCount.fetch_add(1, std::memory_order_relaxed);
+			if (newNodeIndex >= this->settings.nodeCapacity) {
+				return -1;
+			}
+			this->resetNode(newNodeIndex);
+
+			// Publish it, another worker may have linked its own child first, this node is then left unused
+			result = -1;
+			if (node.children[bestDirectionIndex].compare_exchange_strong(result, newNodeIndex, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				result = newNodeIndex;
+			}
+			return result;
+		}
+
+		// Play random moves that do not die straight away, leaning towards the apple, and score where they end up
+		float MctsBot::runRollout(MctsWorker& worker, int movesPlayed, float appleScore) {
+			QuickGame& game = *worker.game;
+			float appleWeight = powf(MCTS_APPLE_DISCOUNT, (float)movesPlayed);
+
+			for (int rolloutMove = 0; rolloutMove < this->settings.rolloutDepth; rolloutMove++) {
+				if (game.getFieldFull()) {
+					return 1.0f;
+				}
+
+				ObjectDirection direction = this->resolveRolloutDirection(worker);
+				if (direction == ObjectDirection::NONE) {
+					return this->resolveReward(game, true, movesPlayed, appleScore);
+				}
+
+				QuickGameUpdateResult updateResult = playMove(game, direction);
+				if (updateResult.snakeAteAppleFlag) {
+					appleScore += appleWeight;
+				}
+				appleWeight *= MCTS_APPLE_DISCOUNT;
+				movesPlayed++;
+				worker.rolloutMoveCount++;
+			}
+
+			return this->resolveReward(game, false, movesPlayed, appleScore);
+		}
+
+		// Pick a rollout move: half the time the safe move closest to the apple, otherwise any safe move
+		ObjectDirection MctsBot::resolveRolloutDirection(MctsWorker& worker) {
+			QuickGame& game = *worker.game;
+			Snake* snake = game.getSnake();
+
+			ObjectDirection safeDirections[4];
+			int safeDirectionCount = 0;
+			for (int directionIndex = 0; directionIndex < 4; directionIndex++) {
+				ObjectDirection direction = MCTS_DIRECTIONS[directionIndex];
+				if (snake->isValidMovementDirection(direction) && !isLethal(game, direction)) {
+					safeDirections[safeDirectionCount++] = direction;
+				}
+			}
+			if (safeDirectionCount == 0) {
+				return ObjectDirection::NONE;
+			}
+
+			unsigned int randomValue = (unsigned int)worker.randomizer();
+			ObjectDirection result = safeDirections[(randomValue >> 1) % safeDirectionCount];
+			if (((randomValue & 1) == 0) && game.getAppleExists()) {
+				sf::Vector2i headPosition = snake->getHead().position;
+				sf::Vector2i applePosition = game.getApplePosition();
+				int bestDistance = -1;
+				for (int safeIndex = 0; safeIndex < safeDirectionCount; safeIndex++) {
+					sf::Vector2i nextPosition = headPosition + SnakeUtils::directionToVector(safeDirections[safeIndex]);
+					int distance = abs(applePosition.x - nextPosition.x) + abs(applePosition.y - nextPosition.y);
+					if ((bestDistance < 0) || (distance < bestDistance)) {
+						bestDistance = distance;
+						result = safeDirections[safeIndex];
+					}
+				}
+			}
+
+			return result;
+		}
+
+		// Score a finished playout between 0 and 1
+		float MctsBot::resolveReward(const QuickGame& game, bool diedFlag, int movesSurvived, float appleScore) const {
+			if (diedFlag) {
+				return MCTS_DEATH_REWARD * (1.0f - powf(MCTS_SURVIVAL_DECAY, (float)movesSurvived));
+			}
+
+			// An apple that is not there yet was eaten on the last move
+			float proximity = 1.0f;
+			if (game.getAppleExists()) {
+				sf::Vector2i headPosition = game.getSnake()->getHead().position;
+				sf::Vector2i applePosition = game.getApplePosition();
+				int distance = abs(applePosition.x - headPosition.x) + abs(applePosition.y - headPosition.y);
+				proximity = 1.0f - ((float)distance / (float)(this->fieldSize.x + this->fieldSize.y));
+			}
+
+			float score = appleScore + (MCTS_APPLE_PROXIMITY_WEIGHT * proximity);
+			return MCTS_SURVIVAL_REWARD + ((1.0f - MCTS_SURVIVAL_REWARD) * (score / (score + 1.0f)));
+		}
+
+		// Hold an input down until the snake has moved one cell or hit something
+		QuickGameUpdateResult MctsBot::playMove(QuickGame& game, ObjectDirection direction) {
+			QuickGameInputRequest input;
+			input.snakeMovementInput = direction;
+
+			QuickGameUpdateResult result = game.update(&input);
+			while ((result.snakeMovementResult == ObjectDirection::NONE) && !result.snakeHitBarrierFlag) {
+				result = game.update(&input);
+			}
+			return result;
+		}
+
+		// Check whether moving the snake in a direction would end the game
+		bool MctsBot::isLethal(const QuickGame& game, ObjectDirection direction) {
+			sf::Vector2i gameFieldSize = game.getFieldSize();
+			sf::Vector2i position = game.getSnake()->getHead().position + SnakeUtils::directionToVector(direction);
+			bool result =
+				(position.x <= 0) ||
+				(position.y <= 0) ||
+				(position.x >= gameFieldSize.x - 1) ||
+				(position.y >= gameFieldSize.y - 1) ||
+				game.getSnake()->bodyOccupiesPosition(position);
+			return result;
+		}
+
+		// Get a move that does not die straight away, or keep going straight when there is none
+		ObjectDirection MctsBot::resolveFallbackDirection(const QuickGame& game) {
+			Snake* snake = game.getSnake();
+			for (int directionIndex = 0; directionIndex < 4; directionIndex++) {
+				ObjectDirection direction = MCTS_DIRECTIONS[directionIndex];
+				if (snake->isValidMovementDirection(direction) && !isLethal(game, direction)) {
+					return direction;
+				}
+			}
+			return snake->getHead().enterDirection;
+		}
+
+	}
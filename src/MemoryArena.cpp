@@ -0,0 +1,64 @@
+#include <assert.h>
+#include "includes/memoryarena.hpp"
+
+
+	namespace snake {
+
+		// Alignment of the backing block, enough for any type carved from it
+		const std::size_t MEMORY_ARENA_BLOCK_ALIGNMENT = alignof(std::max_align_t);
+
+		// Constructor for the MemoryArena class
+		MemoryArena::MemoryArena(std::size_t capacity) {
+			this->memory = new unsigned char[capacity];
+			this->capacity = capacity;
+			this->usedBytes = 0;
+		}
+
+		// Destructor for the MemoryArena class
+		MemoryArena::~MemoryArena() {
+			delete[] this->memory;
+		}
+
+		// Carve an aligned block from the arena
+		void* MemoryArena::allocate(std::size_t size, std::size_t alignment) {
+			assert((alignment != 0) && ((alignment & (alignment - 1)) == 0)); // Alignment must be a power of two
+			assert(alignment <= MEMORY_ARENA_BLOCK_ALIGNMENT);
+
+			// Round the current offset up to the requested alignment
+			std::size_t alignedOffset = (this->usedBytes + alignment - 1) & ~(alignment - 1);
+			if ((alignedOffset > this->capacity) || (size > this->capacity - alignedOffset)) {
+				throw "Memory arena exhausted";
+			}
+
+			this->usedBytes = alignedOffset + size;
+			return this->memory + alignedOffset;
+		}
+
+		// Release everything carved from the arena
+		void MemoryArena::reset() {
+			this->usedBytes = 0;
+		}
+
+		// Reset the arena, growing the backing block if it is too small
+		void MemoryArena::resetWithCapacity(std::size_t capacity) {
+			if (capacity > this->capacity) {
+				delete[] this->memory;
+				this->memory = new unsigned char[capacity];
+				this->capacity = capacity;
+			}
+
+			this->usedBytes = 0;
+		}
+
+		// Get the size of the backing block
+		std::size_t MemoryArena::getCapacity() const {
+			return this->capacity;
+		}
+
+		// Get the number of bytes carved so far, including alignment padding
+		std::size_t MemoryArena::getUsedBytes() const {
+			return this->usedBytes;
+		}
+
+
+}
@@ -0,0 +1,420 @@
+#include <assert.h>
+#include <string.h>
+#include "includes/netclient.hpp"
+
+
+	namespace snake {
+
+		// How long the client waits on an unanswered hello or resync before sending it again
+		const std::chrono::milliseconds NET_CLIENT_RETRY_INTERVAL(500);
+
+		// Largest field a welcome is believed for, anything bigger is not from a server
+		const long long NET_CLIENT_MAX_CELL_COUNT = 1LL << 26;
+
+		// Constructor for NetClient
+		NetClient::NetClient() {
+			this->serverPort = 0;
+			this->replica = nullptr;
+			this->snakeIndex = -1;
+			this->appliedTick = 0;
+			this->sendTick = 0;
+			this->welcomedFlag = false;
+			this->syncedFlag = false;
+			this->closedFlag = false;
+
+			this->partBytes = nullptr;
+			this->partSizes = nullptr;
+			this->partCapacity = 0;
+			this->pendingType = NetMessageType::DELTA;
+			this->pendingTick = -1;
+			this->pendingPartCount = 0;
+			this->receivedPartCount = 0;
+			this->receiveBytes = new unsigned char[NET_MAX_DATAGRAM_SIZE];
+
+			this->stats.receivedBytes = 0;
+			this->stats.receivedDatagramCount = 0;
+			this->stats.appliedTickCount = 0;
+			this->stats.keyframeCount = 0;
+			this->stats.resyncCount = 0;
+			this->stats.hashCheckCount = 0;
+			this->stats.hashMismatchCount = 0;
+		}
+
+		// Destructor for NetClient
+		NetClient::~NetClient() {
+			this->socket.unbind();
+			delete this->replica;
+			delete[] this->partBytes;
+			delete[] this->partSizes;
+			delete[] this->receiveBytes;
+		}
+
+		// Bind a port and send the first hello, poll() repeats it until the server answers
+		bool NetClient::connect(const sf::IpAddress& address, unsigned short port) {
+			this->socket.setBlocking(false);
+			if (this->socket.bind(sf::Socket::AnyPort) != sf::Socket::Done) {
+				return false;
+			}
+
+			this->serverAddress = address;
+			this->serverPort = port;
+			unsigned char bytes[NET_HELLO_SIZE];
+			int offset = NetUtils::writeHeader(bytes, NetMessageType::HELLO);
+			NetUtils::writeUint32(bytes + offset, NET_PROTOCOL_VERSION);
+			this->sendMessage(bytes, NET_HELLO_SIZE);
+			this->requestTime = std::chrono::steady_clock::now();
+			return true;
+		}
+
+		// Handle everything waiting on the socket, then repeat whatever request is still unanswered
+		int NetClient::poll() {
+			if (this->closedFlag) {
+				return 0;
+			}
+
+			int appliedBefore = this->stats.appliedTickCount;
+			std::size_t receivedSize = 0;
+			sf::IpAddress address;
+			unsigned short port = 0;
+			while (this->socket.receive(this->receiveBytes, NET_MAX_DATAGRAM_SIZE, receivedSize, address, port) == sf::Socket::Done) {
+				NetMessageType messageType;
+				if ((port != this->serverPort) || !(address == this->serverAddress) || !NetUtils::readHeader(this->receiveBytes, (int)receivedSize, messageType)) {
+					continue;
+				}
+				this->stats.receivedBytes += (long long)receivedSize;
+				this->stats.receivedDatagramCount++;
+				this->handleMessage(messageType, this->receiveBytes, (int)receivedSize);
+				if (this->closedFlag) {
+					return this->stats.appliedTickCount - appliedBefore;
+				}
+			}
+
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			if (!this->welcomedFlag && (now - this->requestTime >= NET_CLIENT_RETRY_INTERVAL)) {
+				unsigned char bytes[NET_HELLO_SIZE];
+				int offset = NetUtils::writeHeader(bytes, NetMessageType::HELLO);
+				NetUtils::writeUint32(bytes + offset, NET_PROTOCOL_VERSION);
+				this->sendMessage(bytes, NET_HELLO_SIZE);
+				this->requestTime = now;
+			} else if (this->welcomedFlag && !this->syncedFlag && (now - this->requestTime >= NET_CLIENT_RETRY_INTERVAL)) {
+				this->requestKeyframe();
+			} else if (this->syncedFlag && (this->appliedTick - this->sendTick >= NET_KEEPALIVE_TICKS)) {
+				this->sendInput(ObjectDirection::NONE);
+			}
+			return this->stats.appliedTickCount - appliedBefore;
+		}
+
+		// Send the direction the snake should turn to, NONE only keeps the client from timing out
+		void NetClient::sendInput(ObjectDirection direction) {
+			unsigned char bytes[NET_INPUT_SIZE];
+			int offset = NetUtils::writeHeader(bytes, NetMessageType::INPUT);
+			bytes[offset] = (unsigned char)direction;
+			this->sendMessage(bytes, NET_INPUT_SIZE);
+		}
+
+		// Say goodbye, the server hands the snake to the next client to join
+		void NetClient::disconnect() {
+			if (!this->closedFlag) {
+				unsigned char bytes[NET_HEADER_SIZE];
+				NetUtils::writeHeader(bytes, NetMessageType::BYE);
+				this->sendMessage(bytes, NET_HEADER_SIZE);
+				this->closedFlag = true;
+			}
+			this->socket.unbind();
+		}
+
+		// Check whether the server answered the hello
+		bool NetClient::isWelcomed() const {
+			return this->welcomedFlag;
+		}
+
+		// Check whether the replica is up to date with a tick the server sent
+		bool NetClient::isSynced() const {
+			return this->syncedFlag;
+		}
+
+		// Check whether the connection is over
+		bool NetClient::isClosed() const {
+			return this->closedFlag;
+		}
+
+		// Get the index of the snake the client steers
+		int NetClient::getSnakeIndex() const {
+			return this->snakeIndex;
+		}
+
+		// Get the tick the replica is at
+		int NetClient::getAppliedTick() const {
+			return this->appliedTick;
+		}
+
+		// Get the replica, only there once welcomed
+		const ArenaReplica& NetClient::getReplica() const {
+			assert(this->replica != nullptr);
+			return *this->replica;
+		}
+
+		// Get the counts of what was received
+		const NetClientStats& NetClient::getStats() const {
+			return this->stats;
+		}
+
+		// Act on one message from the server
+		void NetClient::handleMessage(NetMessageType messageType, const unsigned char* bytes, int size) {
+			if (messageType == NetMessageType::WELCOME) {
+				this->handleWelcome(bytes, size);
+			} else if ((messageType == NetMessageType::SERVER_FULL) && !this->welcomedFlag) {
+				this->closedFlag = true;
+			} else if (messageType == NetMessageType::BYE) {
+				this->closedFlag = true;
+			} else if (((messageType == NetMessageType::DELTA) || (messageType == NetMessageType::KEYFRAME)) && this->welcomedFlag) {
+				this->handlePart(messageType, bytes, size);
+			}
+		}
+
+		// Make the replica for the arena's shape, a repeated welcome for a lost one changes nothing
+		void NetClient::handleWelcome(const unsigned char* bytes, int size) {
+			if (this->welcomedFlag || (size < NET_WELCOME_SIZE)) {
+				return;
+			}
+
+			int offset = NET_HEADER_SIZE;
+			NetArenaShape shape;
+			int snakeIndex = (int)NetUtils::readUint16(bytes + offset);
+			offset += 2;
+			shape.fieldSize.x = (int)NetUtils::readUint32(bytes + offset);
+			shape.fieldSize.y = (int)NetUtils::readUint32(bytes + offset + 4);
+			shape.snakeCount = (int)NetUtils::readUint32(bytes + offset + 8);
+			shape.snakeMaxLength = (int)NetUtils::readUint32(bytes + offset + 12);
+			shape.appleCount = (int)NetUtils::readUint32(bytes + offset + 16);
+			int tick = (int)NetUtils::readUint32(bytes + offset + 20);
+
+			bool validFlag =
+				(shape.fieldSize.x >= 3) && (shape.fieldSize.y >= 3) && ((long long)shape.fieldSize.x * shape.fieldSize.y <= NET_CLIENT_MAX_CELL_COUNT) &&
+				(shape.snakeCount > snakeIndex) && (shape.snakeCount <= 0xFFFF) && (shape.snakeMaxLength >= 2) && (shape.appleCount >= 0) &&
+				(NetUtils::resolveSnakeRecordSize(shape.snakeMaxLength) <= NET_MAX_DATAGRAM_SIZE - NET_PART_HEADER_SIZE - NET_PART_HASH_SIZE);
+			if (!validFlag) {
+				return;
+			}
+
+			this->replica = new ArenaReplica(shape);
+			this->snakeIndex = snakeIndex;
+			this->appliedTick = tick;
+			this->partCapacity = NetUtils::resolveMaxPartCount(shape);
+			this->partBytes = new unsigned char[(std::size_t)this->partCapacity * NET_MAX_DATAGRAM_SIZE];
+			this->partSizes = new int[this->partCapacity];
+			this->sendTick = tick;
+			this->welcomedFlag = true;
+			this->syncedFlag = false;
+			this->requestTime = std::chrono::steady_clock::now();
+		}
+
+		// File a part of a delta or keyframe, and apply the whole of it once its last part is in
+		void NetClient::handlePart(NetMessageType messageType, const unsigned char* bytes, int size) {
+			if (size < NET_PART_HEADER_SIZE) {
+				return;
+			}
+			int tick = (int)NetUtils::readUint32(bytes + NET_HEADER_SIZE);
+			int partIndex = (int)NetUtils::readUint16(bytes + NET_HEADER_SIZE + 4);
+			int partCount = (int)NetUtils::readUint16(bytes + NET_HEADER_SIZE + 6);
+			bool hashFlag = bytes[NET_PART_HEADER_SIZE - 1] != 0;
+			if ((partCount < 1) || (partCount > this->partCapacity) || (partIndex >= partCount) || (hashFlag && (size < NET_PART_HEADER_SIZE + NET_PART_HASH_SIZE))) {
+				return;
+			}
+
+			// A delta is only any use on top of the tick before it, and a keyframe only while one is being waited for
+			if (messageType == NetMessageType::DELTA) {
+				if (!this->syncedFlag || (tick <= this->appliedTick)) {
+					return;
+				}
+				if (tick > this->appliedTick + 1) {
+					this->requestKeyframe();
+					return;
+				}
+			} else if (this->syncedFlag) {
+				return;
+			}
+
+			if ((messageType != this->pendingType) || (tick != this->pendingTick) || (partCount != this->pendingPartCount)) {
+				this->pendingType = messageType;
+				this->pendingTick = tick;
+				this->pendingPartCount = partCount;
+				this->receivedPartCount = 0;
+				for (int slot = 0; slot < partCount; slot++) {
+					this->partSizes[slot] = 0;
+				}
+			}
+			if (this->partSizes[partIndex] != 0) {
+				return;
+			}
+			memcpy(this->partBytes + ((std::size_t)partIndex * NET_MAX_DATAGRAM_SIZE), bytes, (std::size_t)size);
+			this->partSizes[partIndex] = size;
+			this->receivedPartCount++;
+			if (this->receivedPartCount < partCount) {
+				return;
+			}
+
+			bool appliedFlag = (messageType == NetMessageType::DELTA) ? this->applyDelta() : this->applyKeyframe();
+			this->pendingTick = -1;
+			if (appliedFlag) {
+				this->appliedTick = tick;
+				this->syncedFlag = true;
+				this->stats.appliedTickCount += (messageType == NetMessageType::DELTA) ? 1 : 0;
+				this->stats.keyframeCount += (messageType == NetMessageType::KEYFRAME) ? 1 : 0;
+				appliedFlag = this->checkHash();
+			}
+			if (!appliedFlag) {
+				this->requestKeyframe();
+			}
+		}
+
+		// Drop the replica's sync and ask for a keyframe, poll() asks again if it does not come
+		void NetClient::requestKeyframe() {
+			this->syncedFlag = false;
+			this->pendingTick = -1;
+			unsigned char bytes[NET_HEADER_SIZE];
+			NetUtils::writeHeader(bytes, NetMessageType::RESYNC);
+			this->sendMessage(bytes, NET_HEADER_SIZE);
+			this->requestTime = std::chrono::steady_clock::now();
+			this->stats.resyncCount++;
+		}
+
+		// Send one datagram to the server
+		void NetClient::sendMessage(const unsigned char* bytes, int size) {
+			this->socket.send(bytes, (std::size_t)size, this->serverAddress, this->serverPort);
+			this->sendTick = this->appliedTick;
+		}
+
+		// Apply a delta's records in two passes the way the arena's tick runs: deaths and tails first, then heads, spawns and apples.
+		// Returns false on a record that is cut off or names a snake that is not there, leaving the replica for a keyframe to replace
+		bool NetClient::applyDelta() {
+			const NetArenaShape& shape = this->replica->getShape();
+			for (int pass = 0; pass < 2; pass++) {
+				for (int partIndex = 0; partIndex < this->pendingPartCount; partIndex++) {
+					const unsigned char* bytes = this->partBytes + ((std::size_t)partIndex * NET_MAX_DATAGRAM_SIZE);
+					int size = this->partSizes[partIndex];
+					int offset = (bytes[NET_PART_HEADER_SIZE - 1] != 0) ? NET_PART_HEADER_SIZE + NET_PART_HASH_SIZE : NET_PART_HEADER_SIZE;
+					while (offset < size) {
+						const unsigned char* record = bytes + offset;
+						int kind = record[0] & 3;
+						int recordSize = NET_APPLE_RECORD_SIZE;
+						if (kind == NET_RECORD_DIED) {
+							recordSize = NET_DIED_RECORD_SIZE;
+						} else if (kind == NET_RECORD_MOVED) {
+							recordSize = NET_MOVED_RUN_HEADER_SIZE;
+							if (offset + recordSize <= size) {
+								recordSize += ((int)NetUtils::readUint16(record + 3) + 1) / 2;
+							}
+						} else if (kind == NET_RECORD_SPAWNED) {
+							recordSize = NET_SPAWNED_RECORD_SIZE;
+						}
+						if (offset + recordSize > size) {
+							return false;
+						}
+						offset += recordSize;
+
+						if (kind == NET_RECORD_APPLE) {
+							if (pass == 1) {
+								this->replica->setApple((int)NetUtils::readUint32(record + 1));
+							}
+							continue;
+						}
+
+						int snakeIndex = (int)NetUtils::readUint16(record + 1);
+						if (snakeIndex >= shape.snakeCount) {
+							return false;
+						}
+						if (kind == NET_RECORD_DIED) {
+							if (pass == 0) {
+								this->replica->removeSnake(snakeIndex);
+							}
+						} else if (kind == NET_RECORD_MOVED) {
+							// The run counts the snakes alive from its first one on, which the deaths before it already left the replica with
+							int runCount = (int)NetUtils::readUint16(record + 3);
+							const unsigned char* moveBytes = record + NET_MOVED_RUN_HEADER_SIZE;
+							for (int moveIndex = 0; moveIndex < runCount; moveIndex++) {
+								while ((snakeIndex < shape.snakeCount) && !this->replica->getSnakeAlive(snakeIndex)) {
+									snakeIndex++;
+								}
+								if (snakeIndex == shape.snakeCount) {
+									return false;
+								}
+								int move = (moveBytes[moveIndex / 2] >> ((moveIndex % 2) * 4)) & 0xF;
+								if ((pass == 0) && ((move & NET_MOVE_TAIL_FLAG) != 0)) {
+									this->replica->moveTail(snakeIndex);
+								} else if (pass == 1) {
+									this->replica->moveHead(snakeIndex, NetUtils::decodeDirection(move));
+								}
+								snakeIndex++;
+							}
+						} else if (pass == 1) {
+							ObjectDirection direction = NetUtils::decodeDirection(record[0] >> 2);
+							int headCell = (int)NetUtils::readUint32(record + 3);
+							int length = (int)NetUtils::readUint16(record + 7);
+							if ((length < 1) || (length > shape.snakeMaxLength)) {
+								return false;
+							}
+							this->replica->spawnSnake(snakeIndex, headCell, direction, length);
+						}
+					}
+				}
+			}
+			return true;
+		}
+
+		// Rebuild the replica from a keyframe's snakes and apples
+		bool NetClient::applyKeyframe() {
+			const NetArenaShape& shape = this->replica->getShape();
+			this->replica->clear();
+			for (int partIndex = 0; partIndex < this->pendingPartCount; partIndex++) {
+				const unsigned char* bytes = this->partBytes + ((std::size_t)partIndex * NET_MAX_DATAGRAM_SIZE);
+				int size = this->partSizes[partIndex];
+				int offset = (bytes[NET_PART_HEADER_SIZE - 1] != 0) ? NET_PART_HEADER_SIZE + NET_PART_HASH_SIZE : NET_PART_HEADER_SIZE;
+				while (offset < size) {
+					const unsigned char* record = bytes + offset;
+					int kind = record[0] & 3;
+					if (kind == NET_RECORD_APPLE) {
+						if (offset + NET_APPLE_RECORD_SIZE > size) {
+							return false;
+						}
+						this->replica->setApple((int)NetUtils::readUint32(record + 1));
+						offset += NET_APPLE_RECORD_SIZE;
+						continue;
+					}
+
+					if ((kind != NET_RECORD_SNAKE) || (offset + NET_SPAWNED_RECORD_SIZE > size)) {
+						return false;
+					}
+					int snakeIndex = (int)NetUtils::readUint16(record + 1);
+					int headCell = (int)NetUtils::readUint32(record + 3);
+					int length = (int)NetUtils::readUint16(record + 7);
+					if ((snakeIndex >= shape.snakeCount) || (length < 1) || (length > shape.snakeMaxLength)) {
+						return false;
+					}
+					int recordSize = NetUtils::resolveSnakeRecordSize(length);
+					if (offset + recordSize > size) {
+						return false;
+					}
+					this->replica->placeSnake(snakeIndex, headCell, NetUtils::decodeDirection(record[0] >> 2), length, record + NET_SPAWNED_RECORD_SIZE);
+					offset += recordSize;
+				}
+			}
+			return true;
+		}
+
+		// Compare the replica with the hash the message carried, if it carried one
+		bool NetClient::checkHash() {
+			const unsigned char* bytes = this->partBytes;
+			if (bytes[NET_PART_HEADER_SIZE - 1] == 0) {
+				return true;
+			}
+
+			this->stats.hashCheckCount++;
+			if (this->replica->computeStateHash() != NetUtils::readUint64(bytes + NET_PART_HEADER_SIZE)) {
+				this->stats.hashMismatchCount++;
+				return false;
+			}
+			return true;
+		}
+
+	}
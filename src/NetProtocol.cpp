@@ -0,0 +1,102 @@
+#include <assert.h>
+#include <string.h>
+#include "includes/netprotocol.hpp"
+
+
+	namespace snake {
+
+		// Directions in the order their two bits count them, clockwise from up
+		const ObjectDirection NET_DIRECTIONS[] = { ObjectDirection::UP, ObjectDirection::RIGHT, ObjectDirection::DOWN, ObjectDirection::LEFT };
+
+		namespace NetUtils {
+
+			// Write a 16 bit value, low byte first
+			void writeUint16(unsigned char* bytes, unsigned int value) {
+				bytes[0] = (unsigned char)(value & 0xFF);
+				bytes[1] = (unsigned char)((value >> 8) & 0xFF);
+			}
+
+			// Write a 32 bit value, low byte first
+			void writeUint32(unsigned char* bytes, std::uint32_t value) {
+				for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
+					bytes[byteIndex] = (unsigned char)((value >> (byteIndex * 8)) & 0xFF);
+				}
+			}
+
+			// Write a 64 bit value, low byte first
+			void writeUint64(unsigned char* bytes, std::uint64_t value) {
+				writeUint32(bytes, (std::uint32_t)(value & 0xFFFFFFFFULL));
+				writeUint32(bytes + 4, (std::uint32_t)(value >> 32));
+			}
+
+			// Read a value written by writeUint16()
+			unsigned int readUint16(const unsigned char* bytes) {
+				return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8);
+			}
+
+			// Read a value written by writeUint32()
+			std::uint32_t readUint32(const unsigned char* bytes) {
+				std::uint32_t result = 0;
+				for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
+					result |= (std::uint32_t)bytes[byteIndex] << (byteIndex * 8);
+				}
+				return result;
+			}
+
+			// Read a value written by writeUint64()
+			std::uint64_t readUint64(const unsigned char* bytes) {
+				return (std::uint64_t)readUint32(bytes) | ((std::uint64_t)readUint32(bytes + 4) << 32);
+			}
+
+			// Write the magic and the message type
+			int writeHeader(unsigned char* bytes, NetMessageType messageType) {
+				memcpy(bytes, NET_MAGIC, sizeof(NET_MAGIC));
+				bytes[2] = (unsigned char)messageType;
+				return NET_HEADER_SIZE;
+			}
+
+			// Check the magic and that the message type is one there is
+			bool readHeader(const unsigned char* bytes, int size, NetMessageType& messageType) {
+				if ((size < NET_HEADER_SIZE) || (memcmp(bytes, NET_MAGIC, sizeof(NET_MAGIC)) != 0) || (bytes[2] > (unsigned char)NetMessageType::KEYFRAME)) {
+					return false;
+				}
+
+				messageType = (NetMessageType)bytes[2];
+				return true;
+			}
+
+			// Get the two bits of a direction
+			int encodeDirection(ObjectDirection direction) {
+				for (int directionBits = 0; directionBits < 4; directionBits++) {
+					if (NET_DIRECTIONS[directionBits] == direction) {
+						return directionBits;
+					}
+				}
+				return 0;
+			}
+
+			// Get the direction two bits stand for
+			ObjectDirection decodeDirection(int directionBits) {
+				return NET_DIRECTIONS[directionBits & 3];
+			}
+
+			// Kind byte, snake index, head cell and length, then four steps to a byte
+			int resolveSnakeRecordSize(int length) {
+				return NET_SPAWNED_RECORD_SIZE + ((length - 1 + 3) / 4);
+			}
+
+			// The largest record is a keyframe snake at its longest and every part is at least as full as that leaves room for,
+			// apples are smaller than any snake so a field of them never takes more parts than snakes of the same bytes
+			int resolveMaxPartCount(const NetArenaShape& shape) {
+				int maxRecordSize = resolveSnakeRecordSize(shape.snakeMaxLength);
+				int partRoom = NET_MAX_DATAGRAM_SIZE - NET_PART_HEADER_SIZE - NET_PART_HASH_SIZE;
+				assert(maxRecordSize <= partRoom);
+
+				long long totalBytes = ((long long)shape.snakeCount * maxRecordSize) + ((long long)shape.appleCount * NET_APPLE_RECORD_SIZE);
+				long long result = (totalBytes / (partRoom - maxRecordSize + 1)) + 1;
+				return (int)result;
+			}
+
+		}
+
+	}
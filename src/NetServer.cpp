@@ -0,0 +1,455 @@
+#include <assert.h>
+#include <string.h>
+#include <chrono>
+#include "includes/netserver.hpp"
+
+
+	namespace snake {
+
+		// Snake indices go out as 16 bit values
+		const int NET_SERVER_MAX_SNAKE_COUNT = 0xFFFF;
+
+		// Get the two bits of the step from one cell of a snake to the next one towards its tail
+		int resolveNetStepBits(int fromCell, int toCell, int fieldWidth) {
+			int offset = toCell - fromCell;
+			ObjectDirection direction = ObjectDirection::LEFT;
+			if (offset == -fieldWidth) {
+				direction = ObjectDirection::UP;
+			} else if (offset == fieldWidth) {
+				direction = ObjectDirection::DOWN;
+			} else if (offset == 1) {
+				direction = ObjectDirection::RIGHT;
+			}
+			return NetUtils::encodeDirection(direction);
+		}
+
+		// Constructor for NetServer, the arena's first snakes are the players' and every buffer is sized for its shape
+		NetServer::NetServer(const NetServerSettings& settings) {
+			assert((settings.arenaDefn.snakeCount <= NET_SERVER_MAX_SNAKE_COUNT) && (settings.arenaDefn.playerSnakeCount > 0));
+			assert(settings.hashIntervalTicks > 0);
+
+			this->settings = settings;
+			this->arena = new ArenaGame(settings.arenaDefn);
+			this->shape.fieldSize = settings.arenaDefn.fieldSize;
+			this->shape.snakeCount = settings.arenaDefn.snakeCount;
+			this->shape.snakeMaxLength = settings.arenaDefn.snakeMaxLength;
+			this->shape.appleCount = settings.arenaDefn.appleCount;
+			this->socket.setBlocking(false);
+
+			this->clientCount = 0;
+			this->clients = new NetServerClient[settings.arenaDefn.playerSnakeCount];
+			for (int clientIndex = 0; clientIndex < settings.arenaDefn.playerSnakeCount; clientIndex++) {
+				this->clients[clientIndex].connectedFlag = false;
+				this->clients[clientIndex].keyframeRequestedFlag = false;
+				this->clients[clientIndex].port = 0;
+				this->clients[clientIndex].lastHeardTick = 0;
+			}
+
+			this->publishedAliveFlags = new bool[this->shape.snakeCount];
+			this->publishedTailSlots = new int[this->shape.snakeCount];
+			this->publishSnakes();
+
+			this->partCapacity = NetUtils::resolveMaxPartCount(this->shape);
+			this->partBytes = new unsigned char[(std::size_t)this->partCapacity * NET_MAX_DATAGRAM_SIZE];
+			this->partSizes = new int[this->partCapacity];
+			this->partCount = 0;
+			this->receiveBytes = new unsigned char[NET_MAX_DATAGRAM_SIZE];
+		}
+
+		// Destructor for NetServer
+		NetServer::~NetServer() {
+			this->socket.unbind();
+			delete this->arena;
+			delete[] this->clients;
+			delete[] this->publishedAliveFlags;
+			delete[] this->publishedTailSlots;
+			delete[] this->partBytes;
+			delete[] this->partSizes;
+			delete[] this->receiveBytes;
+		}
+
+		// Bind the socket the clients send to
+		bool NetServer::start() {
+			return this->socket.bind(this->settings.port) == sf::Socket::Done;
+		}
+
+		// Take in the clients' messages, catch up the clients that need a keyframe, then advance the arena and send what changed
+		NetServerTickStats NetServer::tick() {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			NetServerTickStats result;
+			result.sentBytes = 0;
+			result.keyframeCount = 0;
+			this->receiveMessages();
+			this->dropIdleClients();
+			this->sendKeyframes(result);
+
+			ArenaTickStats arenaStats = this->arena->update();
+			result.simulationSeconds = arenaStats.tickSeconds;
+
+			this->encodeDelta();
+			result.deltaPartCount = this->partCount;
+			result.deltaBytes = 0;
+			for (int clientIndex = 0; clientIndex < this->settings.arenaDefn.playerSnakeCount; clientIndex++) {
+				if (this->clients[clientIndex].connectedFlag) {
+					result.deltaBytes = (int)this->sendParts(clientIndex);
+					result.sentBytes += result.deltaBytes;
+				}
+			}
+
+			result.tick = this->arena->getTickCount();
+			result.clientCount = this->clientCount;
+			result.tickSeconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / 1e9;
+			return result;
+		}
+
+		// Say goodbye to every client so they stop waiting for ticks
+		void NetServer::stop() {
+			unsigned char bytes[NET_HEADER_SIZE];
+			NetUtils::writeHeader(bytes, NetMessageType::BYE);
+			for (int clientIndex = 0; clientIndex < this->settings.arenaDefn.playerSnakeCount; clientIndex++) {
+				if (this->clients[clientIndex].connectedFlag) {
+					this->sendMessage(clientIndex, bytes, NET_HEADER_SIZE);
+					this->clients[clientIndex].connectedFlag = false;
+				}
+			}
+			this->clientCount = 0;
+			this->socket.unbind();
+		}
+
+		// Get the arena being played
+		const ArenaGame& NetServer::getArena() const {
+			return *this->arena;
+		}
+
+		// Get the port the socket is bound to, which is the one picked when the settings asked for any
+		unsigned short NetServer::getPort() const {
+			return this->socket.getLocalPort();
+		}
+
+		// Get the number of connected clients
+		int NetServer::getClientCount() const {
+			return this->clientCount;
+		}
+
+		// Read datagrams until none are waiting, anything malformed is dropped
+		void NetServer::receiveMessages() {
+			std::size_t receivedSize = 0;
+			sf::IpAddress address;
+			unsigned short port = 0;
+			while (this->socket.receive(this->receiveBytes, NET_MAX_DATAGRAM_SIZE, receivedSize, address, port) == sf::Socket::Done) {
+				NetMessageType messageType;
+				if (NetUtils::readHeader(this->receiveBytes, (int)receivedSize, messageType)) {
+					this->handleMessage(messageType, this->receiveBytes, (int)receivedSize, address, port);
+				}
+			}
+		}
+
+		// Act on one message from a client
+		void NetServer::handleMessage(NetMessageType messageType, const unsigned char* bytes, int size, const sf::IpAddress& address, unsigned short port) {
+			int clientIndex = this->findClient(address, port);
+			if (clientIndex >= 0) {
+				this->clients[clientIndex].lastHeardTick = this->arena->getTickCount();
+			}
+
+			if (messageType == NetMessageType::HELLO) {
+				if ((size < NET_HELLO_SIZE) || (NetUtils::readUint32(bytes + NET_HEADER_SIZE) != NET_PROTOCOL_VERSION)) {
+					return;
+				}
+
+				// A repeated hello is a client whose welcome got lost, it keeps its snake
+				if (clientIndex < 0) {
+					for (int slot = 0; slot < this->settings.arenaDefn.playerSnakeCount; slot++) {
+						if (!this->clients[slot].connectedFlag) {
+							clientIndex = slot;
+							break;
+						}
+					}
+					if (clientIndex < 0) {
+						unsigned char fullBytes[NET_HEADER_SIZE];
+						NetUtils::writeHeader(fullBytes, NetMessageType::SERVER_FULL);
+						this->socket.send(fullBytes, NET_HEADER_SIZE, address, port);
+						return;
+					}
+
+					NetServerClient& client = this->clients[clientIndex];
+					client.connectedFlag = true;
+					client.address = address;
+					client.port = port;
+					client.lastHeardTick = this->arena->getTickCount();
+					this->clientCount++;
+				}
+
+				unsigned char welcomeBytes[NET_WELCOME_SIZE];
+				int offset = NetUtils::writeHeader(welcomeBytes, NetMessageType::WELCOME);
+				NetUtils::writeUint16(welcomeBytes + offset, (unsigned int)clientIndex);
+				offset += 2;
+				NetUtils::writeUint32(welcomeBytes + offset, (std::uint32_t)this->shape.fieldSize.x);
+				NetUtils::writeUint32(welcomeBytes + offset + 4, (std::uint32_t)this->shape.fieldSize.y);
+				NetUtils::writeUint32(welcomeBytes + offset + 8, (std::uint32_t)this->shape.snakeCount);
+				NetUtils::writeUint32(welcomeBytes + offset + 12, (std::uint32_t)this->shape.snakeMaxLength);
+				NetUtils::writeUint32(welcomeBytes + offset + 16, (std::uint32_t)this->shape.appleCount);
+				NetUtils::writeUint32(welcomeBytes + offset + 20, (std::uint32_t)this->arena->getTickCount());
+				this->sendMessage(clientIndex, welcomeBytes, NET_WELCOME_SIZE);
+				this->clients[clientIndex].keyframeRequestedFlag = true;
+				return;
+			}
+
+			if (clientIndex < 0) {
+				return;
+			}
+
+			if (messageType == NetMessageType::INPUT) {
+				if ((size >= NET_INPUT_SIZE) && (bytes[NET_HEADER_SIZE] >= (unsigned char)ObjectDirection::UP) && (bytes[NET_HEADER_SIZE] <= (unsigned char)ObjectDirection::LEFT)) {
+					this->arena->setSnakeInput(clientIndex, (ObjectDirection)bytes[NET_HEADER_SIZE]);
+				}
+			} else if (messageType == NetMessageType::RESYNC) {
+				this->clients[clientIndex].keyframeRequestedFlag = true;
+			} else if (messageType == NetMessageType::BYE) {
+				this->clients[clientIndex].connectedFlag = false;
+				this->clients[clientIndex].keyframeRequestedFlag = false;
+				this->clientCount--;
+			}
+		}
+
+		// Find the connected client sending from an address and port, -1 when it is not one
+		int NetServer::findClient(const sf::IpAddress& address, unsigned short port) const {
+			for (int clientIndex = 0; clientIndex < this->settings.arenaDefn.playerSnakeCount; clientIndex++) {
+				const NetServerClient& client = this->clients[clientIndex];
+				if (client.connectedFlag && (client.port == port) && (client.address == address)) {
+					return clientIndex;
+				}
+			}
+			return -1;
+		}
+
+		// Forget clients that went quiet, their snakes carry on straight ahead until a new client takes them
+		void NetServer::dropIdleClients() {
+			int tick = this->arena->getTickCount();
+			for (int clientIndex = 0; clientIndex < this->settings.arenaDefn.playerSnakeCount; clientIndex++) {
+				NetServerClient& client = this->clients[clientIndex];
+				if (client.connectedFlag && (tick - client.lastHeardTick > this->settings.clientTimeoutTicks)) {
+					client.connectedFlag = false;
+					client.keyframeRequestedFlag = false;
+					this->clientCount--;
+				}
+			}
+		}
+
+		// Encode the arena once if any client asked for it and send it to each of them
+		void NetServer::sendKeyframes(NetServerTickStats& stats) {
+			bool encodedFlag = false;
+			for (int clientIndex = 0; clientIndex < this->settings.arenaDefn.playerSnakeCount; clientIndex++) {
+				NetServerClient& client = this->clients[clientIndex];
+				if (!client.connectedFlag || !client.keyframeRequestedFlag) {
+					continue;
+				}
+				if (!encodedFlag) {
+					this->encodeKeyframe();
+					encodedFlag = true;
+				}
+				stats.sentBytes += this->sendParts(clientIndex);
+				stats.keyframeCount++;
+				client.keyframeRequestedFlag = false;
+			}
+		}
+
+		// Send every encoded part to a client, returns the bytes sent
+		long long NetServer::sendParts(int clientIndex) {
+			long long result = 0;
+			for (int partIndex = 0; partIndex < this->partCount; partIndex++) {
+				this->sendMessage(clientIndex, this->partBytes + ((std::size_t)partIndex * NET_MAX_DATAGRAM_SIZE), this->partSizes[partIndex]);
+				result += this->partSizes[partIndex];
+			}
+			return result;
+		}
+
+		// Send one datagram to a client, a full socket buffer drops it like the network would
+		void NetServer::sendMessage(int clientIndex, const unsigned char* bytes, int size) {
+			const NetServerClient& client = this->clients[clientIndex];
+			this->socket.send(bytes, (std::size_t)size, client.address, client.port);
+		}
+
+		// Start the first part of a delta or keyframe, the part count is filled in by finishParts()
+		void NetServer::beginParts(NetMessageType messageType, int tick, bool hashFlag, std::uint64_t stateHash) {
+			unsigned char* bytes = this->partBytes;
+			int offset = NetUtils::writeHeader(bytes, messageType);
+			NetUtils::writeUint32(bytes + offset, (std::uint32_t)tick);
+			NetUtils::writeUint16(bytes + offset + 4, 0);
+			NetUtils::writeUint16(bytes + offset + 6, 0);
+			bytes[offset + 8] = hashFlag ? 1 : 0;
+			offset = NET_PART_HEADER_SIZE;
+			if (hashFlag) {
+				NetUtils::writeUint64(bytes + offset, stateHash);
+				offset += NET_PART_HASH_SIZE;
+			}
+			this->partSizes[0] = offset;
+			this->partCount = 1;
+		}
+
+		// Start another part with the first part's header and its own index
+		void NetServer::startPart() {
+			assert(this->partCount < this->partCapacity);
+			int headerSize = (this->partBytes[NET_PART_HEADER_SIZE - 1] != 0) ? NET_PART_HEADER_SIZE + NET_PART_HASH_SIZE : NET_PART_HEADER_SIZE;
+			unsigned char* bytes = this->partBytes + ((std::size_t)this->partCount * NET_MAX_DATAGRAM_SIZE);
+			memcpy(bytes, this->partBytes, (std::size_t)headerSize);
+			NetUtils::writeUint16(bytes + NET_HEADER_SIZE + 4, (unsigned int)this->partCount);
+			this->partSizes[this->partCount] = headerSize;
+			this->partCount++;
+		}
+
+		// Get the bytes left in the last part
+		int NetServer::resolvePartRoom() const {
+			return NET_MAX_DATAGRAM_SIZE - this->partSizes[this->partCount - 1];
+		}
+
+		// Get room for a record at the end of the last part, starting a new part when it does not fit
+		unsigned char* NetServer::reserveRecord(int recordSize) {
+			if (this->resolvePartRoom() < recordSize) {
+				this->startPart();
+			}
+
+			int partIndex = this->partCount - 1;
+			unsigned char* result = this->partBytes + ((std::size_t)partIndex * NET_MAX_DATAGRAM_SIZE) + this->partSizes[partIndex];
+			this->partSizes[partIndex] += recordSize;
+			return result;
+		}
+
+		// Write the part count into every part
+		void NetServer::finishParts() {
+			for (int partIndex = 0; partIndex < this->partCount; partIndex++) {
+				NetUtils::writeUint16(this->partBytes + ((std::size_t)partIndex * NET_MAX_DATAGRAM_SIZE) + NET_HEADER_SIZE + 6, (unsigned int)this->partCount);
+			}
+		}
+
+		// Encode every live snake with its whole body and every apple, always with the hash so the client knows it caught up
+		void NetServer::encodeKeyframe() {
+			this->beginParts(NetMessageType::KEYFRAME, this->arena->getTickCount(), true, this->arena->computeStateHash());
+
+			int fieldWidth = this->shape.fieldSize.x;
+			for (int snakeIndex = 0; snakeIndex < this->shape.snakeCount; snakeIndex++) {
+				const ArenaSnake& snake = this->arena->getSnake(snakeIndex);
+				if (!snake.aliveFlag) {
+					continue;
+				}
+
+				unsigned char* record = this->reserveRecord(NetUtils::resolveSnakeRecordSize(snake.length));
+				sf::Vector2i headPosition = this->arena->getSnakeCell(snakeIndex, 0);
+				int cellIndex = (headPosition.y * fieldWidth) + headPosition.x;
+				record[0] = (unsigned char)(NET_RECORD_SNAKE | (NetUtils::encodeDirection(snake.direction) << 2));
+				NetUtils::writeUint16(record + 1, (unsigned int)snakeIndex);
+				NetUtils::writeUint32(record + 3, (std::uint32_t)cellIndex);
+				NetUtils::writeUint16(record + 7, (unsigned int)snake.length);
+
+				unsigned char* stepBytes = record + NET_SPAWNED_RECORD_SIZE;
+				memset(stepBytes, 0, (std::size_t)((snake.length - 1 + 3) / 4));
+				for (int segmentIndex = 0; segmentIndex + 1 < snake.length; segmentIndex++) {
+					sf::Vector2i nextPosition = this->arena->getSnakeCell(snakeIndex, segmentIndex + 1);
+					int nextCellIndex = (nextPosition.y * fieldWidth) + nextPosition.x;
+					stepBytes[segmentIndex / 4] |= (unsigned char)(resolveNetStepBits(cellIndex, nextCellIndex, fieldWidth) << ((segmentIndex % 4) * 2));
+					cellIndex = nextCellIndex;
+				}
+			}
+
+			for (int y = 1; y < this->shape.fieldSize.y - 1; y++) {
+				for (int x = 1; x < fieldWidth - 1; x++) {
+					if (this->arena->getAppleAt(sf::Vector2i(x, y))) {
+						unsigned char* record = this->reserveRecord(NET_APPLE_RECORD_SIZE);
+						record[0] = (unsigned char)NET_RECORD_APPLE;
+						NetUtils::writeUint32(record + 1, (std::uint32_t)((y * fieldWidth) + x));
+					}
+				}
+			}
+
+			this->finishParts();
+			this->publishSnakes();
+		}
+
+		// Encode what the last tick changed against what the clients were last sent: deaths, moves, spawns and new apples in that order
+		void NetServer::encodeDelta() {
+			int tick = this->arena->getTickCount();
+			bool hashFlag = (tick % this->settings.hashIntervalTicks) == 0;
+			this->beginParts(NetMessageType::DELTA, tick, hashFlag, hashFlag ? this->arena->computeStateHash() : 0);
+
+			for (int snakeIndex = 0; snakeIndex < this->shape.snakeCount; snakeIndex++) {
+				if (this->publishedAliveFlags[snakeIndex] && !this->arena->getSnake(snakeIndex).aliveFlag) {
+					unsigned char* record = this->reserveRecord(NET_DIED_RECORD_SIZE);
+					record[0] = (unsigned char)NET_RECORD_DIED;
+					NetUtils::writeUint16(record + 1, (unsigned int)snakeIndex);
+				}
+			}
+
+			// Each run of moves takes as many survivors as fit in what is left of the part, starting a part when not even two would
+			int runStart = 0;
+			while (true) {
+				while ((runStart < this->shape.snakeCount) && !(this->publishedAliveFlags[runStart] && this->arena->getSnake(runStart).aliveFlag)) {
+					runStart++;
+				}
+				if (runStart == this->shape.snakeCount) {
+					break;
+				}
+
+				if (this->resolvePartRoom() < NET_MOVED_RUN_HEADER_SIZE + 1) {
+					this->startPart();
+				}
+				int runCapacity = (this->resolvePartRoom() - NET_MOVED_RUN_HEADER_SIZE) * 2;
+				int runCount = 0;
+				int runEnd = runStart;
+				for (; (runEnd < this->shape.snakeCount) && (runCount < runCapacity); runEnd++) {
+					if (this->publishedAliveFlags[runEnd] && this->arena->getSnake(runEnd).aliveFlag) {
+						runCount++;
+					}
+				}
+
+				unsigned char* record = this->reserveRecord(NET_MOVED_RUN_HEADER_SIZE + ((runCount + 1) / 2));
+				record[0] = (unsigned char)NET_RECORD_MOVED;
+				NetUtils::writeUint16(record + 1, (unsigned int)runStart);
+				NetUtils::writeUint16(record + 3, (unsigned int)runCount);
+				unsigned char* moveBytes = record + NET_MOVED_RUN_HEADER_SIZE;
+				memset(moveBytes, 0, (std::size_t)((runCount + 1) / 2));
+				int moveIndex = 0;
+				for (int snakeIndex = runStart; snakeIndex < runEnd; snakeIndex++) {
+					const ArenaSnake& snake = this->arena->getSnake(snakeIndex);
+					if (this->publishedAliveFlags[snakeIndex] && snake.aliveFlag) {
+						int tailFlag = (snake.tailSlot != this->publishedTailSlots[snakeIndex]) ? NET_MOVE_TAIL_FLAG : 0;
+						moveBytes[moveIndex / 2] |= (unsigned char)((NetUtils::encodeDirection(snake.direction) | tailFlag) << ((moveIndex % 2) * 4));
+						moveIndex++;
+					}
+				}
+				runStart = runEnd;
+			}
+
+			int fieldWidth = this->shape.fieldSize.x;
+			for (int snakeIndex = 0; snakeIndex < this->shape.snakeCount; snakeIndex++) {
+				const ArenaSnake& snake = this->arena->getSnake(snakeIndex);
+				if (!this->publishedAliveFlags[snakeIndex] && snake.aliveFlag) {
+					unsigned char* record = this->reserveRecord(NET_SPAWNED_RECORD_SIZE);
+					sf::Vector2i headPosition = this->arena->getSnakeCell(snakeIndex, 0);
+					record[0] = (unsigned char)(NET_RECORD_SPAWNED | (NetUtils::encodeDirection(snake.direction) << 2));
+					NetUtils::writeUint16(record + 1, (unsigned int)snakeIndex);
+					NetUtils::writeUint32(record + 3, (std::uint32_t)((headPosition.y * fieldWidth) + headPosition.x));
+					NetUtils::writeUint16(record + 7, (unsigned int)snake.length);
+				}
+			}
+
+			for (int appleIndex = 0; appleIndex < this->arena->getSpawnedAppleCount(); appleIndex++) {
+				sf::Vector2i position = this->arena->getSpawnedApple(appleIndex);
+				unsigned char* record = this->reserveRecord(NET_APPLE_RECORD_SIZE);
+				record[0] = (unsigned char)NET_RECORD_APPLE;
+				NetUtils::writeUint32(record + 1, (std::uint32_t)((position.y * fieldWidth) + position.x));
+			}
+
+			this->finishParts();
+			this->publishSnakes();
+		}
+
+		// Remember every snake as it was just sent
+		void NetServer::publishSnakes() {
+			for (int snakeIndex = 0; snakeIndex < this->shape.snakeCount; snakeIndex++) {
+				const ArenaSnake& snake = this->arena->getSnake(snakeIndex);
+				this->publishedAliveFlags[snakeIndex] = snake.aliveFlag;
+				this->publishedTailSlots[snakeIndex] = snake.tailSlot;
+			}
+		}
+
+	}
@@ -0,0 +1,410 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include "includes/neuroevolution.hpp"
+
+
+	namespace snake {
+
+		// Every checkpoint file starts with these bytes
+		const char NEURO_CHECKPOINT_MAGIC[4] = { 'S', 'N', 'K', 'N' };
+		// Version of the checkpoint layout, bumped whenever the layout or the network shape changes
+		const unsigned int NEURO_CHECKPOINT_VERSION = 1;
+		// Size of the header: magic, version, seed, generation, population size and weights per genome, followed by every weight
+		const int NEURO_CHECKPOINT_HEADER_SIZE = 4 + (4 * 5);
+
+		// Snakes move every frame, so one update is one move
+		const float NEURO_SNAKE_SPEED = 60.0f;
+		const int NEURO_SNAKE_LENGTH = 3;
+
+		// A game ends once the snake has gone this many field widths plus heights without eating, so circling forever does not pay
+		const int NEURO_STARVATION_FIELD_SPANS = 2;
+
+		// Fitness of a game is the apples eaten plus a little for every move survived
+		const float NEURO_MOVE_FITNESS = 0.001f;
+
+		// Standard deviation of the weights of the first generation
+		const float NEURO_INITIAL_WEIGHT_SPREAD = 0.5f;
+
+		// Genomes drawn for each tournament that picks a parent
+		const int NEURO_TOURNAMENT_SIZE = 3;
+
+		// Directions in clockwise order, turning right moves one along and turning left one back
+		const ObjectDirection NEURO_CLOCKWISE_DIRECTIONS[] = { ObjectDirection::UP, ObjectDirection::RIGHT, ObjectDirection::DOWN, ObjectDirection::LEFT };
+
+		// Write a 32 bit value in little endian order
+		void writeNeuroWord(unsigned char* bytes, unsigned int value) {
+			bytes[0] = (unsigned char)(value & 0xFF);
+			bytes[1] = (unsigned char)((value >> 8) & 0xFF);
+			bytes[2] = (unsigned char)((value >> 16) & 0xFF);
+			bytes[3] = (unsigned char)((value >> 24) & 0xFF);
+		}
+
+		// Read a 32 bit value in little endian order
+		unsigned int readNeuroWord(const unsigned char* bytes) {
+			unsigned int result =
+				((unsigned int)bytes[0]) |
+				((unsigned int)bytes[1] << 8) |
+				((unsigned int)bytes[2] << 16) |
+				((unsigned int)bytes[3] << 24);
+			return result;
+		}
+
+		namespace NeuralPolicy {
+
+			// Turn a direction a quarter clockwise, or anticlockwise with a negative count
+			ObjectDirection turnDirection(ObjectDirection direction, int quarterTurns) {
+				int directionIndex = (int)direction - (int)ObjectDirection::UP;
+				return NEURO_CLOCKWISE_DIRECTIONS[(directionIndex + quarterTurns + 4) % 4];
+			}
+
+			// Get how near the first wall or body cell is along a direction from the head, 1 when it is next to the head
+			float resolveObstacleNearness(const QuickGame& game, ObjectDirection direction) {
+				sf::Vector2i fieldSize = game.getFieldSize();
+				Snake* snake = game.getSnake();
+				sf::Vector2i step = SnakeUtils::directionToVector(direction);
+				sf::Vector2i position = snake->getHead().position + step;
+
+				int distance = 1;
+				while ((position.x > 0) && (position.y > 0) && (position.x < fieldSize.x - 1) && (position.y < fieldSize.y - 1) && !snake->bodyOccupiesPosition(position)) {
+					position += step;
+					distance++;
+				}
+				return 1.0f / (float)distance;
+			}
+
+			// Fill the inputs for the snake's current heading
+			void resolveInputs(const QuickGame& game, float* inputs) {
+				SnakeSegment head = game.getSnake()->getHead();
+				ObjectDirection leftDirection = turnDirection(head.enterDirection, -1);
+				ObjectDirection rightDirection = turnDirection(head.enterDirection, 1);
+
+				inputs[0] = resolveObstacleNearness(game, head.enterDirection);
+				inputs[1] = resolveObstacleNearness(game, leftDirection);
+				inputs[2] = resolveObstacleNearness(game, rightDirection);
+
+				// The apple is missing for the one frame after it is eaten
+				inputs[3] = 0.0f;
+				inputs[4] = 0.0f;
+				if (game.getAppleExists()) {
+					sf::Vector2i offset = game.getApplePosition() - head.position;
+					sf::Vector2i forward = SnakeUtils::directionToVector(head.enterDirection);
+					sf::Vector2i right = SnakeUtils::directionToVector(rightDirection);
+					float distance = sqrtf((float)((offset.x * offset.x) + (offset.y * offset.y)));
+					inputs[3] = (float)((offset.x * forward.x) + (offset.y * forward.y)) / distance;
+					inputs[4] = (float)((offset.x * right.x) + (offset.y * right.y)) / distance;
+				}
+			}
+
+			// Run the network and turn the highest scoring output into a direction
+			ObjectDirection resolveDirection(const float* weights, const QuickGame& game) {
+				float inputs[NEURAL_POLICY_INPUT_COUNT];
+				resolveInputs(game, inputs);
+
+				float hidden[NEURAL_POLICY_HIDDEN_COUNT];
+				const float* weight = weights;
+				for (int hiddenIndex = 0; hiddenIndex < NEURAL_POLICY_HIDDEN_COUNT; hiddenIndex++) {
+					float sum = 0.0f;
+					for (int inputIndex = 0; inputIndex < NEURAL_POLICY_INPUT_COUNT; inputIndex++) {
+						sum += inputs[inputIndex] * (*weight++);
+					}
+					sum += *weight++;
+					hidden[hiddenIndex] = tanhf(sum);
+				}
+
+				int bestOutputIndex = 0;
+				float bestOutput = 0.0f;
+				for (int outputIndex = 0; outputIndex < NEURAL_POLICY_OUTPUT_COUNT; outputIndex++) {
+					float sum = 0.0f;
+					for (int hiddenIndex = 0; hiddenIndex < NEURAL_POLICY_HIDDEN_COUNT; hiddenIndex++) {
+						sum += hidden[hiddenIndex] * (*weight++);
+					}
+					sum += *weight++;
+					if ((outputIndex == 0) || (sum > bestOutput)) {
+						bestOutput = sum;
+						bestOutputIndex = outputIndex;
+					}
+				}
+
+				// Outputs are straight on, left and right
+				const int quarterTurns[NEURAL_POLICY_OUTPUT_COUNT] = { 0, -1, 1 };
+				return turnDirection(game.getSnake()->getHead().enterDirection, quarterTurns[bestOutputIndex]);
+			}
+
+		}
+
+		// Constructor for NeuroEvolution, every buffer and scratch game is made here so generations do not allocate
+		NeuroEvolution::NeuroEvolution(const NeuroEvolutionSettings& settings) {
+			assert(settings.populationSize > 0);
+			assert((settings.eliteCount >= 0) && (settings.eliteCount <= settings.populationSize));
+			assert(settings.gamesPerGenome > 0);
+
+			this->settings = settings;
+			this->pool = new WorkStealingPool(settings.workerCount, settings.populationSize);
+
+			this->gameDefn.fieldSize = settings.fieldSize;
+			this->gameDefn.snakeSpeedTilesPerSecond = NEURO_SNAKE_SPEED;
+			this->gameDefn.snakeStartDefn.headPosition = sf::Vector2i(settings.fieldSize.x / 2, settings.fieldSize.y / 2);
+			this->gameDefn.snakeStartDefn.facingDirection = ObjectDirection::DOWN;
+			this->gameDefn.snakeStartDefn.length = NEURO_SNAKE_LENGTH;
+			this->gameDefn.randomSeed = settings.seed;
+
+			this->workers = new NeuroWorker[settings.workerCount];
+			for (int workerIndex = 0; workerIndex < settings.workerCount; workerIndex++) {
+				this->workers[workerIndex].game = new QuickGame(&this->gameDefn);
+			}
+
+			int weightCount = settings.populationSize * NEURAL_POLICY_WEIGHT_COUNT;
+			this->genomes = new float[weightCount];
+			this->nextGenomes = new float[weightCount];
+			this->fitness = new float[settings.populationSize];
+			this->meanApples = new float[settings.populationSize];
+			this->rankedGenomes = new int[settings.populationSize];
+
+			this->initializePopulation();
+		}
+
+		// Destructor for NeuroEvolution, the threads stop before the games they play are freed
+		NeuroEvolution::~NeuroEvolution() {
+			delete this->pool;
+
+			for (int workerIndex = 0; workerIndex < this->settings.workerCount; workerIndex++) {
+				delete this->workers[workerIndex].game;
+			}
+			delete[] this->workers;
+
+			delete[] this->genomes;
+			delete[] this->nextGenomes;
+			delete[] this->fitness;
+			delete[] this->meanApples;
+			delete[] this->rankedGenomes;
+		}
+
+		// Evaluate the population on the workers, then breed the next one
+		NeuroGenerationStats NeuroEvolution::runGeneration() {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			// Every genome's index is one task, the same list breeding later sorts into rank order
+			for (int genomeIndex = 0; genomeIndex < this->settings.populationSize; genomeIndex++) {
+				this->rankedGenomes[genomeIndex] = genomeIndex;
+			}
+			this->pool->run(*this, this->rankedGenomes, this->settings.populationSize);
+
+			NeuroGenerationStats result;
+			result.generation = this->generation;
+			result.bestFitness = this->fitness[0];
+			result.meanFitness = 0.0f;
+			result.bestMeanApples = this->meanApples[0];
+			for (int genomeIndex = 0; genomeIndex < this->settings.populationSize; genomeIndex++) {
+				result.meanFitness += this->fitness[genomeIndex];
+				if (this->fitness[genomeIndex] > result.bestFitness) {
+					result.bestFitness = this->fitness[genomeIndex];
+					result.bestMeanApples = this->meanApples[genomeIndex];
+				}
+			}
+			result.meanFitness /= (float)this->settings.populationSize;
+			result.evaluationSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			this->breed();
+			return result;
+		}
+
+		// Save the population with its seed and generation
+		bool NeuroEvolution::saveCheckpoint(const char* path) const {
+			FILE* file = fopen(path, "wb");
+			if (file == nullptr) {
+				return false;
+			}
+
+			unsigned char header[NEURO_CHECKPOINT_HEADER_SIZE];
+			memcpy(header, NEURO_CHECKPOINT_MAGIC, 4);
+			writeNeuroWord(header + 4, NEURO_CHECKPOINT_VERSION);
+			writeNeuroWord(header + 8, this->settings.seed);
+			writeNeuroWord(header + 12, (unsigned int)this->generation);
+			writeNeuroWord(header + 16, (unsigned int)this->settings.populationSize);
+			writeNeuroWord(header + 20, (unsigned int)NEURAL_POLICY_WEIGHT_COUNT);
+			bool result = (fwrite(header, 1, NEURO_CHECKPOINT_HEADER_SIZE, file) == (size_t)NEURO_CHECKPOINT_HEADER_SIZE);
+
+			unsigned char word[4];
+			int weightCount = this->settings.populationSize * NEURAL_POLICY_WEIGHT_COUNT;
+			for (int weightIndex = 0; result && (weightIndex < weightCount); weightIndex++) {
+				unsigned int bits;
+				memcpy(&bits, &this->genomes[weightIndex], 4);
+				writeNeuroWord(word, bits);
+				result = (fwrite(word, 1, 4, file) == 4);
+			}
+
+			result = (fclose(file) == 0) && result;
+			return result;
+		}
+
+		// Load a population saved by saveCheckpoint() into the next generation's buffer first, so a bad file changes nothing
+		bool NeuroEvolution::loadCheckpoint(const char* path) {
+			FILE* file = fopen(path, "rb");
+			if (file == nullptr) {
+				return false;
+			}
+
+			unsigned char header[NEURO_CHECKPOINT_HEADER_SIZE];
+			bool result = (fread(header, 1, NEURO_CHECKPOINT_HEADER_SIZE, file) == (size_t)NEURO_CHECKPOINT_HEADER_SIZE);
+			result = result && (memcmp(header, NEURO_CHECKPOINT_MAGIC, 4) == 0);
+			result = result && (readNeuroWord(header + 4) == NEURO_CHECKPOINT_VERSION);
+			result = result && (readNeuroWord(header + 8) == this->settings.seed);
+			result = result && ((int)readNeuroWord(header + 16) == this->settings.populationSize);
+			result = result && (readNeuroWord(header + 20) == (unsigned int)NEURAL_POLICY_WEIGHT_COUNT);
+			int loadedGeneration = result ? (int)readNeuroWord(header + 12) : 0;
+
+			unsigned char word[4];
+			int weightCount = this->settings.populationSize * NEURAL_POLICY_WEIGHT_COUNT;
+			for (int weightIndex = 0; result && (weightIndex < weightCount); weightIndex++) {
+				result = (fread(word, 1, 4, file) == 4);
+				unsigned int bits = readNeuroWord(word);
+				memcpy(&this->nextGenomes[weightIndex], &bits, 4);
+				result = result && std::isfinite(this->nextGenomes[weightIndex]);
+			}
+			fclose(file);
+
+			if (result) {
+				std::swap(this->genomes, this->nextGenomes);
+				this->generation = loadedGeneration;
+			}
+			return result;
+		}
+
+		// Get the number of the generation that plays next
+		int NeuroEvolution::getGeneration() const {
+			return this->generation;
+		}
+
+		// Get a genome's weights, after a generation genome 0 is the best of the one before
+		const float* NeuroEvolution::getGenome(int genomeIndex) const {
+			return this->genomes + (genomeIndex * NEURAL_POLICY_WEIGHT_COUNT);
+		}
+
+		// Get the settings the population evolves with
+		const NeuroEvolutionSettings& NeuroEvolution::getSettings() const {
+			return this->settings;
+		}
+
+		// Play every game of one genome, the same seeds for every genome of a generation
+		void NeuroEvolution::runTask(WorkStealingPool&, int workerIndex, int taskArgument) {
+			NeuroWorker& worker = this->workers[workerIndex];
+			const float* weights = this->getGenome(taskArgument);
+
+			float fitnessSum = 0.0f;
+			int appleSum = 0;
+			for (int gameIndex = 0; gameIndex < this->settings.gamesPerGenome; gameIndex++) {
+				int applesEaten = 0;
+				fitnessSum += this->playGame(worker, weights, this->resolveGameSeed(gameIndex), &applesEaten);
+				appleSum += applesEaten;
+			}
+
+			this->fitness[taskArgument] = fitnessSum / (float)this->settings.gamesPerGenome;
+			this->meanApples[taskArgument] = (float)appleSum / (float)this->settings.gamesPerGenome;
+		}
+
+		// Fill the first generation with random weights
+		void NeuroEvolution::initializePopulation() {
+			std::mt19937 randomizer(this->settings.seed);
+			std::normal_distribution<float> weightDistribution(0.0f, NEURO_INITIAL_WEIGHT_SPREAD);
+
+			int weightCount = this->settings.populationSize * NEURAL_POLICY_WEIGHT_COUNT;
+			for (int weightIndex = 0; weightIndex < weightCount; weightIndex++) {
+				this->genomes[weightIndex] = weightDistribution(randomizer);
+			}
+			this->generation = 0;
+		}
+
+		// Rank the evaluated genomes, keep the elite in rank order and fill the rest with mutated crossovers of tournament winners
+		void NeuroEvolution::breed() {
+			const float* genomeFitness = this->fitness;
+			std::sort(this->rankedGenomes, this->rankedGenomes + this->settings.populationSize, [genomeFitness](int left, int right) {
+				if (genomeFitness[left] != genomeFitness[right]) {
+					return genomeFitness[left] > genomeFitness[right];
+				}
+				return left < right;
+			});
+
+			std::mt19937 randomizer(this->settings.seed ^ ((unsigned int)(this->generation + 1) * 2654435761u));
+			std::uniform_real_distribution<float> unitDistribution(0.0f, 1.0f);
+			std::normal_distribution<float> mutationDistribution(0.0f, this->settings.mutationStrength);
+
+			for (int childIndex = 0; childIndex < this->settings.populationSize; childIndex++) {
+				float* child = this->nextGenomes + (childIndex * NEURAL_POLICY_WEIGHT_COUNT);
+				if (childIndex < this->settings.eliteCount) {
+					memcpy(child, this->getGenome(this->rankedGenomes[childIndex]), NEURAL_POLICY_WEIGHT_COUNT * sizeof(float));
+					continue;
+				}
+
+				const float* firstParent = this->getGenome(this->selectParent(randomizer));
+				const float* secondParent = this->getGenome(this->selectParent(randomizer));
+				for (int weightIndex = 0; weightIndex < NEURAL_POLICY_WEIGHT_COUNT; weightIndex++) {
+					child[weightIndex] = (unitDistribution(randomizer) < 0.5f) ? firstParent[weightIndex] : secondParent[weightIndex];
+					if (unitDistribution(randomizer) < this->settings.mutationRate) {
+						child[weightIndex] += mutationDistribution(randomizer);
+					}
+				}
+			}
+
+			std::swap(this->genomes, this->nextGenomes);
+			this->generation++;
+		}
+
+		// Pick the fittest of a few random genomes, the lower index wins a tie
+		int NeuroEvolution::selectParent(std::mt19937& randomizer) const {
+			std::uniform_int_distribution<int> genomeDistribution(0, this->settings.populationSize - 1);
+
+			int result = genomeDistribution(randomizer);
+			for (int drawIndex = 1; drawIndex < NEURO_TOURNAMENT_SIZE; drawIndex++) {
+				int candidate = genomeDistribution(randomizer);
+				bool betterFlag =
+					(this->fitness[candidate] > this->fitness[result]) ||
+					((this->fitness[candidate] == this->fitness[result]) && (candidate < result));
+				if (betterFlag) {
+					result = candidate;
+				}
+			}
+			return result;
+		}
+
+		// Play one game until the snake dies, starves or fills the field, and return its fitness
+		float NeuroEvolution::playGame(NeuroWorker& worker, const float* weights, unsigned int randomSeed, int* applesEaten) {
+			QuickGame& game = *worker.game;
+			QuickGameDefn gameDefn = this->gameDefn;
+			gameDefn.randomSeed = randomSeed;
+			game.reset(&gameDefn);
+
+			int starvationMoves = NEURO_STARVATION_FIELD_SPANS * (this->settings.fieldSize.x + this->settings.fieldSize.y);
+			int moveCount = 0;
+			int movesSinceApple = 0;
+			*applesEaten = 0;
+			while (!game.getFieldFull() && (movesSinceApple < starvationMoves)) {
+				QuickGameInputRequest input;
+				input.snakeMovementInput = NeuralPolicy::resolveDirection(weights, game);
+				QuickGameUpdateResult updateResult = game.update(&input);
+				if (updateResult.snakeHitBarrierFlag) {
+					break;
+				}
+
+				moveCount++;
+				movesSinceApple++;
+				if (updateResult.snakeAteAppleFlag) {
+					(*applesEaten)++;
+					movesSinceApple = 0;
+				}
+			}
+
+			return (float)(*applesEaten) + (NEURO_MOVE_FITNESS * (float)moveCount);
+		}
+
+		// Get the seed of one of a generation's games
+		unsigned int NeuroEvolution::resolveGameSeed(int gameIndex) const {
+			unsigned int gameNumber = (unsigned int)((this->generation * this->settings.gamesPerGenome) + gameIndex);
+			return this->settings.seed + (gameNumber * 2654435761u);
+		}
+
+	}
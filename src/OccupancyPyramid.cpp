@@ -0,0 +1,197 @@
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include "includes/occupancypyramid.hpp"
+
+
+	namespace snake {
+
+		// Constructor for the OccupancyPyramid class
+		OccupancyPyramid::OccupancyPyramid(int maxBaseSize) {
+			assert(maxBaseSize >= 1);
+
+			this->maxBaseSize = maxBaseSize;
+			this->segmentCounts = nullptr;
+			this->segmentCountCapacity = 0;
+			this->trackedFlag = false;
+			this->reset(sf::Vector2i(QUICK_GAME_DEFAULT_FIELD_WIDTH, QUICK_GAME_DEFAULT_FIELD_HEIGHT));
+		}
+
+		// Destructor for the OccupancyPyramid class
+		OccupancyPyramid::~OccupancyPyramid() {
+			delete[] this->segmentCounts;
+		}
+
+		// Catch up with the game, a move adds the new head cell and takes away the old tail cell, anything else counts the whole snake again
+		void OccupancyPyramid::sync(const QuickGame& game) {
+			if (game.getFieldSize() != this->fieldSize) {
+				this->reset(game.getFieldSize());
+			}
+
+			Snake* snake = game.getSnake();
+			sf::Vector2i headPosition = snake->getHead().position;
+			sf::Vector2i tailPosition = snake->getTail().position;
+			int length = snake->getLength();
+
+			// A new game starts its frames over, and more than one move between syncs cannot be followed cell by cell
+			bool followableFlag = this->trackedFlag && (game.getFrameCount() >= this->trackedFrame);
+			if (followableFlag && (headPosition != this->trackedHeadPosition)) {
+				sf::Vector2i headStep = headPosition - this->trackedHeadPosition;
+				sf::Vector2i tailStep = tailPosition - this->trackedTailPosition;
+				bool headMovedOnceFlag = (headStep.x * headStep.x) + (headStep.y * headStep.y) == 1;
+				bool tailMovedOnceFlag = (tailStep.x * tailStep.x) + (tailStep.y * tailStep.y) == 1;
+				bool movedFlag = (length == this->trackedLength) && tailMovedOnceFlag;
+				bool grewFlag = (length == this->trackedLength + 1) && (tailPosition == this->trackedTailPosition);
+				followableFlag = headMovedOnceFlag && (movedFlag || grewFlag);
+
+				if (followableFlag) {
+					this->addSegments(headPosition, 1);
+					if (movedFlag) {
+						this->addSegments(this->trackedTailPosition, -1);
+					}
+				}
+			} else if (followableFlag) {
+				followableFlag = (tailPosition == this->trackedTailPosition) && (length == this->trackedLength);
+			}
+
+			if (!followableFlag) {
+				this->rebuild(game);
+			}
+
+			this->trackedFlag = true;
+			this->trackedHeadPosition = headPosition;
+			this->trackedTailPosition = tailPosition;
+			this->trackedLength = length;
+			this->trackedFrame = game.getFrameCount();
+		}
+
+		// Hand out the changed blocks and start collecting again
+		bool OccupancyPyramid::takeDirtyRect(sf::Vector2i& dirtyMin, sf::Vector2i& dirtyMax) {
+			if (!this->dirtyFlag) {
+				return false;
+			}
+
+			dirtyMin = this->dirtyMin;
+			dirtyMax = this->dirtyMax;
+			this->dirtyFlag = false;
+			return true;
+		}
+
+		// Get the number of levels from the finest to the single block
+		int OccupancyPyramid::getLevelCount() const {
+			return this->levelCount;
+		}
+
+		// Get the number of blocks along each side of a level
+		sf::Vector2i OccupancyPyramid::getLevelSize(int level) const {
+			assert((level >= 0) && (level < this->levelCount));
+			return this->levelSizes[level];
+		}
+
+		// Get the size of a level's blocks as a shift
+		int OccupancyPyramid::getBlockShift(int level) const {
+			return this->baseShift + level;
+		}
+
+		// Get the number of segments in a block
+		int OccupancyPyramid::getSegmentCount(int level, sf::Vector2i block) const {
+			assert((level >= 0) && (level < this->levelCount));
+			assert((block.x >= 0) && (block.x < this->levelSizes[level].x) && (block.y >= 0) && (block.y < this->levelSizes[level].y));
+
+			int result = this->segmentCounts[this->levelOffsets[level] + (block.y * this->levelSizes[level].x) + block.x];
+			return result;
+		}
+
+		// Find the finest level that fits a size, the coarsest one always fits
+		int OccupancyPyramid::resolveLevelForSize(sf::Vector2i maxSize) const {
+			int result = 0;
+			while ((result < this->levelCount - 1) && ((this->levelSizes[result].x > maxSize.x) || (this->levelSizes[result].y > maxSize.y))) {
+				result++;
+			}
+			return result;
+		}
+
+		// Lay out the levels for a field, growing the counts only when the new layout needs more of them
+		void OccupancyPyramid::reset(sf::Vector2i fieldSize) {
+			this->fieldSize = fieldSize;
+
+			// The finest blocks are as small as they can be with the level still fitting maxBaseSize
+			this->baseShift = 0;
+			while ((((fieldSize.x - 1) >> this->baseShift) + 1 > this->maxBaseSize) || (((fieldSize.y - 1) >> this->baseShift) + 1 > this->maxBaseSize)) {
+				this->baseShift++;
+			}
+
+			// Every level halves the one below, rounding up, until one block is left
+			sf::Vector2i levelSize(((fieldSize.x - 1) >> this->baseShift) + 1, ((fieldSize.y - 1) >> this->baseShift) + 1);
+			int segmentCountTotal = 0;
+			this->levelCount = 0;
+			while (true) {
+				assert(this->levelCount < OCCUPANCY_PYRAMID_MAX_LEVELS);
+				this->levelSizes[this->levelCount] = levelSize;
+				this->levelOffsets[this->levelCount] = segmentCountTotal;
+				segmentCountTotal += levelSize.x * levelSize.y;
+				this->levelCount++;
+
+				if ((levelSize.x == 1) && (levelSize.y == 1)) {
+					break;
+				}
+				levelSize = sf::Vector2i((levelSize.x + 1) / 2, (levelSize.y + 1) / 2);
+			}
+
+			if (segmentCountTotal > this->segmentCountCapacity) {
+				delete[] this->segmentCounts;
+				this->segmentCounts = new int[segmentCountTotal];
+				this->segmentCountCapacity = segmentCountTotal;
+			}
+			memset(this->segmentCounts, 0, sizeof(int) * segmentCountTotal);
+
+			this->trackedFlag = false;
+			this->dirtyFlag = true;
+			this->dirtyMin = sf::Vector2i(0, 0);
+			this->dirtyMax = this->levelSizes[0] - sf::Vector2i(1, 1);
+		}
+
+		// Count the whole snake from scratch, which walks its body so it is left for new games and missed moves
+		void OccupancyPyramid::rebuild(const QuickGame& game) {
+			// The single block of the last level ends the counts
+			int segmentCountTotal = this->levelOffsets[this->levelCount - 1] + 1;
+			memset(this->segmentCounts, 0, sizeof(int) * segmentCountTotal);
+
+			Snake* snake = game.getSnake();
+			this->addSegments(snake->getHead().position, 1);
+			for (int bodyIndex = 0; bodyIndex < snake->getBodyLength(); bodyIndex++) {
+				this->addSegments(snake->getBody(bodyIndex).position, 1);
+			}
+			this->addSegments(snake->getTail().position, 1);
+
+			this->dirtyFlag = true;
+			this->dirtyMin = sf::Vector2i(0, 0);
+			this->dirtyMax = this->levelSizes[0] - sf::Vector2i(1, 1);
+		}
+
+		// Add to the count of the block over a cell on every level
+		void OccupancyPyramid::addSegments(sf::Vector2i position, int delta) {
+			sf::Vector2i block(position.x >> this->baseShift, position.y >> this->baseShift);
+			this->markDirty(block);
+
+			for (int level = 0; level < this->levelCount; level++) {
+				this->segmentCounts[this->levelOffsets[level] + (block.y * this->levelSizes[level].x) + block.x] += delta;
+				assert(this->segmentCounts[this->levelOffsets[level] + (block.y * this->levelSizes[level].x) + block.x] >= 0);
+				block = sf::Vector2i(block.x >> 1, block.y >> 1);
+			}
+		}
+
+		// Grow the changed rectangle to take in a finest level block
+		void OccupancyPyramid::markDirty(sf::Vector2i block) {
+			if (!this->dirtyFlag) {
+				this->dirtyFlag = true;
+				this->dirtyMin = block;
+				this->dirtyMax = block;
+				return;
+			}
+
+			this->dirtyMin = sf::Vector2i(std::min(this->dirtyMin.x, block.x), std::min(this->dirtyMin.y, block.y));
+			this->dirtyMax = sf::Vector2i(std::max(this->dirtyMax.x, block.x), std::max(this->dirtyMax.y, block.y));
+		}
+
+	}
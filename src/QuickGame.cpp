@@ -1,36 +1,295 @@
-#include <time.h>
-#include "includes/quickgamescene.hpp"
+#include <assert.h>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include "includes/level.hpp"
+#include "includes/quickgame.hpp"
 
 
 	namespace snake {
 
+		// Slack for aligning each block carved from the game's arena
+		const std::size_t QUICK_GAME_ARENA_ALIGNMENT_SLACK = 64;
+
+		// Fixed seed for the Zobrist keys, so hashes stay comparable across runs and machines
+		const std::uint64_t ZOBRIST_KEY_SEED = 0x5EED5A4E0B5A11EDULL;
+
+		// Size of a keyframe ahead of its randomizer state: frame, move timer, queued input and growth, apple, snake head and body length,
+		// state hash and the length of the randomizer state. The randomizer state follows, then one enter direction per segment from the head
+		const std::size_t QUICK_GAME_KEYFRAME_HEADER_SIZE = 4 * 13;
+
+		// The snake is dropped with the arena without running its destructor
+		static_assert(std::is_trivially_destructible<Snake>::value, "Snake must not own memory outside the arena");
+
+		// Append a 32 bit value in little endian order
+		void writeKeyframeWord(std::vector<unsigned char>& bytes, unsigned int value) {
+			bytes.push_back((unsigned char)(value & 0xFF));
+			bytes.push_back((unsigned char)((value >> 8) & 0xFF));
+			bytes.push_back((unsigned char)((value >> 16) & 0xFF));
+			bytes.push_back((unsigned char)((value >> 24) & 0xFF));
+		}
+
+		// Read a 32 bit value in little endian order
+		unsigned int readKeyframeWord(const unsigned char* bytes) {
+			unsigned int result =
+				((unsigned int)bytes[0]) |
+				((unsigned int)bytes[1] << 8) |
+				((unsigned int)bytes[2] << 16) |
+				((unsigned int)bytes[3] << 24);
+			return result;
+		}
+
+		namespace QuickGameUtils {
+
+			// Fill the key tables from a fixed seed with splitmix64
+			void fillZobristKeys(std::uint64_t* keys, sf::Vector2i fieldSize) {
+				int keyCount = (fieldSize.x * fieldSize.y * ZOBRIST_CELL_TABLE_COUNT) + ZOBRIST_DIRECTION_COUNT;
+
+				for (int keyIndex = 0; keyIndex < keyCount; keyIndex++) {
+					keys[keyIndex] = resolveZobristKey((std::uint64_t)keyIndex);
+				}
+			}
+
+			// Work out one key, splitmix64 can jump straight to any step of its sequence
+			std::uint64_t resolveZobristKey(std::uint64_t keyIndex) {
+				std::uint64_t key = ZOBRIST_KEY_SEED + ((keyIndex + 1) * 0x9E3779B97F4A7C15ULL);
+				key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+				key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+				return key ^ (key >> 31);
+			}
+
+			// Check whether a field has too many cells for the dense grids
+			bool usesChunkedStorage(sf::Vector2i fieldSize) {
+				bool result = ((long long)fieldSize.x * (long long)fieldSize.y) > QUICK_GAME_DENSE_CELL_LIMIT;
+				return result;
+			}
+
+		}
+
 		// Constructor for the QuickGame class
 		QuickGame::QuickGame(const QuickGameDefn* quickGameDefn) {
-			// Seed the random number generator with the current time
-			this->randomizer.seed((unsigned int)time(NULL));
+			// Allocate the one block all per-game memory comes from
+			this->arena = new MemoryArena(resolveArenaSize(quickGameDefn));
+
+			this->chunkedOccupancy = nullptr;
+			this->level = nullptr;
+			this->foodSet = nullptr;
+			this->zobristKeys = nullptr;
+			this->zobristKeysFieldSize = sf::Vector2i(0, 0);
+			this->reset(quickGameDefn);
+		}
+
+		// Destructor for the QuickGame class
+		QuickGame::~QuickGame() {
+			// The snake and everything it uses live in the arena, so freeing the arena frees them all
+			delete this->arena;
+			// Except for the chunks of a huge field, which come and go as the snake moves, and the foods, whose count is set after construction
+			delete this->chunkedOccupancy;
+			delete this->foodSet;
+		}
+
+		// Reset the game to its starting state, releasing the previous game's memory in one step
+		void QuickGame::reset(const QuickGameDefn* quickGameDefn) {
+			// The keys only depend on the field size, they are carved first so a reset on the same size finds them where they were
+			std::uint64_t* previousZobristKeys = this->zobristKeys;
+			bool keepZobristKeysFlag = (previousZobristKeys != nullptr) && (this->zobristKeysFieldSize == quickGameDefn->fieldSize);
+
+			bool chunkedFlag = QuickGameUtils::usesChunkedStorage(quickGameDefn->fieldSize);
+
+			this->arena->resetWithCapacity(resolveArenaSize(quickGameDefn));
+			if (chunkedFlag) {
+				this->zobristKeys = nullptr;
+			} else {
+				int cellCount = quickGameDefn->fieldSize.x * quickGameDefn->fieldSize.y;
+				this->zobristKeys = this->arena->allocateArray<std::uint64_t>((cellCount * ZOBRIST_CELL_TABLE_COUNT) + ZOBRIST_DIRECTION_COUNT);
+			}
+			assert(!keepZobristKeysFlag || (this->zobristKeys == previousZobristKeys)); // The same size never regrows the arena
+
+			// Seed the random number generator, the same seed and inputs always play out the same game
+			this->randomizer.seed(quickGameDefn->randomSeed);
 
 			// Set the dimensions of the game field
 			this->fieldSize = quickGameDefn->fieldSize;
+			this->farWallPosition = quickGameDefn->fieldSize - sf::Vector2i(1, 1);
 			// Set the speed of the snake (tiles per second)
 			this->snakeSpeedTilesPerSecond = quickGameDefn->snakeSpeedTilesPerSecond;
 
-			// Initialize the snake with its starting definition
-			this->snake = new Snake(quickGameDefn->snakeStartDefn);
+			// Initialize the snake with its starting definition, it can at most fill the whole field or reach the cap of a chunked one
+			SnakeStorage snakeStorage;
+			if (chunkedFlag) {
+				if (this->chunkedOccupancy == nullptr) {
+					this->chunkedOccupancy = new ChunkedOccupancy(this->fieldSize);
+				}
+				this->chunkedOccupancy->reset(this->fieldSize);
+				snakeStorage = SnakeUtils::allocateChunkedStorage(*this->arena, *this->chunkedOccupancy, resolveSnakeCapacity(quickGameDefn));
+			} else {
+				snakeStorage = SnakeUtils::allocateStorage(*this->arena, this->fieldSize);
+			}
+			void* snakeMemory = this->arena->allocate(sizeof(Snake), alignof(Snake));
+			this->snake = new (snakeMemory) Snake(quickGameDefn->snakeStartDefn, snakeStorage);
+
+			this->frameCount = 0;
 
 			// Initialize apple state and position
 			this->appleExistsFlag = false;
 			this->applePosition = sf::Vector2i(0, 0);
+			if (this->foodSet != nullptr) {
+				assert(!chunkedFlag);
+				this->foodSet->reset(this->fieldSize, this->foodSet->getCapacity());
+			}
 
 			// Initialize frame counter and input queue
 			this->framesSinceSnakeMoved = 0;
 			this->queuedSnakeInput = ObjectDirection::NONE;
 			this->queuedSnakeGrowth = 0;
+
+			// Hash the starting board once, every later change updates the hash in place
+			if (!keepZobristKeysFlag) {
+				this->initZobristKeys();
+				this->zobristKeysFieldSize = this->fieldSize;
+			}
+			this->stateHash = this->computeStateHash();
 		}
 
-		// Destructor for the QuickGame class
-		QuickGame::~QuickGame() {
-			// Free dynamically allocated memory for the snake object
-			delete this->snake;
+		// Copy another game's state, the Zobrist keys are already the same for the same field size
+		void QuickGame::copyFrom(const QuickGame& other) {
+			assert(this->fieldSize == other.fieldSize);
+
+			this->randomizer = other.randomizer;
+			this->snakeSpeedTilesPerSecond = other.snakeSpeedTilesPerSecond;
+			this->level = other.level;
+			this->snake->copyFrom(*other.snake);
+
+			this->appleExistsFlag = other.appleExistsFlag;
+			this->applePosition = other.applePosition;
+			if (other.foodSet != nullptr) {
+				if ((this->foodSet == nullptr) || (this->foodSet->getCapacity() != other.foodSet->getCapacity())) {
+					this->setFoodCount(other.foodSet->getCapacity());
+				}
+				this->foodSet->copyFrom(*other.foodSet);
+			} else if (this->foodSet != nullptr) {
+				this->setFoodCount(0);
+			}
+
+			this->framesSinceSnakeMoved = other.framesSinceSnakeMoved;
+			this->queuedSnakeInput = other.queuedSnakeInput;
+			this->queuedSnakeGrowth = other.queuedSnakeGrowth;
+
+			this->stateHash = other.stateHash;
+			this->frameCount = other.frameCount;
+		}
+
+		// Reseed the random number generator that places apples
+		void QuickGame::reseedRandomizer(unsigned int randomSeed) {
+			this->randomizer.seed(randomSeed);
+		}
+
+		// Save the game as its counters, apple, randomizer and snake, the snake as its head and one enter direction per segment
+		void QuickGame::saveKeyframe(std::vector<unsigned char>& bytes) const {
+			assert((this->foodSet == nullptr) && (this->level == nullptr));
+
+			// The standard only fixes the randomizer's state as text, which is the same for the same state on every platform
+			std::ostringstream randomizerStream;
+			randomizerStream << this->randomizer;
+			std::string randomizerText = randomizerStream.str();
+
+			SnakeSegment head = this->snake->getHead();
+			int bodyLength = this->snake->getBodyLength();
+			writeKeyframeWord(bytes, (unsigned int)this->frameCount);
+			writeKeyframeWord(bytes, (unsigned int)this->framesSinceSnakeMoved);
+			writeKeyframeWord(bytes, (unsigned int)this->queuedSnakeInput);
+			writeKeyframeWord(bytes, (unsigned int)this->queuedSnakeGrowth);
+			writeKeyframeWord(bytes, this->appleExistsFlag ? 1 : 0);
+			writeKeyframeWord(bytes, (unsigned int)this->applePosition.x);
+			writeKeyframeWord(bytes, (unsigned int)this->applePosition.y);
+			writeKeyframeWord(bytes, (unsigned int)head.position.x);
+			writeKeyframeWord(bytes, (unsigned int)head.position.y);
+			writeKeyframeWord(bytes, (unsigned int)bodyLength);
+			writeKeyframeWord(bytes, (unsigned int)(this->stateHash & 0xFFFFFFFFULL));
+			writeKeyframeWord(bytes, (unsigned int)(this->stateHash >> 32));
+			writeKeyframeWord(bytes, (unsigned int)randomizerText.size());
+
+			bytes.insert(bytes.end(), randomizerText.begin(), randomizerText.end());
+			bytes.push_back((unsigned char)head.enterDirection);
+			for (int bodyIndex = 0; bodyIndex < bodyLength; bodyIndex++) {
+				bytes.push_back((unsigned char)this->snake->getBody(bodyIndex).enterDirection);
+			}
+		}
+
+		// Restore a saved game over the reset one, checking the rebuilt board against the hash it was saved with
+		bool QuickGame::loadKeyframe(const unsigned char* bytes, std::size_t byteCount) {
+			assert((this->foodSet == nullptr) && (this->level == nullptr));
+			if (byteCount < QUICK_GAME_KEYFRAME_HEADER_SIZE) {
+				return false;
+			}
+
+			std::size_t randomizerTextSize = readKeyframeWord(bytes + 48);
+			int bodyLength = (int)readKeyframeWord(bytes + 36);
+			if ((bodyLength < 1) || (randomizerTextSize > byteCount - QUICK_GAME_KEYFRAME_HEADER_SIZE) ||
+				((std::size_t)bodyLength + 1 != byteCount - QUICK_GAME_KEYFRAME_HEADER_SIZE - randomizerTextSize)) {
+				return false;
+			}
+
+			std::istringstream randomizerStream(std::string((const char*)bytes + QUICK_GAME_KEYFRAME_HEADER_SIZE, randomizerTextSize));
+			randomizerStream >> this->randomizer;
+			if (randomizerStream.fail()) {
+				return false;
+			}
+
+			sf::Vector2i headPosition((int)readKeyframeWord(bytes + 28), (int)readKeyframeWord(bytes + 32));
+			if (!this->snake->restore(headPosition, bytes + QUICK_GAME_KEYFRAME_HEADER_SIZE + randomizerTextSize, bodyLength)) {
+				return false;
+			}
+
+			this->frameCount = (int)readKeyframeWord(bytes);
+			this->framesSinceSnakeMoved = (int)readKeyframeWord(bytes + 4);
+			this->queuedSnakeInput = (ObjectDirection)readKeyframeWord(bytes + 8);
+			this->queuedSnakeGrowth = (int)readKeyframeWord(bytes + 12);
+			this->appleExistsFlag = (readKeyframeWord(bytes + 16) != 0);
+			this->applePosition = sf::Vector2i((int)readKeyframeWord(bytes + 20), (int)readKeyframeWord(bytes + 24));
+			bool appleInsideFieldFlag =
+				(this->applePosition.x >= 0) && (this->applePosition.x < this->fieldSize.x) &&
+				(this->applePosition.y >= 0) && (this->applePosition.y < this->fieldSize.y);
+			if ((this->appleExistsFlag && !appleInsideFieldFlag) || ((unsigned int)this->queuedSnakeInput > (unsigned int)ObjectDirection::LEFT)) {
+				return false;
+			}
+
+			// The counters are not part of the hash, so they are checked against what play can reach: the snake moves once the timer
+			// reaches the move interval, and growth never outruns the length, since a run of growth starts at 2 and each grown move adds at most 1 more
+			bool moveTimerInRangeFlag = (this->framesSinceSnakeMoved >= 0) && (this->framesSinceSnakeMoved < (60.0f / this->snakeSpeedTilesPerSecond));
+			bool growthInRangeFlag = (this->queuedSnakeGrowth >= 0) && (this->queuedSnakeGrowth <= this->snake->getLength());
+			if (!moveTimerInRangeFlag || !growthInRangeFlag) {
+				return false;
+			}
+
+			// A board that was saved wrong or damaged since rarely hashes the same, so the hash doubles as a check of the whole keyframe
+			std::uint64_t savedStateHash = (std::uint64_t)readKeyframeWord(bytes + 40) | ((std::uint64_t)readKeyframeWord(bytes + 44) << 32);
+			this->stateHash = this->computeStateHash();
+			bool result = (this->stateHash == savedStateHash);
+			return result;
+		}
+
+		// Play on a level's obstacles from the next apple on
+		void QuickGame::setLevel(const Level* level) {
+			assert((level == nullptr) || (level->getFieldSize() == this->fieldSize));
+			this->level = level;
+		}
+
+		// Keep many foods on the field from the next update on, or go back to the single apple
+		void QuickGame::setFoodCount(int foodCount) {
+			assert(foodCount >= 0);
+			assert((foodCount == 0) || !QuickGameUtils::usesChunkedStorage(this->fieldSize));
+
+			if (foodCount == 0) {
+				delete this->foodSet;
+				this->foodSet = nullptr;
+				return;
+			}
+
+			if (this->foodSet == nullptr) {
+				this->foodSet = new FoodSet();
+			}
+			this->foodSet->reset(this->fieldSize, foodCount);
 		}
 
 		// Get the size of the game field
@@ -43,6 +302,16 @@
 			return this->snake;
 		}
 
+		// Get the level the game is played on, nullptr for an open field
+		const Level* QuickGame::getLevel() const {
+			return this->level;
+		}
+
+		// Get the foods on the field, nullptr for a single apple
+		const FoodSet* QuickGame::getFoodSet() const {
+			return this->foodSet;
+		}
+
 		// Check if the apple currently exists
 		bool QuickGame::getAppleExists() const {
 			return this->appleExistsFlag;
@@ -53,6 +322,34 @@
 			return this->applePosition;
 		}
 
+		// Get the number of frames the game has been updated for
+		int QuickGame::getFrameCount() const {
+			return this->frameCount;
+		}
+
+		// Get the number of bytes this game has drawn from its arena
+		std::size_t QuickGame::getArenaUsedBytes() const {
+			return this->arena->getUsedBytes();
+		}
+
+		// Get the number of moves the snake still grows on
+		int QuickGame::getQueuedSnakeGrowth() const {
+			return this->queuedSnakeGrowth;
+		}
+
+		// Check whether the snake has filled the field
+		bool QuickGame::getFieldFull() const {
+			if (this->level != nullptr) {
+				return this->snake->getLength() >= this->level->getOpenCellCount();
+			}
+			return this->snake->getLength() >= ((long long)(this->fieldSize.x - 2) * (long long)(this->fieldSize.y - 2));
+		}
+
+		// Get the hash of the current board
+		std::uint64_t QuickGame::getStateHash() const {
+			return this->stateHash;
+		}
+
 		// Update game state based on input and elapsed time
 		QuickGameUpdateResult QuickGame::update(const QuickGameInputRequest* input) {
 			QuickGameUpdateResult result;
@@ -60,14 +357,13 @@
 			result.snakeHitBarrierFlag = false;
 			result.snakeAteAppleFlag = false;
 			result.snakeGrewFlag = false;
+			result.appleSpawnedFlag = false;
 
 			// Check if an apple needs to be placed
-			if (!this->appleExistsFlag) {
-				this->applePosition = this->resolveNewApplePosition();
-				this->appleExistsFlag = true;
-			}
+			result.appleSpawnedFlag = this->spawnAppleIfMissing();
 
-			// Increment the frame counter
+			// Increment the frame counters
+			this->frameCount++;
 			this->framesSinceSnakeMoved++;
 
 			// Process snake movement input if valid
@@ -87,6 +383,14 @@
 				if (this->snakeWouldHitBarrier(directionToMoveSnake)) {
 					result.snakeHitBarrierFlag = true;
 				} else {
+					SnakeSegment previousHead = this->snake->getHead();
+					sf::Vector2i previousTailPosition = this->snake->getTail().position;
+
+					// A snake at the body cap of a chunked field stops growing and keeps moving
+					if ((this->queuedSnakeGrowth > 0) && !this->snake->canGrow()) {
+						this->queuedSnakeGrowth = 0;
+					}
+
 					// Move or grow the snake
 					if (this->queuedSnakeGrowth > 0) {
 						this->snake->growForward(directionToMoveSnake);
@@ -95,23 +399,180 @@
 					}
 					else {
 						this->snake->moveForward(directionToMoveSnake);
+
+						// Only a move clears the old tail cell, growing keeps the tail where it was
+						this->stateHash ^= this->resolveCellKey(ZOBRIST_BODY_TABLE, previousTailPosition);
 					}
 
+					// The new head cell is set and the head and its direction moved
+					sf::Vector2i headPosition = this->snake->getHead().position;
+					this->stateHash ^=
+						this->resolveCellKey(ZOBRIST_BODY_TABLE, headPosition) ^
+						this->resolveCellKey(ZOBRIST_HEAD_TABLE, previousHead.position) ^
+						this->resolveCellKey(ZOBRIST_HEAD_TABLE, headPosition) ^
+						this->resolveDirectionKey(previousHead.enterDirection) ^
+						this->resolveDirectionKey(directionToMoveSnake);
+
 					result.snakeMovementResult = directionToMoveSnake;
 
+					// Check if the snake ate a food, the cell index finds it without looking through the others
+					FoodItem eatenFood;
+					if (this->foodSet != nullptr) {
+						if (this->foodSet->remove(headPosition, eatenFood)) {
+							result.snakeAteAppleFlag = true;
+							this->stateHash ^= this->resolveFoodKey(headPosition, eatenFood.foodType);
+							this->queuedSnakeGrowth += FoodSetUtils::resolveGrowth(eatenFood.foodType);
+						}
+					}
 					// Check if the snake ate the apple
-					if (this->snake->getHead().position == this->applePosition) {
+					else if (this->snake->getHead().position == this->applePosition) {
 						result.snakeAteAppleFlag = true;
-
 						this->appleExistsFlag = false;
+						this->stateHash ^= this->resolveCellKey(ZOBRIST_APPLE_TABLE, this->applePosition);
 						this->queuedSnakeGrowth += 2; // Increase growth for eating the apple
 					}
 				}
 
 				// Reset frame counter after movement
 				this->framesSinceSnakeMoved = 0;
+
+				assert(this->stateHash == this->computeStateHash()); // Ensure the incremental hash matches a full rehash
+			}
+
+			return result;
+		}
+
+		// Place a new apple when there is none
+		bool QuickGame::spawnAppleIfMissing() {
+			if (this->foodSet != nullptr) {
+				return this->spawnMissingFood();
+			}
+			if (this->appleExistsFlag) {
+				return false;
+			}
+
+			this->applePosition = this->resolveNewApplePosition();
+			this->appleExistsFlag = true;
+			this->stateHash ^= this->resolveCellKey(ZOBRIST_APPLE_TABLE, this->applePosition);
+			return true;
+		}
+
+		// Work out how large the arena must be for a game on the given field
+		std::size_t QuickGame::resolveArenaSize(const QuickGameDefn* quickGameDefn) {
+			std::size_t snakeCapacity = (std::size_t)resolveSnakeCapacity(quickGameDefn);
+
+			std::size_t result =
+				sizeof(Snake) +
+				(snakeCapacity * sizeof(SnakeSegment)) + // Body segments
+				(QUICK_GAME_ARENA_ALIGNMENT_SLACK * 4);
+
+			// Chunked fields keep neither grid in the arena
+			if (!QuickGameUtils::usesChunkedStorage(quickGameDefn->fieldSize)) {
+				std::size_t cellCount = (std::size_t)(quickGameDefn->fieldSize.x * quickGameDefn->fieldSize.y);
+				result +=
+					cellCount + // Occupancy counts
+					(((cellCount * ZOBRIST_CELL_TABLE_COUNT) + ZOBRIST_DIRECTION_COUNT) * sizeof(std::uint64_t)); // Zobrist keys
 			}
+			return result;
+		}
+
+		// Work out how many body segments the snake gets room for
+		int QuickGame::resolveSnakeCapacity(const QuickGameDefn* quickGameDefn) {
+			if (QuickGameUtils::usesChunkedStorage(quickGameDefn->fieldSize)) {
+				return QUICK_GAME_CHUNKED_BODY_CAPACITY;
+			}
+
+			int result = quickGameDefn->fieldSize.x * quickGameDefn->fieldSize.y;
+			return result;
+		}
+
+		// Fill the key tables for this game's field
+		void QuickGame::initZobristKeys() {
+			if (this->zobristKeys != nullptr) {
+				QuickGameUtils::fillZobristKeys(this->zobristKeys, this->fieldSize);
+			}
+		}
 
+		// Get the key of a cell in one of the cell tables
+		std::uint64_t QuickGame::resolveCellKey(int keyTable, sf::Vector2i position) const {
+			if (this->zobristKeys == nullptr) {
+				std::uint64_t cellCount = (std::uint64_t)this->fieldSize.x * (std::uint64_t)this->fieldSize.y;
+				std::uint64_t cellIndex = ((std::uint64_t)position.y * (std::uint64_t)this->fieldSize.x) + (std::uint64_t)position.x;
+				return QuickGameUtils::resolveZobristKey(((std::uint64_t)keyTable * cellCount) + cellIndex);
+			}
+
+			int cellCount = this->fieldSize.x * this->fieldSize.y;
+			return this->zobristKeys[(keyTable * cellCount) + (position.y * this->fieldSize.x) + position.x];
+		}
+
+		// Get the key of the direction the head last moved in
+		std::uint64_t QuickGame::resolveDirectionKey(ObjectDirection direction) const {
+			if (this->zobristKeys == nullptr) {
+				std::uint64_t cellCount = (std::uint64_t)this->fieldSize.x * (std::uint64_t)this->fieldSize.y;
+				return QuickGameUtils::resolveZobristKey(((std::uint64_t)ZOBRIST_CELL_TABLE_COUNT * cellCount) + (std::uint64_t)direction);
+			}
+
+			int cellCount = this->fieldSize.x * this->fieldSize.y;
+			return this->zobristKeys[(ZOBRIST_CELL_TABLE_COUNT * cellCount) + (int)direction];
+		}
+
+		// Get the key of a food, the apple table's key for its cell turned by a byte per kind so kinds on the same cell hash apart
+		std::uint64_t QuickGame::resolveFoodKey(sf::Vector2i position, FoodType foodType) const {
+			std::uint64_t key = this->resolveCellKey(ZOBRIST_APPLE_TABLE, position);
+			int rotation = (int)foodType * 8;
+			if (rotation == 0) {
+				return key;
+			}
+			return (key << rotation) | (key >> (64 - rotation));
+		}
+
+		// Hash the board from scratch, a cell covered by two segments cancels out just like in the incremental hash
+		std::uint64_t QuickGame::computeStateHash() const {
+			SnakeSegment head = this->snake->getHead();
+
+			std::uint64_t result =
+				this->resolveCellKey(ZOBRIST_BODY_TABLE, head.position) ^
+				this->resolveCellKey(ZOBRIST_BODY_TABLE, this->snake->getTail().position) ^
+				this->resolveCellKey(ZOBRIST_HEAD_TABLE, head.position) ^
+				this->resolveDirectionKey(head.enterDirection);
+
+			for (int bodyIndex = 0; bodyIndex < this->snake->getBodyLength(); bodyIndex++) {
+				result ^= this->resolveCellKey(ZOBRIST_BODY_TABLE, this->snake->getBody(bodyIndex).position);
+			}
+
+			if (this->appleExistsFlag) {
+				result ^= this->resolveCellKey(ZOBRIST_APPLE_TABLE, this->applePosition);
+			}
+
+			if (this->foodSet != nullptr) {
+				for (int foodIndex = 0; foodIndex < this->foodSet->getCount(); foodIndex++) {
+					const FoodItem& food = this->foodSet->getItem(foodIndex);
+					result ^= this->resolveFoodKey(food.position, food.foodType);
+				}
+			}
+
+			return result;
+		}
+
+		// Place foods until the set is full again, or until every cell inside the walls is taken by the snake or a food
+		bool QuickGame::spawnMissingFood() {
+			long long openCellCount = (this->level != nullptr) ?
+				(long long)this->level->getOpenCellCount() :
+				((long long)(this->fieldSize.x - 2) * (long long)(this->fieldSize.y - 2));
+			long long freeCellCount = openCellCount - this->snake->getLength() - this->foodSet->getCount();
+
+			std::uniform_int_distribution<int> foodTypeDistribution(0, FOOD_TYPE_COUNT - 1);
+
+			bool result = false;
+			while (!this->foodSet->getFull() && (freeCellCount > 0)) {
+				sf::Vector2i position = this->resolveNewApplePosition();
+				FoodType foodType = (FoodType)foodTypeDistribution(this->randomizer);
+
+				this->foodSet->add(position, foodType);
+				this->stateHash ^= this->resolveFoodKey(position, foodType);
+				freeCellCount--;
+				result = true;
+			}
 			return result;
 		}
 
@@ -128,8 +589,11 @@
 				result.x = xPositionDistribution(this->randomizer);
 				result.y = yPositionDistribution(this->randomizer);
 
-				// Check if the new position is free of the snake
-				foundFreePositionFlag = !this->snake->occupiesPosition(result);
+				// Check if the new position is free of the snake, of the level's obstacles and of other foods
+				foundFreePositionFlag =
+					!this->snake->occupiesPosition(result) &&
+					((this->level == nullptr) || !this->level->isBlocked(result)) &&
+					((this->foodSet == nullptr) || !this->foodSet->occupiesPosition(result));
 			}
 
 			return result;
@@ -141,9 +605,10 @@
 
 			bool result =
 				(newHeadPosition.x <= 0) || // Check if out of left boundary
-				(newHeadPosition.x >= (this->fieldSize.x - 1)) || // Check if out of right boundary
+				(newHeadPosition.x >= this->farWallPosition.x) || // Check if out of right boundary
 				(newHeadPosition.y <= 0) || // Check if out of top boundary
-				(newHeadPosition.y >= (this->fieldSize.y - 1)) || // Check if out of bottom boundary
+				(newHeadPosition.y >= this->farWallPosition.y) || // Check if out of bottom boundary
+				((this->level != nullptr) && this->level->isBlocked(newHeadPosition)) || // Check if hits one of the level's obstacles
 				this->snake->bodyOccupiesPosition(newHeadPosition); // Check if collides with its own body
 			return result;
 		}
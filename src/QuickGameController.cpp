@@ -1,18 +1,32 @@
+#include <stdio.h>
+#include <time.h>
 #include "includes/utils.hpp"
+#include "includes/alloctracker.hpp"
+#include "includes/level.hpp"
+#include "includes/levelgenerator.hpp"
 #include "includes/quickgamescene.hpp"
 
 
 	namespace snake {
 
-		// Paths to sound and music resources
-		const char* QUICK_GAME_EAT_APPLE_SOUND_PATH = "resources/sounds/eat-apple.wav";
-		const char* QUICK_GAME_HIT_BARRIER_SOUND_PATH = "resources/sounds/hit-barrier.wav";
-
+		// Paths to music resources
 		const char* QUICK_GAME_RUNNING_MUSIC_PATH = "resources/music/sample4.mp3";
 		const char* QUICK_GAME_DONE_SUMMARY_MUSIC_PATH = "resources/music/game_over.mp3";
 
+		// Longest game a replay holds, an hour at 60 frames per second
+		const int QUICK_GAME_REPLAY_FRAME_CAPACITY = 60 * 60 * 60;
+
+		// Planning time per frame the autopilot should stay under, a quarter of a 60 frames per second frame
+		const std::int64_t QUICK_GAME_AUTOPILOT_BUDGET_MICROSECONDS = 4000;
+
+		// Frames a bot leaves the summary up before starting the next game
+		const int QUICK_GAME_AUTOPILOT_RESTART_FRAMES = 180;
+
+		// Directory the perfect play solver caches its cycle for each field size in
+		const char* QUICK_GAME_CYCLE_CACHE_DIRECTORY = "cache";
+
 		// Constructor for QuickGameController
-		QuickGameController::QuickGameController(sf::RenderWindow& window) {
+		QuickGameController::QuickGameController(sf::RenderWindow& window, const QuickGameControllerOptions& options) {
 			// Initialize window reference
 			this->window = &window;
 
@@ -22,11 +36,99 @@
 			// Set initial mode to WAIT_TO_START
 			this->mode = QuickGameMode::WAIT_TO_START;
 
-			// Initialize game pointer and sound/music resources
+			// Initialize game pointer and sound/music resources, the game is constructed on the first start and reused after
 			this->game = nullptr;
+			this->gameStartedFlag = false;
+			this->fieldSize = options.fieldSize;
+
+			// A level brings its own field size, a level that does not load leaves the plain field
+			this->level = nullptr;
+			if (options.levelPath != nullptr) {
+				this->level = new Level();
+				if (this->level->load(options.levelPath)) {
+					this->fieldSize = this->level->getFieldSize();
+				} else {
+					fprintf(stderr, "Could not load level %s, playing on the plain field\n", options.levelPath);
+					delete this->level;
+					this->level = nullptr;
+				}
+			}
+
+			// Generated levels are made one ahead on a worker thread, the first one while the player is still on the waiting screen
+			this->levelGenerator = nullptr;
+			this->nextLevelSeed = (unsigned int)time(NULL);
+			if (options.generatedLevelsFlag && (this->level == nullptr)) {
+				if ((long long)this->fieldSize.x * (long long)this->fieldSize.y > LEVEL_MAX_CELL_COUNT) {
+					fprintf(stderr, "Levels cannot be generated for a %dx%d field, playing on the plain field\n", this->fieldSize.x, this->fieldSize.y);
+				} else {
+					this->levelGenerator = new BackgroundLevelGenerator(LevelGenerator::resolveDefaultSettings());
+					QuickGameDefn gameDefn = this->resolveGameDefn();
+					this->levelGenerator->request(gameDefn, this->nextLevelSeed++);
+				}
+			}
+			bool levelFlag = (this->level != nullptr) || (this->levelGenerator != nullptr);
+
+			// Many foods are kept in a grid of every cell, and at most half the field is covered so a free cell is always quick to find
+			this->foodCount = options.foodCount;
+			if ((this->foodCount > 0) && QuickGameUtils::usesChunkedStorage(this->fieldSize)) {
+				fprintf(stderr, "Many foods cannot be kept on a %dx%d field, playing with a single apple\n", this->fieldSize.x, this->fieldSize.y);
+				this->foodCount = 0;
+			}
+			int maxFoodCount = ((this->fieldSize.x - 2) * (this->fieldSize.y - 2)) / 2;
+			if (this->foodCount > maxFoodCount) {
+				fprintf(stderr, "At most %d foods fit a %dx%d field, keeping %d\n", maxFoodCount, this->fieldSize.x, this->fieldSize.y, maxFoodCount);
+				this->foodCount = maxFoodCount;
+			}
+
+			// Load every sound effect into the voice pool
+			this->soundEffects = new SoundEffectPool();
+
+			// Only record inputs when replays are being saved
+			this->replayDirectory = options.replayDirectory;
+			this->replaySaver = nullptr;
+			if ((options.replayDirectory != nullptr) && levelFlag) {
+				// A replay holds the game definition alone, which has no room for the level it was played on
+				fprintf(stderr, "Games on a level are not recorded\n");
+			} else if ((options.replayDirectory != nullptr) && (this->foodCount > 0)) {
+				// Nor for the number of foods
+				fprintf(stderr, "Games with many foods are not recorded\n");
+			} else if (options.replayDirectory != nullptr) {
+				this->replaySaver = new BackgroundReplaySaver(QUICK_GAME_REPLAY_FRAME_CAPACITY);
+			}
 
-			this->eatAppleSoundBuffer = new sf::SoundBuffer();
-			this->hitBarrierSoundBuffer = new sf::SoundBuffer();
+			// Viewers follow the games from shared memory, a broadcast that cannot be made leaves the game to the window alone
+			this->spectatorPublisher = nullptr;
+			if (options.broadcastName != nullptr) {
+				this->spectatorPublisher = new SpectatorPublisher();
+				if (!this->spectatorPublisher->create(options.broadcastName, this->fieldSize)) {
+					fprintf(stderr, "Could not broadcast as %s, spectators will not see the games\n", options.broadcastName);
+					delete this->spectatorPublisher;
+					this->spectatorPublisher = nullptr;
+				}
+			}
+
+			// Only plan moves when a bot plays, the cycle is made when the first game's field size is known
+			this->autopilot = nullptr;
+			this->perfectPlaySolver = nullptr;
+			this->mctsBot = nullptr;
+			bool botRequestedFlag = options.perfectPlayFlag || options.mctsFlag || options.autopilotFlag;
+			if (botRequestedFlag && QuickGameUtils::usesChunkedStorage(this->fieldSize)) {
+				// Every bot plans over grids of the whole field, which a chunked field is too large for
+				fprintf(stderr, "Bots cannot play on a %dx%d field, the game is left to the keyboard\n", this->fieldSize.x, this->fieldSize.y);
+			} else if (botRequestedFlag && levelFlag) {
+				// Every bot plans for a field walled in at its edge alone
+				fprintf(stderr, "Bots cannot play on a level, the game is left to the keyboard\n");
+			} else if (botRequestedFlag && (this->foodCount > 0)) {
+				// Every bot heads for a single apple
+				fprintf(stderr, "Bots cannot play with many foods, the game is left to the keyboard\n");
+			} else if (options.perfectPlayFlag) {
+				this->perfectPlaySolver = new HamiltonianSolver(true);
+			} else if (options.mctsFlag) {
+				this->mctsBot = new MctsBot(MctsBot::resolveDifficultySettings(options.mctsDifficulty));
+			} else if (options.autopilotFlag) {
+				this->autopilot = new Autopilot(QUICK_GAME_AUTOPILOT_BUDGET_MICROSECONDS);
+			}
+			this->framesSinceGameDone = 0;
 
 			this->gameRunningMusic = nullptr;
 			this->gameRunningMusicLoaded = false;
@@ -38,17 +140,6 @@
 			this->lastGameBeatLongestSnakeLength = false;
 
 			this->nextSnakeMovementInput = ObjectDirection::NONE;
-
-			// Load sound effects
-			if (
-				!this->eatAppleSoundBuffer->loadFromFile(QUICK_GAME_EAT_APPLE_SOUND_PATH) ||
-				!this->hitBarrierSoundBuffer->loadFromFile(QUICK_GAME_HIT_BARRIER_SOUND_PATH)
-				) {
-				throw "Could not load sound effects";
-			}
-			// Set sound buffers for sound effects
-			this->eatAppleSound.setBuffer(*this->eatAppleSoundBuffer);
-			this->hitBarrierSound.setBuffer(*this->hitBarrierSoundBuffer);
 		}
 
 		// Destructor for QuickGameController
@@ -57,12 +148,40 @@
 			if (this->game != nullptr) {
 				delete this->game;
 			}
+			// Clean up the levels after the game that played on them
+			if (this->level != nullptr) {
+				delete this->level;
+			}
+			if (this->levelGenerator != nullptr) {
+				delete this->levelGenerator;
+			}
 			// Clean up renderer
 			delete this->renderer;
 
-			// Clean up sound buffers
-			delete this->eatAppleSoundBuffer;
-			delete this->hitBarrierSoundBuffer;
+			// Clean up sound effects
+			delete this->soundEffects;
+
+			// Clean up replay saver once the last game's replay is written
+			if (this->replaySaver != nullptr) {
+				this->finishReplaySave();
+				delete this->replaySaver;
+			}
+
+			// Close the broadcast, telling viewers the game is gone
+			if (this->spectatorPublisher != nullptr) {
+				delete this->spectatorPublisher;
+			}
+
+			// Clean up bots
+			if (this->autopilot != nullptr) {
+				delete this->autopilot;
+			}
+			if (this->perfectPlaySolver != nullptr) {
+				delete this->perfectPlaySolver;
+			}
+			if (this->mctsBot != nullptr) {
+				delete this->mctsBot;
+			}
 
 			// Clean up music resources
 			if (this->gameRunningMusic != nullptr) {
@@ -109,7 +228,11 @@
 		void QuickGameController::update() {
 			// Manage music when in WAIT_TO_START mode
 			if (this->mode == QuickGameMode::WAIT_TO_START) {
-				if (!this->gameRunningMusicLoaded) {
+				// Music is kept loaded across scene changes, so restart it whenever it is not playing
+				bool waitToStartMusicPlaying =
+					this->gameRunningMusicLoaded &&
+					(this->gameRunningMusic->getStatus() == sf::SoundSource::Status::Playing);
+				if (!waitToStartMusicPlaying) {
 					this->beginWaitToStartMusic();
 				}
 			}
@@ -119,32 +242,62 @@
 				QuickGameInputRequest inputRequest;
 				inputRequest.snakeMovementInput = this->nextSnakeMovementInput;
 
-				QuickGameUpdateResult updateResult = this->game->update(&inputRequest);
-				if (updateResult.snakeAteAppleFlag) {
-					this->eatAppleSound.play(); // Play sound when apple is eaten
+				QuickGameUpdateResult updateResult;
+				{
+					AllocationScope allocationScope(AllocationSubsystem::SIMULATION);
+					if (this->perfectPlaySolver != nullptr) {
+						inputRequest = this->perfectPlaySolver->resolveInput(*this->game);
+					} else if (this->mctsBot != nullptr) {
+						inputRequest = this->mctsBot->resolveInput(*this->game);
+					} else if (this->autopilot != nullptr) {
+						inputRequest = this->autopilot->resolveInput(*this->game);
+					}
+					updateResult = this->game->update(&inputRequest);
 				}
 
-				if (updateResult.snakeHitBarrierFlag) {
-					this->hitBarrierSound.play(); // Play sound when hitting barrier
+				if (this->replaySaver != nullptr) {
+					this->replaySaver->getRecorder().record(inputRequest, this->game->getStateHash());
+				}
 
-					// Change mode to GAME_DONE_SUMMARY
-					this->mode = QuickGameMode::GAME_DONE_SUMMARY;
+				if (this->spectatorPublisher != nullptr) {
+					this->spectatorPublisher->publishTick(inputRequest.snakeMovementInput, this->game->getStateHash());
+				}
 
-					this->lastGameBeatLongestSnakeLength = false;
-					int endedGameSnakeLength = this->game->getSnake()->getLength();
-					if (endedGameSnakeLength > this->longestSnakeLength) {
-						this->lastGameBeatLongestSnakeLength = true;
-						this->longestSnakeLength = this->game->getSnake()->getLength();
+				if (updateResult.appleSpawnedFlag) {
+					this->soundEffects->trigger(SoundEffectId::FOOD_SPAWNED); // Play sound when a new apple appears
+				}
 
-						this->beginGameDoneSummaryMusic(); // Start summary music
-					} else {
-						this->beginWaitToStartMusic(); // Restart wait-to-start music
-					}
+				if (updateResult.snakeAteAppleFlag) {
+					this->soundEffects->trigger(SoundEffectId::EAT_APPLE); // Play sound when apple is eaten
+				}
+
+				if (updateResult.snakeHitBarrierFlag) {
+					this->soundEffects->trigger(SoundEffectId::HIT_BARRIER); // Play sound when hitting barrier
+
+					this->finishGame();
+				} else if (this->game->getFieldFull()) {
+					// No apple can spawn on a full field, so filling it wins the game
+					this->finishGame();
 				}
 
 				this->nextSnakeMovementInput = ObjectDirection::NONE;
 			}
 
+			// Start every sound effect triggered this frame, the scope ends with it so starting the next game and the music are not charged to audio
+			{
+				AllocationScope allocationScope(AllocationSubsystem::AUDIO);
+				this->soundEffects->flush();
+			}
+
+			// A bot starts the next game by itself once the summary has been up a while
+			bool botPlayingFlag = (this->autopilot != nullptr) || (this->perfectPlaySolver != nullptr) || (this->mctsBot != nullptr);
+			if (botPlayingFlag && (this->mode == QuickGameMode::GAME_DONE_SUMMARY)) {
+				this->framesSinceGameDone++;
+				if (this->framesSinceGameDone >= QUICK_GAME_AUTOPILOT_RESTART_FRAMES) {
+					this->beginGame();
+				}
+			}
+
 			// Manage music when in GAME_DONE_SUMMARY mode
 			if (this->mode == QuickGameMode::GAME_DONE_SUMMARY) {
 				if (this->gameDoneSummaryMusicLoaded) {
@@ -161,7 +314,7 @@
 		// Render the game state to the window
 		void QuickGameController::render() {
 			QuickGameRenderState renderState;
-			renderState.game = this->game;
+			renderState.game = this->gameStartedFlag ? this->game : nullptr;
 			renderState.longestSnake = this->longestSnakeLength;
 			renderState.lastGameBeatLongestSnakeLength = this->lastGameBeatLongestSnakeLength;
 
@@ -181,6 +334,11 @@
 			this->window->display();
 		}
 
+		// Check whether a game is currently being played
+		bool QuickGameController::isGameRunning() const {
+			return this->mode == QuickGameMode::GAME_RUNNING;
+		}
+
 		// Handle key events when waiting to start or in game summary
 		QuickGameSceneClientRequest QuickGameController::processWaitToStartKeyEvent(sf::Event& event) {
 			QuickGameSceneClientRequest result = QuickGameSceneClientRequest::NONE;
@@ -189,20 +347,13 @@
 			case sf::Keyboard::Key::Escape:
 				result = QuickGameSceneClientRequest::RETURN_TO_SPLASH_SCREEN;
 
-				// Free music resources when returning to splash screen
-				this->freeGameRunningMusic();
-				this->freeGameDoneSummaryMusic();
+				// Stop music when returning to splash screen, keeping it loaded for the next visit
+				this->soundEffects->stopAll();
+				this->stopAllMusic();
 				break;
 			case sf::Keyboard::Key::Enter:
 				// Start a new game when Enter is pressed
-				if (this->game != nullptr) {
-					delete this->game;
-				}
-
-				this->startGame();
-				this->mode = QuickGameMode::GAME_RUNNING;
-
-				this->beginGameRunningMusic(); // Start game running music
+				this->beginGame();
 				break;
 			}
 
@@ -218,8 +369,8 @@
 				// Pause game and return to WAIT_TO_START mode
 				this->mode = QuickGameMode::WAIT_TO_START;
 
-				delete this->game;
-				this->game = nullptr;
+				this->gameStartedFlag = false;
+				this->publishSpectatorPhase();
 
 				this->beginWaitToStartMusic(); // Restart wait-to-start music
 				break;
@@ -244,21 +395,179 @@
 			return result;
 		}
 
-		// Start a new game with predefined settings
+		// Get the predefined settings of a game on the plain field
+		QuickGameDefn QuickGameController::resolveGameDefn() const {
+			QuickGameDefn result;
+			result.fieldSize = this->fieldSize;
+			result.snakeSpeedTilesPerSecond = 10.0f;
+			// Half way across and two fifths of the way down, (25, 10) on the default field
+			result.snakeStartDefn.headPosition.x = this->fieldSize.x / 2;
+			result.snakeStartDefn.headPosition.y = (this->fieldSize.y * 2) / 5;
+			result.snakeStartDefn.facingDirection = ObjectDirection::DOWN;
+			result.snakeStartDefn.length = 3;
+			result.randomSeed = (unsigned int)time(NULL);
+			return result;
+		}
+
+		// Start a new game with predefined settings, on the level when there is one
 		void QuickGameController::startGame() {
-			QuickGameDefn gameDefn;
-			gameDefn.fieldSize = sf::Vector2i(50, 25);
-			gameDefn.snakeSpeedTilesPerSecond = 10.0f;
-			gameDefn.snakeStartDefn.headPosition.x = 25;
-			gameDefn.snakeStartDefn.headPosition.y = 10;
-			gameDefn.snakeStartDefn.facingDirection = ObjectDirection::DOWN;
-			gameDefn.snakeStartDefn.length = 3;
+			QuickGameDefn gameDefn = this->resolveGameDefn();
+
+			// The next generated level is requested as soon as this one is handed out, so it is ready before this game ends
+			const Level* gameLevel = this->level;
+			if (this->levelGenerator != nullptr) {
+				LevelGeneratorStats levelStats;
+				gameLevel = this->levelGenerator->take(levelStats);
+				fprintf(stderr, "Generated a level in %lld us after %d attempt(s)%s\n", (long long)levelStats.elapsedMicroseconds, levelStats.attemptCount,
+					levelStats.fallbackFlag ? ", none passed so the field is left open" : "");
+				this->levelGenerator->request(gameDefn, this->nextLevelSeed++);
+			}
+			if (gameLevel != nullptr) {
+				gameDefn.snakeStartDefn = gameLevel->getSnakeStartDefn();
+			}
+
+			// Construct the game the first time, then reset it in place
+			if (this->game == nullptr) {
+				this->game = new QuickGame(&gameDefn);
+			} else {
+				this->game->reset(&gameDefn);
+			}
+			this->game->setLevel(gameLevel);
+			this->game->setFoodCount(this->foodCount);
+			this->gameStartedFlag = true;
+
+			// The solver needs a cycle for this field size, without one the game is left to the keyboard
+			if ((this->perfectPlaySolver != nullptr) && !this->perfectPlaySolver->prepare(gameDefn.fieldSize, QUICK_GAME_CYCLE_CACHE_DIRECTORY)) {
+				fprintf(stderr, "No Hamiltonian cycle fits a %dx%d field, perfect play is off\n", gameDefn.fieldSize.x, gameDefn.fieldSize.y);
+				delete this->perfectPlaySolver;
+				this->perfectPlaySolver = nullptr;
+			}
+
+			if (this->replaySaver != nullptr) {
+				this->replaySaver->getRecorder().begin(gameDefn);
+			}
+
+			if (this->spectatorPublisher != nullptr) {
+				this->spectatorPublisher->publishGame(gameDefn, gameLevel, this->foodCount);
+			}
+
+			// Rewind the summary music for the end of this game
+			this->ensureGameDoneSummaryMusicLoaded();
+			if (this->gameDoneSummaryMusicLoaded) {
+				this->gameDoneSummaryMusic->stop();
+			}
+		}
 
-			this->game = new QuickGame(&gameDefn);
+		// Start a new game and switch to running it
+		void QuickGameController::beginGame() {
+			this->startGame();
+			this->mode = QuickGameMode::GAME_RUNNING;
+			this->publishSpectatorPhase();
 
+			this->soundEffects->trigger(SoundEffectId::SNAKE_HISS); // Play sound when the snake sets off
 
-			    this->freeGameDoneSummaryMusic();
-    this->ensureGameDoneSummaryMusicLoaded();
+			this->beginGameRunningMusic(); // Start game running music
+		}
+
+		// End the game and show the summary
+		void QuickGameController::finishGame() {
+			// Change mode to GAME_DONE_SUMMARY
+			this->mode = QuickGameMode::GAME_DONE_SUMMARY;
+
+			this->saveReplay();
+			this->reportSoundEffectStats();
+			this->reportAutopilotStats();
+			this->reportMctsStats();
+			this->framesSinceGameDone = 0;
+
+			this->lastGameBeatLongestSnakeLength = false;
+			int endedGameSnakeLength = this->game->getSnake()->getLength();
+			if (endedGameSnakeLength > this->longestSnakeLength) {
+				this->lastGameBeatLongestSnakeLength = true;
+				this->longestSnakeLength = this->game->getSnake()->getLength();
+
+				this->beginGameDoneSummaryMusic(); // Start summary music
+			} else {
+				this->beginWaitToStartMusic(); // Restart wait-to-start music
+			}
+
+			this->publishSpectatorPhase();
+		}
+
+		// Save the finished game as a replay named after its seed on the saver's worker thread, when replays are recorded
+		void QuickGameController::saveReplay() {
+			if (this->replaySaver == nullptr) {
+				return;
+			}
+
+			// The previous game's save has had the whole of this game to finish, so this rarely waits
+			this->finishReplaySave();
+
+			char replayPath[1024];
+			snprintf(replayPath, sizeof(replayPath), "%s/game-%u.snkr", this->replayDirectory, this->replaySaver->getRecorder().getGameDefn().randomSeed);
+			this->replaySaver->save(replayPath);
+		}
+
+		// Wait for the replay being saved, reporting it when it could not be written
+		void QuickGameController::finishReplaySave() {
+			if (!this->replaySaver->finishSave()) {
+				fprintf(stderr, "Could not save replay %s\n", this->replaySaver->getSavePath());
+			}
+		}
+
+		// Print how long the finished game's sound effects waited between being triggered and being started
+		void QuickGameController::reportSoundEffectStats() {
+			const SoundEffectLatencyStats& stats = this->soundEffects->getLatencyStats();
+			double meanMicroseconds = (stats.playedCount > 0) ? ((double)stats.totalMicroseconds / (double)stats.playedCount) : 0.0;
+			fprintf(stderr, "sound effects: %d played, trigger to play() %.1f us mean, %lld us max, %d dropped, %d stolen\n",
+				stats.playedCount, meanMicroseconds, (long long)stats.maxMicroseconds, stats.droppedCount, stats.stolenCount);
+
+			this->soundEffects->resetLatencyStats();
+		}
+
+		// Print how long the autopilot spent planning the finished game, when the autopilot plays
+		void QuickGameController::reportAutopilotStats() {
+			if (this->autopilot == nullptr) {
+				return;
+			}
+
+			const AutopilotStats& stats = this->autopilot->getStats();
+			double meanMicroseconds = (stats.tickCount > 0) ? ((double)stats.totalMicroseconds / (double)stats.tickCount) : 0.0;
+			fprintf(stderr, "autopilot: length %d, %d frames, %d plans, %.1f us mean, %lld us max, %d over budget\n",
+				this->game->getSnake()->getLength(), stats.tickCount, stats.planCount, meanMicroseconds, (long long)stats.maxMicroseconds, stats.overBudgetCount);
+
+			this->autopilot->resetStats();
+		}
+
+		// Print how much the tree search bot searched in the finished game, when it plays
+		void QuickGameController::reportMctsStats() {
+			if (this->mctsBot == nullptr) {
+				return;
+			}
+
+			const MctsBotStats& stats = this->mctsBot->getStats();
+			int workerCount = this->mctsBot->getSettings().workerCount;
+			double rolloutsPerSecond = (stats.searchSeconds > 0.0) ? ((double)stats.rolloutCount / stats.searchSeconds) : 0.0;
+			fprintf(stderr, "mcts: length %d, %d searches, %lld rollouts, %.0f rollouts/s on %d worker(s), %.0f rollouts/s per core, %lld of %lld tasks stolen, %d nodes max\n",
+				this->game->getSnake()->getLength(), stats.searchCount, stats.rolloutCount, rolloutsPerSecond, workerCount,
+				rolloutsPerSecond / (double)workerCount, stats.stolenTaskCount, stats.taskCount, stats.maxNodesUsed);
+
+			this->mctsBot->resetStats();
+		}
+
+		// Tell spectators what the window is showing now, when the games are broadcast
+		void QuickGameController::publishSpectatorPhase() {
+			if (this->spectatorPublisher == nullptr) {
+				return;
+			}
+
+			SpectatorPhase phase = SpectatorPhase::WAITING;
+			if (this->mode == QuickGameMode::GAME_RUNNING) {
+				phase = SpectatorPhase::RUNNING;
+			} else if (this->mode == QuickGameMode::GAME_DONE_SUMMARY) {
+				phase = SpectatorPhase::DONE;
+			}
+			this->spectatorPublisher->publishPhase(phase, this->longestSnakeLength, this->lastGameBeatLongestSnakeLength);
 		}
 
 		// Ensure game running music is loaded
@@ -282,6 +591,16 @@
 			}
 		}
 
+		// Stop all music without freeing it
+		void QuickGameController::stopAllMusic() {
+			if (this->gameRunningMusicLoaded) {
+				this->gameRunningMusic->stop();
+			}
+			if (this->gameDoneSummaryMusicLoaded) {
+				this->gameDoneSummaryMusic->stop();
+			}
+		}
+
 		// Ensure game done summary music is loaded
 		void QuickGameController::ensureGameDoneSummaryMusicLoaded() {
 			if (!this->gameDoneSummaryMusicLoaded) {
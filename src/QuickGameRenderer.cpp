@@ -1,6 +1,9 @@
 #include <assert.h>
+#include <wchar.h>
+#include <algorithm>
 #include "includes/utils.hpp"
 #include "includes/quickgamescene.hpp"
+#include "includes/level.hpp"
 
 
 	namespace snake {
@@ -11,6 +14,8 @@
 		const char* SNAKE_TILESET_TEXTURE_PATH = "resources/textures/snake-tileset.png";
 
 		const char* FOOD_TILESET_TEXTURE_PATH = "resources/textures/food-tileset.png";
+		// Path to the texture for the spikes of levels
+		const char* DANGER_TILESET_TEXTURE_PATH = "resources/textures/danger-tileset.png";
 
 		// Size of each snake tile in pixels
 		const int SNAKE_TILE_PIXEL_SIZE = 75;
@@ -18,15 +23,32 @@
 		const float SNAKE_TILE_VIEWPORT_SIZE = 37.5f;
 		// Position of the field viewport in the game window
 		const sf::Vector2f FIELD_VIEWPORT_POSITION(22.0f, 108.0f); // TODO: configurable based on field size...  this is the furthest top-left position
-		// Size of the field in tiles
-		const sf::Vector2i FIELD_SIZE(50, 25); // TODO: field size is part of the game state...
+		// Tiles the field viewport has room for, larger fields only draw the part around the snake's head
+		const sf::Vector2i FIELD_VIEWPORT_TILES(QUICK_GAME_DEFAULT_FIELD_WIDTH, QUICK_GAME_DEFAULT_FIELD_HEIGHT);
+		// Most quads the field batches hold, grass and a shrub over every tile in view, or a spike over every tile in view
+		const int FIELD_BATCH_QUAD_CAPACITY = QUICK_GAME_DEFAULT_FIELD_WIDTH * QUICK_GAME_DEFAULT_FIELD_HEIGHT * 2;
+		const int DANGER_BATCH_QUAD_CAPACITY = QUICK_GAME_DEFAULT_FIELD_WIDTH * QUICK_GAME_DEFAULT_FIELD_HEIGHT;
+		const int FOOD_BATCH_QUAD_CAPACITY = QUICK_GAME_DEFAULT_FIELD_WIDTH * QUICK_GAME_DEFAULT_FIELD_HEIGHT;
 
 		// Background color for the quick game scene
 		const sf::Color QUICK_GAME_BACKGROUND_COLOR = sf::Color(0, 126, 3, 255);
 
-		// Format strings for displaying game statistics
-		const wchar_t* SNAKE_LENGTH_FORMAT_STRING = L"Snake Length: %d";
-		const wchar_t* LONGEST_SNAKE_FORMAT_STRING = L"Longest Snake: %d";
+		// Most pixels the minimap covers, and the most blocks along each side of the finest level of its pyramid
+		const sf::Vector2i MINIMAP_SIZE(240, 120);
+		const int MINIMAP_MAX_BLOCKS = 256;
+		// Gap between the minimap and the bottom right corner of the field viewport
+		const float MINIMAP_MARGIN = 12.0f;
+		// Colors of empty blocks, and of blocks with snake in them that get brighter the more of the block the snake covers
+		const sf::Color MINIMAP_EMPTY_COLOR = sf::Color(0, 60, 0, 220);
+		const sf::Color MINIMAP_FRAME_COLOR = sf::Color(255, 255, 255, 200);
+		const sf::Color MINIMAP_APPLE_COLOR = sf::Color(230, 20, 20, 255);
+		const int MINIMAP_SNAKE_MIN_BRIGHTNESS = 150;
+
+		// Prefixes for displaying game statistics, the number is appended after them
+		const wchar_t* SNAKE_LENGTH_PREFIX_STRING = L"Snake Length: ";
+		const wchar_t* LONGEST_SNAKE_PREFIX_STRING = L"Longest Snake: ";
+		// Every digit, used to load their glyphs and size the score strings before the first frame
+		const wchar_t* SCORE_WARMUP_DIGITS = L"0123456789";
 
 		// Instructions for starting and exiting the game
 		const wchar_t* START_INSTRUCTIONS = L"Press ENTER to start game";
@@ -42,6 +64,17 @@
 				sprite.setScale(0.5f, 0.5f); // Scale the sprite to fit the viewport
 			}
 
+			// Add a tile at its viewport position to a batch, as the quad a half scale sprite of it would cover
+			void appendTileQuad(sf::Vertex* vertices, int& vertexCount, sf::Vector2f position, int pixelLeft, int pixelTop) {
+				float pixelRight = (float)(pixelLeft + SNAKE_TILE_PIXEL_SIZE);
+				float pixelBottom = (float)(pixelTop + SNAKE_TILE_PIXEL_SIZE);
+				vertices[vertexCount + 0] = sf::Vertex(position, sf::Vector2f((float)pixelLeft, (float)pixelTop));
+				vertices[vertexCount + 1] = sf::Vertex(position + sf::Vector2f(SNAKE_TILE_VIEWPORT_SIZE, 0.0f), sf::Vector2f(pixelRight, (float)pixelTop));
+				vertices[vertexCount + 2] = sf::Vertex(position + sf::Vector2f(SNAKE_TILE_VIEWPORT_SIZE, SNAKE_TILE_VIEWPORT_SIZE), sf::Vector2f(pixelRight, pixelBottom));
+				vertices[vertexCount + 3] = sf::Vertex(position + sf::Vector2f(0.0f, SNAKE_TILE_VIEWPORT_SIZE), sf::Vector2f((float)pixelLeft, pixelBottom));
+				vertexCount += 4;
+			}
+
 			// Initialize the sprite for the snake's head with the appropriate texture based on direction
 			void initSnakeHeadSprite(sf::Sprite& sprite, const sf::Texture& sourceTexture, ObjectDirection direction) {
 				sprite.setTexture(sourceTexture);
@@ -153,6 +186,36 @@
 		QuickGameRenderer::QuickGameRenderer() {
 			this->uiFont = nullptr;
 			this->snakeTilesetTexture = nullptr;
+			this->fieldSize = sf::Vector2i(QUICK_GAME_DEFAULT_FIELD_WIDTH, QUICK_GAME_DEFAULT_FIELD_HEIGHT);
+			this->cameraPosition = sf::Vector2i(0, 0);
+			this->level = nullptr;
+
+			// The batches are allocated once for the most tiles the viewport shows
+			this->fieldVertices = new sf::Vertex[FIELD_BATCH_QUAD_CAPACITY * 4];
+			this->fieldVertexCount = 0;
+			this->dangerVertices = new sf::Vertex[DANGER_BATCH_QUAD_CAPACITY * 4];
+			this->dangerVertexCount = 0;
+			this->fieldBatchBuiltFlag = false;
+			this->fieldBatchLevel = nullptr;
+			this->foodVertices = new sf::Vertex[FOOD_BATCH_QUAD_CAPACITY * 4];
+			this->foodVertexCount = 0;
+			this->foodBatchFoodSet = nullptr;
+			this->foodBatchChangeCount = 0;
+
+			// The minimap's pixels are set up for the largest texture it uses, the texture itself is made for each field size
+			this->minimapPyramid = new OccupancyPyramid(MINIMAP_MAX_BLOCKS);
+			this->minimapTexture = new sf::Texture();
+			this->minimapPixels = new sf::Uint8[MINIMAP_SIZE.x * MINIMAP_SIZE.y * 4];
+			this->minimapTextureSize = sf::Vector2i(0, 0);
+			this->minimapLevel = -1;
+			this->minimapFrame.setFillColor(sf::Color::Transparent);
+			this->minimapFrame.setOutlineColor(MINIMAP_FRAME_COLOR);
+			this->minimapFrame.setOutlineThickness(2.0f);
+			this->minimapCameraFrame.setFillColor(sf::Color::Transparent);
+			this->minimapCameraFrame.setOutlineColor(MINIMAP_FRAME_COLOR);
+			this->minimapCameraFrame.setOutlineThickness(1.0f);
+			this->minimapAppleMarker.setFillColor(MINIMAP_APPLE_COLOR);
+			this->minimapAppleMarker.setSize(sf::Vector2f(4.0f, 4.0f));
 
 			// Load the font for UI elements
 			this->uiFont = new sf::Font();
@@ -171,6 +234,11 @@
 				throw "Could not load game texture";
 			}
 
+			this->dangerTilesetTexture = new sf::Texture();
+			if (!this->dangerTilesetTexture->loadFromFile(DANGER_TILESET_TEXTURE_PATH)) {
+				throw "Could not load game texture";
+			}
+
 			// Initialize text elements for the UI
 			this->snakeLengthText.setFont(*this->uiFont);
 			this->snakeLengthText.setCharacterSize(48);
@@ -182,6 +250,17 @@
 			this->longestSnakeText.setOutlineColor(sf::Color::White);
 			this->longestSnakeText.setPosition(0.0f, 24.0f);
 
+			// Size the score strings for the longest number they will show and load every digit glyph,
+			// so updating the score later neither allocates nor touches the font
+			this->snakeLengthString = std::wstring(SNAKE_LENGTH_PREFIX_STRING) + SCORE_WARMUP_DIGITS;
+			this->longestSnakeString = std::wstring(LONGEST_SNAKE_PREFIX_STRING) + SCORE_WARMUP_DIGITS;
+			this->snakeLengthText.setString(this->snakeLengthString);
+			this->longestSnakeText.setString(this->longestSnakeString);
+			this->snakeLengthText.getLocalBounds();
+			this->longestSnakeText.getLocalBounds();
+			this->displayedSnakeLength = -1;
+			this->displayedLongestSnake = -1;
+
 			this->startInstructionsText.setFont(*this->uiFont);
 			this->startInstructionsText.setCharacterSize(64);
 			this->startInstructionsText.setOutlineColor(sf::Color::White);
@@ -196,9 +275,14 @@
 			float exitInstructionsWidth = FontUtils::resolveTextWidth(exitInstructionsText);
 			this->exitInstructionsText.setPosition((ViewUtils::VIEW_SIZE.x / 2.0f) - (exitInstructionsWidth / 2.0f), (ViewUtils::VIEW_SIZE.y / 2.0f) + 35.0f);
 
+			this->gameWonText.setFont(*this->uiFont);
+			this->gameWonText.setCharacterSize(64);
+			this->gameWonText.setOutlineColor(sf::Color::White);
+			this->gameWonText.setString(LAST_GAME_WON_STRING);
+			float gameWonWidth = FontUtils::resolveTextWidth(gameWonText);
+			this->gameWonText.setPosition((ViewUtils::VIEW_SIZE.x / 2.0f) - (gameWonWidth / 2.0f), FIELD_VIEWPORT_POSITION.y + (SNAKE_TILE_VIEWPORT_SIZE * 2.0f));
+
 			// Initialize sprites for game objects
-			QuickGameRendererUtils::initSprite(this->grassSprite, *this->snakeTilesetTexture, 0, 375);
-			QuickGameRendererUtils::initSprite(this->shrubSprite, *this->snakeTilesetTexture, 75, 375);
 			QuickGameRendererUtils::initSprite(this->appleSprite, *this->foodTilesetTexture, 150, 0);
 		}
 
@@ -210,12 +294,19 @@
 			if (this->snakeTilesetTexture != nullptr) {
 				delete this->snakeTilesetTexture;
 			}
+			delete this->dangerTilesetTexture;
+			delete[] this->fieldVertices;
+			delete[] this->dangerVertices;
+			delete[] this->foodVertices;
+			delete this->minimapPyramid;
+			delete this->minimapTexture;
+			delete[] this->minimapPixels;
 		}
 
 		// Render the "waiting to start" screen
 		void QuickGameRenderer::renderWaitToStart(sf::RenderTarget& renderTarget, const QuickGameRenderState& gameRenderState) {
 			renderTarget.clear(QUICK_GAME_BACKGROUND_COLOR); // Clear the screen with the background color
-			this->renderPlayingField(renderTarget); // Render the playing field
+			this->renderPlayingField(renderTarget, gameRenderState.game); // Render the playing field
 			this->renderScoreUi(renderTarget, gameRenderState); // Render the score UI
 			renderTarget.draw(startInstructionsText); // Draw start instructions
 			renderTarget.draw(exitInstructionsText); // Draw exit instructions
@@ -224,17 +315,19 @@
 		// Render the game while it is running
 		void QuickGameRenderer::renderGameRunning(sf::RenderTarget& renderTarget, const QuickGameRenderState& gameRenderState) {
 			renderTarget.clear(QUICK_GAME_BACKGROUND_COLOR); // Clear the screen with the background color
-			this->renderPlayingField(renderTarget); // Render the playing field
+			this->renderPlayingField(renderTarget, gameRenderState.game); // Render the playing field
 			this->renderApple(renderTarget, *gameRenderState.game); // Render the apple
 			this->renderSnake(renderTarget, *gameRenderState.game); // Render the snake
+			this->renderMinimap(renderTarget, *gameRenderState.game); // Render the overview of large fields
 			this->renderScoreUi(renderTarget, gameRenderState); // Render the score UI
 		}
 
 		// Render the game summary after it is done
 		void QuickGameRenderer::renderGameDoneSummary(sf::RenderTarget& renderTarget, const QuickGameRenderState& gameRenderState) {
 			renderTarget.clear(QUICK_GAME_BACKGROUND_COLOR); // Clear the screen with the background color
-			this->renderPlayingField(renderTarget); // Render the playing field
+			this->renderPlayingField(renderTarget, gameRenderState.game); // Render the playing field
 			this->renderSnake(renderTarget, *gameRenderState.game); // Render the snake
+			this->renderMinimap(renderTarget, *gameRenderState.game); // Render the overview of large fields
 			this->renderScoreUi(renderTarget, gameRenderState); // Render the score UI
 			if (gameRenderState.lastGameBeatLongestSnakeLength) {
 				this->renderLongestSnakeUi(renderTarget); // Render the longest snake UI if applicable
@@ -243,61 +336,75 @@
 			renderTarget.draw(exitInstructionsText); // Draw exit instructions
 		}
 
-		// Render the playing field with grass and shrub barriers
-		void QuickGameRenderer::renderPlayingField(sf::RenderTarget& renderTarget) {
-			// Draw grass tiles under the entire playing field
-			for (int x = 0; x < FIELD_SIZE.x; x++) {
-				for (int y = 0; y < FIELD_SIZE.y; y++) {
-					this->grassSprite.setPosition(x * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.x, y * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.y);
-					renderTarget.draw(this->grassSprite);
-				}
+		// Render the playing field with grass, shrub barriers and the level's obstacles, sized for the game when there is one and for the last game otherwise
+		void QuickGameRenderer::renderPlayingField(sf::RenderTarget& renderTarget, const QuickGame* game) {
+			if (game != nullptr) {
+				this->fieldSize = game->getFieldSize();
+				this->level = game->getLevel();
+				this->updateCamera(*game);
 			}
 
-			// Draw top and bottom rows of shrub barriers
-			for (int x = 0; x < FIELD_SIZE.x; x++) {
-				this->shrubSprite.setPosition(x * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.x, FIELD_VIEWPORT_POSITION.y);
-				renderTarget.draw(this->shrubSprite);
-
-				this->shrubSprite.setPosition(x * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.x, (FIELD_SIZE.y - 1) * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.y);
-				renderTarget.draw(this->shrubSprite);
+			// The tiles in view only change when the camera moves or another field is shown
+			bool batchStaleFlag =
+				!this->fieldBatchBuiltFlag ||
+				(this->fieldBatchCameraPosition != this->cameraPosition) ||
+				(this->fieldBatchFieldSize != this->fieldSize) ||
+				(this->fieldBatchLevel != this->level);
+			if (batchStaleFlag) {
+				this->buildFieldBatches();
 			}
 
-			// Draw left and right columns of shrub barriers
-			for (int y = 1; y < FIELD_SIZE.y - 1; y++) {
-				this->shrubSprite.setPosition(FIELD_VIEWPORT_POSITION.x, y * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.y);
-				renderTarget.draw(this->shrubSprite);
-
-				this->shrubSprite.setPosition((FIELD_SIZE.x - 1) * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.x, y * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.y);
-				renderTarget.draw(this->shrubSprite);
+			renderTarget.draw(this->fieldVertices, this->fieldVertexCount, sf::Quads, sf::RenderStates(this->snakeTilesetTexture));
+			if (this->dangerVertexCount > 0) {
+				renderTarget.draw(this->dangerVertices, this->dangerVertexCount, sf::Quads, sf::RenderStates(this->dangerTilesetTexture));
 			}
 		}
 
-		// Render the apple on the playing field
+		// Render the apple on the playing field, or every food in view with one draw
 		void QuickGameRenderer::renderApple(sf::RenderTarget& renderTarget, const QuickGame& game) {
-			if (game.getAppleExists()) {
-				sf::Vector2i applePosition = game.getApplePosition();
-				this->appleSprite.setPosition(applePosition.x * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.x, applePosition.y * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.y);
+			const FoodSet* foodSet = game.getFoodSet();
+			if (foodSet != nullptr) {
+				bool batchStaleFlag =
+					(this->foodBatchFoodSet != foodSet) ||
+					(this->foodBatchChangeCount != foodSet->getChangeCount()) ||
+					(this->foodBatchCameraPosition != this->cameraPosition);
+				if (batchStaleFlag) {
+					this->buildFoodBatch(*foodSet);
+				}
+				if (this->foodVertexCount > 0) {
+					renderTarget.draw(this->foodVertices, this->foodVertexCount, sf::Quads, sf::RenderStates(this->foodTilesetTexture));
+				}
+				return;
+			}
+
+			if (game.getAppleExists() && this->tileIsVisible(game.getApplePosition())) {
+				this->appleSprite.setPosition(this->resolveTileViewportPosition(game.getApplePosition()));
 				renderTarget.draw(this->appleSprite);
 			}
 		}
 
 
-		// Render the snake on the playing field
+		// Render the snake on the playing field, skipping the segments outside the viewport
 		void QuickGameRenderer::renderSnake(sf::RenderTarget& renderTarget, const QuickGame& game) {
 			// Render the snake's tail
-			sf::Sprite tailSprite = this->createSnakeTailSprite(game);
-			renderTarget.draw(tailSprite);
+			if (this->tileIsVisible(game.getSnake()->getTail().position)) {
+				this->buildSnakeTailSprite(this->snakeTailSprite, game);
+				renderTarget.draw(this->snakeTailSprite);
+			}
 
-			// Render the snake's body segments from tail to head
+			// Render the snake's body segments from tail to head, reusing one sprite
 			int bodySegmentCount = game.getSnake()->getBodyLength();
 			for (int segmentIndex = bodySegmentCount - 1; segmentIndex >= 0; segmentIndex--) {
-				sf::Sprite currBodySprite = this->createSnakeBodySprite(game.getSnake()->getBody(segmentIndex));
-				renderTarget.draw(currBodySprite);
+				SnakeSegment bodySegment = game.getSnake()->getBody(segmentIndex);
+				if (this->tileIsVisible(bodySegment.position)) {
+					this->buildSnakeBodySprite(this->snakeBodySprite, bodySegment);
+					renderTarget.draw(this->snakeBodySprite);
+				}
 			}
 
-			// Render the snake's head
-			sf::Sprite headSprite = this->createSnakeHeadSprite(game);
-			renderTarget.draw(headSprite);
+			// Render the snake's head, the camera follows it so it is always visible
+			this->buildSnakeHeadSprite(this->snakeHeadSprite, game);
+			renderTarget.draw(this->snakeHeadSprite);
 		}
 
 		// Render the score UI elements on the screen
@@ -308,32 +415,31 @@
 				currSnakeLength = gameRenderState.game->getSnake()->getLength();
 			}
 
-			wchar_t snakeLengthString[32];
-			swprintf_s(snakeLengthString, SNAKE_LENGTH_FORMAT_STRING, currSnakeLength);
-			snakeLengthText.setString(snakeLengthString);
+			if (currSnakeLength != this->displayedSnakeLength) {
+				FontUtils::replaceNumberSuffix(this->snakeLengthString, wcslen(SNAKE_LENGTH_PREFIX_STRING), currSnakeLength);
+				this->snakeLengthText.setString(this->snakeLengthString);
+				this->displayedSnakeLength = currSnakeLength;
+			}
 			renderTarget.draw(snakeLengthText);
 
 			// Draw the longest snake length
-			wchar_t longestSnakeString[32];
-			swprintf_s(longestSnakeString, LONGEST_SNAKE_FORMAT_STRING, gameRenderState.longestSnake);
-			longestSnakeText.setString(longestSnakeString);
-			float longestSnakeTextWidth = FontUtils::resolveTextWidth(longestSnakeText);
-			longestSnakeText.setPosition(ViewUtils::VIEW_SIZE.x - longestSnakeTextWidth - 24.0f, 24.0f);
+			if (gameRenderState.longestSnake != this->displayedLongestSnake) {
+				FontUtils::replaceNumberSuffix(this->longestSnakeString, wcslen(LONGEST_SNAKE_PREFIX_STRING), gameRenderState.longestSnake);
+				this->longestSnakeText.setString(this->longestSnakeString);
+				float longestSnakeTextWidth = FontUtils::resolveTextWidth(longestSnakeText);
+				this->longestSnakeText.setPosition(ViewUtils::VIEW_SIZE.x - longestSnakeTextWidth - 24.0f, 24.0f);
+				this->displayedLongestSnake = gameRenderState.longestSnake;
+			}
 			renderTarget.draw(longestSnakeText);
 		}
 
 		// Render the UI indicating the longest snake achievement
 		void QuickGameRenderer::renderLongestSnakeUi(sf::RenderTarget& renderTarget) {
-			sf::Text gameWonText;
-			gameWonText.setFont(*this->uiFont);
-			gameWonText.setCharacterSize(64);
-			gameWonText.setOutlineColor(sf::Color::White);
-			gameWonText.setString(LAST_GAME_WON_STRING);
-			float gameWonWidth = FontUtils::resolveTextWidth(gameWonText);
-			float gameWonLeftPos = (ViewUtils::VIEW_SIZE.x / 2.0f) - (gameWonWidth / 2.0f);
-			float gameWonTopPos = FIELD_VIEWPORT_POSITION.y + (SNAKE_TILE_VIEWPORT_SIZE * 2.0f);
-			gameWonText.setPosition(gameWonLeftPos, gameWonTopPos);
-			renderTarget.draw(gameWonText);
+			// The message is laid out once in the constructor
+			float gameWonWidth = FontUtils::resolveTextWidth(this->gameWonText);
+			float gameWonLeftPos = this->gameWonText.getPosition().x;
+			float gameWonTopPos = this->gameWonText.getPosition().y;
+			renderTarget.draw(this->gameWonText);
 
 			// Render apples to either side of the "Game Won" message
 			this->appleSprite.setScale(1.2f, 1.2f);
@@ -347,37 +453,211 @@
 			this->appleSprite.setScale(0.5f, 0.5f);
 		}
 
-		// Create and return a sprite for the snake's head
-		sf::Sprite QuickGameRenderer::createSnakeHeadSprite(const QuickGame& game) {
-			sf::Sprite result;
+		// Render the minimap of a field larger than the viewport, with the part in view framed
+		void QuickGameRenderer::renderMinimap(sf::RenderTarget& renderTarget, const QuickGame& game) {
+			if ((this->fieldSize.x <= FIELD_VIEWPORT_TILES.x) && (this->fieldSize.y <= FIELD_VIEWPORT_TILES.y)) {
+				return; // The whole field is already in view
+			}
 
-			SnakeSegment head = game.getSnake()->getHead();
+			// Only the blocks over the cells the snake moved through since the last frame change
+			this->minimapPyramid->sync(game);
+			int level = this->minimapPyramid->resolveLevelForSize(MINIMAP_SIZE);
+			sf::Vector2i levelSize = this->minimapPyramid->getLevelSize(level);
+
+			// Changed blocks of the finest level, scaled down to the level shown
+			sf::Vector2i dirtyMin;
+			sf::Vector2i dirtyMax;
+			bool dirtyFlag = this->minimapPyramid->takeDirtyRect(dirtyMin, dirtyMax);
+			dirtyMin = sf::Vector2i(dirtyMin.x >> level, dirtyMin.y >> level);
+			dirtyMax = sf::Vector2i(dirtyMax.x >> level, dirtyMax.y >> level);
+			if ((level != this->minimapLevel) || (levelSize != this->minimapTextureSize)) {
+				// A new field size, the texture is made once and filled whole
+				this->minimapTexture->create(levelSize.x, levelSize.y);
+				this->minimapSprite.setTexture(*this->minimapTexture, true);
+				this->minimapTextureSize = levelSize;
+				this->minimapLevel = level;
+
+				float scale = std::min((float)MINIMAP_SIZE.x / (float)levelSize.x, (float)MINIMAP_SIZE.y / (float)levelSize.y);
+				sf::Vector2f minimapPosition(
+					FIELD_VIEWPORT_POSITION.x + (FIELD_VIEWPORT_TILES.x * SNAKE_TILE_VIEWPORT_SIZE) - (levelSize.x * scale) - MINIMAP_MARGIN,
+					FIELD_VIEWPORT_POSITION.y + (FIELD_VIEWPORT_TILES.y * SNAKE_TILE_VIEWPORT_SIZE) - (levelSize.y * scale) - MINIMAP_MARGIN);
+				this->minimapSprite.setScale(scale, scale);
+				this->minimapSprite.setPosition(minimapPosition);
+				this->minimapFrame.setPosition(minimapPosition);
+				this->minimapFrame.setSize(sf::Vector2f(levelSize.x * scale, levelSize.y * scale));
+
+				dirtyFlag = true;
+				dirtyMin = sf::Vector2i(0, 0);
+				dirtyMax = levelSize - sf::Vector2i(1, 1);
+			}
+			if (dirtyFlag) {
+				this->uploadMinimapBlocks(dirtyMin, dirtyMax);
+			}
 
-			QuickGameRendererUtils::initSnakeHeadSprite(result, *this->snakeTilesetTexture, head.enterDirection);
-			result.setPosition(head.position.x * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.x, head.position.y * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.y);
+			renderTarget.draw(this->minimapSprite);
+			renderTarget.draw(this->minimapFrame);
 
-			return result;
+			// Cells are placed on the minimap by the size of a block and the scale of a pixel
+			sf::Vector2f minimapPosition = this->minimapSprite.getPosition();
+			float pixelsPerCell = this->minimapFrame.getSize().x / (float)(levelSize.x << this->minimapPyramid->getBlockShift(level));
+
+			this->minimapCameraFrame.setPosition(minimapPosition.x + (this->cameraPosition.x * pixelsPerCell), minimapPosition.y + (this->cameraPosition.y * pixelsPerCell));
+			this->minimapCameraFrame.setSize(sf::Vector2f(
+				std::max(FIELD_VIEWPORT_TILES.x * pixelsPerCell, 2.0f),
+				std::max(FIELD_VIEWPORT_TILES.y * pixelsPerCell, 2.0f)));
+			renderTarget.draw(this->minimapCameraFrame);
+
+			if (game.getAppleExists()) {
+				sf::Vector2i applePosition = game.getApplePosition();
+				this->minimapAppleMarker.setPosition(minimapPosition.x + (applePosition.x * pixelsPerCell) - 2.0f, minimapPosition.y + (applePosition.y * pixelsPerCell) - 2.0f);
+				renderTarget.draw(this->minimapAppleMarker);
+			}
 		}
 
-		// Create and return a sprite for the snake's tail
-		sf::Sprite QuickGameRenderer::createSnakeTailSprite(const QuickGame& game) {
-			sf::Sprite result;
+		// Repaint a rectangle of the minimap's blocks and upload only those pixels
+		void QuickGameRenderer::uploadMinimapBlocks(sf::Vector2i blockMin, sf::Vector2i blockMax) {
+			int level = this->minimapLevel;
+			long long blockCellCount = 1LL << (this->minimapPyramid->getBlockShift(level) * 2);
+			sf::Vector2i rectSize = blockMax - blockMin + sf::Vector2i(1, 1);
+
+			// The rectangle's pixels are packed at the start of the buffer, the way the texture update takes them
+			sf::Uint8* pixel = this->minimapPixels;
+			for (int y = blockMin.y; y <= blockMax.y; y++) {
+				for (int x = blockMin.x; x <= blockMax.x; x++) {
+					int segmentCount = this->minimapPyramid->getSegmentCount(level, sf::Vector2i(x, y));
+					sf::Color color = MINIMAP_EMPTY_COLOR;
+					if (segmentCount > 0) {
+						// A quarter covered block is already at full brightness, so thin snakes on coarse levels still show
+						long long coverage = std::min((segmentCount * 4LL * (255 - MINIMAP_SNAKE_MIN_BRIGHTNESS)) / blockCellCount, 255LL - MINIMAP_SNAKE_MIN_BRIGHTNESS);
+						sf::Uint8 brightness = (sf::Uint8)(MINIMAP_SNAKE_MIN_BRIGHTNESS + coverage);
+						color = sf::Color(brightness, brightness, 40, 255);
+					}
+					pixel[0] = color.r;
+					pixel[1] = color.g;
+					pixel[2] = color.b;
+					pixel[3] = color.a;
+					pixel += 4;
+				}
+			}
+			this->minimapTexture->update(this->minimapPixels, rectSize.x, rectSize.y, blockMin.x, blockMin.y);
+		}
 
-			SnakeSegment tail = game.getSnake()->getTail();
+		// Centre the camera on the snake's head, stopping at the field's edges so no tile past them is shown
+		void QuickGameRenderer::updateCamera(const QuickGame& game) {
+			sf::Vector2i headPosition = game.getSnake()->getHead().position;
+			sf::Vector2i maxCameraPosition(
+				std::max(this->fieldSize.x - FIELD_VIEWPORT_TILES.x, 0),
+				std::max(this->fieldSize.y - FIELD_VIEWPORT_TILES.y, 0));
 
-			QuickGameRendererUtils::initSnakeTailSprite(result, *this->snakeTilesetTexture, tail.exitDirection);
-			result.setPosition(tail.position.x * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.x, tail.position.y * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.y);
+			this->cameraPosition.x = std::min(std::max(headPosition.x - (FIELD_VIEWPORT_TILES.x / 2), 0), maxCameraPosition.x);
+			this->cameraPosition.y = std::min(std::max(headPosition.y - (FIELD_VIEWPORT_TILES.y / 2), 0), maxCameraPosition.y);
+		}
 
-			return result;
+		// Lay out the tiles in view as quads, grass under every tile with shrubs over the field's edge and the level's shrubs, and the level's spikes in their own batch
+		void QuickGameRenderer::buildFieldBatches() {
+			sf::Vector2i fieldSize = this->fieldSize;
+
+			// Only the tiles inside the viewport are laid out, however large the field is
+			sf::Vector2i visibleEnd(
+				std::min(this->cameraPosition.x + FIELD_VIEWPORT_TILES.x, fieldSize.x),
+				std::min(this->cameraPosition.y + FIELD_VIEWPORT_TILES.y, fieldSize.y));
+
+			this->fieldVertexCount = 0;
+			this->dangerVertexCount = 0;
+			for (int x = this->cameraPosition.x; x < visibleEnd.x; x++) {
+				for (int y = this->cameraPosition.y; y < visibleEnd.y; y++) {
+					sf::Vector2i position(x, y);
+					sf::Vector2f tilePosition = this->resolveTileViewportPosition(position);
+					QuickGameRendererUtils::appendTileQuad(this->fieldVertices, this->fieldVertexCount, tilePosition, 0, 375);
+
+					LevelTile tile = (this->level != nullptr) ? this->level->getTile(position) : LevelTile::GRASS;
+					bool barrierFlag = (x == 0) || (y == 0) || (x == fieldSize.x - 1) || (y == fieldSize.y - 1);
+					if (tile == LevelTile::SPIKES) {
+						QuickGameRendererUtils::appendTileQuad(this->dangerVertices, this->dangerVertexCount, tilePosition, 0, 0);
+					} else if (tile == LevelTile::RED_SPIKES) {
+						QuickGameRendererUtils::appendTileQuad(this->dangerVertices, this->dangerVertexCount, tilePosition, 75, 0);
+					} else if (barrierFlag || (tile == LevelTile::SHRUB)) {
+						QuickGameRendererUtils::appendTileQuad(this->fieldVertices, this->fieldVertexCount, tilePosition, 75, 375);
+					}
+				}
+			}
+
+			this->fieldBatchBuiltFlag = true;
+			this->fieldBatchCameraPosition = this->cameraPosition;
+			this->fieldBatchFieldSize = fieldSize;
+			this->fieldBatchLevel = this->level;
 		}
 
-		// Create and return a sprite for a body segment of the snake
-		sf::Sprite QuickGameRenderer::createSnakeBodySprite(const SnakeSegment& snakeSegment) {
-			sf::Sprite result;
+		// Get where a field tile is drawn in the view
+		// Put every food in view into the batch, going through the foods or through the cells in view, whichever there are fewer of
+		void QuickGameRenderer::buildFoodBatch(const FoodSet& foodSet) {
+			this->foodVertexCount = 0;
+
+			sf::Vector2i viewMax(
+				std::min(this->cameraPosition.x + FIELD_VIEWPORT_TILES.x, this->fieldSize.x),
+				std::min(this->cameraPosition.y + FIELD_VIEWPORT_TILES.y, this->fieldSize.y));
+			int viewCellCount = (viewMax.x - this->cameraPosition.x) * (viewMax.y - this->cameraPosition.y);
+
+			if (foodSet.getCount() <= viewCellCount) {
+				for (int foodIndex = 0; foodIndex < foodSet.getCount(); foodIndex++) {
+					const FoodItem& food = foodSet.getItem(foodIndex);
+					if (this->tileIsVisible(food.position)) {
+						sf::Vector2i tilesetPosition = FoodSetUtils::resolveTilesetPosition(food.foodType);
+						QuickGameRendererUtils::appendTileQuad(this->foodVertices, this->foodVertexCount, this->resolveTileViewportPosition(food.position), tilesetPosition.x, tilesetPosition.y);
+					}
+				}
+			} else {
+				for (int y = this->cameraPosition.y; y < viewMax.y; y++) {
+					for (int x = this->cameraPosition.x; x < viewMax.x; x++) {
+						sf::Vector2i position(x, y);
+						FoodType foodType;
+						if (foodSet.findAt(position, foodType)) {
+							sf::Vector2i tilesetPosition = FoodSetUtils::resolveTilesetPosition(foodType);
+							QuickGameRendererUtils::appendTileQuad(this->foodVertices, this->foodVertexCount, this->resolveTileViewportPosition(position), tilesetPosition.x, tilesetPosition.y);
+						}
+					}
+				}
+			}
+
+			this->foodBatchFoodSet = &foodSet;
+			this->foodBatchChangeCount = foodSet.getChangeCount();
+			this->foodBatchCameraPosition = this->cameraPosition;
+		}
 
-			QuickGameRendererUtils::initSnakeBodySprite(result, *this->snakeTilesetTexture, snakeSegment.enterDirection, snakeSegment.exitDirection);
-			result.setPosition(snakeSegment.position.x * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.x, snakeSegment.position.y * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.y);
+		sf::Vector2f QuickGameRenderer::resolveTileViewportPosition(sf::Vector2i position) const {
+			sf::Vector2i viewportTile = position - this->cameraPosition;
+			sf::Vector2f result(viewportTile.x * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.x, viewportTile.y * SNAKE_TILE_VIEWPORT_SIZE + FIELD_VIEWPORT_POSITION.y);
+			return result;
+		}
 
+		// Check whether a field tile is inside the viewport
+		bool QuickGameRenderer::tileIsVisible(sf::Vector2i position) const {
+			sf::Vector2i viewportTile = position - this->cameraPosition;
+			bool result =
+				(viewportTile.x >= 0) && (viewportTile.x < FIELD_VIEWPORT_TILES.x) &&
+				(viewportTile.y >= 0) && (viewportTile.y < FIELD_VIEWPORT_TILES.y);
 			return result;
 		}
+
+		// Set up a sprite for the snake's head
+		void QuickGameRenderer::buildSnakeHeadSprite(sf::Sprite& sprite, const QuickGame& game) {
+			SnakeSegment head = game.getSnake()->getHead();
+
+			QuickGameRendererUtils::initSnakeHeadSprite(sprite, *this->snakeTilesetTexture, head.enterDirection);
+			sprite.setPosition(this->resolveTileViewportPosition(head.position));
+		}
+
+		// Set up a sprite for the snake's tail
+		void QuickGameRenderer::buildSnakeTailSprite(sf::Sprite& sprite, const QuickGame& game) {
+			SnakeSegment tail = game.getSnake()->getTail();
+
+			QuickGameRendererUtils::initSnakeTailSprite(sprite, *this->snakeTilesetTexture, tail.exitDirection);
+			sprite.setPosition(this->resolveTileViewportPosition(tail.position));
+		}
+
+		// Set up a sprite for a body segment of the snake
+		void QuickGameRenderer::buildSnakeBodySprite(sf::Sprite& sprite, const SnakeSegment& snakeSegment) {
+			QuickGameRendererUtils::initSnakeBodySprite(sprite, *this->snakeTilesetTexture, snakeSegment.enterDirection, snakeSegment.exitDirection);
+			sprite.setPosition(this->resolveTileViewportPosition(snakeSegment.position));
+		}
 }
\ No newline at end of file
@@ -0,0 +1,650 @@
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include "includes/replay.hpp"
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+	namespace snake {
+
+		// Every replay file starts with these bytes
+		const char REPLAY_MAGIC[4] = { 'S', 'N', 'K', 'R' };
+		// Version of the replay layout, bumped whenever the layout changes
+		const unsigned int REPLAY_VERSION = 3;
+		// Oldest version that can still be loaded, version 1 replays have no checkpoints and version 2 replays no keyframes
+		const unsigned int REPLAY_OLDEST_VERSION = 1;
+
+		// Size of the header: magic, version, field size, speed, snake start, seed and frame count
+		const int REPLAY_HEADER_SIZE = 4 + (4 * 10);
+
+		// A checkpoint is stored once a second of play at 60 frames per second, and after the last frame
+		const int REPLAY_CHECKPOINT_INTERVAL = 60;
+		// Size of the checkpoint section header (interval and count) and of each checkpoint (frame and hash)
+		const int REPLAY_CHECKPOINT_HEADER_SIZE = 4 * 2;
+		const int REPLAY_CHECKPOINT_SIZE = 4 * 3;
+
+		// A keyframe is stored every 10 seconds of play at 60 frames per second, so a seek never plays more than that
+		const int REPLAY_KEYFRAME_INTERVAL = 600;
+		// The keyframes follow the checkpoints, then an index of them aligned for reading in place and a footer at the very end of the file
+		// that points at the index, so seeking only has to read the end of the file to find every keyframe
+		const char REPLAY_KEYFRAME_MAGIC[4] = { 'S', 'N', 'K', 'K' };
+		const int REPLAY_KEYFRAME_INDEX_ALIGNMENT = 8;
+		// Size of each index entry (frame, size and the low and high halves of the offset) and of the footer (magic, interval, count and index offset)
+		const int REPLAY_KEYFRAME_INDEX_ENTRY_SIZE = 4 * 4;
+		const int REPLAY_KEYFRAME_FOOTER_SIZE = 4 + (4 * 4);
+
+		// Names tried for a background save before giving up, the path itself and then the path with -2 up to this before its extension
+		const int REPLAY_UNIQUE_PATH_ATTEMPTS = 1000;
+
+		// Create an empty file at the path, or at the path with -2, -3 and so on before its extension when a file of that name exists,
+		// and change the path to the one created. Creating it exclusively claims the name, so games saved at once never share one
+		bool reserveReplayPath(std::string& path) {
+			std::size_t extensionOffset = path.rfind('.');
+			std::size_t separatorOffset = path.find_last_of("/\\");
+			if ((extensionOffset == std::string::npos) || ((separatorOffset != std::string::npos) && (extensionOffset < separatorOffset))) {
+				extensionOffset = path.size();
+			}
+
+			for (int attempt = 1; attempt <= REPLAY_UNIQUE_PATH_ATTEMPTS; attempt++) {
+				std::string candidatePath = path;
+				if (attempt > 1) {
+					candidatePath.insert(extensionOffset, "-" + std::to_string(attempt));
+				}
+
+				FILE* file = fopen(candidatePath.c_str(), "wx");
+				if (file != nullptr) {
+					fclose(file);
+					path = candidatePath;
+					return true;
+				}
+				if (errno != EEXIST) {
+					return false;
+				}
+			}
+			return false;
+		}
+
+		// Write a 32 bit value in little endian order
+		void writeReplayWord(unsigned char* bytes, unsigned int value) {
+			bytes[0] = (unsigned char)(value & 0xFF);
+			bytes[1] = (unsigned char)((value >> 8) & 0xFF);
+			bytes[2] = (unsigned char)((value >> 16) & 0xFF);
+			bytes[3] = (unsigned char)((value >> 24) & 0xFF);
+		}
+
+		// Read a 32 bit value in little endian order
+		unsigned int readReplayWord(const unsigned char* bytes) {
+			unsigned int result =
+				((unsigned int)bytes[0]) |
+				((unsigned int)bytes[1] << 8) |
+				((unsigned int)bytes[2] << 16) |
+				((unsigned int)bytes[3] << 24);
+			return result;
+		}
+
+		// Write a checkpoint as its frame followed by the low and high halves of its hash
+		void writeReplayCheckpoint(unsigned char* bytes, const ReplayCheckpoint& checkpoint) {
+			writeReplayWord(bytes, (unsigned int)checkpoint.frame);
+			writeReplayWord(bytes + 4, (unsigned int)(checkpoint.stateHash & 0xFFFFFFFFULL));
+			writeReplayWord(bytes + 8, (unsigned int)(checkpoint.stateHash >> 32));
+		}
+
+		// Read a checkpoint written by writeReplayCheckpoint()
+		ReplayCheckpoint readReplayCheckpoint(const unsigned char* bytes) {
+			ReplayCheckpoint result;
+			result.frame = (int)readReplayWord(bytes);
+			result.stateHash = (std::uint64_t)readReplayWord(bytes + 4) | ((std::uint64_t)readReplayWord(bytes + 8) << 32);
+			return result;
+		}
+
+		// Read the game definition out of a header
+		void readReplayGameDefn(const unsigned char* header, QuickGameDefn& gameDefn) {
+			unsigned int speedBits = readReplayWord(header + 16);
+			memcpy(&gameDefn.snakeSpeedTilesPerSecond, &speedBits, sizeof(speedBits));
+
+			gameDefn.fieldSize.x = (int)readReplayWord(header + 8);
+			gameDefn.fieldSize.y = (int)readReplayWord(header + 12);
+			gameDefn.snakeStartDefn.headPosition.x = (int)readReplayWord(header + 20);
+			gameDefn.snakeStartDefn.headPosition.y = (int)readReplayWord(header + 24);
+			gameDefn.snakeStartDefn.facingDirection = (ObjectDirection)readReplayWord(header + 28);
+			gameDefn.snakeStartDefn.length = (int)readReplayWord(header + 32);
+			gameDefn.randomSeed = readReplayWord(header + 36);
+		}
+
+		// Write a keyframe index entry as its frame and size followed by the low and high halves of its offset
+		void writeReplayKeyframe(unsigned char* bytes, const ReplayKeyframe& keyframe) {
+			writeReplayWord(bytes, (unsigned int)keyframe.frame);
+			writeReplayWord(bytes + 4, keyframe.size);
+			writeReplayWord(bytes + 8, (unsigned int)(keyframe.offset & 0xFFFFFFFFULL));
+			writeReplayWord(bytes + 12, (unsigned int)(keyframe.offset >> 32));
+		}
+
+		// Read a keyframe index entry written by writeReplayKeyframe()
+		ReplayKeyframe readReplayKeyframe(const unsigned char* bytes) {
+			ReplayKeyframe result;
+			result.frame = (int)readReplayWord(bytes);
+			result.size = readReplayWord(bytes + 4);
+			result.offset = (std::uint64_t)readReplayWord(bytes + 8) | ((std::uint64_t)readReplayWord(bytes + 12) << 32);
+			return result;
+		}
+
+		// Constructor for ReplayRecorder
+		ReplayRecorder::ReplayRecorder(int frameCapacity) {
+			this->inputs = new unsigned char[frameCapacity];
+			this->frameCount = 0;
+			this->frameCapacity = frameCapacity;
+			this->truncatedFlag = false;
+
+			this->checkpointCapacity = (frameCapacity / REPLAY_CHECKPOINT_INTERVAL) + 1;
+			this->checkpoints = new ReplayCheckpoint[this->checkpointCapacity];
+			this->checkpointCount = 0;
+			this->lastStateHash = 0;
+
+			this->gameDefn = QuickGameDefn();
+		}
+
+		// Destructor for ReplayRecorder
+		ReplayRecorder::~ReplayRecorder() {
+			delete[] this->inputs;
+			delete[] this->checkpoints;
+		}
+
+		// Start recording a new game, dropping the previous recording
+		void ReplayRecorder::begin(const QuickGameDefn& gameDefn) {
+			this->gameDefn = gameDefn;
+			this->frameCount = 0;
+			this->truncatedFlag = false;
+			this->checkpointCount = 0;
+			this->lastStateHash = 0;
+		}
+
+		// Record the input of one frame, games longer than the buffer are cut off instead of growing it
+		void ReplayRecorder::record(const QuickGameInputRequest& input, std::uint64_t stateHash) {
+			if (this->frameCount >= this->frameCapacity) {
+				this->truncatedFlag = true;
+				return;
+			}
+
+			this->inputs[this->frameCount] = (unsigned char)input.snakeMovementInput;
+			this->frameCount++;
+			this->lastStateHash = stateHash;
+
+			if ((this->frameCount % REPLAY_CHECKPOINT_INTERVAL) == 0) {
+				ReplayCheckpoint& checkpoint = this->checkpoints[this->checkpointCount];
+				checkpoint.frame = this->frameCount;
+				checkpoint.stateHash = stateHash;
+				this->checkpointCount++;
+			}
+		}
+
+		// Write the header, one input byte per frame, the checkpoints, then the keyframes with their index and footer
+		bool ReplayRecorder::saveToFile(const char* path) const {
+			unsigned char header[REPLAY_HEADER_SIZE];
+			unsigned int speedBits;
+			memcpy(&speedBits, &this->gameDefn.snakeSpeedTilesPerSecond, sizeof(speedBits));
+
+			memcpy(header, REPLAY_MAGIC, 4);
+			writeReplayWord(header + 4, REPLAY_VERSION);
+			writeReplayWord(header + 8, (unsigned int)this->gameDefn.fieldSize.x);
+			writeReplayWord(header + 12, (unsigned int)this->gameDefn.fieldSize.y);
+			writeReplayWord(header + 16, speedBits);
+			writeReplayWord(header + 20, (unsigned int)this->gameDefn.snakeStartDefn.headPosition.x);
+			writeReplayWord(header + 24, (unsigned int)this->gameDefn.snakeStartDefn.headPosition.y);
+			writeReplayWord(header + 28, (unsigned int)this->gameDefn.snakeStartDefn.facingDirection);
+			writeReplayWord(header + 32, (unsigned int)this->gameDefn.snakeStartDefn.length);
+			writeReplayWord(header + 36, this->gameDefn.randomSeed);
+			writeReplayWord(header + 40, (unsigned int)this->frameCount);
+
+			// The last frame always gets a checkpoint, so playback confirms the final board
+			bool finalCheckpointFlag = (this->frameCount > 0) && ((this->frameCount % REPLAY_CHECKPOINT_INTERVAL) != 0);
+			int savedCheckpointCount = this->checkpointCount + (finalCheckpointFlag ? 1 : 0);
+
+			unsigned char checkpointHeader[REPLAY_CHECKPOINT_HEADER_SIZE];
+			writeReplayWord(checkpointHeader, (unsigned int)REPLAY_CHECKPOINT_INTERVAL);
+			writeReplayWord(checkpointHeader + 4, (unsigned int)savedCheckpointCount);
+
+			std::vector<unsigned char> keyframeBytes;
+			std::vector<ReplayKeyframe> keyframes;
+			this->buildKeyframes(keyframeBytes, keyframes);
+
+			std::uint64_t keyframeOffset = (std::uint64_t)REPLAY_HEADER_SIZE + this->frameCount + REPLAY_CHECKPOINT_HEADER_SIZE + ((std::uint64_t)savedCheckpointCount * REPLAY_CHECKPOINT_SIZE);
+			std::uint64_t keyframeEndOffset = keyframeOffset + keyframeBytes.size();
+			std::uint64_t indexOffset = (keyframeEndOffset + REPLAY_KEYFRAME_INDEX_ALIGNMENT - 1) & ~(std::uint64_t)(REPLAY_KEYFRAME_INDEX_ALIGNMENT - 1);
+			// Index entries and padding go out in one block after the keyframes
+			std::vector<unsigned char> indexBytes((std::size_t)(indexOffset - keyframeEndOffset) + (keyframes.size() * REPLAY_KEYFRAME_INDEX_ENTRY_SIZE), 0);
+			for (std::size_t keyframeIndex = 0; keyframeIndex < keyframes.size(); keyframeIndex++) {
+				keyframes[keyframeIndex].offset += keyframeOffset;
+				writeReplayKeyframe(indexBytes.data() + (indexOffset - keyframeEndOffset) + (keyframeIndex * REPLAY_KEYFRAME_INDEX_ENTRY_SIZE), keyframes[keyframeIndex]);
+			}
+
+			unsigned char footer[REPLAY_KEYFRAME_FOOTER_SIZE];
+			memcpy(footer, REPLAY_KEYFRAME_MAGIC, 4);
+			writeReplayWord(footer + 4, (unsigned int)REPLAY_KEYFRAME_INTERVAL);
+			writeReplayWord(footer + 8, (unsigned int)keyframes.size());
+			writeReplayWord(footer + 12, (unsigned int)(indexOffset & 0xFFFFFFFFULL));
+			writeReplayWord(footer + 16, (unsigned int)(indexOffset >> 32));
+
+			FILE* file = fopen(path, "wb");
+			if (file == nullptr) {
+				return false;
+			}
+
+			bool result =
+				(fwrite(header, 1, REPLAY_HEADER_SIZE, file) == (size_t)REPLAY_HEADER_SIZE) &&
+				(fwrite(this->inputs, 1, this->frameCount, file) == (size_t)this->frameCount) &&
+				(fwrite(checkpointHeader, 1, REPLAY_CHECKPOINT_HEADER_SIZE, file) == (size_t)REPLAY_CHECKPOINT_HEADER_SIZE);
+
+			unsigned char checkpointBytes[REPLAY_CHECKPOINT_SIZE];
+			for (int checkpointIndex = 0; result && (checkpointIndex < savedCheckpointCount); checkpointIndex++) {
+				ReplayCheckpoint checkpoint;
+				if (checkpointIndex < this->checkpointCount) {
+					checkpoint = this->checkpoints[checkpointIndex];
+				} else {
+					checkpoint.frame = this->frameCount;
+					checkpoint.stateHash = this->lastStateHash;
+				}
+
+				writeReplayCheckpoint(checkpointBytes, checkpoint);
+				result = (fwrite(checkpointBytes, 1, REPLAY_CHECKPOINT_SIZE, file) == (size_t)REPLAY_CHECKPOINT_SIZE);
+			}
+
+			result = result &&
+				(fwrite(keyframeBytes.data(), 1, keyframeBytes.size(), file) == keyframeBytes.size()) &&
+				(fwrite(indexBytes.data(), 1, indexBytes.size(), file) == indexBytes.size()) &&
+				(fwrite(footer, 1, REPLAY_KEYFRAME_FOOTER_SIZE, file) == (size_t)REPLAY_KEYFRAME_FOOTER_SIZE);
+
+			result = (fclose(file) == 0) && result;
+
+			return result;
+		}
+
+		// Get the definition of the game being recorded
+		const QuickGameDefn& ReplayRecorder::getGameDefn() const {
+			return this->gameDefn;
+		}
+
+		// Get the number of frames recorded so far
+		int ReplayRecorder::getFrameCount() const {
+			return this->frameCount;
+		}
+
+		// Check whether the game outlasted the buffer
+		bool ReplayRecorder::getTruncated() const {
+			return this->truncatedFlag;
+		}
+
+		// Play the recording again on a game of its own, saving the game every keyframe interval, offsets are from the first keyframe
+		void ReplayRecorder::buildKeyframes(std::vector<unsigned char>& keyframeBytes, std::vector<ReplayKeyframe>& keyframes) const {
+			keyframeBytes.clear();
+			keyframes.clear();
+			if (this->frameCount < REPLAY_KEYFRAME_INTERVAL) {
+				return;
+			}
+
+			QuickGame game(&this->gameDefn);
+			int nextCheckpointIndex = 0;
+			for (int frame = 0; frame < this->frameCount; frame++) {
+				QuickGameInputRequest input;
+				input.snakeMovementInput = (ObjectDirection)this->inputs[frame];
+				game.update(&input);
+
+				// The checkpoints come from the game that was recorded, a copy that strays from them would save keyframes of another game
+				int framesPlayed = frame + 1;
+				bool checkpointFlag = (nextCheckpointIndex < this->checkpointCount) && (this->checkpoints[nextCheckpointIndex].frame == framesPlayed);
+				bool lastFrameFlag = (framesPlayed == this->frameCount);
+				if ((checkpointFlag && (this->checkpoints[nextCheckpointIndex].stateHash != game.getStateHash())) ||
+					(lastFrameFlag && (this->lastStateHash != game.getStateHash()))) {
+					keyframeBytes.clear();
+					keyframes.clear();
+					return;
+				}
+				if (checkpointFlag) {
+					nextCheckpointIndex++;
+				}
+
+				if ((framesPlayed % REPLAY_KEYFRAME_INTERVAL) == 0) {
+					ReplayKeyframe keyframe;
+					keyframe.frame = framesPlayed;
+					keyframe.offset = keyframeBytes.size();
+					game.saveKeyframe(keyframeBytes);
+					keyframe.size = (std::uint32_t)(keyframeBytes.size() - keyframe.offset);
+					keyframes.push_back(keyframe);
+				}
+			}
+		}
+
+		// Constructor for BackgroundReplaySaver, nothing runs until the first save
+		BackgroundReplaySaver::BackgroundReplaySaver(int frameCapacity) {
+			this->recorders[0] = new ReplayRecorder(frameCapacity);
+			this->recorders[1] = new ReplayRecorder(frameCapacity);
+			this->recordingIndex = 0;
+			this->saveSucceededFlag = true;
+		}
+
+		// Destructor for BackgroundReplaySaver
+		BackgroundReplaySaver::~BackgroundReplaySaver() {
+			this->finishSave();
+			delete this->recorders[0];
+			delete this->recorders[1];
+		}
+
+		// Get the recorder of the running game
+		ReplayRecorder& BackgroundReplaySaver::getRecorder() {
+			return *this->recorders[this->recordingIndex];
+		}
+
+		// Save the finished recording on a worker thread and switch recording to the other recorder, which no save is using
+		void BackgroundReplaySaver::save(const char* path) {
+			assert(!this->thread.joinable()); // Every save has to be finished before the next one
+
+			const ReplayRecorder* recorder = this->recorders[this->recordingIndex];
+			this->savePath = path;
+			this->thread = std::thread([this, recorder]() {
+				this->saveSucceededFlag = reserveReplayPath(this->savePath) && recorder->saveToFile(this->savePath.c_str());
+			});
+			this->recordingIndex = 1 - this->recordingIndex;
+		}
+
+		// Wait for the worker to finish the save in progress
+		bool BackgroundReplaySaver::finishSave() {
+			if (!this->thread.joinable()) {
+				return true;
+			}
+
+			this->thread.join();
+			bool result = this->saveSucceededFlag;
+			return result;
+		}
+
+		// Get the path of the last save, the one it was made under once it has finished
+		const char* BackgroundReplaySaver::getSavePath() const {
+			return this->savePath.c_str();
+		}
+
+		// Constructor for Replay
+		Replay::Replay() {
+			this->gameDefn = QuickGameDefn();
+		}
+
+		// Load a replay file, returns false when it is missing, truncated or of an unknown version
+		bool Replay::loadFromFile(const char* path) {
+			FILE* file = fopen(path, "rb");
+			if (file == nullptr) {
+				return false;
+			}
+
+			this->inputs.clear();
+			this->checkpoints.clear();
+
+			unsigned char header[REPLAY_HEADER_SIZE];
+			bool result = (fread(header, 1, REPLAY_HEADER_SIZE, file) == (size_t)REPLAY_HEADER_SIZE);
+			result = result && (memcmp(header, REPLAY_MAGIC, 4) == 0);
+
+			unsigned int version = result ? readReplayWord(header + 4) : 0;
+			result = result && (version >= REPLAY_OLDEST_VERSION) && (version <= REPLAY_VERSION);
+
+			if (result) {
+				readReplayGameDefn(header, this->gameDefn);
+
+				int frameCount = (int)readReplayWord(header + 40);
+				result = (frameCount >= 0);
+				if (result) {
+					this->inputs.resize(frameCount);
+					result = (fread(this->inputs.data(), 1, frameCount, file) == (size_t)frameCount);
+				}
+			}
+
+			// Keyframes after the checkpoints are only for seeking, loading plays from the start and leaves them alone
+			if (result && (version >= 2)) {
+				unsigned char checkpointHeader[REPLAY_CHECKPOINT_HEADER_SIZE];
+				result = (fread(checkpointHeader, 1, REPLAY_CHECKPOINT_HEADER_SIZE, file) == (size_t)REPLAY_CHECKPOINT_HEADER_SIZE);
+
+				int checkpointCount = result ? (int)readReplayWord(checkpointHeader + 4) : 0;
+				unsigned char checkpointBytes[REPLAY_CHECKPOINT_SIZE];
+				for (int checkpointIndex = 0; result && (checkpointIndex < checkpointCount); checkpointIndex++) {
+					result = (fread(checkpointBytes, 1, REPLAY_CHECKPOINT_SIZE, file) == (size_t)REPLAY_CHECKPOINT_SIZE);
+					if (result) {
+						this->checkpoints.push_back(readReplayCheckpoint(checkpointBytes));
+					}
+				}
+			}
+
+			fclose(file);
+
+			return result;
+		}
+
+		// Get the definition the recorded game was started with
+		const QuickGameDefn& Replay::getGameDefn() const {
+			return this->gameDefn;
+		}
+
+		// Get the number of recorded frames
+		int Replay::getFrameCount() const {
+			return (int)this->inputs.size();
+		}
+
+		// Get the input given on one frame
+		QuickGameInputRequest Replay::getInput(int frame) const {
+			QuickGameInputRequest result;
+			result.snakeMovementInput = (ObjectDirection)this->inputs[frame];
+			return result;
+		}
+
+		// Get the number of state hash checkpoints
+		int Replay::getCheckpointCount() const {
+			return (int)this->checkpoints.size();
+		}
+
+		// Get a checkpoint, checkpoints are in frame order
+		ReplayCheckpoint Replay::getCheckpoint(int checkpointIndex) const {
+			return this->checkpoints[checkpointIndex];
+		}
+
+		// Constructor for MappedReplay, nothing is mapped until open()
+		MappedReplay::MappedReplay() {
+			this->mappedBytes = nullptr;
+			this->mappedByteCount = 0;
+			this->fileHandle = nullptr;
+			this->mappingHandle = nullptr;
+			this->gameDefn = QuickGameDefn();
+			this->inputs = nullptr;
+			this->frameCount = 0;
+			this->keyframeIndex = nullptr;
+			this->keyframeCount = 0;
+			this->keyframeInterval = 0;
+		}
+
+		// Destructor for MappedReplay
+		MappedReplay::~MappedReplay() {
+			this->close();
+		}
+
+		// Map the file and check the header, and the footer and index bounds of replays with keyframes
+		bool MappedReplay::open(const char* path) {
+			this->close();
+
+#if defined(_WIN32)
+			HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file == INVALID_HANDLE_VALUE) {
+				return false;
+			}
+			LARGE_INTEGER fileSize;
+			HANDLE mapping = NULL;
+			const void* view = NULL;
+			if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart >= REPLAY_HEADER_SIZE)) {
+				mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			}
+			if (mapping != NULL) {
+				view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			}
+			if (view == NULL) {
+				if (mapping != NULL) {
+					CloseHandle(mapping);
+				}
+				CloseHandle(file);
+				return false;
+			}
+			this->fileHandle = file;
+			this->mappingHandle = mapping;
+			this->mappedBytes = (const unsigned char*)view;
+			this->mappedByteCount = (std::size_t)fileSize.QuadPart;
+#else
+			int file = ::open(path, O_RDONLY);
+			if (file < 0) {
+				return false;
+			}
+			struct stat fileStat;
+			void* view = MAP_FAILED;
+			if ((fstat(file, &fileStat) == 0) && (fileStat.st_size >= REPLAY_HEADER_SIZE)) {
+				view = mmap(nullptr, (std::size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+			}
+			// The mapping stays valid once the descriptor is closed
+			::close(file);
+			if (view == MAP_FAILED) {
+				return false;
+			}
+			this->mappedBytes = (const unsigned char*)view;
+			this->mappedByteCount = (std::size_t)fileStat.st_size;
+#endif
+
+			const unsigned char* header = this->mappedBytes;
+			bool result = (memcmp(header, REPLAY_MAGIC, 4) == 0);
+			unsigned int version = result ? readReplayWord(header + 4) : 0;
+			result = result && (version >= REPLAY_OLDEST_VERSION) && (version <= REPLAY_VERSION);
+
+			if (result) {
+				readReplayGameDefn(header, this->gameDefn);
+				this->frameCount = (int)readReplayWord(header + 40);
+				this->inputs = header + REPLAY_HEADER_SIZE;
+				result = (this->frameCount >= 0) && ((std::uint64_t)REPLAY_HEADER_SIZE + this->frameCount <= this->mappedByteCount);
+			}
+
+			// Only the footer and the index bounds are checked here, each keyframe is checked as a seek restores it
+			if (result && (version >= 3)) {
+				std::uint64_t footerOffset = (std::uint64_t)this->mappedByteCount - REPLAY_KEYFRAME_FOOTER_SIZE;
+				result = ((std::uint64_t)REPLAY_HEADER_SIZE + this->frameCount + REPLAY_KEYFRAME_FOOTER_SIZE <= this->mappedByteCount);
+
+				const unsigned char* footer = this->mappedBytes + footerOffset;
+				result = result && (memcmp(footer, REPLAY_KEYFRAME_MAGIC, 4) == 0);
+				if (result) {
+					std::uint64_t keyframeCount = readReplayWord(footer + 8);
+					std::uint64_t indexOffset = (std::uint64_t)readReplayWord(footer + 12) | ((std::uint64_t)readReplayWord(footer + 16) << 32);
+					this->keyframeInterval = (int)readReplayWord(footer + 4);
+					result =
+						(this->keyframeInterval > 0) &&
+						((indexOffset % REPLAY_KEYFRAME_INDEX_ALIGNMENT) == 0) &&
+						(indexOffset <= footerOffset) &&
+						(keyframeCount <= (footerOffset - indexOffset) / REPLAY_KEYFRAME_INDEX_ENTRY_SIZE);
+					if (result) {
+						this->keyframeIndex = this->mappedBytes + indexOffset;
+						this->keyframeCount = (int)keyframeCount;
+					}
+				}
+			}
+
+			if (!result) {
+				this->close();
+			}
+
+			return result;
+		}
+
+		// Unmap the replay, if one is mapped
+		void MappedReplay::close() {
+			if (this->mappedBytes != nullptr) {
+#if defined(_WIN32)
+				UnmapViewOfFile(this->mappedBytes);
+				CloseHandle((HANDLE)this->mappingHandle);
+				CloseHandle((HANDLE)this->fileHandle);
+#else
+				munmap((void*)this->mappedBytes, this->mappedByteCount);
+#endif
+			}
+
+			this->mappedBytes = nullptr;
+			this->mappedByteCount = 0;
+			this->fileHandle = nullptr;
+			this->mappingHandle = nullptr;
+			this->inputs = nullptr;
+			this->frameCount = 0;
+			this->keyframeIndex = nullptr;
+			this->keyframeCount = 0;
+			this->keyframeInterval = 0;
+		}
+
+		// Get the definition the recorded game was started with
+		const QuickGameDefn& MappedReplay::getGameDefn() const {
+			return this->gameDefn;
+		}
+
+		// Get the number of recorded frames
+		int MappedReplay::getFrameCount() const {
+			return this->frameCount;
+		}
+
+		// Get the input given on one frame, straight from the mapping
+		QuickGameInputRequest MappedReplay::getInput(int frame) const {
+			assert((frame >= 0) && (frame < this->frameCount));
+			QuickGameInputRequest result;
+			result.snakeMovementInput = (ObjectDirection)this->inputs[frame];
+			return result;
+		}
+
+		// Get the number of keyframes, 0 for replays older than keyframes
+		int MappedReplay::getKeyframeCount() const {
+			return this->keyframeCount;
+		}
+
+		// Get an index entry, keyframes are in frame order
+		ReplayKeyframe MappedReplay::getKeyframe(int keyframeIndex) const {
+			assert((keyframeIndex >= 0) && (keyframeIndex < this->keyframeCount));
+			return readReplayKeyframe(this->keyframeIndex + (keyframeIndex * REPLAY_KEYFRAME_INDEX_ENTRY_SIZE));
+		}
+
+		// Restore the last keyframe at or before the frame and play the frames after it
+		int MappedReplay::seek(QuickGame& game, int frame) const {
+			assert((frame >= 0) && (frame <= this->frameCount));
+			game.reset(&this->gameDefn);
+
+			// Keyframes are saved every interval from the first, so the one to restore is found by dividing rather than searching the index
+			int keyframeIndex = (this->keyframeCount > 0) ? (frame / this->keyframeInterval) - 1 : -1;
+			if (keyframeIndex >= this->keyframeCount) {
+				keyframeIndex = this->keyframeCount - 1;
+			}
+
+			int startFrame = 0;
+			if (keyframeIndex >= 0) {
+				ReplayKeyframe keyframe = this->getKeyframe(keyframeIndex);
+				bool restoredFlag =
+					(keyframe.frame >= 0) && (keyframe.frame <= frame) &&
+					(keyframe.offset <= this->mappedByteCount) && (keyframe.size <= this->mappedByteCount - keyframe.offset) &&
+					game.loadKeyframe(this->mappedBytes + keyframe.offset, keyframe.size);
+				if (restoredFlag) {
+					startFrame = keyframe.frame;
+				} else {
+					game.reset(&this->gameDefn);
+				}
+			}
+
+			for (int playFrame = startFrame; playFrame < frame; playFrame++) {
+				QuickGameInputRequest input = this->getInput(playFrame);
+				game.update(&input);
+			}
+
+			int result = frame - startFrame;
+			return result;
+		}
+
+	}
@@ -0,0 +1,222 @@
+#include <assert.h>
+#include <chrono>
+#include "includes/rollbacksession.hpp"
+
+
+	namespace snake {
+
+		// Constructor for RollbackSession, every snapshot is a game of its own made up front for copying into
+		RollbackSession::RollbackSession(const RollbackSessionDefn& defn) {
+			assert((defn.playerCount > 0) && (defn.playerCount <= ROLLBACK_MAX_PLAYER_COUNT));
+			assert((defn.localPlayerIndex >= 0) && (defn.localPlayerIndex < defn.playerCount));
+			assert(defn.maxRollbackTicks > 0);
+
+			this->defn = defn;
+			this->currentTick = 0;
+			for (int playerIndex = 0; playerIndex < defn.playerCount; playerIndex++) {
+				this->games[playerIndex] = new QuickGame(&defn.playerGameDefns[playerIndex]);
+				this->confirmedTicks[playerIndex] = -1;
+			}
+
+			this->slotCount = defn.maxRollbackTicks + 1;
+			this->snapshotGames = new QuickGame*[this->slotCount * defn.playerCount];
+			for (int slot = 0; slot < this->slotCount; slot++) {
+				for (int playerIndex = 0; playerIndex < defn.playerCount; playerIndex++) {
+					this->snapshotGames[(slot * defn.playerCount) + playerIndex] = new QuickGame(&defn.playerGameDefns[playerIndex]);
+				}
+			}
+			this->hashSlotCount = this->slotCount * 4;
+			this->tickHashes = new std::uint64_t[this->hashSlotCount];
+
+			this->inputSlotCount = this->slotCount * 2;
+			this->inputs = new ObjectDirection[this->inputSlotCount * defn.playerCount];
+			this->playedInputs = new ObjectDirection[this->inputSlotCount * defn.playerCount];
+			for (int inputIndex = 0; inputIndex < this->inputSlotCount * defn.playerCount; inputIndex++) {
+				this->inputs[inputIndex] = ObjectDirection::NONE;
+				this->playedInputs[inputIndex] = ObjectDirection::NONE;
+			}
+			this->rollbackTick = -1;
+
+			this->stats.predictionMissCount = 0;
+			this->stats.rollbackCount = 0;
+			this->stats.resimulatedTickCount = 0;
+			this->stats.deepestRollbackTicks = 0;
+			this->stats.lastRollbackTicks = 0;
+			this->stats.lastRollbackSeconds = 0.0;
+			this->stats.slowestRollbackSeconds = 0.0;
+			this->stats.stallCount = 0;
+			this->stats.desyncCount = 0;
+		}
+
+		// Destructor for RollbackSession
+		RollbackSession::~RollbackSession() {
+			for (int playerIndex = 0; playerIndex < this->defn.playerCount; playerIndex++) {
+				delete this->games[playerIndex];
+			}
+			for (int gameIndex = 0; gameIndex < this->slotCount * this->defn.playerCount; gameIndex++) {
+				delete this->snapshotGames[gameIndex];
+			}
+			delete[] this->snapshotGames;
+			delete[] this->tickHashes;
+			delete[] this->inputs;
+			delete[] this->playedInputs;
+		}
+
+		// Fix up the ticks a late input changed, then play the next tick unless a remote player is too far behind
+		bool RollbackSession::advance(ObjectDirection localInput) {
+			this->synchronize();
+
+			// Playing the tick leaves currentTick + 1 - (confirmedTick + 1) ticks unconfirmed, every one of which a rollback may have to play again
+			for (int playerIndex = 0; playerIndex < this->defn.playerCount; playerIndex++) {
+				if ((playerIndex != this->defn.localPlayerIndex) && (this->currentTick - this->confirmedTicks[playerIndex] > this->defn.maxRollbackTicks)) {
+					this->stats.stallCount++;
+					return false;
+				}
+			}
+
+			int inputSlot = this->currentTick % this->inputSlotCount;
+			this->inputs[(inputSlot * this->defn.playerCount) + this->defn.localPlayerIndex] = localInput;
+			this->confirmedTicks[this->defn.localPlayerIndex] = this->currentTick;
+			this->playTick();
+			return true;
+		}
+
+		// Store a remote input and note the earliest tick it proves was played wrong
+		void RollbackSession::addRemoteInput(int playerIndex, int tick, ObjectDirection input) {
+			assert((playerIndex >= 0) && (playerIndex < this->defn.playerCount) && (playerIndex != this->defn.localPlayerIndex));
+			// Repeats are dropped, and a peer is never further ahead than the stall lets it be
+			if ((tick != this->confirmedTicks[playerIndex] + 1) || (tick - this->currentTick >= this->inputSlotCount - this->slotCount)) {
+				return;
+			}
+
+			int inputIndex = ((tick % this->inputSlotCount) * this->defn.playerCount) + playerIndex;
+			this->inputs[inputIndex] = input;
+			this->confirmedTicks[playerIndex] = tick;
+			if ((tick < this->currentTick) && (this->playedInputs[inputIndex] != input)) {
+				this->stats.predictionMissCount++;
+				if ((this->rollbackTick < 0) || (tick < this->rollbackTick)) {
+					this->rollbackTick = tick;
+				}
+			}
+		}
+
+		// Compare a hash from another peer, ticks that are not confirmed yet or have left the ring cannot be checked and pass
+		bool RollbackSession::checkRemoteHash(int tick, std::uint64_t stateHash) {
+			if ((tick >= this->getConfirmedTick()) || (tick < this->currentTick - this->hashSlotCount)) {
+				return true;
+			}
+			if (this->tickHashes[tick % this->hashSlotCount] != stateHash) {
+				this->stats.desyncCount++;
+				return false;
+			}
+			return true;
+		}
+
+		// Run the rollback a late input asked for, if there is one
+		void RollbackSession::synchronize() {
+			if (this->rollbackTick >= 0) {
+				this->rollback();
+			}
+		}
+
+		// Get the definition the session was made from
+		const RollbackSessionDefn& RollbackSession::getDefn() const {
+			return this->defn;
+		}
+
+		// Get a player's game as of the last tick played, predictions included
+		const QuickGame& RollbackSession::getGame(int playerIndex) const {
+			assert((playerIndex >= 0) && (playerIndex < this->defn.playerCount));
+			return *this->games[playerIndex];
+		}
+
+		// Get the tick the next advance() plays
+		int RollbackSession::getCurrentTick() const {
+			return this->currentTick;
+		}
+
+		// Get the first tick that is not confirmed, a pending rollback keeps its ticks unconfirmed until it has run
+		int RollbackSession::getConfirmedTick() const {
+			int result = this->currentTick;
+			for (int playerIndex = 0; playerIndex < this->defn.playerCount; playerIndex++) {
+				if (this->confirmedTicks[playerIndex] + 1 < result) {
+					result = this->confirmedTicks[playerIndex] + 1;
+				}
+			}
+			if ((this->rollbackTick >= 0) && (this->rollbackTick < result)) {
+				result = this->rollbackTick;
+			}
+			return result;
+		}
+
+		// Get the match hash after one of the ticks still in the ring
+		std::uint64_t RollbackSession::getTickHash(int tick) const {
+			assert((tick < this->currentTick) && (tick >= this->currentTick - this->hashSlotCount) && (tick >= 0));
+			return this->tickHashes[tick % this->hashSlotCount];
+		}
+
+		// Get the counts of predictions, rollbacks and stalls
+		const RollbackStats& RollbackSession::getStats() const {
+			return this->stats;
+		}
+
+		// Restore every game from before the earliest mispredicted tick and play up to where the session was
+		void RollbackSession::rollback() {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			int targetTick = this->currentTick;
+			int rollbackTicks = targetTick - this->rollbackTick;
+			int slot = this->rollbackTick % this->slotCount;
+			for (int playerIndex = 0; playerIndex < this->defn.playerCount; playerIndex++) {
+				this->games[playerIndex]->copyFrom(*this->snapshotGames[(slot * this->defn.playerCount) + playerIndex]);
+			}
+			this->currentTick = this->rollbackTick;
+			this->rollbackTick = -1;
+			while (this->currentTick < targetTick) {
+				this->playTick();
+			}
+
+			this->stats.rollbackCount++;
+			this->stats.resimulatedTickCount += rollbackTicks;
+			this->stats.deepestRollbackTicks = (rollbackTicks > this->stats.deepestRollbackTicks) ? rollbackTicks : this->stats.deepestRollbackTicks;
+			this->stats.lastRollbackTicks = rollbackTicks;
+			this->stats.lastRollbackSeconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / 1e9;
+			if (this->stats.lastRollbackSeconds > this->stats.slowestRollbackSeconds) {
+				this->stats.slowestRollbackSeconds = this->stats.lastRollbackSeconds;
+			}
+		}
+
+		// Snapshot every game and play one tick of each with the inputs known or predicted for it
+		void RollbackSession::playTick() {
+			int slot = this->currentTick % this->slotCount;
+			int inputSlot = this->currentTick % this->inputSlotCount;
+			for (int playerIndex = 0; playerIndex < this->defn.playerCount; playerIndex++) {
+				this->snapshotGames[(slot * this->defn.playerCount) + playerIndex]->copyFrom(*this->games[playerIndex]);
+
+				QuickGameInputRequest input;
+				input.snakeMovementInput = this->resolveInput(playerIndex, this->currentTick);
+				this->playedInputs[(inputSlot * this->defn.playerCount) + playerIndex] = input.snakeMovementInput;
+				this->games[playerIndex]->update(&input);
+			}
+			this->tickHashes[this->currentTick % this->hashSlotCount] = this->computeMatchHash();
+			this->currentTick++;
+		}
+
+		// Get a player's input for a tick, predicting no key press when it has not arrived
+		ObjectDirection RollbackSession::resolveInput(int playerIndex, int tick) const {
+			if (tick > this->confirmedTicks[playerIndex]) {
+				return ObjectDirection::NONE;
+			}
+			return this->inputs[((tick % this->inputSlotCount) * this->defn.playerCount) + playerIndex];
+		}
+
+		// Mix every player's Zobrist hash with FNV-1a, in player order
+		std::uint64_t RollbackSession::computeMatchHash() const {
+			std::uint64_t result = 0xCBF29CE484222325ULL;
+			for (int playerIndex = 0; playerIndex < this->defn.playerCount; playerIndex++) {
+				result = (result ^ this->games[playerIndex]->getStateHash()) * 0x100000001B3ULL;
+			}
+			return result;
+		}
+
+	}
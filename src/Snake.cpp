@@ -1,4 +1,6 @@
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 #include "includes/gamestate.hpp"
 
 
@@ -29,11 +31,57 @@
 				return result;
 			}
 
+			// Carve room for a snake filling the whole field, and its occupancy grid, from an arena
+			SnakeStorage allocateStorage(MemoryArena& arena, sf::Vector2i fieldSize) {
+				SnakeStorage result;
+
+				int cellCount = fieldSize.x * fieldSize.y;
+				result.bodyCapacity = cellCount;
+				result.bodySegments = arena.allocateArray<SnakeSegment>(cellCount);
+				result.cellOccupancy = arena.allocateArray<unsigned char>(cellCount);
+				result.chunkedOccupancy = nullptr;
+				result.fieldSize = fieldSize;
+
+				return result;
+			}
+
+			// Carve room for a capped body from an arena, the occupancy lives in chunks outside it
+			SnakeStorage allocateChunkedStorage(MemoryArena& arena, ChunkedOccupancy& occupancy, int bodyCapacity) {
+				SnakeStorage result;
+
+				result.bodyCapacity = bodyCapacity;
+				result.bodySegments = arena.allocateArray<SnakeSegment>(bodyCapacity);
+				result.cellOccupancy = nullptr;
+				result.chunkedOccupancy = &occupancy;
+				result.fieldSize = occupancy.getFieldSize();
+
+				return result;
+			}
+
 		}
 
 		// Constructor for the Snake class
-		Snake::Snake(const SnakeStartDefn& startDefn) {
+		Snake::Snake(const SnakeStartDefn& startDefn, const SnakeStorage& storage) {
+			this->reset(startDefn, storage);
+		}
+
+		// Reset the snake to its starting state inside the given storage
+		void Snake::reset(const SnakeStartDefn& startDefn, const SnakeStorage& storage) {
 			assert(startDefn.length >= 2); // Ensure the snake length is valid
+			assert(storage.bodyCapacity >= startDefn.length - 2);
+
+			// Take over the storage, growing never needs more than it provides
+			this->bodyList = storage.bodySegments;
+			this->bodyLength = 0;
+			this->bodyCapacity = storage.bodyCapacity;
+			this->cellOccupancy = storage.cellOccupancy;
+			this->chunkedOccupancy = storage.chunkedOccupancy;
+			this->fieldSize = storage.fieldSize;
+			if (this->chunkedOccupancy != nullptr) {
+				this->chunkedOccupancy->reset(this->fieldSize);
+			} else {
+				memset(this->cellOccupancy, 0, this->fieldSize.x * this->fieldSize.y);
+			}
 
 			// Initialize the head position and direction
 			sf::Vector2i nextSegmentPosition = startDefn.headPosition;
@@ -43,8 +91,8 @@
 			this->head.position = nextSegmentPosition;
 			this->head.enterDirection = startDefn.facingDirection;
 			this->head.exitDirection = ObjectDirection::NONE;
+			this->occupyCell(this->head.position);
 
-			this->bodyList.reserve(500); // Reserve space for body segments
 			int bodyCount = startDefn.length - 2;
 			for (int currBodyPos = 0; currBodyPos < bodyCount; currBodyPos++) {
 				nextSegmentPosition += adjustVector;
@@ -55,7 +103,9 @@
 				currBodySegment.enterDirection = startDefn.facingDirection;
 				currBodySegment.exitDirection = startDefn.facingDirection;
 
-				this->bodyList.push_back(currBodySegment); // Add body segment to the list
+				this->bodyList[this->bodyLength] = currBodySegment; // Add body segment to the list
+				this->bodyLength++;
+				this->occupyCell(currBodySegment.position);
 			}
 
 			nextSegmentPosition += adjustVector;
@@ -65,6 +115,84 @@
 			this->tail.position = nextSegmentPosition;
 			this->tail.enterDirection = ObjectDirection::NONE;
 			this->tail.exitDirection = startDefn.facingDirection;
+			this->occupyCell(this->tail.position);
+		}
+
+		// Copy another snake into this snake's storage without allocating
+		void Snake::copyFrom(const Snake& other) {
+			assert(this->fieldSize == other.fieldSize);
+			assert(other.bodyLength <= this->bodyCapacity);
+
+			this->head = other.head;
+			this->tail = other.tail;
+			this->bodyLength = other.bodyLength;
+			memcpy(this->bodyList, other.bodyList, other.bodyLength * sizeof(SnakeSegment));
+			if (this->chunkedOccupancy != nullptr) {
+				this->chunkedOccupancy->copyFrom(*other.chunkedOccupancy);
+			} else {
+				memcpy(this->cellOccupancy, other.cellOccupancy, this->fieldSize.x * this->fieldSize.y);
+			}
+		}
+
+		// Rebuild the segments and occupancy walking back from the head, the way reset() lays out a straight snake
+		bool Snake::restore(sf::Vector2i headPosition, const unsigned char* enterDirections, int bodyLength) {
+			// Moving and growing read the last body segment, so a snake always has one
+			if ((bodyLength < 1) || (bodyLength > this->bodyCapacity)) {
+				return false;
+			}
+			for (int segmentIndex = 0; segmentIndex <= bodyLength; segmentIndex++) {
+				if ((enterDirections[segmentIndex] <= (unsigned char)ObjectDirection::NONE) || (enterDirections[segmentIndex] > (unsigned char)ObjectDirection::LEFT)) {
+					return false;
+				}
+			}
+
+			this->head.segmentType = SnakeSegmentType::HEAD;
+			this->head.position = headPosition;
+			this->head.enterDirection = (ObjectDirection)enterDirections[0];
+			this->head.exitDirection = ObjectDirection::NONE;
+
+			sf::Vector2i nextSegmentPosition = headPosition;
+			ObjectDirection previousEnterDirection = this->head.enterDirection;
+			for (int segmentIndex = 0; segmentIndex < bodyLength; segmentIndex++) {
+				nextSegmentPosition -= SnakeUtils::directionToVector(previousEnterDirection);
+
+				SnakeSegment& currBodySegment = this->bodyList[segmentIndex];
+				currBodySegment.segmentType = SnakeSegmentType::BODY;
+				currBodySegment.position = nextSegmentPosition;
+				currBodySegment.enterDirection = (ObjectDirection)enterDirections[segmentIndex + 1];
+				currBodySegment.exitDirection = previousEnterDirection;
+				previousEnterDirection = currBodySegment.enterDirection;
+			}
+			nextSegmentPosition -= SnakeUtils::directionToVector(previousEnterDirection);
+
+			this->tail.segmentType = SnakeSegmentType::TAIL;
+			this->tail.position = nextSegmentPosition;
+			this->tail.enterDirection = ObjectDirection::NONE;
+			this->tail.exitDirection = previousEnterDirection;
+			this->bodyLength = bodyLength;
+
+			// Every segment is placed before any is counted, so occupancy is never touched for a snake that runs off the field
+			bool result = (this->resolveCellIndex(this->head.position) >= 0) && (this->resolveCellIndex(this->tail.position) >= 0);
+			for (int segmentIndex = 0; result && (segmentIndex < bodyLength); segmentIndex++) {
+				result = (this->resolveCellIndex(this->bodyList[segmentIndex].position) >= 0);
+			}
+			if (!result) {
+				return false;
+			}
+
+			if (this->chunkedOccupancy != nullptr) {
+				this->chunkedOccupancy->reset(this->fieldSize);
+			} else {
+				memset(this->cellOccupancy, 0, this->fieldSize.x * this->fieldSize.y);
+			}
+			this->occupyCell(this->head.position);
+			for (int segmentIndex = 0; segmentIndex < bodyLength; segmentIndex++) {
+				this->occupyCell(this->bodyList[segmentIndex].position);
+			}
+			this->occupyCell(this->tail.position);
+			this->assertContiguous();
+
+			return result;
 		}
 
 		// Get the head segment of the snake
@@ -74,12 +202,13 @@
 
 		// Get the length of the snake's body
 		int Snake::getBodyLength() const {
-			return this->bodyList.size();
+			return this->bodyLength;
 		}
 
 		// Get a specific body segment by index
 		SnakeSegment Snake::getBody(int segmentIndex) const {
-			SnakeSegment result = this->bodyList.at(segmentIndex);
+			assert((segmentIndex >= 0) && (segmentIndex < this->bodyLength));
+			SnakeSegment result = this->bodyList[segmentIndex];
 			return result;
 		}
 
@@ -90,7 +219,13 @@
 
 		// Get the total length of the snake (head, body, and tail)
 		int Snake::getLength() const {
-			int result = this->bodyList.size() + 2;
+			int result = this->bodyLength + 2;
+			return result;
+		}
+
+		// Check whether the storage has room for another body segment
+		bool Snake::canGrow() const {
+			bool result = this->bodyLength < this->bodyCapacity;
 			return result;
 		}
 
@@ -118,32 +253,36 @@
 
 		// Check if the snake occupies a specific position
 		bool Snake::occupiesPosition(sf::Vector2i position) {
-			bool result =
-				(this->head.position == position) ||
-				this->bodyOccupiesPosition(position) ||
-				(this->tail.position == position);
+			bool result = this->resolveCellCount(position) > 0;
 
 			return result;
 		}
 
 		// Check if the body of the snake occupies a specific position
 		bool Snake::bodyOccupiesPosition(sf::Vector2i position) {
-			bool result = false;
+			// The occupancy counts every segment, take away the head and tail to leave the body
+			int bodySegmentCount = this->resolveCellCount(position);
+			if (bodySegmentCount == 0) {
+				return false;
+			}
 
-			int bodyLength = this->bodyList.size();
-			for (int currSegmentIndex = 0; currSegmentIndex < bodyLength; currSegmentIndex++) {
-				SnakeSegment currBodySegment = this->bodyList.at(currSegmentIndex);
-				result = result || (currBodySegment.position == position);
-				if (result) {
-					break;
-				}
+			if (this->head.position == position) {
+				bodySegmentCount--;
+			}
+			if (this->tail.position == position) {
+				bodySegmentCount--;
 			}
 
+			bool result = bodySegmentCount > 0;
 			return result;
 		}
 
 		// Move the snake forward in the specified direction
 		void Snake::moveForward(ObjectDirection direction) {
+			// Every segment takes the place of the one in front, so only the new head cell and the old tail cell change
+			this->occupyCell(this->head.position + SnakeUtils::directionToVector(direction));
+			this->vacateCell(this->tail.position);
+
 			this->moveHeadForward(direction);
 			this->moveBodyForward();
 			this->moveTailForward();
@@ -153,10 +292,16 @@
 
 		// Grow the snake forward in the specified direction
 		void Snake::growForward(ObjectDirection direction) {
+			assert(this->bodyLength > 0); // The new segment is derived from the last body segment
+			assert(this->bodyLength < this->bodyCapacity);
+
+			// The extra segment fills the old last body cell and the tail stays, so only the new head cell changes
+			this->occupyCell(this->head.position + SnakeUtils::directionToVector(direction));
+
 			this->moveHeadForward(direction);
 			this->moveBodyForward();
 
-			SnakeSegment lastBodySegment = this->bodyList.back();
+			SnakeSegment lastBodySegment = this->bodyList[this->bodyLength - 1];
 
 			SnakeSegment extraBodySegment;
 			extraBodySegment.segmentType = SnakeSegmentType::BODY;
@@ -164,12 +309,8 @@
 			extraBodySegment.exitDirection = lastBodySegment.enterDirection;
 			extraBodySegment.enterDirection = tail.exitDirection;
 
-			// Check if the body list needs more space
-			if (this->bodyList.size() == this->bodyList.capacity()) {
-				this->bodyList.reserve(this->bodyList.size() + 500);
-			}
-
-			this->bodyList.push_back(extraBodySegment); // Add the new body segment
+			this->bodyList[this->bodyLength] = extraBodySegment; // Add the new body segment
+			this->bodyLength++;
 
 			this->assertContiguous(); // Ensure the snake segments are contiguous
 		}
@@ -197,19 +338,64 @@
 
 		// Move the snake's tail forward
 		void Snake::moveTailForward() {
-			ObjectDirection newExitDirection = this->bodyList.back().enterDirection;
+			ObjectDirection newExitDirection = this->bodyList[this->bodyLength - 1].enterDirection;
 
 			this->tail.position += SnakeUtils::directionToVector(this->tail.exitDirection);
 			this->tail.exitDirection = newExitDirection;
 		}
 
+		// Get the index of a position in the occupancy grid, or -1 when it is outside the field
+		int Snake::resolveCellIndex(sf::Vector2i position) const {
+			bool insideField =
+				(position.x >= 0) && (position.x < this->fieldSize.x) &&
+				(position.y >= 0) && (position.y < this->fieldSize.y);
+
+			int result = insideField ? (position.y * this->fieldSize.x + position.x) : -1;
+			return result;
+		}
+
+		// Get the number of segments on a cell, 0 when it is outside the field
+		int Snake::resolveCellCount(sf::Vector2i position) const {
+			if (this->chunkedOccupancy != nullptr) {
+				return this->chunkedOccupancy->getCount(position);
+			}
+
+			int cellIndex = this->resolveCellIndex(position);
+			int result = (cellIndex >= 0) ? this->cellOccupancy[cellIndex] : 0;
+			return result;
+		}
+
+		// Count one more segment on a cell
+		void Snake::occupyCell(sf::Vector2i position) {
+			if (this->chunkedOccupancy != nullptr) {
+				this->chunkedOccupancy->increment(position);
+				return;
+			}
+
+			int cellIndex = this->resolveCellIndex(position);
+			assert(cellIndex >= 0); // The snake never leaves the field
+			this->cellOccupancy[cellIndex]++;
+		}
+
+		// Count one less segment on a cell
+		void Snake::vacateCell(sf::Vector2i position) {
+			if (this->chunkedOccupancy != nullptr) {
+				this->chunkedOccupancy->decrement(position);
+				return;
+			}
+
+			int cellIndex = this->resolveCellIndex(position);
+			assert((cellIndex >= 0) && (this->cellOccupancy[cellIndex] > 0));
+			this->cellOccupancy[cellIndex]--;
+		}
+
 		// Assert that all segments are contiguous and correctly aligned
 		void Snake::assertContiguous() {
 			int bodyLength = this->getBodyLength();
 
 			SnakeSegment* prevSnakeSegment = &this->head;
 			for (int currSegmentIndex = 0; currSegmentIndex < bodyLength; currSegmentIndex++) {
-				SnakeSegment* currSnakeSegment = &this->bodyList.at(currSegmentIndex);
+				SnakeSegment* currSnakeSegment = &this->bodyList[currSegmentIndex];
 
 				sf::Vector2i positionDifference = currSnakeSegment->position - prevSnakeSegment->position;
 				int tileDifference = abs(positionDifference.x) + abs(positionDifference.y);
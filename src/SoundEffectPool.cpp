@@ -0,0 +1,151 @@
+#include "includes/soundeffects.hpp"
+
+
+	namespace snake {
+
+		// Paths to every sound effect, indexed by SoundEffectId
+		const char* SOUND_EFFECT_PATHS[(int)SoundEffectId::COUNT] = {
+			"resources/sounds/eat-apple.wav",
+			"resources/sounds/hit-barrier.wav",
+			"resources/sounds/food-spawned.wav",
+			"resources/sounds/snake-hiss.wav",
+		};
+
+		// Priority of every sound effect, a voice can only be stolen by an effect of equal or higher priority
+		const int SOUND_EFFECT_PRIORITIES[(int)SoundEffectId::COUNT] = {
+			2, // EAT_APPLE
+			3, // HIT_BARRIER
+			0, // FOOD_SPAWNED
+			1, // SNAKE_HISS
+		};
+
+		// Constructor for SoundEffectPool
+		SoundEffectPool::SoundEffectPool() {
+			// Preload the PCM for every effect so triggering never touches the disk
+			for (int currEffectIndex = 0; currEffectIndex < (int)SoundEffectId::COUNT; currEffectIndex++) {
+				if (!this->buffers[currEffectIndex].loadFromFile(SOUND_EFFECT_PATHS[currEffectIndex])) {
+					throw "Could not load sound effects";
+				}
+			}
+
+			// Initialize every voice as free
+			for (int currVoiceIndex = 0; currVoiceIndex < VOICE_COUNT; currVoiceIndex++) {
+				this->voiceEffect[currVoiceIndex] = SoundEffectId::COUNT;
+				this->voicePriority[currVoiceIndex] = -1;
+				this->voiceStartedAt[currVoiceIndex] = 0;
+			}
+
+			this->pendingCount = 0;
+			this->resetLatencyStats();
+		}
+
+		// Queue a sound effect to be started on the next flush
+		void SoundEffectPool::trigger(SoundEffectId effect) {
+			if (this->pendingCount >= PENDING_CAPACITY) {
+				this->latencyStats.droppedCount++;
+				return;
+			}
+
+			this->pendingEffect[this->pendingCount] = effect;
+			this->pendingTriggeredAt[this->pendingCount] = this->clock.getElapsedTime().asMicroseconds();
+			this->pendingCount++;
+		}
+
+		// Start every queued sound effect
+		void SoundEffectPool::flush() {
+			for (int currPendingIndex = 0; currPendingIndex < this->pendingCount; currPendingIndex++) {
+				SoundEffectId effect = this->pendingEffect[currPendingIndex];
+				int priority = SOUND_EFFECT_PRIORITIES[(int)effect];
+
+				int voiceIndex = this->resolveVoice(priority);
+				if (voiceIndex < 0) {
+					// Every voice is busy with something more important
+					this->latencyStats.droppedCount++;
+					continue;
+				}
+
+				sf::Sound& voice = this->voices[voiceIndex];
+				if (voice.getStatus() == sf::SoundSource::Status::Playing) {
+					voice.stop();
+					this->latencyStats.stolenCount++;
+				}
+
+				// Only rebind the buffer when the voice last played a different effect
+				if (this->voiceEffect[voiceIndex] != effect) {
+					voice.setBuffer(this->buffers[(int)effect]);
+					this->voiceEffect[voiceIndex] = effect;
+				}
+				voice.play();
+
+				sf::Int64 playedAt = this->clock.getElapsedTime().asMicroseconds();
+				this->voicePriority[voiceIndex] = priority;
+				this->voiceStartedAt[voiceIndex] = playedAt;
+
+				// Record the trigger to play latency
+				sf::Int64 latency = playedAt - this->pendingTriggeredAt[currPendingIndex];
+				this->latencyStats.playedCount++;
+				this->latencyStats.lastMicroseconds = latency;
+				this->latencyStats.totalMicroseconds += latency;
+				if (latency > this->latencyStats.maxMicroseconds) {
+					this->latencyStats.maxMicroseconds = latency;
+				}
+			}
+
+			this->pendingCount = 0;
+		}
+
+		// Stop every voice and drop queued triggers
+		void SoundEffectPool::stopAll() {
+			for (int currVoiceIndex = 0; currVoiceIndex < VOICE_COUNT; currVoiceIndex++) {
+				this->voices[currVoiceIndex].stop();
+				this->voicePriority[currVoiceIndex] = -1;
+			}
+
+			this->pendingCount = 0;
+		}
+
+		// Get the latency statistics collected so far
+		const SoundEffectLatencyStats& SoundEffectPool::getLatencyStats() const {
+			return this->latencyStats;
+		}
+
+		// Start collecting latency statistics again
+		void SoundEffectPool::resetLatencyStats() {
+			this->latencyStats.playedCount = 0;
+			this->latencyStats.droppedCount = 0;
+			this->latencyStats.stolenCount = 0;
+			this->latencyStats.lastMicroseconds = 0;
+			this->latencyStats.maxMicroseconds = 0;
+			this->latencyStats.totalMicroseconds = 0;
+		}
+
+		// Find a free voice, or the least important and oldest voice that the given priority may steal
+		int SoundEffectPool::resolveVoice(int priority) {
+			int result = -1;
+
+			for (int currVoiceIndex = 0; currVoiceIndex < VOICE_COUNT; currVoiceIndex++) {
+				if (this->voices[currVoiceIndex].getStatus() != sf::SoundSource::Status::Playing) {
+					return currVoiceIndex;
+				}
+
+				if (this->voicePriority[currVoiceIndex] > priority) {
+					continue;
+				}
+
+				bool betterCandidate =
+					(result < 0) ||
+					(this->voicePriority[currVoiceIndex] < this->voicePriority[result]) ||
+					(
+						(this->voicePriority[currVoiceIndex] == this->voicePriority[result]) &&
+						(this->voiceStartedAt[currVoiceIndex] < this->voiceStartedAt[result])
+					);
+				if (betterCandidate) {
+					result = currVoiceIndex;
+				}
+			}
+
+			return result;
+		}
+
+
+}
@@ -0,0 +1,494 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <new>
+#include "includes/spectatorbroadcast.hpp"
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+	namespace snake {
+
+		// Viewers map the memory read only, so every atomic they load has to be a plain load rather than a locked instruction that writes
+		static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the spectator broadcast needs lock free 64 bit atomics");
+
+		// Alignment of the sections after the header
+		const std::uint64_t SPECTATOR_SECTION_ALIGNMENT = 64;
+
+		// Build the name of the shared memory from the broadcast name, POSIX names start with a slash and Windows ones stay in the session
+		void resolveSpectatorSegmentName(const char* name, char* segmentName, std::size_t segmentNameSize) {
+#if defined(_WIN32)
+			snprintf(segmentName, segmentNameSize, "Local\\snake-spectator-%s", name);
+#else
+			snprintf(segmentName, segmentNameSize, "/snake-spectator-%s", name);
+#endif
+		}
+
+		// Constructor for SpectatorPublisher
+		SpectatorPublisher::SpectatorPublisher() {
+			this->header = nullptr;
+			this->slots = nullptr;
+			this->tiles = nullptr;
+			this->segmentSize = 0;
+			this->segmentName[0] = '\0';
+			this->mappingHandle = nullptr;
+			this->game = SpectatorGameRecord();
+			this->tickCount = 0;
+		}
+
+		// Destructor for SpectatorPublisher
+		SpectatorPublisher::~SpectatorPublisher() {
+			this->close();
+		}
+
+		// Size the shared memory for the field, map it and lay out the header and ring, the magic going in last so viewers only take a finished layout
+		bool SpectatorPublisher::create(const char* name, sf::Vector2i fieldSize) {
+			this->close();
+
+			long long cellCount = (long long)fieldSize.x * (long long)fieldSize.y;
+			std::uint32_t tileCapacity = (cellCount <= LEVEL_MAX_CELL_COUNT) ? (std::uint32_t)cellCount : 0;
+			std::uint64_t slotOffset = ((sizeof(SpectatorHeader) + SPECTATOR_SECTION_ALIGNMENT - 1) / SPECTATOR_SECTION_ALIGNMENT) * SPECTATOR_SECTION_ALIGNMENT;
+			std::uint64_t tileOffset = slotOffset + ((std::uint64_t)SPECTATOR_SLOT_COUNT * sizeof(SpectatorSlot));
+			std::size_t segmentSize = (std::size_t)(tileOffset + tileCapacity);
+			resolveSpectatorSegmentName(name, this->segmentName, sizeof(this->segmentName));
+
+#if defined(_WIN32)
+			HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((std::uint64_t)segmentSize >> 32), (DWORD)(segmentSize & 0xFFFFFFFF), this->segmentName);
+			if (mapping == NULL) {
+				return false;
+			}
+			void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, segmentSize);
+			if (view == NULL) {
+				CloseHandle(mapping);
+				return false;
+			}
+			this->mappingHandle = mapping;
+#else
+			// Memory left by a game that did not close is replaced, viewers still mapping it keep their copy until they look again
+			shm_unlink(this->segmentName);
+			int file = shm_open(this->segmentName, O_CREAT | O_EXCL | O_RDWR, 0644);
+			if (file < 0) {
+				return false;
+			}
+			void* view = MAP_FAILED;
+			if (ftruncate(file, (off_t)segmentSize) == 0) {
+				view = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+			}
+			// The mapping stays valid once the descriptor is closed
+			::close(file);
+			if (view == MAP_FAILED) {
+				shm_unlink(this->segmentName);
+				return false;
+			}
+#endif
+
+			unsigned char* bytes = (unsigned char*)view;
+			this->segmentSize = segmentSize;
+			this->header = new (bytes) SpectatorHeader();
+			this->header->version = SPECTATOR_VERSION;
+			this->header->fieldWidth = fieldSize.x;
+			this->header->fieldHeight = fieldSize.y;
+			this->header->slotCount = (std::uint32_t)SPECTATOR_SLOT_COUNT;
+			this->header->tileCapacity = tileCapacity;
+			this->header->slotOffset = slotOffset;
+			this->header->tileOffset = tileOffset;
+			this->header->segmentSize = segmentSize;
+			this->header->gameSequence.store(0, std::memory_order_relaxed);
+			this->header->publishedTickCount.store(0, std::memory_order_relaxed);
+
+			this->slots = (SpectatorSlot*)(bytes + slotOffset);
+			for (int slotIndex = 0; slotIndex < SPECTATOR_SLOT_COUNT; slotIndex++) {
+				new (&this->slots[slotIndex]) SpectatorSlot();
+				this->slots[slotIndex].sequence.store(0, std::memory_order_relaxed);
+			}
+			this->tiles = bytes + tileOffset;
+
+			this->game = SpectatorGameRecord();
+			this->game.phase = (std::uint32_t)SpectatorPhase::WAITING;
+			this->tickCount = 0;
+			this->writeGameRecord(nullptr, false);
+
+			std::atomic_thread_fence(std::memory_order_release);
+			memcpy(this->header->magic, SPECTATOR_MAGIC, sizeof(SPECTATOR_MAGIC));
+			return true;
+		}
+
+		// Tell viewers the broadcast is over and let the memory go, viewers that still map it keep it alive until they close
+		void SpectatorPublisher::close() {
+			if (this->header == nullptr) {
+				return;
+			}
+
+			this->game.phase = (std::uint32_t)SpectatorPhase::CLOSED;
+			this->writeGameRecord(nullptr, false);
+
+#if defined(_WIN32)
+			UnmapViewOfFile(this->header);
+			CloseHandle((HANDLE)this->mappingHandle);
+			this->mappingHandle = nullptr;
+#else
+			munmap(this->header, this->segmentSize);
+			shm_unlink(this->segmentName);
+#endif
+			this->header = nullptr;
+			this->slots = nullptr;
+			this->tiles = nullptr;
+			this->segmentSize = 0;
+		}
+
+		// Start a new game record from the next tick on, with the level's tiles when it has one
+		void SpectatorPublisher::publishGame(const QuickGameDefn& gameDefn, const Level* level, int foodCount) {
+			if (this->header == nullptr) {
+				return;
+			}
+			bool levelFlag = (level != nullptr) && (this->header->tileCapacity > 0);
+			assert(!levelFlag || ((level->getFieldSize().x == this->header->fieldWidth) && (level->getFieldSize().y == this->header->fieldHeight)));
+
+			this->game.gameIndex++;
+			this->game.firstTick = this->tickCount;
+			this->game.gameDefn = gameDefn;
+			this->game.foodCount = foodCount;
+			this->game.levelFlag = levelFlag ? 1 : 0;
+			this->writeGameRecord(level, levelFlag);
+		}
+
+		// Change what viewers show, the game itself carries on from its ticks
+		void SpectatorPublisher::publishPhase(SpectatorPhase phase, int longestSnakeLength, bool lastGameBeatLongestSnakeLengthFlag) {
+			if (this->header == nullptr) {
+				return;
+			}
+
+			this->game.phase = (std::uint32_t)phase;
+			this->game.longestSnakeLength = longestSnakeLength;
+			this->game.lastGameBeatLongestSnakeLengthFlag = lastGameBeatLongestSnakeLengthFlag ? 1 : 0;
+			this->writeGameRecord(nullptr, false);
+		}
+
+		// Write the tick into its slot between an odd and an even sequence number, then publish it
+		void SpectatorPublisher::publishTick(ObjectDirection input, std::uint64_t stateHash) {
+			if (this->header == nullptr) {
+				return;
+			}
+
+			SpectatorSlot& slot = this->slots[this->tickCount % (std::uint64_t)SPECTATOR_SLOT_COUNT];
+			slot.sequence.store((this->tickCount * 2) + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.tick.stateHash = stateHash;
+			slot.tick.gameIndex = this->game.gameIndex;
+			slot.tick.input = (std::int32_t)input;
+			slot.sequence.store((this->tickCount * 2) + 2, std::memory_order_release);
+
+			this->tickCount++;
+			this->header->publishedTickCount.store(this->tickCount, std::memory_order_release);
+		}
+
+		// Copy the game record, and the level's tiles when asked, between an odd and an even sequence number
+		void SpectatorPublisher::writeGameRecord(const Level* level, bool tilesFlag) {
+			std::uint64_t sequence = this->header->gameSequence.load(std::memory_order_relaxed);
+			this->header->gameSequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			memcpy(&this->header->game, &this->game, sizeof(this->game));
+			if (tilesFlag) {
+				for (int y = 0; y < this->header->fieldHeight; y++) {
+					for (int x = 0; x < this->header->fieldWidth; x++) {
+						this->tiles[(y * this->header->fieldWidth) + x] = (unsigned char)level->getTile(sf::Vector2i(x, y));
+					}
+				}
+			}
+
+			this->header->gameSequence.store(sequence + 2, std::memory_order_release);
+		}
+
+		// Constructor for SpectatorSubscriber
+		SpectatorSubscriber::SpectatorSubscriber() {
+			this->header = nullptr;
+			this->slots = nullptr;
+			this->tiles = nullptr;
+			this->segmentSize = 0;
+			this->mappingHandle = nullptr;
+			this->game = SpectatorGameRecord();
+			this->game.phase = (std::uint32_t)SpectatorPhase::CLOSED;
+			this->mirrorGame = nullptr;
+			this->mirrorLevel = nullptr;
+			this->tileBuffer = nullptr;
+			this->tileBufferCapacity = 0;
+			this->followingFlag = false;
+			this->nextTick = 0;
+			this->stats.appliedTickCount = 0;
+			this->stats.followedGameCount = 0;
+			this->stats.missedGameCount = 0;
+			this->stats.hashMismatchCount = 0;
+		}
+
+		// Destructor for SpectatorSubscriber
+		SpectatorSubscriber::~SpectatorSubscriber() {
+			this->close();
+			delete this->mirrorGame;
+			delete this->mirrorLevel;
+			delete[] this->tileBuffer;
+		}
+
+		// Map the broadcast read only and check its layout before trusting any of the offsets in it
+		bool SpectatorSubscriber::open(const char* name) {
+			this->close();
+
+			char segmentName[64];
+			resolveSpectatorSegmentName(name, segmentName, sizeof(segmentName));
+
+#if defined(_WIN32)
+			HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, segmentName);
+			if (mapping == NULL) {
+				return false;
+			}
+			const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			MEMORY_BASIC_INFORMATION viewInfo;
+			if ((view == NULL) || (VirtualQuery(view, &viewInfo, sizeof(viewInfo)) == 0)) {
+				if (view != NULL) {
+					UnmapViewOfFile(view);
+				}
+				CloseHandle(mapping);
+				return false;
+			}
+			this->mappingHandle = mapping;
+			std::size_t segmentSize = viewInfo.RegionSize;
+#else
+			int file = shm_open(segmentName, O_RDONLY, 0);
+			if (file < 0) {
+				return false;
+			}
+			struct stat fileStat;
+			void* view = MAP_FAILED;
+			if ((fstat(file, &fileStat) == 0) && ((std::size_t)fileStat.st_size >= sizeof(SpectatorHeader))) {
+				view = mmap(nullptr, (std::size_t)fileStat.st_size, PROT_READ, MAP_SHARED, file, 0);
+			}
+			::close(file);
+			if (view == MAP_FAILED) {
+				return false;
+			}
+			std::size_t segmentSize = (std::size_t)fileStat.st_size;
+#endif
+
+			const unsigned char* bytes = (const unsigned char*)view;
+			this->header = (const SpectatorHeader*)bytes;
+			this->segmentSize = segmentSize;
+			bool result =
+				(memcmp(this->header->magic, SPECTATOR_MAGIC, sizeof(SPECTATOR_MAGIC)) == 0) &&
+				(this->header->version == SPECTATOR_VERSION) &&
+				(this->header->segmentSize <= segmentSize) &&
+				(this->header->fieldWidth >= 8) && (this->header->fieldHeight >= 8) && (this->header->slotCount > 0) &&
+				(this->header->slotOffset + ((std::uint64_t)this->header->slotCount * sizeof(SpectatorSlot)) <= this->header->tileOffset) &&
+				(this->header->tileOffset + this->header->tileCapacity <= this->header->segmentSize);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (!result) {
+				this->close();
+				return false;
+			}
+
+			this->slots = (const SpectatorSlot*)(bytes + this->header->slotOffset);
+			this->tiles = bytes + this->header->tileOffset;
+			if (this->tileBufferCapacity < this->header->tileCapacity) {
+				delete[] this->tileBuffer;
+				this->tileBuffer = new LevelTile[this->header->tileCapacity];
+				this->tileBufferCapacity = this->header->tileCapacity;
+			}
+			return true;
+		}
+
+		// Unmap the broadcast and forget the game, the mirror's memory is kept for the next broadcast opened
+		void SpectatorSubscriber::close() {
+			if (this->header != nullptr) {
+#if defined(_WIN32)
+				UnmapViewOfFile(this->header);
+				CloseHandle((HANDLE)this->mappingHandle);
+				this->mappingHandle = nullptr;
+#else
+				munmap((void*)this->header, this->segmentSize);
+#endif
+			}
+			this->header = nullptr;
+			this->slots = nullptr;
+			this->tiles = nullptr;
+			this->segmentSize = 0;
+			this->game = SpectatorGameRecord();
+			this->game.phase = (std::uint32_t)SpectatorPhase::CLOSED;
+			this->followingFlag = false;
+		}
+
+		// Check whether a broadcast is mapped
+		bool SpectatorSubscriber::isOpen() const {
+			return this->header != nullptr;
+		}
+
+		// Pick up a new game or phase, then play the ticks published since the last poll on the mirror, stopping at the first that does not add up
+		int SpectatorSubscriber::poll() {
+			if (this->header == nullptr) {
+				return 0;
+			}
+
+			// The record is only unreadable while the publisher is writing it, the next poll will find it written
+			SpectatorGameRecord record;
+			if (!this->readGameRecord(record, false)) {
+				return 0;
+			}
+			if (record.gameIndex != this->game.gameIndex) {
+				this->followGame(record);
+			} else {
+				this->game = record;
+			}
+			if (!this->followingFlag) {
+				return 0;
+			}
+
+			std::uint64_t publishedTickCount = this->header->publishedTickCount.load(std::memory_order_acquire);
+			if (publishedTickCount - this->nextTick > this->header->slotCount) {
+				this->stats.missedGameCount++;
+				this->followingFlag = false;
+				return 0;
+			}
+
+			int result = 0;
+			while (this->nextTick < publishedTickCount) {
+				SpectatorTick tick;
+				if (!this->readSlot(this->nextTick, tick)) {
+					this->stats.missedGameCount++;
+					this->followingFlag = false;
+					break;
+				}
+				// Ticks of the next game are played once its record has been read
+				if (tick.gameIndex != this->game.gameIndex) {
+					break;
+				}
+
+				QuickGameInputRequest input;
+				input.snakeMovementInput = (ObjectDirection)tick.input;
+				this->mirrorGame->update(&input);
+				this->nextTick++;
+				this->stats.appliedTickCount++;
+				result++;
+
+				if (this->mirrorGame->getStateHash() != tick.stateHash) {
+					this->stats.hashMismatchCount++;
+					this->followingFlag = false;
+					break;
+				}
+			}
+			return result;
+		}
+
+		// Get what the game is showing, closed when no broadcast is mapped
+		SpectatorPhase SpectatorSubscriber::getPhase() const {
+			return (SpectatorPhase)this->game.phase;
+		}
+
+		// Get the mirror while it holds the game being shown
+		const QuickGame* SpectatorSubscriber::getGame() const {
+			bool shownFlag = this->followingFlag && ((this->getPhase() == SpectatorPhase::RUNNING) || (this->getPhase() == SpectatorPhase::DONE));
+			return shownFlag ? this->mirrorGame : nullptr;
+		}
+
+		// Get the longest snake of the games played while the publisher has been up
+		int SpectatorSubscriber::getLongestSnakeLength() const {
+			return this->game.longestSnakeLength;
+		}
+
+		// Get whether the last game set the longest snake
+		bool SpectatorSubscriber::getLastGameBeatLongestSnakeLength() const {
+			return this->game.lastGameBeatLongestSnakeLengthFlag != 0;
+		}
+
+		// Get the counts of ticks played and games missed
+		const SpectatorStats& SpectatorSubscriber::getStats() const {
+			return this->stats;
+		}
+
+		// Copy the game record, and the level's tiles when asked, failing when the publisher wrote it meanwhile
+		bool SpectatorSubscriber::readGameRecord(SpectatorGameRecord& record, bool tilesFlag) {
+			std::uint64_t sequence = this->header->gameSequence.load(std::memory_order_acquire);
+			if ((sequence & 1) != 0) {
+				return false;
+			}
+
+			memcpy(&record, (const void*)&this->header->game, sizeof(record));
+			if (tilesFlag && (record.levelFlag != 0)) {
+				for (std::uint32_t tileIndex = 0; tileIndex < this->header->tileCapacity; tileIndex++) {
+					this->tileBuffer[tileIndex] = (LevelTile)this->tiles[tileIndex];
+				}
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return this->header->gameSequence.load(std::memory_order_relaxed) == sequence;
+		}
+
+		// Copy a tick out of its slot, failing when the slot has not been written for this tick or has been written again since
+		bool SpectatorSubscriber::readSlot(std::uint64_t tick, SpectatorTick& result) const {
+			const SpectatorSlot& slot = this->slots[tick % this->header->slotCount];
+			std::uint64_t sequence = (tick * 2) + 2;
+			if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+				return false;
+			}
+
+			memcpy(&result, (const void*)&slot.tick, sizeof(result));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return slot.sequence.load(std::memory_order_relaxed) == sequence;
+		}
+
+		// Set the mirror up for a new game and play it from its first tick, as long as that tick is still in the ring
+		void SpectatorSubscriber::followGame(const SpectatorGameRecord& record) {
+			// A record torn by the publisher leaves the last game in place, so the next poll tries again
+			SpectatorGameRecord levelRecord = record;
+			if ((record.levelFlag != 0) && (!this->readGameRecord(levelRecord, true) || (levelRecord.gameIndex != record.gameIndex))) {
+				return;
+			}
+
+			this->game = levelRecord;
+			this->followingFlag = false;
+			if (levelRecord.gameIndex == 0) {
+				return;
+			}
+			std::uint64_t publishedTickCount = this->header->publishedTickCount.load(std::memory_order_acquire);
+			if (publishedTickCount - levelRecord.firstTick > this->header->slotCount) {
+				this->stats.missedGameCount++;
+				return;
+			}
+
+			const QuickGameDefn& gameDefn = levelRecord.gameDefn;
+			if ((this->mirrorGame != nullptr) && (this->mirrorGame->getFieldSize() != gameDefn.fieldSize)) {
+				delete this->mirrorGame;
+				this->mirrorGame = nullptr;
+			}
+			if (this->mirrorGame == nullptr) {
+				this->mirrorGame = new QuickGame(&gameDefn);
+			} else {
+				this->mirrorGame->reset(&gameDefn);
+			}
+
+			const Level* level = nullptr;
+			if (levelRecord.levelFlag != 0) {
+				if (this->mirrorLevel == nullptr) {
+					this->mirrorLevel = new Level();
+				}
+				if (!this->mirrorLevel->build(gameDefn.fieldSize, gameDefn.snakeStartDefn, this->tileBuffer)) {
+					this->stats.missedGameCount++;
+					return;
+				}
+				level = this->mirrorLevel;
+			}
+			this->mirrorGame->setLevel(level);
+			this->mirrorGame->setFoodCount(levelRecord.foodCount);
+
+			this->nextTick = levelRecord.firstTick;
+			this->followingFlag = true;
+			this->stats.followedGameCount++;
+		}
+
+	}
@@ -0,0 +1,191 @@
+#include <assert.h>
+#include "includes/workstealingpool.hpp"
+
+
+	namespace snake {
+
+		// Constructor for WorkStealingPool, the threads wait for the first job
+		WorkStealingPool::WorkStealingPool(int workerCount, int queueCapacity) {
+			assert(workerCount > 0);
+
+			this->workerCount = workerCount;
+			this->queues = new WorkStealingQueue[workerCount];
+			this->workerStats = new WorkStealingWorkerStats[workerCount];
+			for (int workerIndex = 0; workerIndex < workerCount; workerIndex++) {
+				this->queues[workerIndex].tasks = new int[queueCapacity];
+				this->queues[workerIndex].capacity = queueCapacity;
+				this->queues[workerIndex].front = 0;
+				this->queues[workerIndex].count = 0;
+			}
+			this->resetStats();
+
+			this->pendingTaskCount = 0;
+			this->currentJob = nullptr;
+			this->generation = 0;
+			this->finishedWorkerCount = 0;
+			this->stoppingFlag = false;
+
+			this->threads.reserve(workerCount);
+			for (int workerIndex = 0; workerIndex < workerCount; workerIndex++) {
+				this->threads.emplace_back([this, workerIndex]() {
+					this->workerLoop(workerIndex);
+				});
+			}
+		}
+
+		// Destructor for WorkStealingPool, stops the threads once they are idle
+		WorkStealingPool::~WorkStealingPool() {
+			{
+				std::lock_guard<std::mutex> lock(this->controlMutex);
+				this->stoppingFlag = true;
+			}
+			this->startCondition.notify_all();
+
+			for (std::thread& thread : this->threads) {
+				thread.join();
+			}
+
+			for (int workerIndex = 0; workerIndex < this->workerCount; workerIndex++) {
+				delete[] this->queues[workerIndex].tasks;
+			}
+			delete[] this->queues;
+			delete[] this->workerStats;
+		}
+
+		// Spread the initial tasks round robin, wake the workers and wait until they have all run out of work
+		void WorkStealingPool::run(WorkStealingJob& job, const int* initialTasks, int initialTaskCount) {
+			std::unique_lock<std::mutex> lock(this->controlMutex);
+
+			this->pendingTaskCount = initialTaskCount;
+			for (int taskIndex = 0; taskIndex < initialTaskCount; taskIndex++) {
+				WorkStealingQueue& queue = this->queues[taskIndex % this->workerCount];
+				assert(queue.count < queue.capacity);
+				queue.tasks[(queue.front + queue.count) % queue.capacity] = initialTasks[taskIndex];
+				queue.count++;
+			}
+
+			this->currentJob = &job;
+			this->finishedWorkerCount = 0;
+			this->generation++;
+			this->startCondition.notify_all();
+
+			this->doneCondition.wait(lock, [this]() {
+				return this->finishedWorkerCount == this->workerCount;
+			});
+			this->currentJob = nullptr;
+		}
+
+		// Queue a task at the back of a worker's deque
+		bool WorkStealingPool::push(int workerIndex, int taskArgument) {
+			WorkStealingQueue& queue = this->queues[workerIndex];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.count >= queue.capacity) {
+				return false;
+			}
+
+			// Counted before it is visible, so the job cannot look finished while the task waits
+			this->pendingTaskCount.fetch_add(1);
+			queue.tasks[(queue.front + queue.count) % queue.capacity] = taskArgument;
+			queue.count++;
+			return true;
+		}
+
+		// Get the number of worker threads
+		int WorkStealingPool::getWorkerCount() const {
+			return this->workerCount;
+		}
+
+		// Get what a worker did since the stats were last reset
+		const WorkStealingWorkerStats& WorkStealingPool::getWorkerStats(int workerIndex) const {
+			return this->workerStats[workerIndex];
+		}
+
+		// Clear every worker's counts, only while no job is running
+		void WorkStealingPool::resetStats() {
+			for (int workerIndex = 0; workerIndex < this->workerCount; workerIndex++) {
+				this->workerStats[workerIndex].taskCount = 0;
+				this->workerStats[workerIndex].stolenTaskCount = 0;
+			}
+		}
+
+		// Wait for a job, then run tasks from the own deque or stolen ones until none are left anywhere
+		void WorkStealingPool::workerLoop(int workerIndex) {
+			int lastGeneration = 0;
+
+			while (true) {
+				WorkStealingJob* job = nullptr;
+				{
+					std::unique_lock<std::mutex> lock(this->controlMutex);
+					this->startCondition.wait(lock, [this, lastGeneration]() {
+						return this->stoppingFlag || (this->generation != lastGeneration);
+					});
+					if (this->stoppingFlag) {
+						return;
+					}
+					lastGeneration = this->generation;
+					job = this->currentJob;
+				}
+
+				while (this->pendingTaskCount.load() > 0) {
+					int taskArgument = 0;
+					bool stolenFlag = false;
+					if (!this->popLocal(workerIndex, &taskArgument)) {
+						stolenFlag = this->steal(workerIndex, &taskArgument);
+						if (!stolenFlag) {
+							// Everything left is running on other workers, which may still push more
+							std::this_thread::yield();
+							continue;
+						}
+					}
+
+					job->runTask(*this, workerIndex, taskArgument);
+					this->pendingTaskCount.fetch_sub(1);
+
+					this->workerStats[workerIndex].taskCount++;
+					if (stolenFlag) {
+						this->workerStats[workerIndex].stolenTaskCount++;
+					}
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(this->controlMutex);
+					this->finishedWorkerCount++;
+					if (this->finishedWorkerCount == this->workerCount) {
+						this->doneCondition.notify_all();
+					}
+				}
+			}
+		}
+
+		// Take the newest task from the worker's own deque, which keeps the tasks it split most recently hot in its cache
+		bool WorkStealingPool::popLocal(int workerIndex, int* taskArgument) {
+			WorkStealingQueue& queue = this->queues[workerIndex];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.count == 0) {
+				return false;
+			}
+
+			queue.count--;
+			*taskArgument = queue.tasks[(queue.front + queue.count) % queue.capacity];
+			return true;
+		}
+
+		// Take the oldest task from another worker's deque, trying each in turn starting with the next one along
+		bool WorkStealingPool::steal(int thiefIndex, int* taskArgument) {
+			for (int offset = 1; offset < this->workerCount; offset++) {
+				WorkStealingQueue& queue = this->queues[(thiefIndex + offset) % this->workerCount];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				if (queue.count == 0) {
+					continue;
+				}
+
+				*taskArgument = queue.tasks[queue.front];
+				queue.front = (queue.front + 1) % queue.capacity;
+				queue.count--;
+				return true;
+			}
+
+			return false;
+		}
+
+	}
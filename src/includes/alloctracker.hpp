@@ -0,0 +1,57 @@
+//This header file defines the allocation tracker used to keep the frame loop free of heap allocations.
+#include <cstddef>
+#pragma once
+
+
+
+	namespace snake {
+
+		//Enum for the parts of a frame that allocations are attributed to, COUNT is the number of subsystems.
+		typedef enum class Snake_AllocationSubsystem {
+			OTHER,
+			EVENTS,
+			SIMULATION,
+			RENDER,
+			AUDIO,
+			COUNT,
+		} AllocationSubsystem;
+
+		//Struct to hold the allocations made by the tracked thread during one frame.
+		typedef struct Snake_AllocationFrameStats {
+			int allocationCount[(int)AllocationSubsystem::COUNT];
+			std::size_t allocatedBytes[(int)AllocationSubsystem::COUNT];
+			int freeCount;
+		} AllocationFrameStats;
+
+		namespace AllocationTracker {
+			//True when built with SNAKE_TRACK_ALLOCATIONS, otherwise every frame reports zero allocations.
+			bool isEnabled();
+
+			//Start counting allocations made by the calling thread.
+			void beginFrame();
+			//Stop counting and return what was allocated since beginFrame().
+			const AllocationFrameStats& endFrame();
+
+			int getTotalAllocationCount(const AllocationFrameStats& frameStats);
+			//Allocations made by every thread since the process started, frame or not, for tools checking work spread over worker threads.
+			long long getProcessAllocationCount();
+			const char* getSubsystemName(AllocationSubsystem subsystem);
+
+		}
+
+		//Attributes allocations made by the calling thread to a subsystem until the scope ends.
+		class AllocationScope {
+
+		private:
+			AllocationSubsystem previousSubsystem;
+
+		public:
+			AllocationScope(AllocationSubsystem subsystem);
+
+		public:
+			~AllocationScope();
+
+		};
+
+	}
+
@@ -0,0 +1,162 @@
+//This header file defines the arena game, where thousands of bot snakes share one large field and are moved region by region on the worker pool.
+#include <atomic>
+#include <cstdint>
+#include <SFML/System/Vector2.hpp>
+#include "gamestate.hpp"
+#include "workstealingpool.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Struct for how an arena is set up.
+		typedef struct Snake_ArenaGameDefn {
+			sf::Vector2i fieldSize;
+			int snakeCount;
+			//the first playerSnakeCount snakes follow setSnakeInput(), every other snake is steered by the arena's bot
+			int playerSnakeCount;
+			int snakeStartLength;
+			//snakes stop growing at this length, it sizes every snake's ring of cells
+			int snakeMaxLength;
+			//apples kept on the field, each eaten apple is put back somewhere else at the end of the tick
+			int appleCount;
+			//ticks a dead snake waits before it is spawned again, 0 leaves dead snakes out for good
+			int respawnDelayTicks;
+			//the field is split into this many bands of rows, each band's snakes are one task on the pool
+			int regionCount;
+			int workerCount;
+			unsigned int randomSeed;
+		} ArenaGameDefn;
+
+		//Struct for one snake of the arena. Its cells live in a ring of snakeMaxLength cell indices owned by the arena.
+		typedef struct Snake_ArenaSnake {
+			int headSlot;
+			int tailSlot;
+			int length;
+			int queuedGrowth;
+			ObjectDirection direction;
+			ObjectDirection input;
+			//cell the head moves into this tick, worked out before any snake moves
+			int targetCell;
+			//cell the bot heads for while no apple is in sight
+			int wanderCell;
+			std::uint32_t randomState;
+			bool aliveFlag;
+			bool dyingFlag;
+			int respawnTicks;
+			int applesEaten;
+		} ArenaSnake;
+
+		//Struct to hold what one tick did.
+		typedef struct Snake_ArenaTickStats {
+			int aliveSnakeCount;
+			//snakes that died, and the part of them that died moving into the same cell as another head
+			int deathCount;
+			int headOnDeathCount;
+			int applesEaten;
+			int respawnCount;
+			double tickSeconds;
+		} ArenaTickStats;
+
+		class ArenaGame;
+
+		//Many snakes on one field sharing an occupancy grid that stores which snake covers each cell.
+		//A tick runs in phases with the pool finishing each before the next starts: every snake picks the cell it moves into and claims it,
+		//then snakes that hit something or share their cell with another head die and every tail that moves leaves its cell,
+		//then the surviving heads move in. Collisions are judged against the board at the start of the tick, and claims are counted
+		//rather than raced for, so a tick plays out the same whatever the worker count and whichever region runs first.
+		class ArenaGame : public WorkStealingJob {
+
+		private:
+			ArenaGameDefn defn;
+			WorkStealingPool* pool;
+
+		private:
+			//owning snake index of every cell, or one of the ARENA_*_CELL values
+			int* cellOwners;
+			//heads that want to move into each cell this tick
+			std::atomic<int>* cellClaims;
+			std::uint8_t* appleCells;
+			//cells of the apples the last update() spawned, in the order they were spawned
+			int* spawnedAppleCells;
+			int spawnedAppleCount;
+
+		private:
+			ArenaSnake* snakes;
+			//snakeCount rings of snakeMaxLength cell indices
+			int* snakeCells;
+
+		private:
+			//indices of the live snakes sorted by the region their head is in, and where each region's run starts
+			int* regionSnakes;
+			int* regionStarts;
+			int* regionTasks;
+			int phase;
+
+		private:
+			//counted by the workers during a tick
+			std::atomic<int> deathCount;
+			std::atomic<int> headOnDeathCount;
+			std::atomic<int> applesEatenCount;
+
+		private:
+			std::uint32_t randomState;
+			int tickCount;
+
+		public:
+			//Constructor, places the walls, snakes and apples. Every buffer is allocated here so ticks do not allocate.
+			ArenaGame(const ArenaGameDefn& defn);
+
+		public:
+			~ArenaGame();
+
+		public:
+			//Set the direction a player snake turns to on the next tick, ignored for bot snakes.
+			void setSnakeInput(int snakeIndex, ObjectDirection direction);
+			//Advance every snake by one move.
+			ArenaTickStats update();
+
+		public:
+			const ArenaGameDefn& getDefn() const;
+			int getTickCount() const;
+			int getAliveSnakeCount() const;
+			const ArenaSnake& getSnake(int snakeIndex) const;
+			sf::Vector2i getSnakeCell(int snakeIndex, int segmentIndex) const;
+			//Snake covering a cell, -1 when there is none.
+			int getCellOwner(sf::Vector2i position) const;
+			bool getAppleAt(sf::Vector2i position) const;
+			//Apples the last update() put on the field, for sending the changes of a tick without looking at every cell.
+			int getSpawnedAppleCount() const;
+			sf::Vector2i getSpawnedApple(int appleIndex) const;
+			//Hash of every snake's cells and direction and every apple, worked out from scratch so it is slow on large arenas.
+			std::uint64_t computeStateHash() const;
+
+		public:
+			void runTask(WorkStealingPool& pool, int workerIndex, int taskArgument) override;
+
+		private:
+			int resolveCellIndex(sf::Vector2i position) const;
+			sf::Vector2i resolvePosition(int cellIndex) const;
+			int resolveDirectionOffset(ObjectDirection direction) const;
+			int resolveRandomInteriorCell(std::uint32_t& randomState) const;
+			int resolveRandomFreeCell(std::uint32_t& randomState) const;
+
+		private:
+			bool spawnSnake(int snakeIndex);
+			void spawnApple();
+			void removeSnake(int snakeIndex);
+			void sortSnakesByRegion();
+			void runPhase(int phase);
+
+		private:
+			ObjectDirection resolveBotDirection(int snakeIndex);
+			bool cellIsFreeFor(int cellIndex) const;
+			bool cellIsHead(int cellIndex) const;
+			void claimTarget(int snakeIndex);
+			void resolveTarget(int snakeIndex);
+			void moveHead(int snakeIndex);
+
+		};
+
+	}
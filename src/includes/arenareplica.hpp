@@ -0,0 +1,78 @@
+//This header file defines the arena replica, a client's copy of an arena built up from the changes the server sends.
+#include <cstdint>
+#include <SFML/System/Vector2.hpp>
+#include "gamestate.hpp"
+#include "netprotocol.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Struct for one snake of a replica, its cells live in a ring of snakeMaxLength cell indices like on the arena.
+		typedef struct Snake_ArenaReplicaSnake {
+			int headSlot;
+			int tailSlot;
+			int length;
+			ObjectDirection direction;
+			bool aliveFlag;
+		} ArenaReplicaSnake;
+
+		class ArenaReplica;
+
+		//The board of an ArenaGame as a client sees it: which snake covers each cell, where the apples are and every snake's body.
+		//It changes only through the same steps the arena takes in the same order within a tick, so applying a tick's changes
+		//leaves it on the board the arena ended the tick on, and computeStateHash() gives the arena's hash for it.
+		class ArenaReplica {
+
+		private:
+			NetArenaShape shape;
+			int* cellOwners;
+			std::uint8_t* appleCells;
+			ArenaReplicaSnake* snakes;
+			int* snakeCells;
+
+		public:
+			//Constructor, allocates every buffer for the arena's shape and starts with walls and nothing else.
+			ArenaReplica(const NetArenaShape& shape);
+
+		public:
+			~ArenaReplica();
+
+		public:
+			//Take every snake and apple off the board, before a keyframe.
+			void clear();
+			//Take a dying snake's cells off the board.
+			void removeSnake(int snakeIndex);
+			//Move a snake's tail off its cell.
+			void moveTail(int snakeIndex);
+			//Move a snake's head one cell on, eating the apple there.
+			void moveHead(int snakeIndex, ObjectDirection direction);
+			//Lay a snake out from its head back, every step the direction from one segment to the next towards the tail.
+			void placeSnake(int snakeIndex, int headCell, ObjectDirection direction, int length, const std::uint8_t* stepBits);
+			//Lay a spawned snake out straight behind its head, the way the arena spawns them.
+			void spawnSnake(int snakeIndex, int headCell, ObjectDirection direction, int length);
+			void setApple(int cellIndex);
+
+		public:
+			const NetArenaShape& getShape() const;
+			bool getSnakeAlive(int snakeIndex) const;
+			ObjectDirection getSnakeDirection(int snakeIndex) const;
+			int getSnakeLength(int snakeIndex) const;
+			//Get a cell of a snake counting back from its head, which is segment 0.
+			sf::Vector2i getSnakeCell(int snakeIndex, int segmentIndex) const;
+			//Check whether a cell is a wall or covered by a snake.
+			bool getCellBlocked(sf::Vector2i position) const;
+			bool getAppleAt(sf::Vector2i position) const;
+			//Hash of the replica worked out the same way as ArenaGame::computeStateHash(), so equal boards hash the same.
+			std::uint64_t computeStateHash() const;
+
+		public:
+			int resolveCellIndex(sf::Vector2i position) const;
+			sf::Vector2i resolvePosition(int cellIndex) const;
+			//Check a cell index from the network is inside the walls.
+			bool isInteriorCell(int cellIndex) const;
+
+		};
+
+	}
@@ -0,0 +1,133 @@
+//This header file defines the autopilot, which plays a quick game by planning a path to the apple and checking the snake can still reach its tail.
+#include <cstdint>
+#include <SFML/System/Vector2.hpp>
+#include "quickgame.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Struct to hold how long the autopilot spent planning, in microseconds.
+		typedef struct Snake_AutopilotStats {
+			int tickCount;
+			int planCount;
+			int overBudgetCount;
+			std::int64_t lastMicroseconds;
+			std::int64_t maxMicroseconds;
+			std::int64_t totalMicroseconds;
+		} AutopilotStats;
+
+		//Struct for the two part priority of a cell in the planner's queue, compared first by primary and then by secondary.
+		typedef struct Snake_AutopilotKey {
+			int primary;
+			int secondary;
+		} AutopilotKey;
+
+		class Autopilot;
+
+		//Chooses the snake's input every frame. The path to the apple comes from a D* Lite search rooted at the apple,
+		//which repairs only the cells whose occupancy changed when the snake moves instead of searching again from scratch.
+		//A path is only taken when the snake could still reach its tail after eating at the end of it.
+		class Autopilot {
+
+		private:
+			sf::Vector2i fieldSize;
+			int cellCount;
+
+		private:
+			//cells the snake's body covers or that are walls, the head and tail cells are never blocked
+			unsigned char* blocked;
+
+		private:
+			//D* Lite state: cost-to-apple estimates, one step lookahead values and the queue of inconsistent cells
+			int* costToGoal;
+			int* lookaheadCost;
+			int* queueCells;
+			AutopilotKey* queueKeys;
+			int* queuePosition;
+			int queueLength;
+			int keyModifier;
+			sf::Vector2i goalPosition;
+			sf::Vector2i lastStartPosition;
+
+		private:
+			//breadth first search scratch for the tail reachability check
+			int* searchQueue;
+			int* searchDistance;
+			int* searchStamp;
+			int currentSearchStamp;
+
+		private:
+			//the snake's cells from tail to head followed by the planned path, for playing the path out ahead of time
+			int* virtualCells;
+			unsigned char* virtualSavedBlocked;
+
+		private:
+			//board the plan was made for, the plan is reused until the board changes
+			bool trackingFlag;
+			int lastFrameCount;
+			std::uint64_t lastStateHash;
+			sf::Vector2i lastHeadPosition;
+			sf::Vector2i lastTailPosition;
+			ObjectDirection plannedDirection;
+
+		private:
+			std::int64_t budgetMicroseconds;
+			AutopilotStats stats;
+
+		public:
+			//Constructor, planning that takes longer than budgetMicroseconds is counted in the stats.
+			Autopilot(std::int64_t budgetMicroseconds);
+
+		public:
+			~Autopilot();
+
+		public:
+			//Choose the input for the next update of the game.
+			QuickGameInputRequest resolveInput(const QuickGame& game);
+
+		public:
+			const AutopilotStats& getStats() const;
+			void resetStats();
+
+		private:
+			ObjectDirection plan(const QuickGame& game);
+
+		private:
+			void resizeForField(sf::Vector2i fieldSize);
+			void rebuild(const QuickGame& game);
+			void syncAfterMove(const QuickGame& game);
+			void setBlocked(int cellIndex, bool blockedFlag);
+
+		private:
+			void resetSearch(sf::Vector2i goalPosition, sf::Vector2i startPosition);
+			int resolveStepCost(int fromCellIndex, int toCellIndex) const;
+			AutopilotKey calculateKey(int cellIndex) const;
+			void updateVertex(int cellIndex);
+			void updateNeighbourVertices(int cellIndex);
+			void computeShortestPath();
+
+		private:
+			bool queueKeyLess(const AutopilotKey& left, const AutopilotKey& right) const;
+			void queuePush(int cellIndex, AutopilotKey key);
+			void queueRemove(int cellIndex);
+			void queueSwap(int leftSlot, int rightSlot);
+			void queueSiftUp(int slot);
+			void queueSiftDown(int slot);
+
+		private:
+			bool isLethal(const QuickGame& game, sf::Vector2i position) const;
+			bool isPathSafe(const QuickGame& game, ObjectDirection firstDirection);
+			int measureTailDistance(const QuickGame& game, sf::Vector2i nextHeadPosition);
+			int measureReachableCells(const QuickGame& game, sf::Vector2i nextHeadPosition);
+			int search(sf::Vector2i startPosition, int targetCellIndex, int* reachedCount);
+
+		private:
+			int resolveCellIndex(sf::Vector2i position) const;
+			sf::Vector2i resolvePosition(int cellIndex) const;
+
+		};
+
+	}
+
@@ -0,0 +1,86 @@
+//This header file defines chunked occupancy, a sparse count of snake segments per cell for fields far too large to store every cell of.
+#include <cstddef>
+#include <cstdint>
+#include <SFML/System/Vector2.hpp>
+#pragma once
+
+
+
+	namespace snake {
+
+		//Cells along each side of a chunk, a power of two so a position splits into its chunk and its cell with shifts and masks.
+		const int OCCUPANCY_CHUNK_SHIFT = 6;
+		const int OCCUPANCY_CHUNK_SIZE = 1 << OCCUPANCY_CHUNK_SHIFT;
+		const int OCCUPANCY_CHUNK_CELL_COUNT = OCCUPANCY_CHUNK_SIZE * OCCUPANCY_CHUNK_SIZE;
+
+		//Struct for one square of cells that something covers. A chunk is only kept while it has an occupied cell.
+		typedef struct Snake_OccupancyChunk {
+			std::int64_t key;
+			int occupiedCellCount;
+			unsigned char cellCounts[OCCUPANCY_CHUNK_CELL_COUNT];
+			//next chunk kept for reuse once this one is released
+			Snake_OccupancyChunk* nextFreeChunk;
+		} OccupancyChunk;
+
+		class ChunkedOccupancy;
+
+		//Per-cell counts for a field of up to billions of cells. Chunks are made the first time one of their cells is counted
+		//and released when their last count goes, so memory follows the area that is covered rather than the size of the field.
+		//Chunks are found through an open addressing table keyed by their place in the field.
+		class ChunkedOccupancy {
+
+		private:
+			sf::Vector2i fieldSize;
+			std::int64_t chunksPerRow;
+
+		private:
+			//linear probed table of the live chunks, its capacity is a power of two kept at least twice the chunk count
+			OccupancyChunk** slots;
+			int slotCapacity;
+			int chunkCount;
+
+		private:
+			//released chunks kept for the next ones needed, up to a few so a snake crossing back and forth does not allocate
+			OccupancyChunk* freeChunks;
+			int freeChunkCount;
+			int allocatedChunkCount;
+
+		public:
+			//Constructor, nothing is counted and no chunk is allocated yet.
+			ChunkedOccupancy(sf::Vector2i fieldSize);
+
+		public:
+			~ChunkedOccupancy();
+
+		public:
+			//Clear every count for a field of the given size, releasing every chunk.
+			void reset(sf::Vector2i fieldSize);
+			//Copy another occupancy's counts, the chunks this one needs beyond its own are allocated.
+			void copyFrom(const ChunkedOccupancy& other);
+
+		public:
+			//Count of a cell, 0 for cells outside the field.
+			unsigned char getCount(sf::Vector2i position) const;
+			void increment(sf::Vector2i position);
+			void decrement(sf::Vector2i position);
+
+		public:
+			sf::Vector2i getFieldSize() const;
+			int getChunkCount() const;
+			//Bytes held by chunks, live or kept for reuse, and by the table.
+			std::size_t getAllocatedBytes() const;
+
+		private:
+			std::int64_t resolveChunkKey(sf::Vector2i position) const;
+			int resolveHomeSlot(std::int64_t key) const;
+			int resolveCellIndex(sf::Vector2i position) const;
+			OccupancyChunk* findChunk(std::int64_t key) const;
+
+		private:
+			OccupancyChunk* acquireChunk(std::int64_t key);
+			void releaseChunk(std::int64_t key);
+			void growSlots();
+
+		};
+
+	}
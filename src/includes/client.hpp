@@ -1,5 +1,8 @@
 //This header file defines the GameClient class, which is responsible for managing the game's state and interactions.
+#include <thread>
 #include <SFML/Graphics.hpp>
+#include "alloctracker.hpp"
+#include "quickgamescene.hpp"
 #pragma once
 
 
@@ -12,6 +15,31 @@
 			QUICK_GAME,
 		} ClientMode;
 
+		//Struct for the options the client is started with.
+		typedef struct Snake_GameClientOptions {
+			//construct the quick game scene on a background thread while the splash screen is showing
+			bool prewarmScenes;
+			//directory every finished quick game is saved to as a replay, nullptr to not record
+			const char* replayDirectory;
+			//let the autopilot play quick games, starting the next one by itself after each game over
+			bool autopilot;
+			//let the Hamiltonian cycle solver play quick games the same way, filling the field every time
+			bool perfectPlay;
+			//let the tree search bot play quick games at mctsDifficulty the same way
+			bool mcts;
+			MctsDifficulty mctsDifficulty;
+			//size of the field quick games are played on, walls included
+			sf::Vector2i fieldSize;
+			//compiled level quick games are played on, taking the place of fieldSize, nullptr for the plain field
+			const char* levelPath;
+			//play every quick game on a new generated level
+			bool generatedLevels;
+			//foods of random kinds kept on the field in place of the single apple, 0 for the apple
+			int foodCount;
+			//name quick games are broadcast under for snake-spectator viewers on the same machine, nullptr to not broadcast
+			const char* broadcastName;
+		} GameClientOptions;
+
 		class SplashSceneController;
 		class QuickGameController;
 		class GameClient;
@@ -19,6 +47,10 @@
 		//main class for handling the game
 		class GameClient {
 
+		private:
+			//options the client was started with
+			GameClientOptions options;
+
 		private:
 			//for storing current mode
 			ClientMode mode;
@@ -26,13 +58,21 @@
 			sf::RenderWindow window;
 
 		private:
-			//controllers for different game states
+			//controllers for different game states, constructed on first use
 			SplashSceneController* splashSceneController;
 			QuickGameController* quickGameController;
 
+		private:
+			//background thread constructing the quick game controller when prewarming, on a GL context of its own
+			std::thread quickGamePrewarmThread;
+
+		private:
+			//number of steady state frames that allocated, only counted in allocation tracking builds
+			int steadyStateAllocationFrameCount;
+
 		public:
 			//constructor
-			GameClient();
+			GameClient(const GameClientOptions& options);
 
 		public:
 			//destructor
@@ -42,6 +82,20 @@
 			//function to start the game loop
 			void run();
 
+		public:
+			int getSteadyStateAllocationFrameCount() const;
+
+		private:
+			//methods returning the controller for a scene, constructing it the first time
+			SplashSceneController* ensureSplashSceneController();
+			QuickGameController* ensureQuickGameController();
+			QuickGameControllerOptions resolveQuickGameControllerOptions() const;
+
+		private:
+			//methods for checking that frames of a running game do not allocate
+			bool isQuickGameRunning() const;
+			void checkSteadyStateAllocations(const AllocationFrameStats& frameStats);
+
 		private:
 			//methods for handling events in different modes
 			void processSplashScreenEvent(sf::Event& event);
@@ -0,0 +1,94 @@
+//This header file defines the field bitboard, which packs a quick game's walls, snake and apple into 64 bit words so bots can flood fill the field every tick.
+#include <cstdint>
+#include <SFML/System/Vector2.hpp>
+#include "quickgame.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Struct for what one move would leave the snake: whether it dies, the cells its head could still reach, and whether its tail is among them.
+		typedef struct Snake_FieldMoveReachability {
+			bool lethalFlag;
+			int reachableCellCount;
+			bool tailReachableFlag;
+		} FieldMoveReachability;
+
+		class FieldBitboard;
+
+		//One bit per cell for each layer, every row starting on a new word. Flood fills spread a whole word of cells at a time:
+		//sideways through runs of open cells with shifts, and between rows by sweeping down and back up until nothing changes.
+		class FieldBitboard {
+
+		private:
+			sf::Vector2i fieldSize;
+			int wordsPerRow;
+			int wordCount;
+
+		private:
+			//layers copied from the game, bits past the field's width are always clear
+			std::uint64_t* wallBits;
+			std::uint64_t* snakeBits;
+			std::uint64_t* appleBits;
+			//cells that are neither wall nor snake
+			std::uint64_t* openBits;
+			//whether the walls are a level's rather than the field's border
+			bool levelWallsFlag;
+
+		private:
+			//cells reached by the last flood fill, and the open cells no region has claimed yet while counting regions
+			std::uint64_t* filledBits;
+			std::uint64_t* unclaimedBits;
+
+		public:
+			//Constructor, the layers are allocated by the first loadFromGame().
+			FieldBitboard();
+
+		public:
+			~FieldBitboard();
+
+		public:
+			//Copy a game's walls, snake and apple. The words are only reallocated when the field size changes.
+			//The walls are the field's border and the obstacles of the game's level, if it has one.
+			void loadFromGame(const QuickGame& game);
+			//Copy a level's collision bitmap as the walls, with no snake or apple on the board.
+			void loadFromLevel(const Level& level);
+
+		public:
+			//Mark a cell as snake or open, for trying moves out on the board.
+			void setSnakeCell(sf::Vector2i position, bool snakeFlag);
+
+		public:
+			sf::Vector2i getFieldSize() const;
+			bool isWall(sf::Vector2i position) const;
+			bool isSnake(sf::Vector2i position) const;
+			bool isApple(sf::Vector2i position) const;
+			bool isOpen(sf::Vector2i position) const;
+			//Whether the last flood fill reached a cell.
+			bool isFilled(sf::Vector2i position) const;
+
+		public:
+			//Flood fill the open cells connected to a cell. Returns how many were reached, 0 when the cell is not open.
+			int floodFill(sf::Vector2i startPosition);
+			//Count the separate regions of open cells, and the cells in the largest when largestRegionCellCount is given.
+			int countRegions(int* largestRegionCellCount);
+			//Play one move of the loaded game's snake on the board and measure the space its head would have left.
+			//The board is put back afterwards, and it has to have been loaded from the same game.
+			FieldMoveReachability measureMove(const QuickGame& game, ObjectDirection direction);
+
+		private:
+			void resize(sf::Vector2i fieldSize);
+			void loadBorderWalls();
+			void loadLevelWalls(const Level& level);
+			void updateOpenBits();
+			void setBit(std::uint64_t* bits, sf::Vector2i position, bool valueFlag);
+			bool getBit(const std::uint64_t* bits, sf::Vector2i position) const;
+
+		private:
+			int expandFill(const std::uint64_t* maskBits);
+			bool fillRow(int rowIndex, int neighbourRowIndex, const std::uint64_t* maskBits);
+
+		};
+
+	}
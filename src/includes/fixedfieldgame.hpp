@@ -0,0 +1,447 @@
+//This header file defines the fixed field game, a quick game compiled for one field size so its grids are fixed arrays and its index math is constant.
+#include <assert.h>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <SFML/System/Vector2.hpp>
+#include "quickgame.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		template <int Width, int Height>
+		class FixedFieldGame;
+
+		//Plays exactly like QuickGame on a Width x Height field: the same definition and inputs place the same apples, end on the same frame
+		//and hash the same, so replays recorded on one play back on the other. The snake is a ring of cell indices rather than segments with
+		//directions, the walls count as occupied cells so a barrier check is one lookup, and there is no arena.
+		//It is meant for headless play such as replays, searches and training. Games that are rendered keep using QuickGame: the renderer
+		//draws every segment from the directions it was entered and left by, which the ring of cells does not keep, and levels and many
+		//foods are only played on QuickGame.
+		template <int Width = QUICK_GAME_DEFAULT_FIELD_WIDTH, int Height = QUICK_GAME_DEFAULT_FIELD_HEIGHT>
+		class FixedFieldGame {
+
+			static_assert((Width >= 4) && (Height >= 4), "The field needs room inside its walls");
+
+		public:
+			static constexpr int CELL_COUNT = Width * Height;
+			static constexpr int INTERIOR_CELL_COUNT = (Width - 2) * (Height - 2);
+			static constexpr int ZOBRIST_KEY_COUNT = (CELL_COUNT * ZOBRIST_CELL_TABLE_COUNT) + ZOBRIST_DIRECTION_COUNT;
+
+		private:
+			//Struct for the Zobrist keys of this field size, filled once and shared by every game of the size.
+			typedef struct Snake_ZobristKeyTable {
+				std::array<std::uint64_t, ZOBRIST_KEY_COUNT> keys;
+
+				Snake_ZobristKeyTable() {
+					QuickGameUtils::fillZobristKeys(this->keys.data(), sf::Vector2i(Width, Height));
+				}
+			} ZobristKeyTable;
+
+		private:
+			std::default_random_engine randomizer;
+			float snakeSpeedTilesPerSecond;
+			const std::uint64_t* zobristKeys;
+
+		private:
+			//segments on every cell, with every wall cell counted once
+			std::array<unsigned char, CELL_COUNT> cellOccupancy;
+			//the snake's cells from tail to head, a ring that only ever gains a head and loses a tail
+			std::array<int, CELL_COUNT> snakeCells;
+			int tailSlot;
+			int headSlot;
+			int snakeLength;
+			ObjectDirection headDirection;
+
+		private:
+			bool appleExistsFlag;
+			int appleCell;
+
+		private:
+			int framesSinceSnakeMoved;
+			ObjectDirection queuedSnakeInput;
+			int queuedSnakeGrowth;
+
+		private:
+			std::uint64_t stateHash;
+			int frameCount;
+
+		public:
+			//Constructor, the definition's field size has to be Width x Height.
+			FixedFieldGame(const QuickGameDefn* quickGameDefn);
+
+		public:
+			//Start a new game in place.
+			void reset(const QuickGameDefn* quickGameDefn);
+
+		public:
+			static sf::Vector2i getFieldSize();
+			sf::Vector2i getHeadPosition() const;
+			ObjectDirection getHeadDirection() const;
+			sf::Vector2i getTailPosition() const;
+			sf::Vector2i getSegmentPosition(int segmentIndex) const;
+			int getSnakeLength() const;
+			bool getAppleExists() const;
+			sf::Vector2i getApplePosition() const;
+			int getFrameCount() const;
+			int getQueuedSnakeGrowth() const;
+			bool getFieldFull() const;
+			std::uint64_t getStateHash() const;
+
+		public:
+			QuickGameUpdateResult update(const QuickGameInputRequest* input);
+
+		private:
+			static int resolveCellIndex(sf::Vector2i position);
+			static sf::Vector2i resolvePosition(int cellIndex);
+			static constexpr int resolveDirectionOffset(ObjectDirection direction);
+			static int resolveNextSlot(int slot);
+
+		private:
+			void spawnAppleIfMissing();
+			bool isValidMovementDirection(ObjectDirection direction) const;
+			bool snakeWouldHitBarrier(int newHeadCell) const;
+			std::uint64_t resolveCellKey(int keyTable, int cellIndex) const;
+			std::uint64_t resolveDirectionKey(ObjectDirection direction) const;
+			std::uint64_t computeStateHash() const;
+
+		};
+
+		// Constructor for FixedFieldGame
+		template <int Width, int Height>
+		FixedFieldGame<Width, Height>::FixedFieldGame(const QuickGameDefn* quickGameDefn) {
+			static const ZobristKeyTable zobristKeyTable;
+			this->zobristKeys = zobristKeyTable.keys.data();
+			this->reset(quickGameDefn);
+		}
+
+		// Reset the game to its starting state, laying the snake out the way Snake::reset does
+		template <int Width, int Height>
+		void FixedFieldGame<Width, Height>::reset(const QuickGameDefn* quickGameDefn) {
+			assert((quickGameDefn->fieldSize.x == Width) && (quickGameDefn->fieldSize.y == Height));
+			assert(quickGameDefn->snakeStartDefn.length >= 2);
+
+			this->randomizer.seed(quickGameDefn->randomSeed);
+			this->snakeSpeedTilesPerSecond = quickGameDefn->snakeSpeedTilesPerSecond;
+
+			this->cellOccupancy.fill(0);
+			for (int x = 0; x < Width; x++) {
+				this->cellOccupancy[resolveCellIndex(sf::Vector2i(x, 0))] = 1;
+				this->cellOccupancy[resolveCellIndex(sf::Vector2i(x, Height - 1))] = 1;
+			}
+			for (int y = 1; y < Height - 1; y++) {
+				this->cellOccupancy[resolveCellIndex(sf::Vector2i(0, y))] = 1;
+				this->cellOccupancy[resolveCellIndex(sf::Vector2i(Width - 1, y))] = 1;
+			}
+
+			// The head is in the last slot and every segment behind it one step further against the facing direction
+			const SnakeStartDefn& startDefn = quickGameDefn->snakeStartDefn;
+			sf::Vector2i facingVector = SnakeUtils::directionToVector(startDefn.facingDirection);
+			this->snakeLength = startDefn.length;
+			this->tailSlot = 0;
+			this->headSlot = startDefn.length - 1;
+			for (int segmentIndex = 0; segmentIndex < startDefn.length; segmentIndex++) {
+				int cellIndex = resolveCellIndex(startDefn.headPosition - (facingVector * segmentIndex));
+				this->snakeCells[this->headSlot - segmentIndex] = cellIndex;
+				this->cellOccupancy[cellIndex]++;
+			}
+			this->headDirection = startDefn.facingDirection;
+
+			this->appleExistsFlag = false;
+			this->appleCell = 0;
+
+			this->framesSinceSnakeMoved = 0;
+			this->queuedSnakeInput = ObjectDirection::NONE;
+			this->queuedSnakeGrowth = 0;
+
+			this->frameCount = 0;
+			this->stateHash = this->computeStateHash();
+		}
+
+		// Get the size of the game field
+		template <int Width, int Height>
+		sf::Vector2i FixedFieldGame<Width, Height>::getFieldSize() {
+			return sf::Vector2i(Width, Height);
+		}
+
+		// Get the position of the snake's head
+		template <int Width, int Height>
+		sf::Vector2i FixedFieldGame<Width, Height>::getHeadPosition() const {
+			return resolvePosition(this->snakeCells[this->headSlot]);
+		}
+
+		// Get the direction the head last moved in
+		template <int Width, int Height>
+		ObjectDirection FixedFieldGame<Width, Height>::getHeadDirection() const {
+			return this->headDirection;
+		}
+
+		// Get the position of the snake's tail
+		template <int Width, int Height>
+		sf::Vector2i FixedFieldGame<Width, Height>::getTailPosition() const {
+			return resolvePosition(this->snakeCells[this->tailSlot]);
+		}
+
+		// Get the position of a segment counted from the head, 0 being the head and getSnakeLength() - 1 the tail
+		template <int Width, int Height>
+		sf::Vector2i FixedFieldGame<Width, Height>::getSegmentPosition(int segmentIndex) const {
+			assert((segmentIndex >= 0) && (segmentIndex < this->snakeLength));
+			int slot = this->headSlot - segmentIndex;
+			if (slot < 0) {
+				slot += CELL_COUNT;
+			}
+			return resolvePosition(this->snakeCells[slot]);
+		}
+
+		// Get the total length of the snake
+		template <int Width, int Height>
+		int FixedFieldGame<Width, Height>::getSnakeLength() const {
+			return this->snakeLength;
+		}
+
+		// Check if the apple currently exists
+		template <int Width, int Height>
+		bool FixedFieldGame<Width, Height>::getAppleExists() const {
+			return this->appleExistsFlag;
+		}
+
+		// Get the position of the apple
+		template <int Width, int Height>
+		sf::Vector2i FixedFieldGame<Width, Height>::getApplePosition() const {
+			return resolvePosition(this->appleCell);
+		}
+
+		// Get the number of frames the game has been updated for
+		template <int Width, int Height>
+		int FixedFieldGame<Width, Height>::getFrameCount() const {
+			return this->frameCount;
+		}
+
+		// Get the number of moves the snake still grows on
+		template <int Width, int Height>
+		int FixedFieldGame<Width, Height>::getQueuedSnakeGrowth() const {
+			return this->queuedSnakeGrowth;
+		}
+
+		// Check whether the snake has filled the field
+		template <int Width, int Height>
+		bool FixedFieldGame<Width, Height>::getFieldFull() const {
+			return this->snakeLength >= INTERIOR_CELL_COUNT;
+		}
+
+		// Get the hash of the current board
+		template <int Width, int Height>
+		std::uint64_t FixedFieldGame<Width, Height>::getStateHash() const {
+			return this->stateHash;
+		}
+
+		// Update the game by one frame, following QuickGame::update step for step
+		template <int Width, int Height>
+		QuickGameUpdateResult FixedFieldGame<Width, Height>::update(const QuickGameInputRequest* input) {
+			QuickGameUpdateResult result;
+			result.snakeMovementResult = ObjectDirection::NONE;
+			result.snakeHitBarrierFlag = false;
+			result.snakeAteAppleFlag = false;
+			result.snakeGrewFlag = false;
+			result.appleSpawnedFlag = !this->appleExistsFlag;
+
+			this->spawnAppleIfMissing();
+
+			this->frameCount++;
+			this->framesSinceSnakeMoved++;
+
+			if (this->isValidMovementDirection(input->snakeMovementInput)) {
+				this->queuedSnakeInput = input->snakeMovementInput;
+			}
+
+			if (this->framesSinceSnakeMoved >= (60.0f / this->snakeSpeedTilesPerSecond)) {
+				ObjectDirection directionToMoveSnake = this->queuedSnakeInput;
+				if (directionToMoveSnake == ObjectDirection::NONE) {
+					directionToMoveSnake = this->headDirection;
+				}
+
+				int previousHeadCell = this->snakeCells[this->headSlot];
+				int newHeadCell = previousHeadCell + resolveDirectionOffset(directionToMoveSnake);
+				if (this->snakeWouldHitBarrier(newHeadCell)) {
+					result.snakeHitBarrierFlag = true;
+				} else {
+					// Growing keeps the tail where it is, a move takes it off its cell
+					if (this->queuedSnakeGrowth > 0) {
+						this->snakeLength++;
+						this->queuedSnakeGrowth--;
+						result.snakeGrewFlag = true;
+					} else {
+						int previousTailCell = this->snakeCells[this->tailSlot];
+						this->cellOccupancy[previousTailCell]--;
+						this->tailSlot = resolveNextSlot(this->tailSlot);
+						this->stateHash ^= this->resolveCellKey(ZOBRIST_BODY_TABLE, previousTailCell);
+					}
+
+					this->headSlot = resolveNextSlot(this->headSlot);
+					this->snakeCells[this->headSlot] = newHeadCell;
+					this->cellOccupancy[newHeadCell]++;
+
+					this->stateHash ^=
+						this->resolveCellKey(ZOBRIST_BODY_TABLE, newHeadCell) ^
+						this->resolveCellKey(ZOBRIST_HEAD_TABLE, previousHeadCell) ^
+						this->resolveCellKey(ZOBRIST_HEAD_TABLE, newHeadCell) ^
+						this->resolveDirectionKey(this->headDirection) ^
+						this->resolveDirectionKey(directionToMoveSnake);
+					this->headDirection = directionToMoveSnake;
+
+					result.snakeMovementResult = directionToMoveSnake;
+
+					if (newHeadCell == this->appleCell) {
+						result.snakeAteAppleFlag = true;
+						this->appleExistsFlag = false;
+						this->stateHash ^= this->resolveCellKey(ZOBRIST_APPLE_TABLE, this->appleCell);
+						this->queuedSnakeGrowth += 2;
+					}
+				}
+
+				this->framesSinceSnakeMoved = 0;
+
+				assert(this->stateHash == this->computeStateHash()); // Ensure the incremental hash matches a full rehash
+			}
+
+			return result;
+		}
+
+		// Convert a position to a cell index
+		template <int Width, int Height>
+		int FixedFieldGame<Width, Height>::resolveCellIndex(sf::Vector2i position) {
+			return (position.y * Width) + position.x;
+		}
+
+		// Convert a cell index back to a position
+		template <int Width, int Height>
+		sf::Vector2i FixedFieldGame<Width, Height>::resolvePosition(int cellIndex) {
+			return sf::Vector2i(cellIndex % Width, cellIndex / Width);
+		}
+
+		// Get how far a cell index moves for one step in a direction
+		template <int Width, int Height>
+		constexpr int FixedFieldGame<Width, Height>::resolveDirectionOffset(ObjectDirection direction) {
+			return
+				(direction == ObjectDirection::UP) ? -Width :
+				(direction == ObjectDirection::RIGHT) ? 1 :
+				(direction == ObjectDirection::DOWN) ? Width :
+				(direction == ObjectDirection::LEFT) ? -1 : 0;
+		}
+
+		// Get the slot after another in the snake's ring
+		template <int Width, int Height>
+		int FixedFieldGame<Width, Height>::resolveNextSlot(int slot) {
+			slot++;
+			return (slot == CELL_COUNT) ? 0 : slot;
+		}
+
+		// Place a new apple on a free cell when there is none, drawing from the randomizer exactly like QuickGame does
+		template <int Width, int Height>
+		void FixedFieldGame<Width, Height>::spawnAppleIfMissing() {
+			if (this->appleExistsFlag) {
+				return;
+			}
+
+			std::uniform_int_distribution<int> xPositionDistribution(1, Width - 2);
+			std::uniform_int_distribution<int> yPositionDistribution(1, Height - 2);
+
+			int cellIndex = 0;
+			bool foundFreePositionFlag = false;
+			while (!foundFreePositionFlag) {
+				int x = xPositionDistribution(this->randomizer);
+				int y = yPositionDistribution(this->randomizer);
+				cellIndex = resolveCellIndex(sf::Vector2i(x, y));
+				foundFreePositionFlag = this->cellOccupancy[cellIndex] == 0;
+			}
+
+			this->appleCell = cellIndex;
+			this->appleExistsFlag = true;
+			this->stateHash ^= this->resolveCellKey(ZOBRIST_APPLE_TABLE, cellIndex);
+		}
+
+		// Check if a direction is a valid input, anything but none or straight back
+		template <int Width, int Height>
+		bool FixedFieldGame<Width, Height>::isValidMovementDirection(ObjectDirection direction) const {
+			return (direction != ObjectDirection::NONE) && (resolveDirectionOffset(direction) != -resolveDirectionOffset(this->headDirection));
+		}
+
+		// Check if the head would hit a wall or the body, the head and tail cells do not count as body just like in Snake::bodyOccupiesPosition
+		template <int Width, int Height>
+		bool FixedFieldGame<Width, Height>::snakeWouldHitBarrier(int newHeadCell) const {
+			int bodySegmentCount = this->cellOccupancy[newHeadCell];
+			if (newHeadCell == this->snakeCells[this->headSlot]) {
+				bodySegmentCount--;
+			}
+			if (newHeadCell == this->snakeCells[this->tailSlot]) {
+				bodySegmentCount--;
+			}
+			return bodySegmentCount > 0;
+		}
+
+		// Get the key of a cell in one of the cell tables
+		template <int Width, int Height>
+		std::uint64_t FixedFieldGame<Width, Height>::resolveCellKey(int keyTable, int cellIndex) const {
+			return this->zobristKeys[(keyTable * CELL_COUNT) + cellIndex];
+		}
+
+		// Get the key of the direction the head last moved in
+		template <int Width, int Height>
+		std::uint64_t FixedFieldGame<Width, Height>::resolveDirectionKey(ObjectDirection direction) const {
+			return this->zobristKeys[(ZOBRIST_CELL_TABLE_COUNT * CELL_COUNT) + (int)direction];
+		}
+
+		// Hash the board from scratch the way QuickGame::computeStateHash does
+		template <int Width, int Height>
+		std::uint64_t FixedFieldGame<Width, Height>::computeStateHash() const {
+			int headCell = this->snakeCells[this->headSlot];
+			std::uint64_t result =
+				this->resolveCellKey(ZOBRIST_HEAD_TABLE, headCell) ^
+				this->resolveDirectionKey(this->headDirection);
+
+			int slot = this->tailSlot;
+			for (int segmentIndex = 0; segmentIndex < this->snakeLength; segmentIndex++) {
+				result ^= this->resolveCellKey(ZOBRIST_BODY_TABLE, this->snakeCells[slot]);
+				slot = resolveNextSlot(slot);
+			}
+
+			if (this->appleExistsFlag) {
+				result ^= this->resolveCellKey(ZOBRIST_APPLE_TABLE, this->appleCell);
+			}
+
+			return result;
+		}
+
+		namespace FixedFieldUtils {
+
+			// Make a game of one engine for the definition, hand it to the visitor and free it afterwards
+			template <typename Game, typename Visitor>
+			int visitNewGame(const QuickGameDefn& gameDefn, Visitor& visitor) {
+				Game* game = new Game(&gameDefn);
+				int result = visitor(*game);
+				delete game;
+				return result;
+			}
+
+			//Function to hand the visitor a game for the definition: a FixedFieldGame when one is compiled for its field size,
+			//a QuickGame otherwise. The visitor is called with the game and returns an int, so it needs an overload or template for each engine.
+			template <typename Visitor>
+			int visitGame(const QuickGameDefn& gameDefn, Visitor& visitor) {
+				sf::Vector2i fieldSize = gameDefn.fieldSize;
+				if (fieldSize == FixedFieldGame<>::getFieldSize()) {
+					return visitNewGame<FixedFieldGame<>>(gameDefn, visitor);
+				}
+				if (fieldSize == FixedFieldGame<100, 50>::getFieldSize()) {
+					return visitNewGame<FixedFieldGame<100, 50>>(gameDefn, visitor);
+				}
+				if (fieldSize == FixedFieldGame<200, 100>::getFieldSize()) {
+					return visitNewGame<FixedFieldGame<200, 100>>(gameDefn, visitor);
+				}
+				return visitNewGame<QuickGame>(gameDefn, visitor);
+			}
+
+		}
+
+	}
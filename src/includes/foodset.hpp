@@ -0,0 +1,98 @@
+//This header file defines the food set, the many foods of a many-food game kept in a dense list with an index from every cell into it.
+#include <cstdint>
+#include <SFML/System/Vector2.hpp>
+#pragma once
+
+
+
+	namespace snake {
+
+		//Enum for the kinds of food, in the order of their tiles in the food tileset.
+		typedef enum class Snake_FoodType {
+			RED_APPLE,
+			CARROT,
+			GREEN_APPLE,
+			CHILI,
+			CHERRIES,
+			PEAR,
+			ORANGE,
+			BANANA,
+		} FoodType;
+
+		const int FOOD_TYPE_COUNT = 8;
+
+		//Cells a food set keeps an index entry for, the same limit as the dense engine's grids.
+		const long long FOOD_SET_MAX_CELL_COUNT = 1LL << 22;
+
+		//Struct for one food on the field.
+		typedef struct Snake_FoodItem {
+			sf::Vector2i position;
+			FoodType foodType;
+		} FoodItem;
+
+		namespace FoodSetUtils {
+			//Function to get the number of moves a snake grows on for eating a kind of food.
+			int resolveGrowth(FoodType foodType);
+			//Function to get the top left pixel of a kind of food's tile in the food tileset.
+			sf::Vector2i resolveTilesetPosition(FoodType foodType);
+
+		}
+
+		class FoodSet;
+
+		//Up to a fixed number of foods, at most one per cell. The foods are kept packed in a list for drawing and hashing,
+		//and every cell holds the list slot of the food on it, so finding, adding and removing a food never looks at more than one slot.
+		//Removing moves the last food into the freed slot. Nothing is allocated after reset() unless the field or the capacity grows.
+		class FoodSet {
+
+		private:
+			sf::Vector2i fieldSize;
+			FoodItem* items;
+			int itemCount;
+			int capacity;
+			int itemAllocation;
+
+		private:
+			//slot of the food on every cell, -1 for none
+			int* cellSlots;
+			int cellAllocation;
+
+		private:
+			//counts every add and remove, so drawing can tell the foods have not changed since it last looked
+			std::uint64_t changeCount;
+
+		public:
+			//Constructor, nothing is allocated until the first reset().
+			FoodSet();
+
+		public:
+			~FoodSet();
+
+		public:
+			//Clear every food and hold up to capacity on a field of the given size, which must have at most FOOD_SET_MAX_CELL_COUNT cells.
+			void reset(sf::Vector2i fieldSize, int capacity);
+			//Copy another set's foods, both sets must be on the same field size with the same capacity.
+			void copyFrom(const FoodSet& other);
+
+		public:
+			//Put a food on a cell, returns false when the cell already has one or the set is full.
+			bool add(sf::Vector2i position, FoodType foodType);
+			//Take the food off a cell, returns false when there is none.
+			bool remove(sf::Vector2i position, FoodItem& item);
+
+		public:
+			bool occupiesPosition(sf::Vector2i position) const;
+			//Look up the kind of the food on a cell, returns false when there is none.
+			bool findAt(sf::Vector2i position, FoodType& foodType) const;
+			int getCount() const;
+			int getCapacity() const;
+			bool getFull() const;
+			const FoodItem& getItem(int itemIndex) const;
+			std::uint64_t getChangeCount() const;
+
+		private:
+			int resolveCellIndex(sf::Vector2i position) const;
+
+		};
+
+	}
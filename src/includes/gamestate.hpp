@@ -1,6 +1,7 @@
 //This header file defines the data structures and methods related to the Snake in the game.
-#include <vector>
-#include <SFML/Graphics.hpp>
+#include <SFML/System/Vector2.hpp>
+#include "chunkedoccupancy.hpp"
+#include "memoryarena.hpp"
 #pragma once
 
 
@@ -38,10 +39,26 @@
 			int length;
 		} SnakeStartDefn;
 
+		//Struct to hold the memory a snake works in: room for its body segments and a per-cell occupancy count for the field.
+		//Fields too large for a grid of every cell count in chunkedOccupancy instead, and cellOccupancy is nullptr.
+		typedef struct Snake_SnakeStorage {
+			SnakeSegment* bodySegments;
+			int bodyCapacity;
+			unsigned char* cellOccupancy;
+			ChunkedOccupancy* chunkedOccupancy;
+			sf::Vector2i fieldSize;
+		} SnakeStorage;
+
 		namespace SnakeUtils {
 			//Function to convert movement direction to a vector.
 			sf::Vector2i directionToVector(const ObjectDirection& direction);
 
+			//Function to carve storage for a snake that can fill the whole field from an arena.
+			SnakeStorage allocateStorage(MemoryArena& arena, sf::Vector2i fieldSize);
+
+			//Function to carve room for bodyCapacity body segments from an arena, counting occupancy in a chunked occupancy the caller owns.
+			SnakeStorage allocateChunkedStorage(MemoryArena& arena, ChunkedOccupancy& occupancy, int bodyCapacity);
+
 		}
 
 		//Represents the snake in the game
@@ -52,12 +69,33 @@
 		private:
 			//Private members for the head, body, and tail.
 			SnakeSegment head;
-			std::vector<SnakeSegment> bodyList;
+			SnakeSegment* bodyList;
+			int bodyLength;
+			int bodyCapacity;
 			SnakeSegment tail;
 
+		private:
+			//Number of snake segments on every field cell, so occupancy checks do not walk the body.
+			unsigned char* cellOccupancy;
+			ChunkedOccupancy* chunkedOccupancy;
+			sf::Vector2i fieldSize;
+
 		public:
-			//Constructor to initialize the snake with starting definitions.
-			Snake(const SnakeStartDefn& startDefn);
+			//Constructor to initialize the snake with starting definitions inside the given storage.
+			Snake(const SnakeStartDefn& startDefn, const SnakeStorage& storage);
+
+		public:
+			//Put the snake back to its starting state inside the given storage.
+			void reset(const SnakeStartDefn& startDefn, const SnakeStorage& storage);
+
+		public:
+			//Copy another snake's segments and occupancy into this snake's own storage, both must be on the same field size.
+			void copyFrom(const Snake& other);
+			//Lay the snake out again from its head position and the direction every segment but the tail was entered from, head first, stored
+			//one byte each. The rest follows, since a segment always leaves toward the one in front of it the way that one was entered.
+			//Returns false when there is no body segment, which moving needs, or the segments would leave the field or outgrow the storage,
+			//the snake has to be reset before it is used again then.
+			bool restore(sf::Vector2i headPosition, const unsigned char* enterDirections, int bodyLength);
 
 		public:
 			SnakeSegment getHead() const;
@@ -65,6 +103,8 @@
 			SnakeSegment getBody(int segmentIndex) const;
 			SnakeSegment getTail() const;
 			int getLength() const;
+			//Whether the body has room for another segment, always true unless the storage holds less than the whole field.
+			bool canGrow() const;
 
 		public:
 			//Methods to get segments of the snake and check if certain positions are occupied.
@@ -82,6 +122,12 @@
 			void moveBodyForward();
 			void moveTailForward();
 
+		private:
+			int resolveCellIndex(sf::Vector2i position) const;
+			int resolveCellCount(sf::Vector2i position) const;
+			void occupyCell(sf::Vector2i position);
+			void vacateCell(sf::Vector2i position);
+
 		private:
 			void assertContiguous();
 
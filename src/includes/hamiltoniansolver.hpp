@@ -0,0 +1,74 @@
+//This header file defines the Hamiltonian cycle solver, which fills the field by following a cycle through every cell and cutting across it towards the apple when that is safe.
+#include <SFML/System/Vector2.hpp>
+#include "quickgame.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		class HamiltonianSolver;
+
+		//Plays a quick game perfectly. The cycle is built or loaded once per field size, after that every frame looks at the four cells around the head only.
+		//Cycle indices increase from the tail to the head along the snake's body, a shortcut jumps the head further along the cycle but never past the apple
+		//or close enough to the tail that the growth still to come could catch it up.
+		class HamiltonianSolver {
+
+		private:
+			sf::Vector2i fieldSize;
+			int cycleLength;
+
+		private:
+			//position of every cell along the cycle, -1 for walls
+			int* cycleIndex;
+			//direction from every cell to the next one along the cycle
+			ObjectDirection* cycleDirection;
+
+		private:
+			bool shortcutsFlag;
+
+		private:
+			//whether the snake's body lies in cycle order, checked every frame until it does and then trusted for the rest of the game
+			bool alignedFlag;
+			int lastFrameCount;
+
+		public:
+			//Constructor, with shortcutsFlag false the snake only ever follows the cycle.
+			HamiltonianSolver(bool shortcutsFlag);
+
+		public:
+			~HamiltonianSolver();
+
+		public:
+			//Check whether the interior of a field has a Hamiltonian cycle, which needs one of its sides to be even.
+			static bool hasCycle(sf::Vector2i fieldSize);
+
+		public:
+			//Load the cycle for a field size from the cache directory, building and caching it when missing. Returns false when the field has no cycle.
+			bool prepare(sf::Vector2i fieldSize, const char* cacheDirectory);
+
+		public:
+			//Choose the input for the next update of a game on the prepared field size.
+			QuickGameInputRequest resolveInput(const QuickGame& game);
+
+		public:
+			sf::Vector2i getFieldSize() const;
+			int getCycleLength() const;
+
+		private:
+			void resizeForField(sf::Vector2i fieldSize);
+			void build();
+			bool loadFromFile(const char* path);
+			bool saveToFile(const char* path) const;
+			bool resolveDirections();
+
+		private:
+			bool isAligned(const QuickGame& game) const;
+			int measureBodyClearance(const QuickGame& game, int headCycleIndex) const;
+			int resolveForwardDistance(int fromCycleIndex, int toCycleIndex) const;
+			int resolveCellIndex(sf::Vector2i position) const;
+
+		};
+
+	}
+
@@ -0,0 +1,97 @@
+//This header file defines levels, fields with obstacles compiled ahead of time into a file that is mapped into memory and used as it is.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "gamestate.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Enum for the tiles of a level's tile layer, every tile other than GRASS blocks the snake.
+		typedef enum class Snake_LevelTile {
+			GRASS,
+			SHRUB,
+			SPIKES,
+			RED_SPIKES,
+		} LevelTile;
+
+		//Layout of a compiled level, all values little endian:
+		//a LEVEL_HEADER_SIZE byte header of 32 bit words (magic, version, field size, snake start, open cell count and where the sections start),
+		//the collision bitmap of LEVEL_COLLISION_ROW_WORDS 64 bit words per row with bit x of a row set for every blocked cell,
+		//and the tile layer of one LevelTile byte per cell, row by row. The bitmap starts 8 byte aligned so it is read straight from the mapping.
+		const char LEVEL_MAGIC[4] = { 'S', 'N', 'K', 'L' };
+		const unsigned int LEVEL_VERSION = 1;
+		const int LEVEL_HEADER_SIZE = 64;
+
+		//Levels are kept to fields small enough for the dense engine, so a level's bitmap and tiles stay a few megabytes.
+		const long long LEVEL_MAX_CELL_COUNT = 1LL << 22;
+
+		class Level;
+
+		//A compiled level mapped read only into memory. Loading maps the file and checks its header, the bitmap and tiles are used where they lie.
+		//Generated levels are laid out the same way in memory the level owns instead.
+		class Level {
+
+		private:
+			//the mapping, or ownedBytes for a level built in memory
+			const unsigned char* mappedBytes;
+			std::size_t mappedByteCount;
+			bool ownedFlag;
+			//file and mapping handles on Windows, unused elsewhere
+			void* fileHandle;
+			void* mappingHandle;
+			//bytes of built levels, kept between builds so building the same size again does not allocate
+			std::vector<unsigned char> ownedBytes;
+
+		private:
+			sf::Vector2i fieldSize;
+			SnakeStartDefn snakeStartDefn;
+			int openCellCount;
+			int collisionRowWords;
+			const std::uint64_t* collisionRows;
+			const unsigned char* tiles;
+
+		public:
+			Level();
+
+		public:
+			~Level();
+
+		public:
+			//Map a compiled level, returns false when it is missing, truncated or of an unknown version. Any level mapped before is unmapped.
+			bool load(const char* path);
+			//Lay a level out in memory from its tile layer, the way LevelUtils::saveLevel writes it. Any level mapped before is unmapped.
+			bool build(sf::Vector2i fieldSize, const SnakeStartDefn& snakeStartDefn, const LevelTile* tiles);
+			void unload();
+			bool isLoaded() const;
+
+		public:
+			sf::Vector2i getFieldSize() const;
+			SnakeStartDefn getSnakeStartDefn() const;
+			//Cells inside the walls the snake can move through, a snake this long fills the level.
+			int getOpenCellCount() const;
+			//Whether a cell blocks the snake, cells outside the field always do.
+			bool isBlocked(sf::Vector2i position) const;
+			LevelTile getTile(sf::Vector2i position) const;
+			//The collision bitmap, rows of (width + 63) / 64 words one after the other.
+			const std::uint64_t* getCollisionBits() const;
+
+		private:
+			bool readHeader();
+			bool validateSnakeStart() const;
+			int countOpenCells() const;
+
+		};
+
+		namespace LevelUtils {
+			//Function to lay a level out in memory, the bytes are resized to the level.
+			void layoutLevel(sf::Vector2i fieldSize, const SnakeStartDefn& snakeStartDefn, const LevelTile* tiles, std::vector<unsigned char>& bytes);
+			//Function to write a compiled level from its tile layer, working out the collision bitmap and open cell count from the tiles.
+			bool saveLevel(const char* path, sf::Vector2i fieldSize, const SnakeStartDefn& snakeStartDefn, const LevelTile* tiles);
+
+		}
+
+	}
@@ -0,0 +1,98 @@
+//This header file defines the level generator, which lays out random obstacles for a field and keeps only layouts the snake can play through.
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+#include "quickgame.hpp"
+#include "level.hpp"
+#include "fieldbitboard.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Struct for the shape of generated levels and how long the generator may spend on one.
+		typedef struct Snake_LevelGeneratorSettings {
+			//share of the cells inside the walls covered with obstacles before any pocket is filled in
+			float obstacleFraction;
+			//share of the cells inside the walls that must be left open and connected to the snake
+			float minOpenFraction;
+			//layouts tried for one level before falling back to an open field
+			int maxAttempts;
+			//time one level may take, no further layouts are tried once it is spent
+			std::int64_t budgetMicroseconds;
+		} LevelGeneratorSettings;
+
+		//Struct for how the last level was generated.
+		typedef struct Snake_LevelGeneratorStats {
+			std::int64_t elapsedMicroseconds;
+			int attemptCount;
+			//no layout passed within the attempts or the budget, so the level is the open field
+			bool fallbackFlag;
+		} LevelGeneratorStats;
+
+		class LevelGenerator;
+		class BackgroundLevelGenerator;
+
+		//Lays out shrub walls and spikes from a seed, keeping the cells around the snake's start clear. Every layout is flood filled
+		//from the snake's head on a FieldBitboard: open cells it cannot reach are filled in, so apples only spawn where the snake can get,
+		//and layouts left with too little open area are thrown away. The same seed and game definition always give the same level.
+		class LevelGenerator {
+
+		private:
+			LevelGeneratorSettings settings;
+			LevelGeneratorStats lastStats;
+
+		private:
+			//the layout being tried and the board it is checked on, kept between levels so the same field size does not allocate
+			std::vector<LevelTile> tiles;
+			FieldBitboard bitboard;
+
+		public:
+			LevelGenerator(const LevelGeneratorSettings& settings);
+
+		public:
+			//Generate a level for a game definition's field size and snake start. The field must be at least 8x8 and hold at most LEVEL_MAX_CELL_COUNT cells.
+			void generate(const QuickGameDefn& gameDefn, unsigned int seed, Level& level);
+			LevelGeneratorStats getLastStats() const;
+
+		public:
+			static LevelGeneratorSettings resolveDefaultSettings();
+
+		private:
+			void layOutObstacles(const QuickGameDefn& gameDefn, std::mt19937& randomizer);
+			void layOutOpenField(sf::Vector2i fieldSize);
+			void setObstacle(const QuickGameDefn& gameDefn, sf::Vector2i position, LevelTile tile, int& obstacleCount);
+			bool validate(const QuickGameDefn& gameDefn, Level& level);
+
+		};
+
+		//Runs a LevelGenerator on a worker thread one level ahead of the game. Levels alternate between two slots,
+		//so the level a game is played on is left alone while the next one is generated into the other slot.
+		class BackgroundLevelGenerator {
+
+		private:
+			LevelGenerator generator;
+			Level levels[2];
+			//slot the requested level is generated into
+			int nextLevelIndex;
+			std::thread thread;
+			bool requestedFlag;
+
+		public:
+			BackgroundLevelGenerator(const LevelGeneratorSettings& settings);
+
+		public:
+			//Waits for the level being generated.
+			~BackgroundLevelGenerator();
+
+		public:
+			//Start generating the next level. The level handed out by the previous take() stays valid until the take() after this one.
+			void request(const QuickGameDefn& gameDefn, unsigned int seed);
+			//Wait for the requested level and hand it out, along with how it was generated.
+			const Level* take(LevelGeneratorStats& stats);
+
+		};
+
+	}
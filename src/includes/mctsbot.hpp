@@ -0,0 +1,147 @@
+//This header file defines the Monte Carlo tree search bot, which plays a quick game by sampling many futures of the current board in parallel.
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <SFML/System/Vector2.hpp>
+#include "quickgame.hpp"
+#include "workstealingpool.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Enum for the strength the bot plays at, harder tiers search longer on more threads.
+		typedef enum class Snake_MctsDifficulty {
+			EASY,
+			NORMAL,
+			HARD,
+		} MctsDifficulty;
+
+		//Struct for how the bot searches.
+		typedef struct Snake_MctsBotSettings {
+			int workerCount;
+			//wall clock time each search may take, one search is made every time the board changes
+			std::int64_t moveBudgetMicroseconds;
+			//most tree nodes one search can create, the tree stops growing when they run out
+			int nodeCapacity;
+			//moves a random playout looks ahead of the tree
+			int rolloutDepth;
+			//UCT exploration constant
+			float exploration;
+		} MctsBotSettings;
+
+		//Struct for one node of the search tree. Nodes are shared by every worker, so all their fields are atomics and no node is ever locked.
+		typedef struct Snake_MctsNode {
+			std::atomic<int> visitCount;
+			//searches that are still below this node, each counts as a visit that lost until it finishes
+			std::atomic<int> virtualLoss;
+			//sum of the rewards of every visit, in fixed point
+			std::atomic<std::int64_t> totalReward;
+			//node index reached by moving UP, RIGHT, DOWN and LEFT, -1 while not expanded
+			std::atomic<int> children[4];
+		} MctsNode;
+
+		//Struct for the scratch state of one worker, every rollout reuses it so the search never allocates.
+		//Aligned to a cache line so workers counting their rollouts do not invalidate each other's lines.
+		typedef struct alignas(64) Snake_MctsWorker {
+			QuickGame* game;
+			std::minstd_rand randomizer;
+			int* pathNodes;
+			long long rolloutCount;
+			long long rolloutMoveCount;
+		} MctsWorker;
+
+		//Struct to hold what the bot's searches did since the stats were last reset.
+		typedef struct Snake_MctsBotStats {
+			int searchCount;
+			long long rolloutCount;
+			long long rolloutMoveCount;
+			long long stolenTaskCount;
+			long long taskCount;
+			int maxNodesUsed;
+			double searchSeconds;
+		} MctsBotStats;
+
+		class MctsBot;
+
+		//Chooses the snake's input every frame. Each search plays the board forward from the tree's root on every worker at once,
+		//with apple spawns sampled from a fresh seed per playout, so the tree's statistics average over the futures the apples could bring.
+		//Workers share one tree through atomic counters, and virtual loss steers them apart while their playouts are still running.
+		class MctsBot : public WorkStealingJob {
+
+		private:
+			MctsBotSettings settings;
+			WorkStealingPool* pool;
+
+		private:
+			sf::Vector2i fieldSize;
+			MctsWorker* workers;
+
+		private:
+			MctsNode* nodes;
+			std::atomic<int> nodeCount;
+
+		private:
+			//board the current search starts from and when it has to stop
+			const QuickGame* rootGame;
+			std::chrono::steady_clock::time_point deadline;
+
+		private:
+			//board the last search was made for, the chosen direction is held until the board changes
+			bool trackingFlag;
+			int lastFrameCount;
+			std::uint64_t lastStateHash;
+			ObjectDirection plannedDirection;
+
+		private:
+			MctsBotStats stats;
+
+		public:
+			//Constructor, the worker threads start here and wait for the first search.
+			MctsBot(const MctsBotSettings& settings);
+
+		public:
+			~MctsBot();
+
+		public:
+			//Get the settings of a difficulty tier for this machine.
+			static MctsBotSettings resolveDifficultySettings(MctsDifficulty difficulty);
+
+		public:
+			//Choose the input for the next update of the game.
+			QuickGameInputRequest resolveInput(const QuickGame& game);
+
+		public:
+			//Search from a board for the move budget and return the most visited move, for tools that drive the bot directly.
+			ObjectDirection search(const QuickGame& game);
+
+		public:
+			const MctsBotSettings& getSettings() const;
+			const MctsBotStats& getStats() const;
+			void resetStats();
+
+		public:
+			void runTask(WorkStealingPool& pool, int workerIndex, int taskArgument) override;
+
+		private:
+			void resizeForField(sf::Vector2i fieldSize);
+			void resetNode(int nodeIndex);
+
+		private:
+			void runPlayout(MctsWorker& worker);
+			int selectChild(MctsWorker& worker, int nodeIndex, ObjectDirection* direction);
+			float runRollout(MctsWorker& worker, int movesPlayed, float appleScore);
+			ObjectDirection resolveRolloutDirection(MctsWorker& worker);
+			float resolveReward(const QuickGame& game, bool diedFlag, int movesSurvived, float appleScore) const;
+
+		private:
+			static QuickGameUpdateResult playMove(QuickGame& game, ObjectDirection direction);
+			static bool isLethal(const QuickGame& game, ObjectDirection direction);
+			static ObjectDirection resolveFallbackDirection(const QuickGame& game);
+
+		};
+
+	}
+
@@ -0,0 +1,53 @@
+//This header file defines the bump allocator that per-game memory is drawn from.
+#include <cstddef>
+#include <new>
+#pragma once
+
+
+
+	namespace snake {
+
+		class MemoryArena;
+
+		//Bump allocator over one block of memory, everything in it is released at once by reset().
+		class MemoryArena {
+
+		private:
+			unsigned char* memory;
+			std::size_t capacity;
+			std::size_t usedBytes;
+
+		public:
+			//Constructor allocating the backing block.
+			MemoryArena(std::size_t capacity);
+
+		public:
+			~MemoryArena();
+
+		private:
+			MemoryArena(const MemoryArena&);
+			MemoryArena& operator=(const MemoryArena&);
+
+		public:
+			//Carve an aligned block from the arena, throws when the arena is exhausted.
+			void* allocate(std::size_t size, std::size_t alignment);
+			//Release everything carved from the arena in one step.
+			void reset();
+			//Reset the arena and make sure the backing block holds at least capacity bytes.
+			void resetWithCapacity(std::size_t capacity);
+
+		public:
+			std::size_t getCapacity() const;
+			std::size_t getUsedBytes() const;
+
+		public:
+			//Carve an uninitialized array of count objects of type T.
+			template <typename T>
+			T* allocateArray(std::size_t count) {
+				return (T*)this->allocate(sizeof(T) * count, alignof(T));
+			}
+
+		};
+
+	}
+
@@ -0,0 +1,106 @@
+//This header file defines the arena client, which joins a NetServer, steers one player snake and keeps an ArenaReplica of the server's arena.
+#include <chrono>
+#include <cstdint>
+#include <SFML/Network.hpp>
+#include "arenareplica.hpp"
+#include "netprotocol.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Struct for what a client has received so far.
+		typedef struct Snake_NetClientStats {
+			long long receivedBytes;
+			long long receivedDatagramCount;
+			int appliedTickCount;
+			int keyframeCount;
+			//keyframes asked for after a tick went missing or the replica stopped matching
+			int resyncCount;
+			int hashCheckCount;
+			int hashMismatchCount;
+		} NetClientStats;
+
+		class NetClient;
+
+		//Client of a NetServer. It says hello until it is welcomed, then takes the keyframe that follows and applies every tick's delta
+		//in order, checking its replica against the hash the deltas carry now and then. A tick that goes missing or a hash that does not
+		//match makes it ask for a keyframe and ignore deltas until that keyframe is in. poll() never blocks, so it fits in a game loop.
+		class NetClient {
+
+		private:
+			sf::UdpSocket socket;
+			sf::IpAddress serverAddress;
+			unsigned short serverPort;
+
+		private:
+			ArenaReplica* replica;
+			int snakeIndex;
+			//tick the replica is at
+			int appliedTick;
+			bool welcomedFlag;
+			bool syncedFlag;
+			bool closedFlag;
+
+		private:
+			//parts of the delta or keyframe being put together, NET_MAX_DATAGRAM_SIZE bytes each
+			unsigned char* partBytes;
+			int* partSizes;
+			int partCapacity;
+			NetMessageType pendingType;
+			int pendingTick;
+			int pendingPartCount;
+			int receivedPartCount;
+			unsigned char* receiveBytes;
+
+		private:
+			//when the last hello or resync went out, repeated until it is answered, and the tick the replica was at when anything last went out
+			std::chrono::steady_clock::time_point requestTime;
+			int sendTick;
+			NetClientStats stats;
+
+		public:
+			//Constructor, nothing is sent until connect().
+			NetClient();
+
+		public:
+			~NetClient();
+
+		public:
+			//Bind any free port and say hello to a server, returns false when no port could be bound.
+			bool connect(const sf::IpAddress& address, unsigned short port);
+			//Read every datagram waiting and apply the ticks they complete, returns how many ticks were applied.
+			int poll();
+			//Ask the server to turn the client's snake.
+			void sendInput(ObjectDirection direction);
+			//Tell the server the client is leaving.
+			void disconnect();
+
+		public:
+			//Check whether the server answered the hello, the replica exists from then on.
+			bool isWelcomed() const;
+			//Check whether the replica is at a tick the server sent, rather than waiting on a keyframe.
+			bool isSynced() const;
+			//Check whether the server turned the client away or shut down.
+			bool isClosed() const;
+			int getSnakeIndex() const;
+			int getAppliedTick() const;
+			const ArenaReplica& getReplica() const;
+			const NetClientStats& getStats() const;
+
+		private:
+			void handleMessage(NetMessageType messageType, const unsigned char* bytes, int size);
+			void handleWelcome(const unsigned char* bytes, int size);
+			void handlePart(NetMessageType messageType, const unsigned char* bytes, int size);
+			void requestKeyframe();
+			void sendMessage(const unsigned char* bytes, int size);
+
+		private:
+			bool applyDelta();
+			bool applyKeyframe();
+			bool checkHash();
+
+		};
+
+	}
@@ -0,0 +1,105 @@
+//This header file defines the datagrams the arena server and its clients exchange over UDP, and the helpers both sides write and read them with.
+#include <cstdint>
+#include "gamestate.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Every datagram starts with the magic and its message type, all values little endian.
+		const unsigned char NET_MAGIC[2] = { 'S', 'N' };
+		const int NET_HEADER_SIZE = 3;
+		//Protocol version a client says hello with, the server turns away clients on any other.
+		const unsigned int NET_PROTOCOL_VERSION = 1;
+		//Largest datagram either side sends, small enough to cross a LAN without being fragmented.
+		const int NET_MAX_DATAGRAM_SIZE = 1200;
+		const unsigned short NET_DEFAULT_PORT = 47000;
+
+		//Enum for the message types.
+		typedef enum class Snake_NetMessageType {
+			//client to server: join, carrying the protocol version
+			HELLO,
+			//server to client: the player snake the client steers and the arena's shape, a keyframe follows
+			WELCOME,
+			//server to client: every player snake is taken
+			SERVER_FULL,
+			//client to server: the direction the client's snake turns to
+			INPUT,
+			//client to server: the client lost a tick and wants a keyframe
+			RESYNC,
+			//either way: leave, sent by a client that quits and by a server shutting down
+			BYE,
+			//server to client, one part of a tick's changes
+			DELTA,
+			//server to client, one part of the whole arena
+			KEYFRAME,
+		} NetMessageType;
+
+		//Sizes of the messages that are not split into parts: hello carries the protocol version, welcome the player snake's index,
+		//the field's width and height, snake count, maximum snake length, apple count and the tick the keyframe after it is from,
+		//and input the direction, with NONE only telling the server the client is still there. The rest are the header alone.
+		const int NET_HELLO_SIZE = NET_HEADER_SIZE + 4;
+		const int NET_WELCOME_SIZE = NET_HEADER_SIZE + 2 + 24;
+		const int NET_INPUT_SIZE = NET_HEADER_SIZE + 1;
+		//Ticks a client goes at most without sending anything, a server drops clients that stay quiet for well over this.
+		const int NET_KEEPALIVE_TICKS = 20;
+
+		//Header of the parts of a delta or keyframe after the common header: tick, part index, part count and a flag,
+		//followed by the arena's state hash when the flag is set.
+		const int NET_PART_HEADER_SIZE = NET_HEADER_SIZE + 9;
+		const int NET_PART_HASH_SIZE = 8;
+
+		//Records of a tick, each starting with a byte holding the kind in its low two bits and for snakes the direction they face in the next two.
+		//A delta lists deaths, then moves, then spawns and then apples, in snake index order within each kind:
+		//died is followed by the snake index, spawned by the snake index, head cell and length of a snake laid out straight behind its head,
+		//and apple by the cell of a new apple. Every snake that lived through the tick moved, so moves go as runs over the snakes still alive
+		//once the deaths are applied: the first snake index and how many live snakes the run covers, then a nibble for each of them with the
+		//direction the head moved in and NET_MOVE_TAIL_FLAG set when the tail moved too, low nibble first.
+		//Eaten apples are not sent, a head moving onto an apple eats it on the client just like on the server.
+		//A keyframe holds a snake record for every live snake, with its body as one two bit step per segment from the head back, and an apple record for every apple.
+		const int NET_RECORD_DIED = 0;
+		const int NET_RECORD_MOVED = 1;
+		const int NET_RECORD_SPAWNED = 2;
+		const int NET_RECORD_SNAKE = 2;
+		const int NET_RECORD_APPLE = 3;
+		const int NET_MOVE_TAIL_FLAG = 0x4;
+		const int NET_MOVED_RUN_HEADER_SIZE = 5;
+		const int NET_DIED_RECORD_SIZE = 3;
+		const int NET_SPAWNED_RECORD_SIZE = 9;
+		const int NET_APPLE_RECORD_SIZE = 5;
+
+		//Struct for the shape of the arena a client mirrors, sent with the welcome.
+		typedef struct Snake_NetArenaShape {
+			sf::Vector2i fieldSize;
+			int snakeCount;
+			int snakeMaxLength;
+			int appleCount;
+		} NetArenaShape;
+
+		namespace NetUtils {
+			//Functions to write and read little endian values.
+			void writeUint16(unsigned char* bytes, unsigned int value);
+			void writeUint32(unsigned char* bytes, std::uint32_t value);
+			void writeUint64(unsigned char* bytes, std::uint64_t value);
+			unsigned int readUint16(const unsigned char* bytes);
+			std::uint32_t readUint32(const unsigned char* bytes);
+			std::uint64_t readUint64(const unsigned char* bytes);
+
+			//Function to write the common header, returns its size.
+			int writeHeader(unsigned char* bytes, NetMessageType messageType);
+			//Function to check a datagram's common header and get its message type, returns false for anything else.
+			bool readHeader(const unsigned char* bytes, int size, NetMessageType& messageType);
+
+			//Functions to pack a direction into the two bits records carry it in, and back.
+			int encodeDirection(ObjectDirection direction);
+			ObjectDirection decodeDirection(int directionBits);
+
+			//Function to get the size of a keyframe snake record for a snake of the given length.
+			int resolveSnakeRecordSize(int length);
+			//Function to get how many parts a delta or keyframe of an arena of this shape can take at most, so both sides allocate once.
+			int resolveMaxPartCount(const NetArenaShape& shape);
+
+		}
+
+	}
@@ -0,0 +1,119 @@
+//This header file defines the arena server, which plays an ArenaGame with one player snake for each connected client and sends every tick's changes over UDP.
+#include <cstdint>
+#include <SFML/Network.hpp>
+#include "arenagame.hpp"
+#include "netprotocol.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Struct for how a server is set up.
+		typedef struct Snake_NetServerSettings {
+			//port to listen on, 0 for any free port
+			unsigned short port;
+			//the arena played, its player snakes are the clients' and every other snake is a bot
+			ArenaGameDefn arenaDefn;
+			//ticks between deltas that carry the arena's state hash for clients to check their replica against
+			int hashIntervalTicks;
+			//ticks a client may go without sending anything before its snake is handed back
+			int clientTimeoutTicks;
+		} NetServerSettings;
+
+		//Struct for what one server tick did.
+		typedef struct Snake_NetServerTickStats {
+			int tick;
+			int clientCount;
+			//bytes of the tick's delta, datagram headers included, that every client was sent
+			int deltaBytes;
+			int deltaPartCount;
+			//bytes sent to every client together, keyframes included
+			long long sentBytes;
+			int keyframeCount;
+			double simulationSeconds;
+			double tickSeconds;
+		} NetServerTickStats;
+
+		//Struct for one client, its slot is the index of the player snake it steers.
+		typedef struct Snake_NetServerClient {
+			bool connectedFlag;
+			bool keyframeRequestedFlag;
+			sf::IpAddress address;
+			unsigned short port;
+			int lastHeardTick;
+		} NetServerClient;
+
+		class NetServer;
+
+		//Authoritative server for an arena. Each tick it reads every datagram waiting, sends keyframes to clients that joined or lost track,
+		//advances the arena and sends the tick's delta: the snakes that died, moved or spawned and the apples that appeared, worked out from
+		//each snake's ring slots rather than from the cells, so a tick costs the same to describe however large the field. The delta is
+		//encoded once and the same datagrams go to every client. Every buffer is allocated when the server is made.
+		class NetServer {
+
+		private:
+			NetServerSettings settings;
+			NetArenaShape shape;
+			ArenaGame* arena;
+			sf::UdpSocket socket;
+
+		private:
+			NetServerClient* clients;
+			int clientCount;
+
+		private:
+			//each snake as the clients last saw it, to tell which snakes moved their tail, died or spawned
+			bool* publishedAliveFlags;
+			int* publishedTailSlots;
+
+		private:
+			//the datagrams of the delta or keyframe being sent, NET_MAX_DATAGRAM_SIZE bytes each
+			unsigned char* partBytes;
+			int* partSizes;
+			int partCount;
+			int partCapacity;
+			unsigned char* receiveBytes;
+
+		public:
+			//Constructor, makes the arena. Nothing is received until start() binds the socket.
+			NetServer(const NetServerSettings& settings);
+
+		public:
+			~NetServer();
+
+		public:
+			//Bind the socket, returns false when the port is taken.
+			bool start();
+			//Read the clients' datagrams, advance the arena one move and send the changes.
+			NetServerTickStats tick();
+			//Tell every client the server is going and stop listening.
+			void stop();
+
+		public:
+			const ArenaGame& getArena() const;
+			unsigned short getPort() const;
+			int getClientCount() const;
+
+		private:
+			void receiveMessages();
+			void handleMessage(NetMessageType messageType, const unsigned char* bytes, int size, const sf::IpAddress& address, unsigned short port);
+			int findClient(const sf::IpAddress& address, unsigned short port) const;
+			void dropIdleClients();
+			void sendKeyframes(NetServerTickStats& stats);
+			long long sendParts(int clientIndex);
+			void sendMessage(int clientIndex, const unsigned char* bytes, int size);
+
+		private:
+			void beginParts(NetMessageType messageType, int tick, bool hashFlag, std::uint64_t stateHash);
+			void startPart();
+			int resolvePartRoom() const;
+			unsigned char* reserveRecord(int recordSize);
+			void finishParts();
+			void encodeKeyframe();
+			void encodeDelta();
+			void publishSnakes();
+
+		};
+
+	}
@@ -0,0 +1,118 @@
+//This header file defines the neuroevolution trainer, which evolves small neural network policies that play quick games.
+#include <random>
+#include <SFML/System/Vector2.hpp>
+#include "quickgame.hpp"
+#include "workstealingpool.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Shape of every policy network: inputs seen from the snake's head, one tanh hidden layer, and a score each for going straight, left and right.
+		const int NEURAL_POLICY_INPUT_COUNT = 5;
+		const int NEURAL_POLICY_HIDDEN_COUNT = 12;
+		const int NEURAL_POLICY_OUTPUT_COUNT = 3;
+		//Weights of one network, every layer has a bias weight per neuron after its input weights.
+		const int NEURAL_POLICY_WEIGHT_COUNT =
+			((NEURAL_POLICY_INPUT_COUNT + 1) * NEURAL_POLICY_HIDDEN_COUNT) +
+			((NEURAL_POLICY_HIDDEN_COUNT + 1) * NEURAL_POLICY_OUTPUT_COUNT);
+
+		namespace NeuralPolicy {
+			//Function to fill the inputs for a game: the nearness of the first obstacle ahead, left and right, then the unit vector towards the apple, its parts ahead and to the right.
+			void resolveInputs(const QuickGame& game, float* inputs);
+
+			//Function to run a network on a game and return the direction it chooses, without allocating.
+			ObjectDirection resolveDirection(const float* weights, const QuickGame& game);
+
+		}
+
+		//Struct for how a population is evolved.
+		typedef struct Snake_NeuroEvolutionSettings {
+			int populationSize;
+			//games every genome plays each generation, every genome plays the same seeds
+			int gamesPerGenome;
+			//best genomes copied into the next generation unchanged
+			int eliteCount;
+			//chance each weight of a child is mutated, and the standard deviation of the mutation
+			float mutationRate;
+			float mutationStrength;
+			sf::Vector2i fieldSize;
+			//every random choice is derived from this seed and the generation, so runs repeat exactly whatever the worker count
+			unsigned int seed;
+			int workerCount;
+		} NeuroEvolutionSettings;
+
+		//Struct to hold how one generation did.
+		typedef struct Snake_NeuroGenerationStats {
+			int generation;
+			float bestFitness;
+			float meanFitness;
+			float bestMeanApples;
+			double evaluationSeconds;
+		} NeuroGenerationStats;
+
+		//Struct for the scratch state of one worker, reused for every game so evaluation never allocates.
+		typedef struct Snake_NeuroWorker {
+			QuickGame* game;
+		} NeuroWorker;
+
+		class NeuroEvolution;
+
+		//Evolves a population of fixed topology networks. Each generation every genome plays its games on the worker pool,
+		//then the elite are kept and the rest of the next generation is bred from tournaments between them all.
+		class NeuroEvolution : public WorkStealingJob {
+
+		private:
+			NeuroEvolutionSettings settings;
+			WorkStealingPool* pool;
+			NeuroWorker* workers;
+			QuickGameDefn gameDefn;
+
+		private:
+			//populationSize genomes of NEURAL_POLICY_WEIGHT_COUNT weights, and the generation being bred into
+			float* genomes;
+			float* nextGenomes;
+			float* fitness;
+			float* meanApples;
+			int* rankedGenomes;
+			int generation;
+
+		public:
+			//Constructor, starts from a random population at generation 0.
+			NeuroEvolution(const NeuroEvolutionSettings& settings);
+
+		public:
+			~NeuroEvolution();
+
+		public:
+			//Play every genome's games, then breed the next generation. Returns how the evaluated generation did.
+			NeuroGenerationStats runGeneration();
+
+		public:
+			//Save the population that plays next, ranked best first after the first generation. Returns false when the file cannot be written.
+			bool saveCheckpoint(const char* path) const;
+			//Load a population saved with the same population size and seed. Returns false and keeps the current population otherwise.
+			bool loadCheckpoint(const char* path);
+
+		public:
+			int getGeneration() const;
+			const float* getGenome(int genomeIndex) const;
+			const NeuroEvolutionSettings& getSettings() const;
+
+		public:
+			void runTask(WorkStealingPool& pool, int workerIndex, int taskArgument) override;
+
+		private:
+			void initializePopulation();
+			void breed();
+			int selectParent(std::mt19937& randomizer) const;
+
+		private:
+			float playGame(NeuroWorker& worker, const float* weights, unsigned int randomSeed, int* applesEaten);
+			unsigned int resolveGameSeed(int gameIndex) const;
+
+		};
+
+	}
+
@@ -0,0 +1,78 @@
+//This header file defines the occupancy pyramid, snake segment counts of a field summed over ever larger blocks of cells for drawing overviews of it.
+#include <SFML/System/Vector2.hpp>
+#include "quickgame.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Most levels a pyramid holds, enough to sum a 100000x100000 field up to a single block.
+		const int OCCUPANCY_PYRAMID_MAX_LEVELS = 24;
+
+		class OccupancyPyramid;
+
+		//Mip-style levels of segment counts. The finest level sums blocks of 2^baseShift cells on a side, picked so it has at most
+		//maxBaseSize blocks along each side however large the field is, and every level above sums 2x2 blocks of the one below up to a single block.
+		//The pyramid follows a game through sync(), which only adds to the blocks over the cells the snake moved into or out of since the last
+		//sync, so keeping it current costs the same on any field size.
+		class OccupancyPyramid {
+
+		private:
+			sf::Vector2i fieldSize;
+			int maxBaseSize;
+			int baseShift;
+			int levelCount;
+			sf::Vector2i levelSizes[OCCUPANCY_PYRAMID_MAX_LEVELS];
+			int levelOffsets[OCCUPANCY_PYRAMID_MAX_LEVELS];
+
+		private:
+			//segment counts of every block of every level, finest level first
+			int* segmentCounts;
+			int segmentCountCapacity;
+
+		private:
+			//blocks of the finest level changed since takeDirtyRect() last ran, as an inclusive rectangle
+			bool dirtyFlag;
+			sf::Vector2i dirtyMin;
+			sf::Vector2i dirtyMax;
+
+		private:
+			//the snake as the last sync() saw it, a sync that cannot be explained by a single move starts over from the whole snake
+			bool trackedFlag;
+			sf::Vector2i trackedHeadPosition;
+			sf::Vector2i trackedTailPosition;
+			int trackedLength;
+			int trackedFrame;
+
+		public:
+			//Constructor, sized for the default field until the first sync.
+			OccupancyPyramid(int maxBaseSize);
+
+		public:
+			~OccupancyPyramid();
+
+		public:
+			//Bring the counts up to date with the game, a single move only touches the ancestors of the cells it changed.
+			void sync(const QuickGame& game);
+			//Get the inclusive corners of the finest level blocks changed since the last call and clear them, false when nothing changed.
+			bool takeDirtyRect(sf::Vector2i& dirtyMin, sf::Vector2i& dirtyMax);
+
+		public:
+			int getLevelCount() const;
+			sf::Vector2i getLevelSize(int level) const;
+			//Cells along each side of a block of a level, as a shift.
+			int getBlockShift(int level) const;
+			int getSegmentCount(int level, sf::Vector2i block) const;
+			//Finest level with at most maxSize blocks along each side.
+			int resolveLevelForSize(sf::Vector2i maxSize) const;
+
+		private:
+			void reset(sf::Vector2i fieldSize);
+			void rebuild(const QuickGame& game);
+			void addSegments(sf::Vector2i position, int delta);
+			void markDirty(sf::Vector2i block);
+
+		};
+
+	}
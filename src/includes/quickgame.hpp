@@ -0,0 +1,183 @@
+//This header file defines the quick game simulation, which only depends on SFML's vector types so it can run headless.
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "gamestate.hpp"
+#include "foodset.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Size of the field a quick game started from the menu is played on, walls included.
+		const int QUICK_GAME_DEFAULT_FIELD_WIDTH = 50;
+		const int QUICK_GAME_DEFAULT_FIELD_HEIGHT = 25;
+
+		//Fields with more cells than this count occupancy in chunks and work out Zobrist keys as they are needed instead of keeping tables,
+		//and the snake's body is capped at QUICK_GAME_CHUNKED_BODY_CAPACITY segments rather than room to fill the field.
+		const long long QUICK_GAME_DENSE_CELL_LIMIT = 1LL << 22;
+		const int QUICK_GAME_CHUNKED_BODY_CAPACITY = 65536;
+
+		//Zobrist key tables, one key per cell in each table followed by one key per direction. Every engine hashing a board shares this layout.
+		const int ZOBRIST_BODY_TABLE = 0;
+		const int ZOBRIST_HEAD_TABLE = 1;
+		const int ZOBRIST_APPLE_TABLE = 2;
+		const int ZOBRIST_CELL_TABLE_COUNT = 3;
+		const int ZOBRIST_DIRECTION_COUNT = 5;
+
+		typedef struct Snake_QuickGameDefn {
+			sf::Vector2i fieldSize;
+			float snakeSpeedTilesPerSecond;
+			SnakeStartDefn snakeStartDefn;
+			unsigned int randomSeed;
+		} QuickGameDefn;
+
+		typedef struct Snake_QuickGameInputRequest {
+			ObjectDirection snakeMovementInput;
+		} QuickGameInputRequest;
+
+		typedef struct Snake_QuickGameUpdateResult {
+			ObjectDirection snakeMovementResult;
+			bool snakeHitBarrierFlag;
+			bool snakeAteAppleFlag;
+			bool snakeGrewFlag;
+			bool appleSpawnedFlag;
+		} QuickGameUpdateResult;
+
+		namespace QuickGameUtils {
+			//Function to fill the Zobrist keys for a field, the same keys every time so hashes stay comparable across runs and machines.
+			void fillZobristKeys(std::uint64_t* keys, sf::Vector2i fieldSize);
+			//Function to work out a single key of the tables fillZobristKeys fills, for fields too large to keep them.
+			std::uint64_t resolveZobristKey(std::uint64_t keyIndex);
+
+			//Function to check whether a field is too large for a grid of every cell and is played on chunked storage.
+			bool usesChunkedStorage(sf::Vector2i fieldSize);
+
+		}
+
+		class Level;
+		class QuickGame;
+
+		//Simulation of a single snake game, advanced one frame at a time by update().
+		class QuickGame {
+
+		private:
+			std::default_random_engine randomizer;
+
+		private:
+			//every per-game allocation is carved from this arena and released together on reset
+			MemoryArena* arena;
+
+		private:
+			sf::Vector2i fieldSize;
+			//position of the right and bottom walls, so barrier checks do not work it out every move
+			sf::Vector2i farWallPosition;
+			float snakeSpeedTilesPerSecond;
+			Snake* snake;
+			//occupancy of the snake on fields too large for a grid, nullptr until a game is played on one
+			ChunkedOccupancy* chunkedOccupancy;
+			//obstacles inside the walls, nullptr for an open field
+			const Level* level;
+			
+		private:
+			bool appleExistsFlag;
+			sf::Vector2i applePosition;
+			//foods kept on the field in place of the apple, nullptr while the game is played with a single apple
+			FoodSet* foodSet;
+
+		private:
+			int framesSinceSnakeMoved;
+			ObjectDirection queuedSnakeInput;
+			int queuedSnakeGrowth;
+
+		private:
+			//Zobrist hash of the snake's cells, its head cell and direction, and the apple, updated as they change
+			std::uint64_t stateHash;
+			//random keys for every cell as part of the body, as the head and as the apple, followed by one per direction,
+			//nullptr on chunked fields where every key is worked out when it is needed
+			std::uint64_t* zobristKeys;
+			//field size the keys were filled for, resets on the same size keep them instead of filling them again
+			sf::Vector2i zobristKeysFieldSize;
+
+		private:
+			int frameCount;
+
+		public:
+			QuickGame(const QuickGameDefn* quickGameDefn);
+
+		public:
+			~QuickGame();
+
+		public:
+			//Start a new game in place, reusing the snake and its storage.
+			void reset(const QuickGameDefn* quickGameDefn);
+
+		public:
+			//Copy another game's state into this one without allocating, for searches that play many futures from one position.
+			//Both games must be on the same field size.
+			void copyFrom(const QuickGame& other);
+			//Reseed the apple spawns, so copies of one game can sample different futures.
+			void reseedRandomizer(unsigned int randomSeed);
+			//Append everything later frames depend on to bytes, for replays to jump into the middle of a game with loadKeyframe().
+			//Only games with a single apple and no level are recorded, so neither foods nor levels are kept.
+			void saveKeyframe(std::vector<unsigned char>& bytes) const;
+			//Restore a game from saveKeyframe() bytes. The game has to be reset with the definition the keyframe's game was started with first.
+			//Returns false when the bytes are cut short, hold counters play cannot reach or do not hash to the board they were saved from,
+			//the game has to be reset again then.
+			bool loadKeyframe(const unsigned char* bytes, std::size_t byteCount);
+			//Play on a level's obstacles, nullptr for an open field. The level is kept across resets and must outlive the game,
+			//its field size must match the game's, and it has to be set before the first update() places an apple.
+			void setLevel(const Level* level);
+			//Keep foodCount foods of random kinds on the field in place of the single apple, 0 to go back to the apple. Like the level
+			//it is kept across resets and has to be set before the first update(), and only fields on dense storage can have many foods.
+			void setFoodCount(int foodCount);
+
+		public:
+			sf::Vector2i getFieldSize() const;
+			Snake* getSnake() const;
+			const Level* getLevel() const;
+			//Foods on the field, nullptr when the game is played with a single apple.
+			const FoodSet* getFoodSet() const;
+			bool getAppleExists() const;
+			sf::Vector2i getApplePosition() const;
+			int getFrameCount() const;
+			std::size_t getArenaUsedBytes() const;
+			//Number of moves the snake will still grow on, for planners looking ahead.
+			int getQueuedSnakeGrowth() const;
+			//Whether the snake covers every cell inside the walls, no apple can spawn after that so the game has to end.
+			bool getFieldFull() const;
+			//64 bit fingerprint of the board, equal boards always hash the same for the same field size.
+			std::uint64_t getStateHash() const;
+
+		public:
+			QuickGameUpdateResult update(const QuickGameInputRequest* input);
+			//Place the apple the next update() would place, when there is none, so callers can show it one frame early.
+			//With many foods every missing food is placed in one go, as far as there are free cells for them.
+			//The game plays on exactly as if update() had placed it. Must not be called on a full field. Returns whether an apple was placed.
+			bool spawnAppleIfMissing();
+
+		public:
+			//Pick a free cell for the next apple or food, public so the benchmarks can measure it at different fill ratios.
+			sf::Vector2i resolveNewApplePosition();
+
+		private:
+			static std::size_t resolveArenaSize(const QuickGameDefn* quickGameDefn);
+			static int resolveSnakeCapacity(const QuickGameDefn* quickGameDefn);
+
+		private:
+			void initZobristKeys();
+			std::uint64_t resolveCellKey(int keyTable, sf::Vector2i position) const;
+			std::uint64_t resolveDirectionKey(ObjectDirection direction) const;
+			std::uint64_t resolveFoodKey(sf::Vector2i position, FoodType foodType) const;
+			std::uint64_t computeStateHash() const;
+
+		private:
+			bool spawnMissingFood();
+			bool snakeWouldHitBarrier(ObjectDirection direction);
+
+		};
+
+	}
+
@@ -3,29 +3,21 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 #include "gamestate.hpp"
+#include "quickgame.hpp"
+#include "soundeffects.hpp"
+#include "replay.hpp"
+#include "autopilot.hpp"
+#include "hamiltoniansolver.hpp"
+#include "mctsbot.hpp"
+#include "occupancypyramid.hpp"
+#include "levelgenerator.hpp"
+#include "spectatorbroadcast.hpp"
 #pragma once
 
 
 
 	namespace snake {
 
-		typedef struct Snake_QuickGameDefn {
-			sf::Vector2i fieldSize;
-			float snakeSpeedTilesPerSecond;
-			SnakeStartDefn snakeStartDefn;
-		} QuickGameDefn;
-
-		typedef struct Snake_QuickGameInputRequest {
-			ObjectDirection snakeMovementInput;
-		} QuickGameInputRequest;
-
-		typedef struct Snake_QuickGameUpdateResult {
-			ObjectDirection snakeMovementResult;
-			bool snakeHitBarrierFlag;
-			bool snakeAteAppleFlag;
-			bool snakeGrewFlag;
-		} QuickGameUpdateResult;
-
 		typedef enum class Snake_QuickGameMode {
 			WAIT_TO_START,
 			GAME_RUNNING,
@@ -38,49 +30,31 @@
 			RETURN_TO_SPLASH_SCREEN,
 		} QuickGameSceneClientRequest;
 
-		class QuickGame;
-		class QuickGameController;
-		class QuickGameRenderer;
-
-		class QuickGame {
-
-		private:
-			std::default_random_engine randomizer;
-
-		private:
+		//Struct for the options a quick game scene is created with.
+		typedef struct Snake_QuickGameControllerOptions {
+			//directory every finished game is saved to as a replay, nullptr to not record
+			const char* replayDirectory;
+			//let the autopilot play instead of the keyboard
+			bool autopilotFlag;
+			//let the Hamiltonian cycle solver play instead of the keyboard, taking precedence over the other bots
+			bool perfectPlayFlag;
+			//let the tree search bot play at mctsDifficulty instead of the keyboard, taking precedence over the autopilot
+			bool mctsFlag;
+			MctsDifficulty mctsDifficulty;
+			//size of the field every game is played on, fields larger than the window scroll with the snake
 			sf::Vector2i fieldSize;
-			float snakeSpeedTilesPerSecond;
-			Snake* snake;
-			
-		private:
-			bool appleExistsFlag;
-			sf::Vector2i applePosition;
-
-		private:
-			int framesSinceSnakeMoved;
-			ObjectDirection queuedSnakeInput;
-			int queuedSnakeGrowth;
+			//compiled level every game is played on instead of the plain field, nullptr for the plain field
+			const char* levelPath;
+			//play every game on a new generated level, unless levelPath gives one
+			bool generatedLevelsFlag;
+			//foods kept on the field in place of the single apple, 0 for the apple
+			int foodCount;
+			//name every game is published under in shared memory for snake-spectator viewers, nullptr to not publish
+			const char* broadcastName;
+		} QuickGameControllerOptions;
 
-		public:
-			QuickGame(const QuickGameDefn* quickGameDefn);
-
-		public:
-			~QuickGame();
-
-		public:
-			sf::Vector2i getFieldSize() const;
-			Snake* getSnake() const;
-			bool getAppleExists() const;
-			sf::Vector2i getApplePosition() const;
-
-		public:
-			QuickGameUpdateResult update(const QuickGameInputRequest* input);
-
-		private:
-			sf::Vector2i resolveNewApplePosition();
-			bool snakeWouldHitBarrier(ObjectDirection direction);
-
-		};
+		class QuickGameController;
+		class QuickGameRenderer;
 
 		class QuickGameController {
 
@@ -91,14 +65,34 @@
 		private:
 			QuickGameMode mode;
 			QuickGame* game;
+			bool gameStartedFlag;
+			sf::Vector2i fieldSize;
+			//level every game is played on, nullptr when the field is plain
+			Level* level;
+			//makes a new level for every game one game ahead, nullptr when levels are not generated
+			BackgroundLevelGenerator* levelGenerator;
+			unsigned int nextLevelSeed;
+			//foods every game keeps on the field, 0 when it is played with a single apple
+			int foodCount;
+
+		private:
+			SoundEffectPool* soundEffects;
 
 		private:
-			sf::SoundBuffer* eatAppleSoundBuffer;
-			sf::SoundBuffer* hitBarrierSoundBuffer;
+			//records every game's inputs and saves them off the render thread when replays are saved, nullptr otherwise
+			BackgroundReplaySaver* replaySaver;
+			const char* replayDirectory;
 
 		private:
-			sf::Sound eatAppleSound;
-			sf::Sound hitBarrierSound;
+			//publishes every game's ticks for viewers when broadcasting, nullptr otherwise
+			SpectatorPublisher* spectatorPublisher;
+
+		private:
+			//play the game instead of the keyboard when they are on, nullptr otherwise
+			Autopilot* autopilot;
+			HamiltonianSolver* perfectPlaySolver;
+			MctsBot* mctsBot;
+			int framesSinceGameDone;
 
 		private:
 			sf::Music* gameRunningMusic;
@@ -116,7 +110,7 @@
 			ObjectDirection nextSnakeMovementInput;
 
 		public:
-			QuickGameController(sf::RenderWindow& window);
+			QuickGameController(sf::RenderWindow& window, const QuickGameControllerOptions& options);
 
 		public:
 			~QuickGameController();
@@ -126,12 +120,24 @@
 			void update();
 			void render();
 
+		public:
+			bool isGameRunning() const;
+
 		private:
 			QuickGameSceneClientRequest processWaitToStartKeyEvent(sf::Event& event);
 			QuickGameSceneClientRequest processGameRunningKeyEvent(sf::Event& event);
 
 		private:
+			QuickGameDefn resolveGameDefn() const;
 			void startGame();
+			void beginGame();
+			void finishGame();
+			void saveReplay();
+			void finishReplaySave();
+			void reportSoundEffectStats();
+			void reportAutopilotStats();
+			void reportMctsStats();
+			void publishSpectatorPhase();
 
 		private:
 			void ensureGameRunningMusicLoaded();
@@ -141,6 +147,9 @@
 			void ensureGameDoneSummaryMusicLoaded();
 			void freeGameDoneSummaryMusic();
 
+		private:
+			void stopAllMusic();
+
 		private:
 			void beginWaitToStartMusic();
 			void beginGameRunningMusic();
@@ -148,6 +157,17 @@
 
 		};
 
+		namespace QuickGameRendererUtils {
+			//Functions to point a sprite at the right tile of a tileset.
+			void initSprite(sf::Sprite& sprite, const sf::Texture& sourceTexture, int pixelLeft, int pixelTop);
+			//Function to add a tile to a batch as a quad of four vertices.
+			void appendTileQuad(sf::Vertex* vertices, int& vertexCount, sf::Vector2f position, int pixelLeft, int pixelTop);
+			void initSnakeHeadSprite(sf::Sprite& sprite, const sf::Texture& sourceTexture, ObjectDirection direction);
+			void initSnakeTailSprite(sf::Sprite& sprite, const sf::Texture& sourceTexture, ObjectDirection direction);
+			void initSnakeBodySprite(sf::Sprite& sprite, const sf::Texture& sourceTexture, ObjectDirection enterDirection, ObjectDirection exitDirection);
+
+		}
+
 		typedef struct Snake_QuickGameRenderState {
 			const QuickGame* game;
 			int longestSnake;
@@ -160,18 +180,70 @@
 			sf::Font* uiFont;
 			sf::Texture* snakeTilesetTexture;
 			sf::Texture* foodTilesetTexture;
+			sf::Texture* dangerTilesetTexture;
 
 		private:
 			sf::Text snakeLengthText;
 			sf::Text longestSnakeText;
 			sf::Text startInstructionsText;
 			sf::Text exitInstructionsText;
+			sf::Text gameWonText;
+
+		private:
+			//score strings are rebuilt in place and only pushed to the texts when the values change
+			sf::String snakeLengthString;
+			sf::String longestSnakeString;
+			int displayedSnakeLength;
+			int displayedLongestSnake;
+
+		private:
+			//field the playing field is drawn for, kept from the last game so the waiting screen matches it
+			sf::Vector2i fieldSize;
+			//field tile drawn at the top left of the viewport, fields larger than the viewport scroll to keep the head in view
+			sf::Vector2i cameraPosition;
+			//level the playing field is drawn for, kept from the last game like the field size, nullptr for a plain field
+			const Level* level;
+
+		private:
+			//the tiles in view as quads, one batch per tileset, drawn with a single call each and only rebuilt when the camera, field or level changes
+			sf::Vertex* fieldVertices;
+			int fieldVertexCount;
+			sf::Vertex* dangerVertices;
+			int dangerVertexCount;
+			bool fieldBatchBuiltFlag;
+			sf::Vector2i fieldBatchCameraPosition;
+			sf::Vector2i fieldBatchFieldSize;
+			const Level* fieldBatchLevel;
+
+		private:
+			//the foods in view of a many-food game as quads, drawn with a single call and only rebuilt when the foods or the camera change
+			sf::Vertex* foodVertices;
+			int foodVertexCount;
+			const FoodSet* foodBatchFoodSet;
+			std::uint64_t foodBatchChangeCount;
+			sf::Vector2i foodBatchCameraPosition;
+
+		private:
+			//overview of fields larger than the viewport, drawn from the level of the pyramid that fits the minimap
+			//into a texture of one pixel per block, where only the blocks that changed are uploaded again
+			OccupancyPyramid* minimapPyramid;
+			sf::Texture* minimapTexture;
+			sf::Uint8* minimapPixels;
+			sf::Vector2i minimapTextureSize;
+			int minimapLevel;
+			sf::Sprite minimapSprite;
+			sf::RectangleShape minimapFrame;
+			sf::RectangleShape minimapCameraFrame;
+			sf::RectangleShape minimapAppleMarker;
 
 		private:
-			sf::Sprite grassSprite;
-			sf::Sprite shrubSprite;
 			sf::Sprite appleSprite;
 
+		private:
+			sf::Sprite snakeHeadSprite;
+			sf::Sprite snakeTailSprite;
+			sf::Sprite snakeBodySprite;
+
 		public:
 			QuickGameRenderer();
 
@@ -184,16 +256,25 @@
 			void renderGameDoneSummary(sf::RenderTarget& renderTarget, const QuickGameRenderState& gameRenderState);
 
 		private:
-			void renderPlayingField(sf::RenderTarget& renderTarget);
+			void renderPlayingField(sf::RenderTarget& renderTarget, const QuickGame* game);
 			void renderApple(sf::RenderTarget& renderTarget, const QuickGame& game);
 			void renderSnake(sf::RenderTarget& renderTarget, const QuickGame& game);
 			void renderScoreUi(sf::RenderTarget& renderTarget, const QuickGameRenderState& gameRenderState);
 			void renderLongestSnakeUi(sf::RenderTarget& renderTarget);
+			void renderMinimap(sf::RenderTarget& renderTarget, const QuickGame& game);
+
+		private:
+			void updateCamera(const QuickGame& game);
+			void buildFieldBatches();
+			void buildFoodBatch(const FoodSet& foodSet);
+			sf::Vector2f resolveTileViewportPosition(sf::Vector2i position) const;
+			bool tileIsVisible(sf::Vector2i position) const;
+			void uploadMinimapBlocks(sf::Vector2i blockMin, sf::Vector2i blockMax);
 
 		private:
-			sf::Sprite createSnakeHeadSprite(const QuickGame& game);
-			sf::Sprite createSnakeTailSprite(const QuickGame& game);
-			sf::Sprite createSnakeBodySprite(const SnakeSegment& snakeSegment);
+			void buildSnakeHeadSprite(sf::Sprite& sprite, const QuickGame& game);
+			void buildSnakeTailSprite(sf::Sprite& sprite, const QuickGame& game);
+			void buildSnakeBodySprite(sf::Sprite& sprite, const SnakeSegment& snakeSegment);
 
 		};
 
@@ -0,0 +1,239 @@
+//This header file defines recorded games: the game definition, the input given on every frame, periodic state hash checkpoints
+//and keyframes of the whole game state that let a player seek without playing from the start.
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "quickgame.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Struct for the state hash a game had after a frame, used to catch playback going out of sync.
+		typedef struct Snake_ReplayCheckpoint {
+			int frame;
+			std::uint64_t stateHash;
+		} ReplayCheckpoint;
+
+		//Struct for the outcome of playing a replay, firstMismatchFrame is -1 when every checkpoint matched.
+		typedef struct Snake_ReplayPlaybackResult {
+			int framesPlayed;
+			int checkpointsVerified;
+			int firstMismatchFrame;
+		} ReplayPlaybackResult;
+
+		//Struct for an entry of a replay's keyframe index, where the game state saved after a frame is in the file.
+		typedef struct Snake_ReplayKeyframe {
+			int frame;
+			std::uint32_t size;
+			std::uint64_t offset;
+		} ReplayKeyframe;
+
+		class ReplayRecorder;
+		class BackgroundReplaySaver;
+		class Replay;
+		class MappedReplay;
+
+		//Records the inputs of one game into a fixed buffer, so recording never allocates while the game runs.
+		class ReplayRecorder {
+
+		private:
+			QuickGameDefn gameDefn;
+
+		private:
+			unsigned char* inputs;
+			int frameCount;
+			int frameCapacity;
+			bool truncatedFlag;
+
+		private:
+			ReplayCheckpoint* checkpoints;
+			int checkpointCount;
+			int checkpointCapacity;
+			std::uint64_t lastStateHash;
+
+		public:
+			//Constructor allocating room for frameCapacity frames of input.
+			ReplayRecorder(int frameCapacity);
+
+		public:
+			~ReplayRecorder();
+
+		public:
+			//Start recording a new game.
+			void begin(const QuickGameDefn& gameDefn);
+			//Record the input given to one QuickGame::update call and the state hash the game had after it.
+			void record(const QuickGameInputRequest& input, std::uint64_t stateHash);
+			//Write the recording to a replay file. Keyframes are made here by playing the recording again, so recording never pays for them,
+			//and a recording that does not play back to its own checkpoints is saved without any. That takes a few milliseconds for
+			//an hour of play, a game that is rendered saves through a BackgroundReplaySaver instead.
+			bool saveToFile(const char* path) const;
+
+		public:
+			const QuickGameDefn& getGameDefn() const;
+			int getFrameCount() const;
+			bool getTruncated() const;
+
+		private:
+			void buildKeyframes(std::vector<unsigned char>& keyframeBytes, std::vector<ReplayKeyframe>& keyframes) const;
+
+		};
+
+		//Records games into two ReplayRecorders in turn and saves each finished game on a worker thread, so playing it again for its
+		//keyframes never holds up the frame the game ended on. The next game is recorded into the other recorder while the save runs.
+		class BackgroundReplaySaver {
+
+		private:
+			ReplayRecorder* recorders[2];
+			//recorder the running game is recorded into, the other one is being saved from
+			int recordingIndex;
+			std::thread thread;
+
+		private:
+			//the last save's path, changed by the worker when the name was taken, and whether it was written, only read once the worker has finished
+			std::string savePath;
+			bool saveSucceededFlag;
+
+		public:
+			//Constructor allocating both recorders with room for frameCapacity frames of input.
+			BackgroundReplaySaver(int frameCapacity);
+
+		public:
+			//Waits for the save in progress.
+			~BackgroundReplaySaver();
+
+		public:
+			//The recorder the running game is recorded into.
+			ReplayRecorder& getRecorder();
+			//Start saving the recorded game to path and record the next game into the other recorder. The previous save has to be finished first.
+			//An existing file is never replaced, the game is saved with -2, -3 and so on before the path's extension instead.
+			void save(const char* path);
+			//Wait for the save in progress, returns false when it could not be written and true when it was or nothing was being saved.
+			bool finishSave();
+			const char* getSavePath() const;
+
+		};
+
+		//A recorded game loaded from a replay file.
+		class Replay {
+
+		private:
+			QuickGameDefn gameDefn;
+			std::vector<unsigned char> inputs;
+			std::vector<ReplayCheckpoint> checkpoints;
+
+		public:
+			Replay();
+
+		public:
+			bool loadFromFile(const char* path);
+
+		public:
+			const QuickGameDefn& getGameDefn() const;
+			int getFrameCount() const;
+			QuickGameInputRequest getInput(int frame) const;
+			int getCheckpointCount() const;
+			ReplayCheckpoint getCheckpoint(int checkpointIndex) const;
+
+		};
+
+		//A replay file mapped read only, for seeking. Only the header and the footer are read on open(), the inputs and keyframes are read
+		//from the mapping as a seek needs them, so opening costs the same for a game of any length.
+		class MappedReplay {
+
+		private:
+			//the mapping
+			const unsigned char* mappedBytes;
+			std::size_t mappedByteCount;
+			//file and mapping handles on Windows, unused elsewhere
+			void* fileHandle;
+			void* mappingHandle;
+
+		private:
+			QuickGameDefn gameDefn;
+			const unsigned char* inputs;
+			int frameCount;
+			//the keyframe index inside the mapping, nullptr for replays older than keyframes
+			const unsigned char* keyframeIndex;
+			int keyframeCount;
+			int keyframeInterval;
+
+		public:
+			MappedReplay();
+
+		public:
+			~MappedReplay();
+
+		public:
+			//Map a replay file, returns false when it is missing, truncated or of an unknown version. Replays without keyframes open too,
+			//every seek on them plays from the start.
+			bool open(const char* path);
+			void close();
+
+		public:
+			const QuickGameDefn& getGameDefn() const;
+			int getFrameCount() const;
+			QuickGameInputRequest getInput(int frame) const;
+			int getKeyframeCount() const;
+			ReplayKeyframe getKeyframe(int keyframeIndex) const;
+
+		public:
+			//Put the game where it was after frame frames, between 0 and getFrameCount(), by restoring the last keyframe at or before it and
+			//playing on from there. Returns the number of frames played, which is less than the keyframe interval unless the replay
+			//has no keyframes or the keyframe was damaged and the game had to be played from the start. The game must not be set to a level
+			//or to many foods, which replays never have.
+			int seek(QuickGame& game, int frame) const;
+
+		};
+
+		namespace ReplayUtils {
+			//Play a replay through a game without rendering, checking the game's state hash at every checkpoint.
+			//Any engine with QuickGame's reset(), update() and getStateHash() can play it, such as a FixedFieldGame.
+			template <typename Game>
+			ReplayPlaybackResult playHeadless(const Replay& replay, Game& game);
+
+		}
+
+		namespace ReplayUtils {
+
+			// Reset the game to the replay's start and feed it every recorded input, stopping early if the snake dies
+			template <typename Game>
+			ReplayPlaybackResult playHeadless(const Replay& replay, Game& game) {
+				game.reset(&replay.getGameDefn());
+
+				ReplayPlaybackResult result;
+				result.framesPlayed = 0;
+				result.checkpointsVerified = 0;
+				result.firstMismatchFrame = -1;
+
+				int nextCheckpointIndex = 0;
+				while (result.framesPlayed < replay.getFrameCount()) {
+					QuickGameInputRequest input = replay.getInput(result.framesPlayed);
+					QuickGameUpdateResult updateResult = game.update(&input);
+					result.framesPlayed++;
+
+					// Compare against the checkpoint for this frame, if there is one
+					if ((nextCheckpointIndex < replay.getCheckpointCount()) && (replay.getCheckpoint(nextCheckpointIndex).frame == result.framesPlayed)) {
+						if (replay.getCheckpoint(nextCheckpointIndex).stateHash == game.getStateHash()) {
+							result.checkpointsVerified++;
+						} else if (result.firstMismatchFrame < 0) {
+							result.firstMismatchFrame = result.framesPlayed;
+						}
+						nextCheckpointIndex++;
+					}
+
+					if (updateResult.snakeHitBarrierFlag) {
+						break;
+					}
+				}
+
+				return result;
+			}
+
+		}
+
+	}
+
@@ -0,0 +1,113 @@
+//This header file defines the rollback session, which plays a head-to-head match of quick games ahead of the remote player's inputs and corrects itself when they arrive.
+#include <cstdint>
+#include "quickgame.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Most players one session holds, each on their own field.
+		const int ROLLBACK_MAX_PLAYER_COUNT = 4;
+
+		//Struct for how a session is set up, every peer of a match sets it up the same apart from localPlayerIndex.
+		typedef struct Snake_RollbackSessionDefn {
+			int playerCount;
+			QuickGameDefn playerGameDefns[ROLLBACK_MAX_PLAYER_COUNT];
+			//the player whose inputs advance() is given, every other player's come from addRemoteInput()
+			int localPlayerIndex;
+			//ticks the session may run ahead of the latest input it has from every player, and so the deepest rollback
+			int maxRollbackTicks;
+		} RollbackSessionDefn;
+
+		//Struct for how much a session had to correct itself.
+		typedef struct Snake_RollbackStats {
+			//remote inputs that arrived for a tick already played and differed from the prediction
+			int predictionMissCount;
+			int rollbackCount;
+			long long resimulatedTickCount;
+			int deepestRollbackTicks;
+			int lastRollbackTicks;
+			double lastRollbackSeconds;
+			double slowestRollbackSeconds;
+			//calls to advance() turned down because the session was maxRollbackTicks ahead
+			int stallCount;
+			//remote hashes of confirmed ticks that differed from this session's
+			int desyncCount;
+		} RollbackStats;
+
+		class RollbackSession;
+
+		//Plays one QuickGame per player in lockstep, a tick being one update() of every game. The local input of a tick is known at once,
+		//and a remote input that has not arrived is predicted to be no key press, which is what most ticks of a quick game are.
+		//Before each tick the session copies every game into a ring of snapshots, so when a remote input turns out to differ from what
+		//was played it restores the snapshot from before that tick and plays every tick since again with the inputs it now knows.
+		//Every tick's match hash is kept in a longer ring for comparing confirmed ticks with the other peers.
+		//The snapshots are allocated up front and copied into with QuickGame::copyFrom(), so neither ticks nor rollbacks allocate.
+		class RollbackSession {
+
+		private:
+			RollbackSessionDefn defn;
+			QuickGame* games[ROLLBACK_MAX_PLAYER_COUNT];
+			//tick the next advance() plays
+			int currentTick;
+
+		private:
+			//maxRollbackTicks + 1 slots, slot tick % slotCount holds every game as it was before the tick
+			int slotCount;
+			QuickGame** snapshotGames;
+			//match hash after each of the last hashSlotCount ticks, kept longer than the snapshots so hashes that take a round trip to arrive can still be checked
+			int hashSlotCount;
+			std::uint64_t* tickHashes;
+
+		private:
+			//inputs of twice slotCount ticks per player so remote inputs for ticks not played yet have room, with the input each tick was played with
+			int inputSlotCount;
+			ObjectDirection* inputs;
+			ObjectDirection* playedInputs;
+			//last tick each player's input is known for
+			int confirmedTicks[ROLLBACK_MAX_PLAYER_COUNT];
+			//earliest tick played with a wrong prediction, -1 when every played tick is right
+			int rollbackTick;
+
+		private:
+			RollbackStats stats;
+
+		public:
+			//Constructor, starts every player's game and allocates the snapshot ring.
+			RollbackSession(const RollbackSessionDefn& defn);
+
+		public:
+			~RollbackSession();
+
+		public:
+			//Correct any mispredicted ticks, then play the next tick with the local input given. Returns false without playing
+			//when the session is already maxRollbackTicks ahead of a remote player, the caller tries again on its next frame.
+			bool advance(ObjectDirection localInput);
+			//Take a remote player's input for a tick, in tick order. Inputs for ticks already played are checked against the prediction
+			//and mark the session for a rollback when they differ, the next advance() plays the ticks again.
+			void addRemoteInput(int playerIndex, int tick, ObjectDirection input);
+			//Compare another peer's hash for a confirmed tick still in the ring, counting a desync when it differs.
+			bool checkRemoteHash(int tick, std::uint64_t stateHash);
+			//Play the mispredicted ticks again now rather than on the next advance(), for a session that stopped advancing.
+			void synchronize();
+
+		public:
+			const RollbackSessionDefn& getDefn() const;
+			const QuickGame& getGame(int playerIndex) const;
+			int getCurrentTick() const;
+			//Ticks before this one were played with every player's real input and will not change.
+			int getConfirmedTick() const;
+			//Match hash after a tick, for one of the last 4 * (maxRollbackTicks + 1) ticks played.
+			std::uint64_t getTickHash(int tick) const;
+			const RollbackStats& getStats() const;
+
+		private:
+			void rollback();
+			void playTick();
+			ObjectDirection resolveInput(int playerIndex, int tick) const;
+			std::uint64_t computeMatchHash() const;
+
+		};
+
+	}
@@ -0,0 +1,85 @@
+//This header file defines the sound effect voice pool used by the game scenes.
+#include <SFML/System.hpp>
+#include <SFML/Audio.hpp>
+#pragma once
+
+
+
+	namespace snake {
+
+		//Enum for every sound effect shipped in resources/sounds, COUNT is the number of effects.
+		typedef enum class Snake_SoundEffectId {
+			EAT_APPLE,
+			HIT_BARRIER,
+			FOOD_SPAWNED,
+			SNAKE_HISS,
+			COUNT,
+		} SoundEffectId;
+
+		//Struct to report the measured delay between a sound effect being triggered and its voice starting. The delay runs from trigger()
+		//to the return of sf::Sound::play() in the next flush(), which is how long the frame held the effect back. The time OpenAL then takes
+		//to mix it and the device to output it is not part of it, SFML does not expose it.
+		typedef struct Snake_SoundEffectLatencyStats {
+			int playedCount;
+			int droppedCount;
+			int stolenCount;
+			sf::Int64 lastMicroseconds;
+			sf::Int64 maxMicroseconds;
+			sf::Int64 totalMicroseconds;
+		} SoundEffectLatencyStats;
+
+		class SoundEffectPool;
+
+		//Fixed pool of voices playing preloaded sound buffers, with priority based voice stealing.
+		class SoundEffectPool {
+
+		public:
+			//Number of voices that can play at the same time.
+			static const int VOICE_COUNT = 8;
+			//Number of triggers that can be queued between two flushes.
+			static const int PENDING_CAPACITY = 16;
+
+		private:
+			//Preloaded PCM for every effect, indexed by SoundEffectId.
+			sf::SoundBuffer buffers[(int)SoundEffectId::COUNT];
+
+		private:
+			//Voices and the effect, priority and start time of what each one is playing.
+			sf::Sound voices[VOICE_COUNT];
+			SoundEffectId voiceEffect[VOICE_COUNT];
+			int voicePriority[VOICE_COUNT];
+			sf::Int64 voiceStartedAt[VOICE_COUNT];
+
+		private:
+			//Triggers waiting for the next flush, with the time they were triggered.
+			SoundEffectId pendingEffect[PENDING_CAPACITY];
+			sf::Int64 pendingTriggeredAt[PENDING_CAPACITY];
+			int pendingCount;
+
+		private:
+			sf::Clock clock;
+			SoundEffectLatencyStats latencyStats;
+
+		public:
+			//Constructor loads every sound effect buffer up front.
+			SoundEffectPool();
+
+		public:
+			//Queue an effect to be started on the next flush, never allocates.
+			void trigger(SoundEffectId effect);
+			//Start every queued effect on a free or stolen voice.
+			void flush();
+			//Stop every voice and drop queued triggers.
+			void stopAll();
+
+		public:
+			const SoundEffectLatencyStats& getLatencyStats() const;
+			void resetLatencyStats();
+
+		private:
+			int resolveVoice(int priority);
+
+		};
+
+	}
+
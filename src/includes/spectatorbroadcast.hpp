@@ -0,0 +1,190 @@
+//This header file defines the spectator broadcast, which publishes a quick game's ticks into shared memory for viewer processes on the same machine to follow.
+#include <atomic>
+#include <cstdint>
+#include "quickgame.hpp"
+#include "level.hpp"
+#pragma once
+
+
+
+	namespace snake {
+
+		//Layout of the shared memory, written by one publisher and only ever read by viewers, which map it read only:
+		//a SpectatorHeader, SPECTATOR_SLOT_COUNT SpectatorSlots and a LevelTile byte per field cell for the level of the current game.
+		//Both the game record and every slot are guarded by a sequence number that is odd while they are being written, so readers copy
+		//them out and check the number did not change rather than taking a lock, and the publisher never waits on a reader.
+		const char SPECTATOR_MAGIC[4] = { 'S', 'N', 'K', 'S' };
+		const std::uint32_t SPECTATOR_VERSION = 1;
+		//Ticks the ring holds, a little over 24 minutes of a game at 45 frames per second. Viewers follow a game by playing its inputs
+		//from its first tick, so one that joins after that tick left the ring waits for the next game.
+		const int SPECTATOR_SLOT_COUNT = 1 << 16;
+		//Name a viewer opens when it is given none.
+		const char* const SPECTATOR_DEFAULT_NAME = "snake";
+
+		//Enum for what the game is showing, which picks what a viewer renders.
+		typedef enum class Snake_SpectatorPhase {
+			WAITING,
+			RUNNING,
+			DONE,
+			//the publisher is gone, viewers look for a new one
+			CLOSED,
+		} SpectatorPhase;
+
+		//Struct for the game being played, rewritten when a game starts and when the phase changes.
+		typedef struct Snake_SpectatorGameRecord {
+			//1 for the first game published, 0 before any game
+			std::uint32_t gameIndex;
+			std::uint32_t phase;
+			//tick of the ring the game's first update() went to
+			std::uint64_t firstTick;
+			QuickGameDefn gameDefn;
+			std::int32_t foodCount;
+			//the tile bytes hold the game's level, otherwise it is played on the open field
+			std::int32_t levelFlag;
+			std::int32_t longestSnakeLength;
+			std::int32_t lastGameBeatLongestSnakeLengthFlag;
+		} SpectatorGameRecord;
+
+		//Struct at the start of the shared memory.
+		typedef struct Snake_SpectatorHeader {
+			char magic[4];
+			std::uint32_t version;
+			std::int32_t fieldWidth;
+			std::int32_t fieldHeight;
+			std::uint32_t slotCount;
+			//cells the tile bytes have room for, 0 when the field is too large for a level
+			std::uint32_t tileCapacity;
+			std::uint64_t slotOffset;
+			std::uint64_t tileOffset;
+			std::uint64_t segmentSize;
+			alignas(64) std::atomic<std::uint64_t> gameSequence;
+			SpectatorGameRecord game;
+			//ticks published so far, tick t is in slot t % slotCount
+			alignas(64) std::atomic<std::uint64_t> publishedTickCount;
+		} SpectatorHeader;
+
+		//Struct for one tick, the input the game was updated with and the state hash it ended on.
+		typedef struct Snake_SpectatorTick {
+			std::uint64_t stateHash;
+			std::uint32_t gameIndex;
+			std::int32_t input;
+		} SpectatorTick;
+
+		//Struct for one slot of the ring.
+		typedef struct Snake_SpectatorSlot {
+			//2 * tick + 2 once the tick is written, 2 * tick + 1 while it is
+			std::atomic<std::uint64_t> sequence;
+			SpectatorTick tick;
+		} SpectatorSlot;
+
+		//Struct for how well a viewer kept up.
+		typedef struct Snake_SpectatorStats {
+			long long appliedTickCount;
+			int followedGameCount;
+			//games the viewer could not follow, because it joined too late or fell a whole ring behind
+			int missedGameCount;
+			int hashMismatchCount;
+		} SpectatorStats;
+
+		class SpectatorPublisher;
+		class SpectatorSubscriber;
+
+		//Writing end of a broadcast. Publishing a tick is a slot write and two atomic stores whatever the number of viewers, since viewers
+		//keep their own place in the ring and write nothing back. Ticks are inputs rather than boards, so a tick costs the same on any field.
+		class SpectatorPublisher {
+
+		private:
+			SpectatorHeader* header;
+			SpectatorSlot* slots;
+			unsigned char* tiles;
+			std::size_t segmentSize;
+			//shared memory name with the prefix the platform wants
+			char segmentName[64];
+			//mapping handle on Windows, unused elsewhere
+			void* mappingHandle;
+
+		private:
+			//the game record as last published, rewritten whole under the sequence number
+			SpectatorGameRecord game;
+			std::uint64_t tickCount;
+
+		public:
+			//Constructor, nothing is shared until create().
+			SpectatorPublisher();
+
+		public:
+			//Closes the broadcast, telling viewers the publisher is gone.
+			~SpectatorPublisher();
+
+		public:
+			//Create the shared memory for games on a field of this size, replacing any left over under the same name. Returns false when it cannot be made.
+			bool create(const char* name, sf::Vector2i fieldSize);
+			void close();
+
+		public:
+			//Announce a new game, played on the level when it is not nullptr. Has to come before the game's first publishTick().
+			void publishGame(const QuickGameDefn& gameDefn, const Level* level, int foodCount);
+			void publishPhase(SpectatorPhase phase, int longestSnakeLength, bool lastGameBeatLongestSnakeLengthFlag);
+			//Publish one update() of the current game, with the state hash it ended on.
+			void publishTick(ObjectDirection input, std::uint64_t stateHash);
+
+		private:
+			void writeGameRecord(const Level* level, bool tilesFlag);
+
+		};
+
+		//Reading end of a broadcast, which keeps its own copy of the game and plays every published tick on it, checking each state hash.
+		//poll() never blocks, so it fits in a render loop.
+		class SpectatorSubscriber {
+
+		private:
+			const SpectatorHeader* header;
+			const SpectatorSlot* slots;
+			const unsigned char* tiles;
+			std::size_t segmentSize;
+			void* mappingHandle;
+
+		private:
+			SpectatorGameRecord game;
+			//copy of the publisher's game, nullptr until the first game followed
+			QuickGame* mirrorGame;
+			Level* mirrorLevel;
+			//the level's tiles copied out of the shared memory, sized to the tile bytes of the broadcast opened
+			LevelTile* tileBuffer;
+			std::uint32_t tileBufferCapacity;
+			//the mirror is playing the current game, false while waiting for the next one
+			bool followingFlag;
+			std::uint64_t nextTick;
+			SpectatorStats stats;
+
+		public:
+			//Constructor, nothing is read until open().
+			SpectatorSubscriber();
+
+		public:
+			~SpectatorSubscriber();
+
+		public:
+			//Map a broadcast read only, returns false when there is none under the name or it is of another version.
+			bool open(const char* name);
+			void close();
+			bool isOpen() const;
+			//Read the game record and play every tick published since the last call, returns how many were played.
+			int poll();
+
+		public:
+			SpectatorPhase getPhase() const;
+			//The copy of the game, nullptr while there is no game being followed to show.
+			const QuickGame* getGame() const;
+			int getLongestSnakeLength() const;
+			bool getLastGameBeatLongestSnakeLength() const;
+			const SpectatorStats& getStats() const;
+
+		private:
+			bool readGameRecord(SpectatorGameRecord& record, bool tilesFlag);
+			bool readSlot(std::uint64_t tick, SpectatorTick& result) const;
+			void followGame(const SpectatorGameRecord& record);
+
+		};
+
+	}
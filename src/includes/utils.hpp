@@ -18,6 +18,7 @@
 		namespace FontUtils {
 
 			float resolveTextWidth(sf::Text& text);
+			void replaceNumberSuffix(sf::String& text, std::size_t prefixLength, int value);
 
 		}
 
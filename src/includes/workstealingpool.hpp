@@ -0,0 +1,92 @@
+//This header file defines the work-stealing thread pool that runs parallel searches.
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#pragma once
+
+
+
+	namespace snake {
+
+		class WorkStealingPool;
+
+		//Work handed to the pool. Tasks are plain integers whose meaning is up to the job, and a task may push more tasks while it runs.
+		class WorkStealingJob {
+
+		public:
+			virtual ~WorkStealingJob() {}
+
+		public:
+			virtual void runTask(WorkStealingPool& pool, int workerIndex, int taskArgument) = 0;
+
+		};
+
+		//Struct for one worker's fixed size task deque: the owner pushes and pops at the back, thieves take from the front.
+		typedef struct Snake_WorkStealingQueue {
+			std::mutex mutex;
+			int* tasks;
+			int capacity;
+			int front;
+			int count;
+		} WorkStealingQueue;
+
+		//Struct to count what one worker did, only written by that worker while a job runs.
+		typedef struct Snake_WorkStealingWorkerStats {
+			long long taskCount;
+			long long stolenTaskCount;
+		} WorkStealingWorkerStats;
+
+		//Fixed set of worker threads, each with its own task deque. Idle workers steal from the others until every task has run.
+		//Nothing is allocated after construction, so jobs that do not allocate run allocation free.
+		class WorkStealingPool {
+
+		private:
+			int workerCount;
+			std::vector<std::thread> threads;
+			WorkStealingQueue* queues;
+			WorkStealingWorkerStats* workerStats;
+
+		private:
+			//tasks pushed and not yet finished, the job is done when it reaches zero
+			std::atomic<int> pendingTaskCount;
+
+		private:
+			std::mutex controlMutex;
+			std::condition_variable startCondition;
+			std::condition_variable doneCondition;
+			WorkStealingJob* currentJob;
+			int generation;
+			int finishedWorkerCount;
+			bool stoppingFlag;
+
+		public:
+			//Constructor, starts workerCount threads that each queue up to queueCapacity tasks.
+			WorkStealingPool(int workerCount, int queueCapacity);
+
+		public:
+			~WorkStealingPool();
+
+		public:
+			//Run a job from initial tasks spread over the workers, returning once every task, including pushed ones, has run.
+			void run(WorkStealingJob& job, const int* initialTasks, int initialTaskCount);
+
+		public:
+			//Queue a task on a worker's own deque from inside runTask(). Returns false when the deque is full, the caller should run it itself.
+			bool push(int workerIndex, int taskArgument);
+
+		public:
+			int getWorkerCount() const;
+			const WorkStealingWorkerStats& getWorkerStats(int workerIndex) const;
+			void resetStats();
+
+		private:
+			void workerLoop(int workerIndex);
+			bool popLocal(int workerIndex, int* taskArgument);
+			bool steal(int thiefIndex, int* taskArgument);
+
+		};
+
+	}
+
@@ -1,10 +1,93 @@
-
+#include <stdio.h>
+#include <string.h>
 #include "includes/client.hpp"
 #include "includes/gamestate.hpp"
 
-int main() {
+int main(int argc, char** argv) {
+	//parse command line options
+	snake::GameClientOptions options;
+	options.prewarmScenes = false;
+	options.replayDirectory = nullptr;
+	options.autopilot = false;
+	options.perfectPlay = false;
+	options.mcts = false;
+	options.mctsDifficulty = snake::MctsDifficulty::NORMAL;
+	options.fieldSize = sf::Vector2i(snake::QUICK_GAME_DEFAULT_FIELD_WIDTH, snake::QUICK_GAME_DEFAULT_FIELD_HEIGHT);
+	options.levelPath = nullptr;
+	options.generatedLevels = false;
+	options.foodCount = 0;
+	options.broadcastName = nullptr;
+	for (int argIndex = 1; argIndex < argc; argIndex++) {
+		if (strcmp(argv[argIndex], "--prewarm") == 0) {
+			options.prewarmScenes = true;
+		}
+		else if ((strcmp(argv[argIndex], "--record-replays") == 0) && (argIndex + 1 < argc)) {
+			argIndex++;
+			options.replayDirectory = argv[argIndex];
+		}
+		else if (strcmp(argv[argIndex], "--autopilot") == 0) {
+			options.autopilot = true;
+		}
+		else if (strcmp(argv[argIndex], "--perfect-play") == 0) {
+			options.perfectPlay = true;
+		}
+		else if ((strcmp(argv[argIndex], "--mcts") == 0) && (argIndex + 1 < argc)) {
+			argIndex++;
+			options.mcts = true;
+			if (strcmp(argv[argIndex], "easy") == 0) {
+				options.mctsDifficulty = snake::MctsDifficulty::EASY;
+			}
+			else if (strcmp(argv[argIndex], "hard") == 0) {
+				options.mctsDifficulty = snake::MctsDifficulty::HARD;
+			}
+		}
+		else if ((strcmp(argv[argIndex], "--field") == 0) && (argIndex + 1 < argc)) {
+			argIndex++;
+			//fields from 8x8 up to 100000x100000, larger than the window they scroll with the snake
+			sf::Vector2i fieldSize;
+			bool validFlag =
+				(sscanf(argv[argIndex], "%dx%d", &fieldSize.x, &fieldSize.y) == 2) &&
+				(fieldSize.x >= 8) && (fieldSize.y >= 8) && (fieldSize.x <= 100000) && (fieldSize.y <= 100000);
+			if (validFlag) {
+				options.fieldSize = fieldSize;
+			}
+			else {
+				fprintf(stderr, "Ignoring --field %s, expected <width>x<height> from 8x8 to 100000x100000\n", argv[argIndex]);
+			}
+		}
+		else if ((strcmp(argv[argIndex], "--level") == 0) && (argIndex + 1 < argc)) {
+			argIndex++;
+			//a level compiled with make levels, its field size wins over --field
+			options.levelPath = argv[argIndex];
+		}
+		else if (strcmp(argv[argIndex], "--generated-levels") == 0) {
+			options.generatedLevels = true;
+		}
+		else if ((strcmp(argv[argIndex], "--food") == 0) && (argIndex + 1 < argc)) {
+			argIndex++;
+			//many foods of every kind on the field at once, the snake grows by the kind it eats
+			int foodCount = 0;
+			if ((sscanf(argv[argIndex], "%d", &foodCount) == 1) && (foodCount >= 1)) {
+				options.foodCount = foodCount;
+			}
+			else {
+				fprintf(stderr, "Ignoring --food %s, expected a count of at least 1\n", argv[argIndex]);
+			}
+		}
+		else if ((strcmp(argv[argIndex], "--broadcast") == 0) && (argIndex + 1 < argc)) {
+			argIndex++;
+			//publish every quick game in shared memory for bin/snake-spectator windows to show
+			options.broadcastName = argv[argIndex];
+		}
+	}
+
 	//entry point
-	snake::GameClient gameClient;
+	snake::GameClient gameClient(options);
 	gameClient.run();
+
+	//allocation tracking builds fail when a steady state frame allocated
+	if (gameClient.getSteadyStateAllocationFrameCount() > 0) {
+		return 1;
+	}
 	return 0;
 }
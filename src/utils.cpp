@@ -46,6 +46,26 @@
 				return result;
 			}
 
+			// Replaces everything after the prefix with a non-negative number, reusing the string's storage
+			void replaceNumberSuffix(sf::String& text, std::size_t prefixLength, int value) {
+				text.erase(prefixLength, text.getSize() - prefixLength);
+
+				// Collect the digits least significant first
+				char digits[16];
+				int digitCount = 0;
+				do {
+					digits[digitCount] = (char)('0' + (value % 10));
+					digitCount++;
+					value /= 10;
+				} while (value > 0);
+
+				// Single characters fit in sf::String's small buffer, so appending them does not allocate
+				while (digitCount > 0) {
+					digitCount--;
+					text += sf::String((sf::Uint32)digits[digitCount]);
+				}
+			}
+
 		}
 
 
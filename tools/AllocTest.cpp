@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SFML/Graphics.hpp>
+#include "../src/includes/utils.hpp"
+#include "../src/includes/alloctracker.hpp"
+#include "../src/includes/quickgamescene.hpp"
+
+
+	namespace snake {
+
+		namespace AllocTest {
+
+			// Size of the target frames are drawn into, the size the game's window opens at
+			const unsigned int RENDER_WIDTH = 800;
+			const unsigned int RENDER_HEIGHT = 450;
+
+			// Frames a game has to run before its frames are expected to be allocation free, the client's warm-up
+			const int WARMUP_FRAMES = 45;
+			// Steady state frames checked when no count is given, several autopilot games' worth
+			const int DEFAULT_FRAME_COUNT = 20000;
+
+			// Planning budget of the autopilot, the same as the game gives it
+			const std::int64_t AUTOPILOT_BUDGET_MICROSECONDS = 4000;
+
+			// Longest game recorded, the same as the game records
+			const int REPLAY_FRAME_CAPACITY = 60 * 60 * 60;
+
+			// Start a game with a seed of its own on the default field, the way the controller starts one
+			QuickGameDefn resolveGameDefn(unsigned int randomSeed) {
+				QuickGameDefn result;
+				result.fieldSize = sf::Vector2i(QUICK_GAME_DEFAULT_FIELD_WIDTH, QUICK_GAME_DEFAULT_FIELD_HEIGHT);
+				result.snakeSpeedTilesPerSecond = 10.0f;
+				result.snakeStartDefn.headPosition.x = result.fieldSize.x / 2;
+				result.snakeStartDefn.headPosition.y = (result.fieldSize.y * 2) / 5;
+				result.snakeStartDefn.facingDirection = ObjectDirection::DOWN;
+				result.snakeStartDefn.length = 3;
+				result.randomSeed = randomSeed;
+				return result;
+			}
+
+			// Print the subsystems that allocated in a frame
+			void reportFrame(int frame, const AllocationFrameStats& frameStats) {
+				fprintf(stderr, "frame %d allocated:", frame);
+				for (int subsystemIndex = 0; subsystemIndex < (int)AllocationSubsystem::COUNT; subsystemIndex++) {
+					if (frameStats.allocationCount[subsystemIndex] > 0) {
+						fprintf(stderr, " %s=%d (%zu bytes)", AllocationTracker::getSubsystemName((AllocationSubsystem)subsystemIndex), frameStats.allocationCount[subsystemIndex], frameStats.allocatedBytes[subsystemIndex]);
+					}
+				}
+				fprintf(stderr, "\n");
+			}
+
+			// Play autopilot games through the controller's per-frame path, with rendering into a texture when a GL context can be made,
+			// failing when any frame after a game's warm-up allocates
+			int run(int frameCount, bool renderFlag) {
+				unsigned int randomSeed = 1;
+				QuickGameDefn gameDefn = resolveGameDefn(randomSeed);
+				QuickGame game(&gameDefn);
+				Autopilot autopilot(AUTOPILOT_BUDGET_MICROSECONDS);
+				ReplayRecorder replayRecorder(REPLAY_FRAME_CAPACITY);
+				SoundEffectPool soundEffects;
+				replayRecorder.begin(gameDefn);
+
+				QuickGameRenderer renderer;
+				sf::RenderTexture renderTexture;
+				if (renderFlag && !renderTexture.create(RENDER_WIDTH, RENDER_HEIGHT)) {
+					fprintf(stderr, "No GL context could be made, the renderer is not checked (run under xvfb-run on a machine without a display)\n");
+					renderFlag = false;
+				}
+				if (renderFlag) {
+					renderTexture.setView(ViewUtils::createView(RENDER_WIDTH, RENDER_HEIGHT));
+				}
+
+				int allocatingFrameCount = 0;
+				int checkedFrameCount = 0;
+				int gameCount = 1;
+				int runningGameFrameCount = 0;
+				while (checkedFrameCount < frameCount) {
+					AllocationTracker::beginFrame();
+
+					QuickGameUpdateResult updateResult;
+					QuickGameInputRequest inputRequest;
+					{
+						AllocationScope allocationScope(AllocationSubsystem::SIMULATION);
+						inputRequest = autopilot.resolveInput(game);
+						updateResult = game.update(&inputRequest);
+					}
+					replayRecorder.record(inputRequest, game.getStateHash());
+
+					if (updateResult.appleSpawnedFlag) {
+						soundEffects.trigger(SoundEffectId::FOOD_SPAWNED);
+					}
+					if (updateResult.snakeAteAppleFlag) {
+						soundEffects.trigger(SoundEffectId::EAT_APPLE);
+					}
+					{
+						AllocationScope allocationScope(AllocationSubsystem::AUDIO);
+						soundEffects.flush();
+					}
+
+					if (renderFlag) {
+						AllocationScope allocationScope(AllocationSubsystem::RENDER);
+						QuickGameRenderState renderState;
+						renderState.game = &game;
+						renderState.longestSnake = 0;
+						renderState.lastGameBeatLongestSnakeLength = false;
+						renderer.renderGameRunning(renderTexture, renderState);
+						renderTexture.display();
+					}
+
+					const AllocationFrameStats& frameStats = AllocationTracker::endFrame();
+					runningGameFrameCount++;
+					if (runningGameFrameCount > WARMUP_FRAMES) {
+						checkedFrameCount++;
+						if (AllocationTracker::getTotalAllocationCount(frameStats) > 0) {
+							allocatingFrameCount++;
+							reportFrame(checkedFrameCount, frameStats);
+						}
+					}
+
+					// The next game starts in place like the controller's, outside the frames that are checked
+					if (updateResult.snakeHitBarrierFlag || game.getFieldFull()) {
+						randomSeed++;
+						gameDefn = resolveGameDefn(randomSeed);
+						game.reset(&gameDefn);
+						replayRecorder.begin(gameDefn);
+						soundEffects.trigger(SoundEffectId::SNAKE_HISS);
+						gameCount++;
+						runningGameFrameCount = 0;
+					}
+				}
+
+				fprintf(stderr, "%d steady state frame(s) of %d game(s)%s, %d allocated\n",
+					checkedFrameCount, gameCount, renderFlag ? " rendered" : "", allocatingFrameCount);
+				return (allocatingFrameCount > 0) ? 1 : 0;
+			}
+
+			void printUsage() {
+				fprintf(stderr, "usage: snake-alloc-test [--frames <count>] [--no-render]\n");
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	int frameCount = snake::AllocTest::DEFAULT_FRAME_COUNT;
+	bool renderFlag = true;
+
+	for (int argIndex = 1; argIndex < argc; argIndex++) {
+		if ((strcmp(argv[argIndex], "--frames") == 0) && (argIndex + 1 < argc)) {
+			frameCount = atoi(argv[++argIndex]);
+		} else if (strcmp(argv[argIndex], "--no-render") == 0) {
+			renderFlag = false;
+		} else {
+			snake::AllocTest::printUsage();
+			return 1;
+		}
+	}
+
+	if (frameCount < 1) {
+		snake::AllocTest::printUsage();
+		return 1;
+	}
+
+	// Without the replacement operator new every frame counts zero allocations and the test would prove nothing
+	if (!snake::AllocationTracker::isEnabled()) {
+		fprintf(stderr, "snake-alloc-test has to be linked with the allocation tracker built with SNAKE_TRACK_ALLOCATIONS\n");
+		return 1;
+	}
+
+	return snake::AllocTest::run(frameCount, renderFlag);
+}
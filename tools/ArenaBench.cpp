@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include "../src/includes/alloctracker.hpp"
+#include "../src/includes/arenagame.hpp"
+
+
+	namespace snake {
+
+		namespace ArenaBench {
+
+			// Default arena, ten thousand bots on a field with room for all of them to grow
+			const int DEFAULT_SNAKE_COUNT = 10000;
+			const sf::Vector2i DEFAULT_FIELD_SIZE = sf::Vector2i(1000, 1000);
+			const int DEFAULT_TICK_COUNT = 200;
+			const int DEFAULT_REGION_COUNT = 128;
+			const unsigned int DEFAULT_SEED = 1;
+			// Ticks per second the arena has to keep up to pass
+			const double DEFAULT_TARGET_TICKS_PER_SECOND = 20.0;
+
+			// Snakes start short, and every snake brings one apple onto the field
+			const int ARENA_SNAKE_START_LENGTH = 4;
+			const int ARENA_SNAKE_MAX_LENGTH = 64;
+			const int ARENA_RESPAWN_DELAY_TICKS = 20;
+
+			// Struct for the options the benchmark was started with
+			typedef struct Snake_ArenaBenchOptions {
+				int tickCount;
+				double targetTicksPerSecond;
+				//play the arena again on one worker and check it ends on the same board
+				bool verifyFlag;
+			} ArenaBenchOptions;
+
+			// Play the ticks and return the hash of the board they end on, printing the throughput when reportFlag is set
+			std::uint64_t play(const ArenaGameDefn& defn, const ArenaBenchOptions& options, bool reportFlag, double* ticksPerSecond, long long* allocations) {
+				ArenaGame arena(defn);
+
+				double totalSeconds = 0.0;
+				double slowestTickSeconds = 0.0;
+				long long deathTotal = 0;
+				long long headOnDeathTotal = 0;
+				long long appleTotal = 0;
+				long long allocationsBefore = AllocationTracker::getProcessAllocationCount();
+				for (int tickIndex = 0; tickIndex < options.tickCount; tickIndex++) {
+					ArenaTickStats stats = arena.update();
+					totalSeconds += stats.tickSeconds;
+					slowestTickSeconds = (stats.tickSeconds > slowestTickSeconds) ? stats.tickSeconds : slowestTickSeconds;
+					deathTotal += stats.deathCount;
+					headOnDeathTotal += stats.headOnDeathCount;
+					appleTotal += stats.applesEaten;
+				}
+				*allocations = AllocationTracker::getProcessAllocationCount() - allocationsBefore;
+				*ticksPerSecond = (totalSeconds > 0.0) ? ((double)options.tickCount / totalSeconds) : 0.0;
+
+				if (reportFlag) {
+					printf("%d tick(s): %.3f ms/tick, slowest %.3f ms, %.1f ticks/s\n",
+						options.tickCount, totalSeconds * 1000.0 / (double)options.tickCount, slowestTickSeconds * 1000.0, *ticksPerSecond);
+					printf("%d snake(s) alive at the end, %lld death(s) of which %lld head-on, %lld apple(s) eaten\n",
+						arena.getAliveSnakeCount(), deathTotal, headOnDeathTotal, appleTotal);
+				}
+				return arena.computeStateHash();
+			}
+
+			// Run the arena, failing when it is slower than the target, a tick allocated, or a single worker ends somewhere else
+			int run(const ArenaGameDefn& defn, const ArenaBenchOptions& options) {
+				printf("%d snake(s) on %dx%d, %d region(s) on %d worker(s), seed %u\n",
+					defn.snakeCount, defn.fieldSize.x, defn.fieldSize.y, defn.regionCount, defn.workerCount, defn.randomSeed);
+
+				double ticksPerSecond = 0.0;
+				long long allocations = 0;
+				std::uint64_t stateHash = play(defn, options, true, &ticksPerSecond, &allocations);
+
+				int result = 0;
+				if (ticksPerSecond < options.targetTicksPerSecond) {
+					fprintf(stderr, "Below the target of %.1f ticks/s\n", options.targetTicksPerSecond);
+					result = 1;
+				}
+				if (allocations > 0) {
+					fprintf(stderr, "Ticks allocated %lld time(s)\n", allocations);
+					result = 1;
+				}
+
+				if (options.verifyFlag) {
+					ArenaGameDefn singleWorkerDefn = defn;
+					singleWorkerDefn.workerCount = 1;
+					double singleTicksPerSecond = 0.0;
+					long long singleAllocations = 0;
+					std::uint64_t singleStateHash = play(singleWorkerDefn, options, false, &singleTicksPerSecond, &singleAllocations);
+					printf("1 worker: %.1f ticks/s, %s\n", singleTicksPerSecond, (singleStateHash == stateHash) ? "same board" : "different board");
+					if (singleStateHash != stateHash) {
+						fprintf(stderr, "The board after %d tick(s) depends on the worker count\n", options.tickCount);
+						result = 1;
+					}
+				}
+				return result;
+			}
+
+			void printUsage() {
+				fprintf(stderr, "usage: snake-arena-bench [--snakes <count>] [--field <width>x<height>] [--ticks <count>] [--workers <count>]\n");
+				fprintf(stderr, "                         [--regions <count>] [--seed <seed>] [--target <ticks per second>] [--verify]\n");
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	snake::ArenaGameDefn defn;
+	defn.fieldSize = snake::ArenaBench::DEFAULT_FIELD_SIZE;
+	defn.snakeCount = snake::ArenaBench::DEFAULT_SNAKE_COUNT;
+	defn.playerSnakeCount = 0;
+	defn.snakeStartLength = snake::ArenaBench::ARENA_SNAKE_START_LENGTH;
+	defn.snakeMaxLength = snake::ArenaBench::ARENA_SNAKE_MAX_LENGTH;
+	defn.respawnDelayTicks = snake::ArenaBench::ARENA_RESPAWN_DELAY_TICKS;
+	defn.regionCount = snake::ArenaBench::DEFAULT_REGION_COUNT;
+	defn.randomSeed = snake::ArenaBench::DEFAULT_SEED;
+	defn.workerCount = (int)std::thread::hardware_concurrency();
+	if (defn.workerCount < 1) {
+		defn.workerCount = 1;
+	}
+
+	snake::ArenaBench::ArenaBenchOptions options;
+	options.tickCount = snake::ArenaBench::DEFAULT_TICK_COUNT;
+	options.targetTicksPerSecond = snake::ArenaBench::DEFAULT_TARGET_TICKS_PER_SECOND;
+	options.verifyFlag = false;
+
+	for (int argIndex = 1; argIndex < argc; argIndex++) {
+		if ((strcmp(argv[argIndex], "--snakes") == 0) && (argIndex + 1 < argc)) {
+			defn.snakeCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--field") == 0) && (argIndex + 1 < argc)) {
+			if (sscanf(argv[++argIndex], "%dx%d", &defn.fieldSize.x, &defn.fieldSize.y) != 2) {
+				snake::ArenaBench::printUsage();
+				return 1;
+			}
+		} else if ((strcmp(argv[argIndex], "--ticks") == 0) && (argIndex + 1 < argc)) {
+			options.tickCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--workers") == 0) && (argIndex + 1 < argc)) {
+			defn.workerCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--regions") == 0) && (argIndex + 1 < argc)) {
+			defn.regionCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--seed") == 0) && (argIndex + 1 < argc)) {
+			defn.randomSeed = (unsigned int)strtoul(argv[++argIndex], nullptr, 10);
+		} else if ((strcmp(argv[argIndex], "--target") == 0) && (argIndex + 1 < argc)) {
+			options.targetTicksPerSecond = atof(argv[++argIndex]);
+		} else if (strcmp(argv[argIndex], "--verify") == 0) {
+			options.verifyFlag = true;
+		} else {
+			snake::ArenaBench::printUsage();
+			return 1;
+		}
+	}
+	defn.appleCount = defn.snakeCount;
+
+	bool validFlag =
+		(defn.snakeCount >= 1) && (options.tickCount >= 1) && (defn.workerCount >= 1) && (defn.regionCount >= 1) &&
+		(defn.fieldSize.x >= 8) && (defn.fieldSize.y >= 8);
+	if (!validFlag) {
+		snake::ArenaBench::printUsage();
+		return 1;
+	}
+
+	return snake::ArenaBench::run(defn, options);
+}
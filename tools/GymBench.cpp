@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../gym/snakegym.h"
+
+
+	namespace snake {
+
+		namespace GymBench {
+
+			// Settings of the benchmarked gyms, the same field as a quick game started from the menu
+			const int BENCH_FIELD_WIDTH = 50;
+			const int BENCH_FIELD_HEIGHT = 25;
+			const int BENCH_START_LENGTH = 3;
+			const int BENCH_MAX_EPISODE_STEPS = 2000;
+			const int DEFAULT_ENV_COUNT = 256;
+			const int DEFAULT_STEP_COUNT = 20000;
+
+			// Chance out of 8 that the random agent turns instead of going straight, low enough for episodes to last a while
+			const unsigned int BENCH_TURN_CHANCE = 1;
+
+			// Struct for what one thread's gym did
+			typedef struct Snake_GymBenchResult {
+				long long envStepCount;
+				long long episodeCount;
+				long long appleCount;
+				bool createdFlag;
+			} GymBenchResult;
+
+			// Step one gym with a random agent, the buffers and actions are made before the clock starts
+			void runGym(int envCount, int stepCount, unsigned int seed, GymBenchResult* result) {
+				SnakeGymConfig config;
+				config.envCount = envCount;
+				config.fieldWidth = BENCH_FIELD_WIDTH;
+				config.fieldHeight = BENCH_FIELD_HEIGHT;
+				config.startLength = BENCH_START_LENGTH;
+				config.maxEpisodeSteps = BENCH_MAX_EPISODE_STEPS;
+
+				std::vector<unsigned char> observations(snake_gym_observation_size(&config) * (size_t)envCount);
+				std::vector<float> rewards(envCount);
+				std::vector<unsigned char> terminated(envCount);
+				std::vector<unsigned char> truncated(envCount);
+				std::vector<int> actions(envCount);
+
+				SnakeGymBuffers buffers;
+				buffers.observations = observations.data();
+				buffers.rewards = rewards.data();
+				buffers.terminated = terminated.data();
+				buffers.truncated = truncated.data();
+
+				result->envStepCount = 0;
+				result->episodeCount = 0;
+				result->appleCount = 0;
+				result->createdFlag = false;
+
+				SnakeGym* gym = snake_gym_create(&config, &buffers);
+				if (gym == nullptr) {
+					return;
+				}
+				result->createdFlag = true;
+				snake_gym_reset(gym, seed);
+
+				// xorshift32, cheap enough not to show up next to the steps
+				unsigned int randomState = seed | 1u;
+				for (int stepIndex = 0; stepIndex < stepCount; stepIndex++) {
+					for (int envIndex = 0; envIndex < envCount; envIndex++) {
+						randomState ^= randomState << 13;
+						randomState ^= randomState >> 17;
+						randomState ^= randomState << 5;
+						bool turnFlag = (randomState & 7u) < BENCH_TURN_CHANCE;
+						actions[envIndex] = turnFlag ? (int)(SNAKE_GYM_ACTION_UP + ((randomState >> 3) % 4u)) : SNAKE_GYM_ACTION_NONE;
+					}
+
+					snake_gym_step(gym, actions.data());
+
+					for (int envIndex = 0; envIndex < envCount; envIndex++) {
+						result->episodeCount += (terminated[envIndex] | truncated[envIndex]);
+						result->appleCount += (rewards[envIndex] > 0.0f) ? 1 : 0;
+					}
+				}
+				result->envStepCount = (long long)envCount * (long long)stepCount;
+
+				snake_gym_destroy(gym);
+			}
+
+			// Run one gym per thread and print the combined steps per second
+			int run(int threadCount, int envCount, int stepCount) {
+				std::vector<GymBenchResult> results(threadCount);
+				std::vector<std::thread> threads;
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (int threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+					threads.emplace_back(runGym, envCount, stepCount, (unsigned int)(threadIndex + 1) * 7919u, &results[threadIndex]);
+				}
+				for (std::thread& thread : threads) {
+					thread.join();
+				}
+				double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				GymBenchResult total;
+				total.envStepCount = 0;
+				total.episodeCount = 0;
+				total.appleCount = 0;
+				for (const GymBenchResult& result : results) {
+					if (!result.createdFlag) {
+						fprintf(stderr, "The gym rejected its config\n");
+						return 1;
+					}
+					total.envStepCount += result.envStepCount;
+					total.episodeCount += result.episodeCount;
+					total.appleCount += result.appleCount;
+				}
+
+				double stepsPerSecond = (double)total.envStepCount / seconds;
+				printf("%d thread(s) x %d env(s) on %dx%d, %lld env steps in %.2f s\n",
+					threadCount, envCount, BENCH_FIELD_WIDTH, BENCH_FIELD_HEIGHT, total.envStepCount, seconds);
+				printf("%.0f env steps/s, %.0f per thread, %lld episode(s), %.1f steps/episode, %lld apple(s)\n",
+					stepsPerSecond, stepsPerSecond / (double)threadCount, total.episodeCount,
+					(total.episodeCount > 0) ? ((double)total.envStepCount / (double)total.episodeCount) : 0.0, total.appleCount);
+				return 0;
+			}
+
+			void printUsage() {
+				fprintf(stderr, "usage: snake-gym-bench [--threads <count>] [--envs <count>] [--steps <count>]\n");
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	int threadCount = 1;
+	int envCount = snake::GymBench::DEFAULT_ENV_COUNT;
+	int stepCount = snake::GymBench::DEFAULT_STEP_COUNT;
+
+	for (int argIndex = 1; argIndex < argc; argIndex++) {
+		if ((strcmp(argv[argIndex], "--threads") == 0) && (argIndex + 1 < argc)) {
+			threadCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--envs") == 0) && (argIndex + 1 < argc)) {
+			envCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--steps") == 0) && (argIndex + 1 < argc)) {
+			stepCount = atoi(argv[++argIndex]);
+		} else {
+			snake::GymBench::printUsage();
+			return 1;
+		}
+	}
+
+	if ((threadCount < 1) || (envCount < 1) || (stepCount < 1)) {
+		snake::GymBench::printUsage();
+		return 1;
+	}
+
+	return snake::GymBench::run(threadCount, envCount, stepCount);
+}
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "../src/includes/level.hpp"
+
+
+	namespace snake {
+
+		namespace LevelCompiler {
+
+			// Snake start of levels without a start line, where a quick game on an open field starts
+			const int DEFAULT_SNAKE_LENGTH = 3;
+
+			// Characters of the map and the tiles they stand for
+			const char GRASS_CHARACTER = '.';
+			const char SHRUB_CHARACTER = '#';
+			const char SPIKES_CHARACTER = '^';
+			const char RED_SPIKES_CHARACTER = '*';
+
+			// Read a whole text file into lines, without their line endings
+			bool readLines(const char* path, std::vector<std::string>& lines) {
+				FILE* file = fopen(path, "rb");
+				if (file == nullptr) {
+					return false;
+				}
+
+				std::string line;
+				int character;
+				while ((character = fgetc(file)) != EOF) {
+					if (character == '\n') {
+						lines.push_back(line);
+						line.clear();
+					} else if (character != '\r') {
+						line.push_back((char)character);
+					}
+				}
+				if (!line.empty()) {
+					lines.push_back(line);
+				}
+				fclose(file);
+				return true;
+			}
+
+			// Turn a direction name into a direction, NONE when it is not one
+			ObjectDirection parseDirection(const char* name) {
+				if (strcmp(name, "up") == 0) {
+					return ObjectDirection::UP;
+				} else if (strcmp(name, "right") == 0) {
+					return ObjectDirection::RIGHT;
+				} else if (strcmp(name, "down") == 0) {
+					return ObjectDirection::DOWN;
+				} else if (strcmp(name, "left") == 0) {
+					return ObjectDirection::LEFT;
+				}
+				return ObjectDirection::NONE;
+			}
+
+			// Turn a map character into a tile, returns false for characters that are not tiles
+			bool parseTile(char character, LevelTile& tile) {
+				switch (character) {
+				case GRASS_CHARACTER:
+					tile = LevelTile::GRASS;
+					return true;
+				case SHRUB_CHARACTER:
+					tile = LevelTile::SHRUB;
+					return true;
+				case SPIKES_CHARACTER:
+					tile = LevelTile::SPIKES;
+					return true;
+				case RED_SPIKES_CHARACTER:
+					tile = LevelTile::RED_SPIKES;
+					return true;
+				}
+				return false;
+			}
+
+			// Report an error at a line of the source, the way compilers do
+			int fail(const char* path, int lineNumber, const char* message) {
+				fprintf(stderr, "%s:%d: %s\n", path, lineNumber, message);
+				return 1;
+			}
+
+			// Compile a level source into a level file
+			int compile(const char* sourcePath, const char* outputPath) {
+				std::vector<std::string> lines;
+				if (!readLines(sourcePath, lines)) {
+					fprintf(stderr, "Could not read %s\n", sourcePath);
+					return 1;
+				}
+
+				// Settings come first, the map takes every line after the map line
+				SnakeStartDefn snakeStartDefn;
+				bool startFlag = false;
+				int startLineNumber = 0;
+				int mapLineIndex = -1;
+				for (int lineIndex = 0; (lineIndex < (int)lines.size()) && (mapLineIndex < 0); lineIndex++) {
+					const std::string& line = lines[lineIndex];
+					if (line.empty() || (line[0] == '#')) {
+						continue;
+					}
+
+					char directionName[16];
+					if (line == "map") {
+						mapLineIndex = lineIndex;
+					} else if (sscanf(line.c_str(), "start %d %d %15s %d", &snakeStartDefn.headPosition.x, &snakeStartDefn.headPosition.y, directionName, &snakeStartDefn.length) == 4) {
+						snakeStartDefn.facingDirection = parseDirection(directionName);
+						if (snakeStartDefn.facingDirection == ObjectDirection::NONE) {
+							return fail(sourcePath, lineIndex + 1, "start direction must be up, right, down or left");
+						}
+						startFlag = true;
+						startLineNumber = lineIndex + 1;
+					} else {
+						return fail(sourcePath, lineIndex + 1, "expected 'start <x> <y> <direction> <length>' or 'map'");
+					}
+				}
+				if (mapLineIndex < 0) {
+					return fail(sourcePath, (int)lines.size(), "no map");
+				}
+
+				// Every row of the map is as wide as the first
+				int firstRowIndex = mapLineIndex + 1;
+				sf::Vector2i fieldSize(0, (int)lines.size() - firstRowIndex);
+				if (fieldSize.y > 0) {
+					fieldSize.x = (int)lines[firstRowIndex].size();
+				}
+				if ((fieldSize.x < 8) || (fieldSize.y < 8)) {
+					return fail(sourcePath, mapLineIndex + 1, "the map must be at least 8x8");
+				}
+				if ((long long)fieldSize.x * (long long)fieldSize.y > LEVEL_MAX_CELL_COUNT) {
+					return fail(sourcePath, mapLineIndex + 1, "the map has too many cells");
+				}
+
+				std::vector<LevelTile> tiles((std::size_t)fieldSize.x * (std::size_t)fieldSize.y);
+				for (int y = 0; y < fieldSize.y; y++) {
+					const std::string& row = lines[firstRowIndex + y];
+					if ((int)row.size() != fieldSize.x) {
+						return fail(sourcePath, firstRowIndex + y + 1, "every map row must be as wide as the first");
+					}
+
+					for (int x = 0; x < fieldSize.x; x++) {
+						LevelTile& tile = tiles[(y * fieldSize.x) + x];
+						if (!parseTile(row[x], tile)) {
+							return fail(sourcePath, firstRowIndex + y + 1, "unknown tile, use . for grass, # for shrubs, ^ for spikes and * for red spikes");
+						}
+
+						// The engine treats the edge as a wall whatever the map says, so the map has to agree
+						bool edgeFlag = (x == 0) || (y == 0) || (x == fieldSize.x - 1) || (y == fieldSize.y - 1);
+						if (edgeFlag && (tile == LevelTile::GRASS)) {
+							return fail(sourcePath, firstRowIndex + y + 1, "the edge of the map must be blocked all the way round");
+						}
+					}
+				}
+
+				// Without a start line the snake starts where it does on an open field
+				if (!startFlag) {
+					snakeStartDefn.headPosition = sf::Vector2i(fieldSize.x / 2, (fieldSize.y * 2) / 5);
+					snakeStartDefn.facingDirection = ObjectDirection::DOWN;
+					snakeStartDefn.length = DEFAULT_SNAKE_LENGTH;
+					startLineNumber = mapLineIndex + 1;
+				}
+				if (snakeStartDefn.length < 2) {
+					return fail(sourcePath, startLineNumber, "the snake must start at least 2 long");
+				}
+
+				// The snake lies behind its head, every cell it covers has to be open
+				sf::Vector2i segmentPosition = snakeStartDefn.headPosition;
+				sf::Vector2i behindVector = sf::Vector2i(0, 0) - SnakeUtils::directionToVector(snakeStartDefn.facingDirection);
+				for (int segmentIndex = 0; segmentIndex < snakeStartDefn.length; segmentIndex++) {
+					bool insideFlag = (segmentPosition.x >= 0) && (segmentPosition.x < fieldSize.x) && (segmentPosition.y >= 0) && (segmentPosition.y < fieldSize.y);
+					if (!insideFlag || (tiles[(segmentPosition.y * fieldSize.x) + segmentPosition.x] != LevelTile::GRASS)) {
+						return fail(sourcePath, startLineNumber, "the snake starts on a blocked cell");
+					}
+					segmentPosition += behindVector;
+				}
+
+				int openCellCount = 0;
+				for (const LevelTile& tile : tiles) {
+					openCellCount += (tile == LevelTile::GRASS) ? 1 : 0;
+				}
+				if (openCellCount <= snakeStartDefn.length) {
+					return fail(sourcePath, mapLineIndex + 1, "the map leaves no room for an apple");
+				}
+
+				if (!LevelUtils::saveLevel(outputPath, fieldSize, snakeStartDefn, tiles.data())) {
+					fprintf(stderr, "Could not write %s\n", outputPath);
+					return 1;
+				}
+				printf("%s: %dx%d, %d open cell(s)\n", outputPath, fieldSize.x, fieldSize.y, openCellCount);
+				return 0;
+			}
+
+			void printUsage() {
+				fprintf(stderr, "usage: snake-level-compiler <level source> <level file>\n");
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		snake::LevelCompiler::printUsage();
+		return 1;
+	}
+
+	return snake::LevelCompiler::compile(argv[1], argv[2]);
+}
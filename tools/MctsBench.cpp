@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include "../src/includes/alloctracker.hpp"
+#include "../src/includes/autopilot.hpp"
+#include "../src/includes/mctsbot.hpp"
+
+
+	namespace snake {
+
+		namespace MctsBench {
+
+			// Settings of the benchmarked games, the same as a quick game started from the menu
+			const sf::Vector2i BENCH_FIELD_SIZE = sf::Vector2i(50, 25);
+			const float BENCH_SNAKE_SPEED = 10.0f;
+			const sf::Vector2i BENCH_SNAKE_START = sf::Vector2i(25, 10);
+			const int BENCH_SNAKE_LENGTH = 3;
+
+			// Boards searched from, taken every BENCH_POSITION_FRAMES of an autopilot game so short and long snakes are both measured
+			const int BENCH_POSITION_COUNT = 8;
+			const int BENCH_POSITION_FRAMES = 600;
+
+			// Search settings, the NORMAL tier's apart from the worker count
+			const int DEFAULT_SEARCHES_PER_POSITION = 4;
+			const std::int64_t DEFAULT_BUDGET_MICROSECONDS = 6000;
+			const int BENCH_NODE_CAPACITY = 1 << 18;
+			const int BENCH_ROLLOUT_DEPTH = 40;
+			const float BENCH_EXPLORATION = 0.7f;
+
+			// Fill the boards to search from by letting the autopilot play one game
+			int preparePositions(QuickGame** positions) {
+				QuickGameDefn gameDefn;
+				gameDefn.fieldSize = BENCH_FIELD_SIZE;
+				gameDefn.snakeSpeedTilesPerSecond = BENCH_SNAKE_SPEED;
+				gameDefn.snakeStartDefn.headPosition = BENCH_SNAKE_START;
+				gameDefn.snakeStartDefn.facingDirection = ObjectDirection::DOWN;
+				gameDefn.snakeStartDefn.length = BENCH_SNAKE_LENGTH;
+				gameDefn.randomSeed = 1;
+
+				QuickGame game(&gameDefn);
+				Autopilot autopilot(0);
+
+				int result = 0;
+				while (result < BENCH_POSITION_COUNT) {
+					QuickGameInputRequest input = autopilot.resolveInput(game);
+					QuickGameUpdateResult updateResult = game.update(&input);
+					if (updateResult.snakeHitBarrierFlag || game.getFieldFull()) {
+						break;
+					}
+
+					if ((game.getFrameCount() % BENCH_POSITION_FRAMES) == 0) {
+						positions[result] = new QuickGame(&gameDefn);
+						positions[result]->copyFrom(game);
+						result++;
+					}
+				}
+
+				return result;
+			}
+
+			// Search every board with one worker count and print the throughput, returning the allocations the searches made
+			long long runWorkerCount(int workerCount, QuickGame** positions, int positionCount, int searchesPerPosition, std::int64_t budgetMicroseconds) {
+				MctsBotSettings settings;
+				settings.workerCount = workerCount;
+				settings.moveBudgetMicroseconds = budgetMicroseconds;
+				settings.nodeCapacity = BENCH_NODE_CAPACITY;
+				settings.rolloutDepth = BENCH_ROLLOUT_DEPTH;
+				settings.exploration = BENCH_EXPLORATION;
+
+				MctsBot bot(settings);
+
+				// The first search on a field size makes the workers' scratch games, after that nothing may allocate
+				bot.search(*positions[0]);
+				bot.resetStats();
+
+				long long allocationsBefore = AllocationTracker::getProcessAllocationCount();
+				for (int positionIndex = 0; positionIndex < positionCount; positionIndex++) {
+					for (int searchIndex = 0; searchIndex < searchesPerPosition; searchIndex++) {
+						bot.search(*positions[positionIndex]);
+					}
+				}
+				long long result = AllocationTracker::getProcessAllocationCount() - allocationsBefore;
+
+				const MctsBotStats& stats = bot.getStats();
+				double rolloutsPerSecond = (double)stats.rolloutCount / stats.searchSeconds;
+				printf("%2d worker(s)  %9.0f rollouts/s  %8.0f rollouts/s per core  %6.1f rollout moves/rollout  %6.0f rollouts/search  %5.1f%% tasks stolen  %lld allocation(s)\n",
+					workerCount, rolloutsPerSecond, rolloutsPerSecond / (double)workerCount,
+					(double)stats.rolloutMoveCount / (double)stats.rolloutCount,
+					(double)stats.rolloutCount / (double)stats.searchCount,
+					(stats.taskCount > 0) ? ((100.0 * (double)stats.stolenTaskCount) / (double)stats.taskCount) : 0.0,
+					result);
+
+				return result;
+			}
+
+			// Measure from one worker up to one per hardware thread, doubling each time
+			int run(int maxWorkerCount, int searchesPerPosition, std::int64_t budgetMicroseconds) {
+				QuickGame* positions[BENCH_POSITION_COUNT];
+				int positionCount = preparePositions(positions);
+				if (positionCount == 0) {
+					fprintf(stderr, "The autopilot game ended before the first board was taken\n");
+					return 1;
+				}
+
+				printf("%d board(s) from a %dx%d game, %d search(es) of %lld us each\n",
+					positionCount, BENCH_FIELD_SIZE.x, BENCH_FIELD_SIZE.y, searchesPerPosition, (long long)budgetMicroseconds);
+
+				long long allocationTotal = 0;
+				for (int workerCount = 1; ; workerCount *= 2) {
+					if (workerCount > maxWorkerCount) {
+						workerCount = maxWorkerCount;
+					}
+					allocationTotal += runWorkerCount(workerCount, positions, positionCount, searchesPerPosition, budgetMicroseconds);
+					if (workerCount == maxWorkerCount) {
+						break;
+					}
+				}
+
+				for (int positionIndex = 0; positionIndex < positionCount; positionIndex++) {
+					delete positions[positionIndex];
+				}
+
+				// Rollouts have to run allocation free, so any allocation fails the benchmark
+				if (allocationTotal > 0) {
+					fprintf(stderr, "Searches allocated %lld time(s)\n", allocationTotal);
+					return 1;
+				}
+				return 0;
+			}
+
+			void printUsage() {
+				fprintf(stderr, "usage: snake-mcts-bench [--workers <count>] [--searches <count>] [--budget <microseconds>]\n");
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	int maxWorkerCount = (int)std::thread::hardware_concurrency();
+	if (maxWorkerCount < 1) {
+		maxWorkerCount = 1;
+	}
+	int searchesPerPosition = snake::MctsBench::DEFAULT_SEARCHES_PER_POSITION;
+	std::int64_t budgetMicroseconds = snake::MctsBench::DEFAULT_BUDGET_MICROSECONDS;
+
+	for (int argIndex = 1; argIndex < argc; argIndex++) {
+		if ((strcmp(argv[argIndex], "--workers") == 0) && (argIndex + 1 < argc)) {
+			maxWorkerCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--searches") == 0) && (argIndex + 1 < argc)) {
+			searchesPerPosition = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--budget") == 0) && (argIndex + 1 < argc)) {
+			budgetMicroseconds = atoll(argv[++argIndex]);
+		} else {
+			snake::MctsBench::printUsage();
+			return 1;
+		}
+	}
+
+	if ((maxWorkerCount < 1) || (searchesPerPosition < 1) || (budgetMicroseconds < 1)) {
+		snake::MctsBench::printUsage();
+		return 1;
+	}
+
+	return snake::MctsBench::run(maxWorkerCount, searchesPerPosition, budgetMicroseconds);
+}
@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include "../src/includes/netclient.hpp"
+#include "../src/includes/netserver.hpp"
+
+
+	namespace snake {
+
+		namespace NetTool {
+
+			// Default arena, a field shared by the players and enough bots to keep it busy
+			const sf::Vector2i DEFAULT_FIELD_SIZE = sf::Vector2i(256, 256);
+			const int DEFAULT_PLAYER_COUNT = 64;
+			const int DEFAULT_BOT_COUNT = 960;
+			const int DEFAULT_TICK_RATE = 20;
+			const int DEFAULT_BENCH_TICK_COUNT = 600;
+			const int DEFAULT_REGION_COUNT = 16;
+			const unsigned int DEFAULT_SEED = 1;
+
+			// Snakes start short, and every snake brings one apple onto the field
+			const int NET_SNAKE_START_LENGTH = 4;
+			const int NET_SNAKE_MAX_LENGTH = 64;
+			const int NET_RESPAWN_DELAY_TICKS = 20;
+			// Ticks between deltas carrying the state hash, and seconds a client may stay quiet before it is dropped
+			const int NET_HASH_INTERVAL_TICKS = 60;
+			const int NET_CLIENT_TIMEOUT_SECONDS = 5;
+			// Ticks the benchmark plays before measuring, for every client to be welcomed and take its keyframe
+			const int NET_BENCH_JOIN_TICKS = 20;
+
+			// Struct for the options the tool was started with
+			typedef struct Snake_NetToolOptions {
+				NetServerSettings serverSettings;
+				sf::IpAddress host;
+				int tickRate;
+				//ticks to run for, 0 runs until stopped
+				int tickCount;
+				int clientCount;
+			} NetToolOptions;
+
+			// Steer a snake straight on while that is free, otherwise into whichever side is, the way a client that sees only its replica can
+			ObjectDirection resolveClientDirection(const ArenaReplica& replica, int snakeIndex) {
+				if (!replica.getSnakeAlive(snakeIndex)) {
+					return ObjectDirection::NONE;
+				}
+
+				const ObjectDirection clockwiseDirections[] = { ObjectDirection::UP, ObjectDirection::RIGHT, ObjectDirection::DOWN, ObjectDirection::LEFT };
+				int forward = NetUtils::encodeDirection(replica.getSnakeDirection(snakeIndex));
+				sf::Vector2i headPosition = replica.getSnakeCell(snakeIndex, 0);
+				const int turns[] = { 0, 1, 3 };
+				for (int turn : turns) {
+					ObjectDirection direction = clockwiseDirections[(forward + turn) % 4];
+					if (!replica.getCellBlocked(headPosition + SnakeUtils::directionToVector(direction))) {
+						return direction;
+					}
+				}
+				return replica.getSnakeDirection(snakeIndex);
+			}
+
+			// Let a client's bot pick its next turn and send it when it changes the snake's direction
+			void steerClient(NetClient& client) {
+				if (!client.isSynced()) {
+					return;
+				}
+				const ArenaReplica& replica = client.getReplica();
+				ObjectDirection direction = resolveClientDirection(replica, client.getSnakeIndex());
+				if ((direction != ObjectDirection::NONE) && (direction != replica.getSnakeDirection(client.getSnakeIndex()))) {
+					client.sendInput(direction);
+				}
+			}
+
+			// Run a server at the tick rate, printing what it sent every second
+			int runServer(const NetToolOptions& options) {
+				NetServer server(options.serverSettings);
+				if (!server.start()) {
+					fprintf(stderr, "Could not listen on port %u\n", (unsigned int)options.serverSettings.port);
+					return 1;
+				}
+
+				const ArenaGameDefn& defn = options.serverSettings.arenaDefn;
+				printf("Listening on port %u: %d player(s) and %d bot(s) on %dx%d at %d ticks/s\n",
+					(unsigned int)server.getPort(), defn.playerSnakeCount, defn.snakeCount - defn.playerSnakeCount, defn.fieldSize.x, defn.fieldSize.y, options.tickRate);
+
+				std::chrono::steady_clock::duration tickDuration = std::chrono::nanoseconds(1000000000LL / options.tickRate);
+				std::chrono::steady_clock::time_point nextTick = std::chrono::steady_clock::now();
+				long long secondBytes = 0;
+				double secondSeconds = 0.0;
+				int secondTicks = 0;
+				for (int tickIndex = 0; (options.tickCount == 0) || (tickIndex < options.tickCount); tickIndex++) {
+					NetServerTickStats stats = server.tick();
+					secondBytes += stats.sentBytes;
+					secondSeconds += stats.tickSeconds;
+					secondTicks++;
+					if (secondTicks == options.tickRate) {
+						printf("tick %d: %d client(s), %d snake(s) alive, %.1f kB/s sent, %.3f ms/tick\n",
+							stats.tick, stats.clientCount, server.getArena().getAliveSnakeCount(), (double)secondBytes / 1000.0, secondSeconds * 1000.0 / (double)secondTicks);
+						fflush(stdout);
+						secondBytes = 0;
+						secondSeconds = 0.0;
+						secondTicks = 0;
+					}
+
+					nextTick += tickDuration;
+					std::this_thread::sleep_until(nextTick);
+				}
+
+				server.stop();
+				return 0;
+			}
+
+			// Join a server and play with the replica's bot until the ticks are done or the server goes
+			int runClient(const NetToolOptions& options) {
+				NetClient client;
+				if (!client.connect(options.host, options.serverSettings.port)) {
+					fprintf(stderr, "Could not bind a port\n");
+					return 1;
+				}
+
+				bool welcomedFlag = false;
+				while (!client.isClosed() && ((options.tickCount == 0) || (client.getStats().appliedTickCount < options.tickCount))) {
+					if (client.poll() > 0) {
+						steerClient(client);
+					}
+					if (!welcomedFlag && client.isWelcomed()) {
+						const NetArenaShape& shape = client.getReplica().getShape();
+						printf("Joined as snake %d of %d on %dx%d\n", client.getSnakeIndex(), shape.snakeCount, shape.fieldSize.x, shape.fieldSize.y);
+						welcomedFlag = true;
+					}
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+				if (!welcomedFlag) {
+					fprintf(stderr, "The server turned the client away\n");
+					return 1;
+				}
+				client.disconnect();
+
+				const NetClientStats& stats = client.getStats();
+				printf("%d tick(s) applied, %d keyframe(s), %d resync(s), %lld bytes received (%.1f per tick)\n",
+					stats.appliedTickCount, stats.keyframeCount, stats.resyncCount, stats.receivedBytes,
+					(stats.appliedTickCount > 0) ? (double)stats.receivedBytes / (double)stats.appliedTickCount : 0.0);
+				printf("%d hash check(s), %d mismatch(es)\n", stats.hashCheckCount, stats.hashMismatchCount);
+				return (stats.hashMismatchCount > 0) ? 1 : 0;
+			}
+
+			// Play a server and every client in one thread over loopback, each tick serving, then letting every client read and steer,
+			// and fail when a client ends on a board other than the server's
+			int runBench(const NetToolOptions& options) {
+				NetServerSettings settings = options.serverSettings;
+				settings.port = sf::Socket::AnyPort;
+				settings.arenaDefn.playerSnakeCount = options.clientCount;
+				NetServer server(settings);
+				if (!server.start()) {
+					fprintf(stderr, "Could not bind a port for the server\n");
+					return 1;
+				}
+
+				NetClient* clients = new NetClient[options.clientCount];
+				for (int clientIndex = 0; clientIndex < options.clientCount; clientIndex++) {
+					if (!clients[clientIndex].connect(sf::IpAddress::LocalHost, server.getPort())) {
+						fprintf(stderr, "Could not bind a port for client %d\n", clientIndex);
+						delete[] clients;
+						return 1;
+					}
+				}
+
+				const ArenaGameDefn& defn = settings.arenaDefn;
+				printf("%d client(s) and %d bot(s) on %dx%d, %d tick(s) over loopback\n",
+					options.clientCount, defn.snakeCount - options.clientCount, defn.fieldSize.x, defn.fieldSize.y, options.tickCount);
+
+				long long deltaBytes = 0;
+				long long deltaParts = 0;
+				long long sentBytes = 0;
+				int keyframeCount = 0;
+				double tickSeconds = 0.0;
+				double simulationSeconds = 0.0;
+				double slowestTickSeconds = 0.0;
+				for (int tickIndex = -NET_BENCH_JOIN_TICKS; tickIndex < options.tickCount; tickIndex++) {
+					NetServerTickStats stats = server.tick();
+					for (int clientIndex = 0; clientIndex < options.clientCount; clientIndex++) {
+						if (clients[clientIndex].poll() > 0) {
+							steerClient(clients[clientIndex]);
+						}
+					}
+					if (tickIndex < 0) {
+						continue;
+					}
+
+					deltaBytes += stats.deltaBytes;
+					deltaParts += stats.deltaPartCount;
+					sentBytes += stats.sentBytes;
+					keyframeCount += stats.keyframeCount;
+					tickSeconds += stats.tickSeconds;
+					simulationSeconds += stats.simulationSeconds;
+					slowestTickSeconds = (stats.tickSeconds > slowestTickSeconds) ? stats.tickSeconds : slowestTickSeconds;
+				}
+
+				double tickCount = (double)options.tickCount;
+				printf("delta: %.1f bytes/tick per client in %.2f datagram(s), %.1f kB/tick to all %d client(s), %d keyframe(s) resent\n",
+					(double)deltaBytes / tickCount, (double)deltaParts / tickCount, (double)sentBytes / tickCount / 1000.0, server.getClientCount(), keyframeCount);
+				printf("server tick: %.3f ms average, %.3f ms slowest, of which %.3f ms simulating\n",
+					tickSeconds * 1000.0 / tickCount, slowestTickSeconds * 1000.0, simulationSeconds * 1000.0 / tickCount);
+
+				// Every client saw the last tick's delta, so its replica has to hash like the arena does now
+				std::uint64_t stateHash = server.getArena().computeStateHash();
+				int result = 0;
+				int hashCheckCount = 0;
+				int resyncCount = 0;
+				for (int clientIndex = 0; clientIndex < options.clientCount; clientIndex++) {
+					NetClient& client = clients[clientIndex];
+					const NetClientStats& stats = client.getStats();
+					hashCheckCount += stats.hashCheckCount;
+					resyncCount += stats.resyncCount;
+					if (!client.isSynced() || (client.getAppliedTick() != server.getArena().getTickCount()) || (client.getReplica().computeStateHash() != stateHash)) {
+						fprintf(stderr, "Client %d ended on a different board than the server\n", clientIndex);
+						result = 1;
+					}
+					if (stats.hashMismatchCount > 0) {
+						fprintf(stderr, "Client %d failed %d hash check(s)\n", clientIndex, stats.hashMismatchCount);
+						result = 1;
+					}
+					client.disconnect();
+				}
+				printf("%d hash check(s) passed, %d resync(s)\n", hashCheckCount, resyncCount);
+
+				server.stop();
+				delete[] clients;
+				return result;
+			}
+
+			void printUsage() {
+				fprintf(stderr, "usage: snake-net server [--port <port>] [--field <width>x<height>] [--players <count>] [--bots <count>]\n");
+				fprintf(stderr, "                        [--tick-rate <ticks per second>] [--ticks <count>] [--workers <count>] [--seed <seed>]\n");
+				fprintf(stderr, "       snake-net client [--host <address>] [--port <port>] [--ticks <count>]\n");
+				fprintf(stderr, "       snake-net bench [--clients <count>] [--field <width>x<height>] [--bots <count>] [--ticks <count>]\n");
+				fprintf(stderr, "                       [--workers <count>] [--seed <seed>]\n");
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		snake::NetTool::printUsage();
+		return 1;
+	}
+	const char* command = argv[1];
+	bool benchFlag = strcmp(command, "bench") == 0;
+
+	snake::NetTool::NetToolOptions options;
+	snake::ArenaGameDefn& defn = options.serverSettings.arenaDefn;
+	defn.fieldSize = snake::NetTool::DEFAULT_FIELD_SIZE;
+	defn.playerSnakeCount = snake::NetTool::DEFAULT_PLAYER_COUNT;
+	int botCount = snake::NetTool::DEFAULT_BOT_COUNT;
+	defn.snakeStartLength = snake::NetTool::NET_SNAKE_START_LENGTH;
+	defn.snakeMaxLength = snake::NetTool::NET_SNAKE_MAX_LENGTH;
+	defn.respawnDelayTicks = snake::NetTool::NET_RESPAWN_DELAY_TICKS;
+	defn.regionCount = snake::NetTool::DEFAULT_REGION_COUNT;
+	defn.randomSeed = snake::NetTool::DEFAULT_SEED;
+	defn.workerCount = (int)std::thread::hardware_concurrency();
+	if (defn.workerCount < 1) {
+		defn.workerCount = 1;
+	}
+	options.serverSettings.port = snake::NET_DEFAULT_PORT;
+	options.serverSettings.hashIntervalTicks = snake::NetTool::NET_HASH_INTERVAL_TICKS;
+	options.host = sf::IpAddress::LocalHost;
+	options.tickRate = snake::NetTool::DEFAULT_TICK_RATE;
+	options.tickCount = benchFlag ? snake::NetTool::DEFAULT_BENCH_TICK_COUNT : 0;
+	options.clientCount = snake::NetTool::DEFAULT_PLAYER_COUNT;
+
+	for (int argIndex = 2; argIndex < argc; argIndex++) {
+		if ((strcmp(argv[argIndex], "--port") == 0) && (argIndex + 1 < argc)) {
+			options.serverSettings.port = (unsigned short)atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--host") == 0) && (argIndex + 1 < argc)) {
+			options.host = sf::IpAddress(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--field") == 0) && (argIndex + 1 < argc)) {
+			if (sscanf(argv[++argIndex], "%dx%d", &defn.fieldSize.x, &defn.fieldSize.y) != 2) {
+				snake::NetTool::printUsage();
+				return 1;
+			}
+		} else if ((strcmp(argv[argIndex], "--players") == 0) && (argIndex + 1 < argc)) {
+			defn.playerSnakeCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--clients") == 0) && (argIndex + 1 < argc)) {
+			options.clientCount = atoi(argv[++argIndex]);
+			defn.playerSnakeCount = options.clientCount;
+		} else if ((strcmp(argv[argIndex], "--bots") == 0) && (argIndex + 1 < argc)) {
+			botCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--tick-rate") == 0) && (argIndex + 1 < argc)) {
+			options.tickRate = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--ticks") == 0) && (argIndex + 1 < argc)) {
+			options.tickCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--workers") == 0) && (argIndex + 1 < argc)) {
+			defn.workerCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--seed") == 0) && (argIndex + 1 < argc)) {
+			defn.randomSeed = (unsigned int)strtoul(argv[++argIndex], nullptr, 10);
+		} else {
+			snake::NetTool::printUsage();
+			return 1;
+		}
+	}
+	defn.snakeCount = defn.playerSnakeCount + botCount;
+	defn.appleCount = defn.snakeCount;
+	options.serverSettings.clientTimeoutTicks = snake::NetTool::NET_CLIENT_TIMEOUT_SECONDS * options.tickRate;
+	if (options.serverSettings.clientTimeoutTicks < 4 * snake::NET_KEEPALIVE_TICKS) {
+		options.serverSettings.clientTimeoutTicks = 4 * snake::NET_KEEPALIVE_TICKS;
+	}
+
+	bool validFlag =
+		(defn.playerSnakeCount >= 1) && (botCount >= 0) && (defn.snakeCount <= 0xFFFF) && (options.tickRate >= 1) && (options.tickCount >= 0) &&
+		(defn.workerCount >= 1) && (defn.fieldSize.x >= 8) && (defn.fieldSize.y >= 8) && (options.host != sf::IpAddress::None);
+	if (!validFlag) {
+		snake::NetTool::printUsage();
+		return 1;
+	}
+
+	if (strcmp(command, "server") == 0) {
+		return snake::NetTool::runServer(options);
+	} else if (strcmp(command, "client") == 0) {
+		return snake::NetTool::runClient(options);
+	} else if (benchFlag && (options.tickCount >= 1)) {
+		return snake::NetTool::runBench(options);
+	}
+	snake::NetTool::printUsage();
+	return 1;
+}
@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include "../src/includes/alloctracker.hpp"
+#include "../src/includes/neuroevolution.hpp"
+
+
+	namespace snake {
+
+		namespace NeuroTrainer {
+
+			// Default training settings, small enough for a generation to take a fraction of a second on one core
+			const int DEFAULT_GENERATION_COUNT = 50;
+			const int DEFAULT_POPULATION_SIZE = 128;
+			const int DEFAULT_GAMES_PER_GENOME = 4;
+			const int DEFAULT_ELITE_COUNT = 8;
+			const float DEFAULT_MUTATION_RATE = 0.1f;
+			const float DEFAULT_MUTATION_STRENGTH = 0.3f;
+			const sf::Vector2i DEFAULT_FIELD_SIZE = sf::Vector2i(30, 20);
+			const unsigned int DEFAULT_SEED = 1;
+			const char* const DEFAULT_CHECKPOINT_PATH = "checkpoints/neuro.snkn";
+			const int DEFAULT_CHECKPOINT_EVERY = 10;
+
+			// Smallest field the inputs make sense on
+			const int MIN_FIELD_SIZE = 8;
+
+			// Struct for the options the trainer was started with
+			typedef struct Snake_NeuroTrainerOptions {
+				int generationCount;
+				int checkpointEvery;
+				const char* checkpointPath;
+				bool resumeFlag;
+			} NeuroTrainerOptions;
+
+			// Save a checkpoint next to its final path first, so a crash while writing never leaves a truncated one
+			bool saveCheckpoint(const NeuroEvolution& evolution, const char* path) {
+				std::filesystem::path checkpointPath(path);
+				if (checkpointPath.has_parent_path()) {
+					std::error_code error;
+					std::filesystem::create_directories(checkpointPath.parent_path(), error);
+				}
+
+				std::string temporaryPath = std::string(path) + ".tmp";
+				if (!evolution.saveCheckpoint(temporaryPath.c_str())) {
+					return false;
+				}
+
+				std::error_code error;
+				std::filesystem::rename(temporaryPath, checkpointPath, error);
+				return !error;
+			}
+
+			// Train for the requested generations, printing each one and saving checkpoints along the way
+			int run(const NeuroEvolutionSettings& settings, const NeuroTrainerOptions& options) {
+				NeuroEvolution evolution(settings);
+
+				if (options.resumeFlag) {
+					if (!evolution.loadCheckpoint(options.checkpointPath)) {
+						fprintf(stderr, "Could not resume from %s, it is missing or was saved with another seed or population size\n", options.checkpointPath);
+						return 1;
+					}
+					printf("resumed from %s at generation %d\n", options.checkpointPath, evolution.getGeneration());
+				}
+
+				printf("%d genome(s) x %d game(s) on %dx%d, %d worker(s), seed %u\n",
+					settings.populationSize, settings.gamesPerGenome, settings.fieldSize.x, settings.fieldSize.y, settings.workerCount, settings.seed);
+
+				double totalSeconds = 0.0;
+				long long allocationTotal = 0;
+				for (int generationIndex = 0; generationIndex < options.generationCount; generationIndex++) {
+					long long allocationsBefore = AllocationTracker::getProcessAllocationCount();
+					NeuroGenerationStats stats = evolution.runGeneration();
+					allocationTotal += AllocationTracker::getProcessAllocationCount() - allocationsBefore;
+					totalSeconds += stats.evaluationSeconds;
+
+					printf("generation %4d  best %7.3f  mean %7.3f  best apples %6.2f  %.3f s\n",
+						stats.generation, stats.bestFitness, stats.meanFitness, stats.bestMeanApples, stats.evaluationSeconds);
+
+					bool lastFlag = (generationIndex + 1 == options.generationCount);
+					if ((options.checkpointEvery > 0) && (lastFlag || ((evolution.getGeneration() % options.checkpointEvery) == 0))) {
+						if (!saveCheckpoint(evolution, options.checkpointPath)) {
+							fprintf(stderr, "Could not write the checkpoint %s\n", options.checkpointPath);
+							return 1;
+						}
+					}
+				}
+
+				if (totalSeconds > 0.0) {
+					printf("%.1f generations/min, %.0f games/s\n",
+						(double)options.generationCount * 60.0 / totalSeconds,
+						(double)options.generationCount * settings.populationSize * settings.gamesPerGenome / totalSeconds);
+				}
+
+				// Generations are meant to run allocation free, so any allocation fails the run
+				if (allocationTotal > 0) {
+					fprintf(stderr, "Generations allocated %lld time(s)\n", allocationTotal);
+					return 1;
+				}
+				return 0;
+			}
+
+			void printUsage() {
+				fprintf(stderr, "usage: snake-neuro-trainer [--generations <count>] [--population <count>] [--games <count>] [--workers <count>]\n");
+				fprintf(stderr, "                           [--field <width>x<height>] [--seed <seed>] [--checkpoint <path>] [--checkpoint-every <generations>] [--resume]\n");
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	snake::NeuroEvolutionSettings settings;
+	settings.populationSize = snake::NeuroTrainer::DEFAULT_POPULATION_SIZE;
+	settings.gamesPerGenome = snake::NeuroTrainer::DEFAULT_GAMES_PER_GENOME;
+	settings.eliteCount = snake::NeuroTrainer::DEFAULT_ELITE_COUNT;
+	settings.mutationRate = snake::NeuroTrainer::DEFAULT_MUTATION_RATE;
+	settings.mutationStrength = snake::NeuroTrainer::DEFAULT_MUTATION_STRENGTH;
+	settings.fieldSize = snake::NeuroTrainer::DEFAULT_FIELD_SIZE;
+	settings.seed = snake::NeuroTrainer::DEFAULT_SEED;
+	settings.workerCount = (int)std::thread::hardware_concurrency();
+	if (settings.workerCount < 1) {
+		settings.workerCount = 1;
+	}
+
+	snake::NeuroTrainer::NeuroTrainerOptions options;
+	options.generationCount = snake::NeuroTrainer::DEFAULT_GENERATION_COUNT;
+	options.checkpointEvery = snake::NeuroTrainer::DEFAULT_CHECKPOINT_EVERY;
+	options.checkpointPath = snake::NeuroTrainer::DEFAULT_CHECKPOINT_PATH;
+	options.resumeFlag = false;
+
+	for (int argIndex = 1; argIndex < argc; argIndex++) {
+		if ((strcmp(argv[argIndex], "--generations") == 0) && (argIndex + 1 < argc)) {
+			options.generationCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--population") == 0) && (argIndex + 1 < argc)) {
+			settings.populationSize = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--games") == 0) && (argIndex + 1 < argc)) {
+			settings.gamesPerGenome = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--workers") == 0) && (argIndex + 1 < argc)) {
+			settings.workerCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--field") == 0) && (argIndex + 1 < argc)) {
+			if (sscanf(argv[++argIndex], "%dx%d", &settings.fieldSize.x, &settings.fieldSize.y) != 2) {
+				snake::NeuroTrainer::printUsage();
+				return 1;
+			}
+		} else if ((strcmp(argv[argIndex], "--seed") == 0) && (argIndex + 1 < argc)) {
+			settings.seed = (unsigned int)strtoul(argv[++argIndex], nullptr, 10);
+		} else if ((strcmp(argv[argIndex], "--checkpoint") == 0) && (argIndex + 1 < argc)) {
+			options.checkpointPath = argv[++argIndex];
+		} else if ((strcmp(argv[argIndex], "--checkpoint-every") == 0) && (argIndex + 1 < argc)) {
+			options.checkpointEvery = atoi(argv[++argIndex]);
+		} else if (strcmp(argv[argIndex], "--resume") == 0) {
+			options.resumeFlag = true;
+		} else {
+			snake::NeuroTrainer::printUsage();
+			return 1;
+		}
+	}
+
+	if (settings.eliteCount > settings.populationSize) {
+		settings.eliteCount = settings.populationSize;
+	}
+	bool validFlag =
+		(options.generationCount >= 1) && (options.checkpointEvery >= 0) &&
+		(settings.populationSize >= 2) && (settings.gamesPerGenome >= 1) && (settings.workerCount >= 1) &&
+		(settings.fieldSize.x >= snake::NeuroTrainer::MIN_FIELD_SIZE) && (settings.fieldSize.y >= snake::NeuroTrainer::MIN_FIELD_SIZE);
+	if (!validFlag) {
+		snake::NeuroTrainer::printUsage();
+		return 1;
+	}
+
+	return snake::NeuroTrainer::run(settings, options);
+}
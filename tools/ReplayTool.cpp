@@ -0,0 +1,385 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "../src/includes/fixedfieldgame.hpp"
+#include "../src/includes/replay.hpp"
+
+
+	namespace snake {
+
+		namespace ReplayTool {
+
+			// Settings of the games in a generated corpus, the same as a quick game started from the menu
+			const sf::Vector2i CORPUS_FIELD_SIZE = sf::Vector2i(50, 25);
+			const float CORPUS_SNAKE_SPEED = 10.0f;
+			const sf::Vector2i CORPUS_SNAKE_START = sf::Vector2i(25, 10);
+			const int CORPUS_SNAKE_LENGTH = 3;
+
+			// Longest generated game, ten minutes at 60 frames per second
+			const int CORPUS_MAX_FRAMES = 60 * 60 * 10;
+
+			// Seeks made when no frames are given, spread evenly over the replay
+			const int SEEK_SAMPLE_COUNT = 64;
+
+			// Directions the autopilot chooses between
+			const ObjectDirection MOVE_DIRECTIONS[] = { ObjectDirection::UP, ObjectDirection::RIGHT, ObjectDirection::DOWN, ObjectDirection::LEFT };
+
+			// Scratch memory for the flood fill, reused across calls
+			typedef struct Snake_FloodFillScratch {
+				std::vector<unsigned char> visited;
+				std::vector<sf::Vector2i> frontier;
+			} FloodFillScratch;
+
+			// Check whether a cell is inside the walls of the field
+			bool isInterior(sf::Vector2i fieldSize, sf::Vector2i position) {
+				return (position.x > 0) && (position.x < fieldSize.x - 1) && (position.y > 0) && (position.y < fieldSize.y - 1);
+			}
+
+			// Count the free cells reachable from a cell, stopping once limit cells have been found
+			int countReachableCells(QuickGame& game, sf::Vector2i start, int limit, FloodFillScratch& scratch) {
+				sf::Vector2i fieldSize = game.getFieldSize();
+				Snake* snake = game.getSnake();
+
+				scratch.visited.assign(fieldSize.x * fieldSize.y, 0);
+				scratch.frontier.clear();
+				scratch.frontier.push_back(start);
+				scratch.visited[(start.y * fieldSize.x) + start.x] = 1;
+
+				int result = 0;
+				while ((!scratch.frontier.empty()) && (result < limit)) {
+					sf::Vector2i position = scratch.frontier.back();
+					scratch.frontier.pop_back();
+					result++;
+
+					for (ObjectDirection direction : MOVE_DIRECTIONS) {
+						sf::Vector2i neighbour = position + SnakeUtils::directionToVector(direction);
+						int neighbourIndex = (neighbour.y * fieldSize.x) + neighbour.x;
+						if (!isInterior(fieldSize, neighbour) || scratch.visited[neighbourIndex] || snake->occupiesPosition(neighbour)) {
+							continue;
+						}
+						scratch.visited[neighbourIndex] = 1;
+						scratch.frontier.push_back(neighbour);
+					}
+				}
+
+				return result;
+			}
+
+			// Pick the safe move with the most room, breaking ties by distance to the apple
+			ObjectDirection chooseDirection(QuickGame& game, FloodFillScratch& scratch) {
+				Snake* snake = game.getSnake();
+				SnakeSegment head = snake->getHead();
+				sf::Vector2i applePosition = game.getApplePosition();
+				int roomNeeded = snake->getLength() + 2;
+
+				ObjectDirection result = head.enterDirection;
+				int bestRoom = -1;
+				int bestDistance = 0;
+				for (ObjectDirection direction : MOVE_DIRECTIONS) {
+					if (!snake->isValidMovementDirection(direction)) {
+						continue;
+					}
+
+					sf::Vector2i next = head.position + SnakeUtils::directionToVector(direction);
+					if (!isInterior(game.getFieldSize(), next) || snake->bodyOccupiesPosition(next)) {
+						continue;
+					}
+
+					int room = countReachableCells(game, next, roomNeeded, scratch);
+					int distance = abs(next.x - applePosition.x) + abs(next.y - applePosition.y);
+					if ((room > bestRoom) || ((room == bestRoom) && (distance < bestDistance))) {
+						result = direction;
+						bestRoom = room;
+						bestDistance = distance;
+					}
+				}
+
+				return result;
+			}
+
+			// Play and record one autopilot game, pressing a key only when the snake should turn
+			void recordGame(unsigned int randomSeed, ReplayRecorder& recorder) {
+				QuickGameDefn gameDefn;
+				gameDefn.fieldSize = CORPUS_FIELD_SIZE;
+				gameDefn.snakeSpeedTilesPerSecond = CORPUS_SNAKE_SPEED;
+				gameDefn.snakeStartDefn.headPosition = CORPUS_SNAKE_START;
+				gameDefn.snakeStartDefn.facingDirection = ObjectDirection::DOWN;
+				gameDefn.snakeStartDefn.length = CORPUS_SNAKE_LENGTH;
+				gameDefn.randomSeed = randomSeed;
+
+				QuickGame game(&gameDefn);
+				recorder.begin(gameDefn);
+				FloodFillScratch scratch;
+
+				ObjectDirection pressedDirection = ObjectDirection::NONE;
+				for (int frame = 0; frame < CORPUS_MAX_FRAMES; frame++) {
+					QuickGameInputRequest input;
+					input.snakeMovementInput = ObjectDirection::NONE;
+
+					// The apple appears on the first update, so steer from the second frame on
+					if (game.getAppleExists()) {
+						ObjectDirection direction = chooseDirection(game, scratch);
+						if ((direction != game.getSnake()->getHead().enterDirection) && (direction != pressedDirection)) {
+							input.snakeMovementInput = direction;
+							pressedDirection = direction;
+						}
+					}
+
+					QuickGameUpdateResult updateResult = game.update(&input);
+					recorder.record(input, game.getStateHash());
+
+					if (updateResult.snakeMovementResult != ObjectDirection::NONE) {
+						pressedDirection = ObjectDirection::NONE;
+					}
+					if (updateResult.snakeHitBarrierFlag) {
+						break;
+					}
+				}
+			}
+
+			// Generate count replays into a directory, seeded from firstSeed upwards
+			int generate(const char* directory, int count, unsigned int firstSeed) {
+				ReplayRecorder recorder(CORPUS_MAX_FRAMES);
+
+				for (int gameIndex = 0; gameIndex < count; gameIndex++) {
+					unsigned int randomSeed = firstSeed + (unsigned int)gameIndex;
+					recordGame(randomSeed, recorder);
+
+					char replayPath[1024];
+					snprintf(replayPath, sizeof(replayPath), "%s/game-%u.snkr", directory, randomSeed);
+					if (!recorder.saveToFile(replayPath)) {
+						fprintf(stderr, "Could not save replay %s\n", replayPath);
+						return 1;
+					}
+					fprintf(stderr, "%s: %d frames\n", replayPath, recorder.getFrameCount());
+				}
+
+				return 0;
+			}
+
+			// Play every replay headless repeat times on one game, failing when a checkpoint does not match or one does not end on its last recorded frame
+			template <typename Game>
+			int playReplays(const std::vector<Replay>& replays, char** replayPaths, int repeat, Game& game) {
+				int replayCount = (int)replays.size();
+				long long totalFrames = 0;
+				int desyncCount = 0;
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (int repeatIndex = 0; repeatIndex < repeat; repeatIndex++) {
+					for (int replayIndex = 0; replayIndex < replayCount; replayIndex++) {
+						ReplayPlaybackResult playbackResult = ReplayUtils::playHeadless(replays[replayIndex], game);
+						totalFrames += playbackResult.framesPlayed;
+
+						if (repeatIndex > 0) {
+							continue;
+						}
+						if (playbackResult.firstMismatchFrame >= 0) {
+							fprintf(stderr, "%s: state hash differs from the recording on frame %d\n", replayPaths[replayIndex], playbackResult.firstMismatchFrame);
+							desyncCount++;
+						} else if (playbackResult.framesPlayed != replays[replayIndex].getFrameCount()) {
+							fprintf(stderr, "%s: snake died on frame %d of %d\n", replayPaths[replayIndex], playbackResult.framesPlayed, replays[replayIndex].getFrameCount());
+							desyncCount++;
+						}
+					}
+				}
+				double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				fprintf(stderr, "%d replay(s) x %d: %lld frames in %.3f s, %.1f ns/frame\n",
+					replayCount, repeat, totalFrames, elapsedSeconds, (elapsedSeconds * 1e9) / (double)totalFrames);
+
+				return (desyncCount > 0) ? 1 : 0;
+			}
+
+			// Struct handed to FixedFieldUtils::visitGame, plays the replays on whichever engine it is given
+			typedef struct Snake_ReplayPlayer {
+				const std::vector<Replay>* replays;
+				char** replayPaths;
+				int repeat;
+
+				template <typename Game>
+				int operator()(Game& game) {
+					return playReplays(*this->replays, this->replayPaths, this->repeat, game);
+				}
+			} ReplayPlayer;
+
+			// Load the replays and play them, on the engine compiled for their field size when fixedFlag is set and they all share one
+			int play(int replayCount, char** replayPaths, int repeat, bool fixedFlag) {
+				std::vector<Replay> replays(replayCount);
+				for (int replayIndex = 0; replayIndex < replayCount; replayIndex++) {
+					if (!replays[replayIndex].loadFromFile(replayPaths[replayIndex])) {
+						fprintf(stderr, "Could not load replay %s\n", replayPaths[replayIndex]);
+						return 1;
+					}
+				}
+				if (replays.empty()) {
+					fprintf(stderr, "No replays given\n");
+					return 1;
+				}
+
+				ReplayPlayer player;
+				player.replays = &replays;
+				player.replayPaths = replayPaths;
+				player.repeat = repeat;
+
+				bool sameFieldSizeFlag = true;
+				for (const Replay& replay : replays) {
+					sameFieldSizeFlag = sameFieldSizeFlag && (replay.getGameDefn().fieldSize == replays[0].getGameDefn().fieldSize);
+				}
+				if (fixedFlag && sameFieldSizeFlag) {
+					return FixedFieldUtils::visitGame(replays[0].getGameDefn(), player);
+				}
+
+				QuickGame game(&replays[0].getGameDefn());
+				return player(game);
+			}
+
+			// Seek to each frame and compare the board with the one playing from the start reaches, timing the seeks against playing the whole replay
+			int seek(const char* replayPath, int frameCount, char** frameArgs) {
+				MappedReplay replay;
+				if (!replay.open(replayPath)) {
+					fprintf(stderr, "Could not open replay %s\n", replayPath);
+					return 1;
+				}
+				if (replay.getKeyframeCount() == 0) {
+					fprintf(stderr, "%s has no keyframes, add them with snake-replay index\n", replayPath);
+					return 1;
+				}
+
+				std::vector<int> frames;
+				for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+					frames.push_back(atoi(frameArgs[frameIndex]));
+				}
+				for (int sampleIndex = 0; (frameCount == 0) && (sampleIndex <= SEEK_SAMPLE_COUNT); sampleIndex++) {
+					frames.push_back((int)(((long long)replay.getFrameCount() * sampleIndex) / SEEK_SAMPLE_COUNT));
+				}
+
+				// The board after every frame, from one play through from the start
+				QuickGame game(&replay.getGameDefn());
+				std::vector<std::uint64_t> stateHashes;
+				stateHashes.push_back(game.getStateHash());
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (int frame = 0; frame < replay.getFrameCount(); frame++) {
+					QuickGameInputRequest input = replay.getInput(frame);
+					game.update(&input);
+					stateHashes.push_back(game.getStateHash());
+				}
+				double playSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				int mismatchCount = 0;
+				int mostFramesPlayed = 0;
+				double totalSeekSeconds = 0.0;
+				double slowestSeekSeconds = 0.0;
+				for (int frame : frames) {
+					if ((frame < 0) || (frame > replay.getFrameCount())) {
+						fprintf(stderr, "%s: frame %d is outside the replay's %d frames\n", replayPath, frame, replay.getFrameCount());
+						return 1;
+					}
+
+					std::chrono::steady_clock::time_point seekStart = std::chrono::steady_clock::now();
+					int framesPlayed = replay.seek(game, frame);
+					double seekSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - seekStart).count();
+
+					totalSeekSeconds += seekSeconds;
+					slowestSeekSeconds = (seekSeconds > slowestSeekSeconds) ? seekSeconds : slowestSeekSeconds;
+					mostFramesPlayed = (framesPlayed > mostFramesPlayed) ? framesPlayed : mostFramesPlayed;
+					if (game.getStateHash() != stateHashes[frame]) {
+						fprintf(stderr, "%s: seeking to frame %d gives another board than playing to it\n", replayPath, frame);
+						mismatchCount++;
+					}
+				}
+
+				fprintf(stderr, "%s: %d seek(s) over %d keyframe(s), %.3f ms average, %.3f ms slowest, at most %d frame(s) played; playing all %d frames takes %.3f ms\n",
+					replayPath, (int)frames.size(), replay.getKeyframeCount(), (totalSeekSeconds * 1e3) / (double)frames.size(), slowestSeekSeconds * 1e3,
+					mostFramesPlayed, replay.getFrameCount(), playSeconds * 1e3);
+
+				return (mismatchCount > 0) ? 1 : 0;
+			}
+
+			// Save replays again in the current version, which adds keyframes to replays recorded before them
+			int index(int replayCount, char** replayPaths) {
+				for (int replayIndex = 0; replayIndex < replayCount; replayIndex++) {
+					Replay replay;
+					if (!replay.loadFromFile(replayPaths[replayIndex])) {
+						fprintf(stderr, "Could not load replay %s\n", replayPaths[replayIndex]);
+						return 1;
+					}
+
+					// A replay that no longer plays back would be saved with the hashes of another game, so it is left as it is
+					QuickGame game(&replay.getGameDefn());
+					ReplayPlaybackResult playbackResult = ReplayUtils::playHeadless(replay, game);
+					if ((playbackResult.firstMismatchFrame >= 0) || (playbackResult.framesPlayed != replay.getFrameCount())) {
+						fprintf(stderr, "%s: does not play back, left unchanged\n", replayPaths[replayIndex]);
+						return 1;
+					}
+
+					ReplayRecorder recorder(replay.getFrameCount());
+					recorder.begin(replay.getGameDefn());
+					game.reset(&replay.getGameDefn());
+					for (int frame = 0; frame < replay.getFrameCount(); frame++) {
+						QuickGameInputRequest input = replay.getInput(frame);
+						game.update(&input);
+						recorder.record(input, game.getStateHash());
+					}
+					if (!recorder.saveToFile(replayPaths[replayIndex])) {
+						fprintf(stderr, "Could not save replay %s\n", replayPaths[replayIndex]);
+						return 1;
+					}
+
+					MappedReplay mappedReplay;
+					int keyframeCount = mappedReplay.open(replayPaths[replayIndex]) ? mappedReplay.getKeyframeCount() : 0;
+					fprintf(stderr, "%s: %d frames, %d keyframe(s)\n", replayPaths[replayIndex], replay.getFrameCount(), keyframeCount);
+				}
+
+				return 0;
+			}
+
+			void printUsage() {
+				fprintf(stderr,
+					"usage: snake-replay play [--repeat <count>] [--fixed] <replay>...\n"
+					"       snake-replay generate <directory> <count> [<first seed>]\n"
+					"       snake-replay seek <replay> [<frame>...]\n"
+					"       snake-replay index <replay>...\n");
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	if ((argc >= 2) && (strcmp(argv[1], "play") == 0)) {
+		int argIndex = 2;
+		int repeat = 1;
+		bool fixedFlag = false;
+		while (argIndex < argc) {
+			if ((argIndex + 1 < argc) && (strcmp(argv[argIndex], "--repeat") == 0)) {
+				repeat = atoi(argv[argIndex + 1]);
+				argIndex += 2;
+			} else if (strcmp(argv[argIndex], "--fixed") == 0) {
+				fixedFlag = true;
+				argIndex++;
+			} else {
+				break;
+			}
+		}
+		return snake::ReplayTool::play(argc - argIndex, argv + argIndex, repeat, fixedFlag);
+	}
+
+	if ((argc >= 4) && (strcmp(argv[1], "generate") == 0)) {
+		unsigned int firstSeed = (argc >= 5) ? (unsigned int)strtoul(argv[4], nullptr, 10) : 1;
+		return snake::ReplayTool::generate(argv[2], atoi(argv[3]), firstSeed);
+	}
+
+	if ((argc >= 3) && (strcmp(argv[1], "seek") == 0)) {
+		return snake::ReplayTool::seek(argv[2], argc - 3, argv + 3);
+	}
+
+	if ((argc >= 3) && (strcmp(argv[1], "index") == 0)) {
+		return snake::ReplayTool::index(argc - 2, argv + 2);
+	}
+
+	snake::ReplayTool::printUsage();
+	return 1;
+}
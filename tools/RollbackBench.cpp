@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+#include "../src/includes/replay.hpp"
+#include "../src/includes/rollbacksession.hpp"
+
+
+	namespace snake {
+
+		namespace RollbackBench {
+
+			// Default match, two recorded games played against each other over a link a sixth of a second long
+			const char* const DEFAULT_REPLAY_PATHS[] = { "replays/corpus/game-1.snkr", "replays/corpus/game-2.snkr" };
+			const int DEFAULT_LATENCY_TICKS = 10;
+			const int DEFAULT_JITTER_TICKS = 2;
+			const int DEFAULT_MAX_ROLLBACK_TICKS = 16;
+			const unsigned int DEFAULT_SEED = 1;
+
+			// Rollbacks this deep or deeper have to play again within an eighth of a 60 Hz frame
+			const int BUDGET_ROLLBACK_TICKS = 10;
+			const double ROLLBACK_BUDGET_SECONDS = 1.0 / 60.0 / 8.0;
+
+			// Peers in the match, one per replay
+			const int PEER_COUNT = 2;
+
+			// Struct for a message on its way from one peer to the other, an input or the hash of a confirmed tick
+			typedef struct Snake_RollbackMessage {
+				int deliveryFrame;
+				int tick;
+				bool hashFlag;
+				ObjectDirection input;
+				std::uint64_t stateHash;
+			} RollbackMessage;
+
+			// Struct for the options the benchmark was started with
+			typedef struct Snake_RollbackBenchOptions {
+				int latencyTicks;
+				int jitterTicks;
+				int maxRollbackTicks;
+				unsigned int seed;
+			} RollbackBenchOptions;
+
+			// Struct for one peer, its session and the messages on their way to it
+			typedef struct Snake_RollbackPeer {
+				RollbackSession* session;
+				std::deque<RollbackMessage> inbox;
+				//next confirmed tick to check against the reference and send the hash of
+				int checkedTick;
+				int lastDeliveryFrame;
+			} RollbackPeer;
+
+			// Match hash after every tick of the two games played straight through with the recorded inputs
+			std::vector<std::uint64_t> playReference(const Replay* replays, int tickCount) {
+				QuickGame* games[PEER_COUNT];
+				for (int peerIndex = 0; peerIndex < PEER_COUNT; peerIndex++) {
+					games[peerIndex] = new QuickGame(&replays[peerIndex].getGameDefn());
+				}
+
+				std::vector<std::uint64_t> result(tickCount);
+				for (int tick = 0; tick < tickCount; tick++) {
+					std::uint64_t matchHash = 0xCBF29CE484222325ULL;
+					for (int peerIndex = 0; peerIndex < PEER_COUNT; peerIndex++) {
+						QuickGameInputRequest input;
+						input.snakeMovementInput = (tick < replays[peerIndex].getFrameCount()) ? replays[peerIndex].getInput(tick).snakeMovementInput : ObjectDirection::NONE;
+						games[peerIndex]->update(&input);
+						matchHash = (matchHash ^ games[peerIndex]->getStateHash()) * 0x100000001B3ULL;
+					}
+					result[tick] = matchHash;
+				}
+
+				for (int peerIndex = 0; peerIndex < PEER_COUNT; peerIndex++) {
+					delete games[peerIndex];
+				}
+				return result;
+			}
+
+			// Queue a message for the other peer, arriving after the latency plus some jitter but never before one sent earlier
+			void sendMessage(RollbackPeer& receiver, RollbackMessage message, int frame, const RollbackBenchOptions& options) {
+				int jitter = (options.jitterTicks > 0) ? (rand() % (options.jitterTicks + 1)) : 0;
+				message.deliveryFrame = frame + options.latencyTicks + jitter;
+				if (message.deliveryFrame < receiver.lastDeliveryFrame) {
+					message.deliveryFrame = receiver.lastDeliveryFrame;
+				}
+				receiver.lastDeliveryFrame = message.deliveryFrame;
+				receiver.inbox.push_back(message);
+			}
+
+			// Play the match on both peers a frame at a time, failing on a wrong confirmed tick, a desync or a rollback over budget
+			int run(const Replay* replays, const RollbackBenchOptions& options) {
+				int tickCount = (replays[0].getFrameCount() > replays[1].getFrameCount()) ? replays[0].getFrameCount() : replays[1].getFrameCount();
+				std::vector<std::uint64_t> reference = playReference(replays, tickCount);
+				srand(options.seed);
+
+				RollbackPeer peers[PEER_COUNT];
+				for (int peerIndex = 0; peerIndex < PEER_COUNT; peerIndex++) {
+					RollbackSessionDefn defn;
+					defn.playerCount = PEER_COUNT;
+					for (int playerIndex = 0; playerIndex < PEER_COUNT; playerIndex++) {
+						defn.playerGameDefns[playerIndex] = replays[playerIndex].getGameDefn();
+					}
+					defn.localPlayerIndex = peerIndex;
+					defn.maxRollbackTicks = options.maxRollbackTicks;
+					peers[peerIndex].session = new RollbackSession(defn);
+					peers[peerIndex].checkedTick = 0;
+					peers[peerIndex].lastDeliveryFrame = 0;
+				}
+
+				printf("%d tick(s), %d tick(s) latency with up to %d of jitter, rollbacks up to %d tick(s)\n",
+					tickCount, options.latencyTicks, options.jitterTicks, options.maxRollbackTicks);
+
+				int mismatchCount = 0;
+				int budgetRollbackCount = 0;
+				double budgetRollbackSeconds = 0.0;
+				double slowestBudgetRollbackSeconds = 0.0;
+				int frame = 0;
+				while ((peers[0].checkedTick < tickCount) || (peers[1].checkedTick < tickCount)) {
+					for (int peerIndex = 0; peerIndex < PEER_COUNT; peerIndex++) {
+						RollbackPeer& peer = peers[peerIndex];
+						RollbackPeer& otherPeer = peers[1 - peerIndex];
+						RollbackSession* session = peer.session;
+
+						while ((!peer.inbox.empty()) && (peer.inbox.front().deliveryFrame <= frame)) {
+							RollbackMessage message = peer.inbox.front();
+							peer.inbox.pop_front();
+							if (message.hashFlag) {
+								session->checkRemoteHash(message.tick, message.stateHash);
+							} else {
+								session->addRemoteInput(1 - peerIndex, message.tick, message.input);
+							}
+						}
+
+						int rollbacksBefore = session->getStats().rollbackCount;
+						if (session->getCurrentTick() < tickCount) {
+							int tick = session->getCurrentTick();
+							ObjectDirection input = (tick < replays[peerIndex].getFrameCount()) ? replays[peerIndex].getInput(tick).snakeMovementInput : ObjectDirection::NONE;
+							if (session->advance(input)) {
+								RollbackMessage message;
+								message.tick = tick;
+								message.hashFlag = false;
+								message.input = input;
+								message.stateHash = 0;
+								sendMessage(otherPeer, message, frame, options);
+							}
+						} else {
+							session->synchronize();
+						}
+						if ((session->getStats().rollbackCount != rollbacksBefore) && (session->getStats().lastRollbackTicks >= BUDGET_ROLLBACK_TICKS)) {
+							budgetRollbackCount++;
+							budgetRollbackSeconds += session->getStats().lastRollbackSeconds;
+							if (session->getStats().lastRollbackSeconds > slowestBudgetRollbackSeconds) {
+								slowestBudgetRollbackSeconds = session->getStats().lastRollbackSeconds;
+							}
+						}
+
+						int confirmedTick = session->getConfirmedTick();
+						for (; peer.checkedTick < confirmedTick; peer.checkedTick++) {
+							std::uint64_t stateHash = session->getTickHash(peer.checkedTick);
+							if (stateHash != reference[peer.checkedTick]) {
+								if (mismatchCount == 0) {
+									fprintf(stderr, "Peer %d confirmed tick %d on a different board than the straight playthrough\n", peerIndex, peer.checkedTick);
+								}
+								mismatchCount++;
+							}
+							RollbackMessage message;
+							message.tick = peer.checkedTick;
+							message.hashFlag = true;
+							message.input = ObjectDirection::NONE;
+							message.stateHash = stateHash;
+							sendMessage(otherPeer, message, frame, options);
+						}
+					}
+					frame++;
+				}
+
+				int result = 0;
+				for (int peerIndex = 0; peerIndex < PEER_COUNT; peerIndex++) {
+					const RollbackStats& stats = peers[peerIndex].session->getStats();
+					printf("peer %d: %d prediction miss(es), %d rollback(s) resimulating %lld tick(s), deepest %d, %d stall(s), %d desync(s)\n",
+						peerIndex, stats.predictionMissCount, stats.rollbackCount, stats.resimulatedTickCount, stats.deepestRollbackTicks, stats.stallCount, stats.desyncCount);
+					if (stats.desyncCount > 0) {
+						result = 1;
+					}
+				}
+				printf("%d frame(s) to play %d tick(s), %d rollback(s) of %d+ tick(s): %.3f ms average, slowest %.3f ms\n",
+					frame, tickCount, budgetRollbackCount, BUDGET_ROLLBACK_TICKS,
+					(budgetRollbackCount > 0) ? (budgetRollbackSeconds * 1000.0 / (double)budgetRollbackCount) : 0.0, slowestBudgetRollbackSeconds * 1000.0);
+
+				if (mismatchCount > 0) {
+					fprintf(stderr, "%d confirmed tick(s) differed from the straight playthrough\n", mismatchCount);
+					result = 1;
+				}
+				if (result != 0) {
+					fprintf(stderr, "The peers desynced\n");
+				}
+				if (slowestBudgetRollbackSeconds > ROLLBACK_BUDGET_SECONDS) {
+					fprintf(stderr, "A rollback of %d+ tick(s) took longer than %.3f ms\n", BUDGET_ROLLBACK_TICKS, ROLLBACK_BUDGET_SECONDS * 1000.0);
+					result = 1;
+				}
+
+				for (int peerIndex = 0; peerIndex < PEER_COUNT; peerIndex++) {
+					delete peers[peerIndex].session;
+				}
+				return result;
+			}
+
+			void printUsage() {
+				fprintf(stderr, "usage: snake-rollback-bench [--latency <ticks>] [--jitter <ticks>] [--max-rollback <ticks>] [--seed <seed>]\n");
+				fprintf(stderr, "                            [<replay 1> <replay 2>]\n");
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	snake::RollbackBench::RollbackBenchOptions options;
+	options.latencyTicks = snake::RollbackBench::DEFAULT_LATENCY_TICKS;
+	options.jitterTicks = snake::RollbackBench::DEFAULT_JITTER_TICKS;
+	options.maxRollbackTicks = snake::RollbackBench::DEFAULT_MAX_ROLLBACK_TICKS;
+	options.seed = snake::RollbackBench::DEFAULT_SEED;
+
+	const char* replayPaths[snake::RollbackBench::PEER_COUNT] = { snake::RollbackBench::DEFAULT_REPLAY_PATHS[0], snake::RollbackBench::DEFAULT_REPLAY_PATHS[1] };
+	int replayPathCount = 0;
+	for (int argIndex = 1; argIndex < argc; argIndex++) {
+		if ((strcmp(argv[argIndex], "--latency") == 0) && (argIndex + 1 < argc)) {
+			options.latencyTicks = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--jitter") == 0) && (argIndex + 1 < argc)) {
+			options.jitterTicks = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--max-rollback") == 0) && (argIndex + 1 < argc)) {
+			options.maxRollbackTicks = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--seed") == 0) && (argIndex + 1 < argc)) {
+			options.seed = (unsigned int)strtoul(argv[++argIndex], nullptr, 10);
+		} else if ((argv[argIndex][0] != '-') && (replayPathCount < snake::RollbackBench::PEER_COUNT)) {
+			replayPaths[replayPathCount++] = argv[argIndex];
+		} else {
+			snake::RollbackBench::printUsage();
+			return 1;
+		}
+	}
+
+	if ((options.latencyTicks < 0) || (options.jitterTicks < 0) || (options.maxRollbackTicks < 1) || (replayPathCount == 1)) {
+		snake::RollbackBench::printUsage();
+		return 1;
+	}
+
+	snake::Replay replays[snake::RollbackBench::PEER_COUNT];
+	for (int peerIndex = 0; peerIndex < snake::RollbackBench::PEER_COUNT; peerIndex++) {
+		if (!replays[peerIndex].loadFromFile(replayPaths[peerIndex])) {
+			fprintf(stderr, "Could not load %s\n", replayPaths[peerIndex]);
+			return 1;
+		}
+	}
+
+	return snake::RollbackBench::run(replays, options);
+}
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "../src/includes/hamiltoniansolver.hpp"
+
+
+	namespace snake {
+
+		namespace SolverBench {
+
+			// Settings of the benchmarked games, the same as a quick game started from the menu
+			const sf::Vector2i DEFAULT_FIELD_SIZE = sf::Vector2i(50, 25);
+			const float SOLVER_SNAKE_SPEED = 10.0f;
+			const int SOLVER_SNAKE_LENGTH = 3;
+			const int DEFAULT_GAME_COUNT = 10;
+			const char* DEFAULT_CACHE_DIRECTORY = "cache";
+
+			// Moves and frames one strategy took to fill the field, summed over every game
+			typedef struct Snake_SolverBenchResult {
+				long long moveCount;
+				long long frameCount;
+				int filledCount;
+				double solverSeconds;
+			} SolverBenchResult;
+
+			// Play gameCount games with a solver until the field is full or the snake dies
+			SolverBenchResult playGames(HamiltonianSolver& solver, sf::Vector2i fieldSize, int gameCount) {
+				QuickGameDefn gameDefn;
+				gameDefn.fieldSize = fieldSize;
+				gameDefn.snakeSpeedTilesPerSecond = SOLVER_SNAKE_SPEED;
+				gameDefn.snakeStartDefn.headPosition = sf::Vector2i(fieldSize.x / 2, fieldSize.y / 2);
+				gameDefn.snakeStartDefn.facingDirection = ObjectDirection::DOWN;
+				gameDefn.snakeStartDefn.length = SOLVER_SNAKE_LENGTH;
+				gameDefn.randomSeed = 1;
+
+				SolverBenchResult result;
+				result.moveCount = 0;
+				result.frameCount = 0;
+				result.filledCount = 0;
+				result.solverSeconds = 0.0;
+
+				QuickGame game(&gameDefn);
+				for (int gameIndex = 0; gameIndex < gameCount; gameIndex++) {
+					gameDefn.randomSeed = (unsigned int)(gameIndex + 1);
+					game.reset(&gameDefn);
+
+					std::chrono::steady_clock::duration solverTime = std::chrono::steady_clock::duration::zero();
+					while (!game.getFieldFull()) {
+						std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+						QuickGameInputRequest input = solver.resolveInput(game);
+						solverTime += std::chrono::steady_clock::now() - start;
+
+						QuickGameUpdateResult updateResult = game.update(&input);
+						if (updateResult.snakeMovementResult != ObjectDirection::NONE) {
+							result.moveCount++;
+						}
+						if (updateResult.snakeHitBarrierFlag) {
+							break;
+						}
+					}
+
+					result.frameCount += game.getFrameCount();
+					result.filledCount += game.getFieldFull() ? 1 : 0;
+					result.solverSeconds += std::chrono::duration<double>(solverTime).count();
+				}
+
+				return result;
+			}
+
+			// Print one strategy's totals, per game and per solver call
+			void printResult(const char* name, const SolverBenchResult& result, int gameCount) {
+				printf("%-10s %d/%d filled, %.0f moves/game, %.0f frames/game, %.1f ns/frame in the solver\n",
+					name, result.filledCount, gameCount,
+					(double)result.moveCount / (double)gameCount,
+					(double)result.frameCount / (double)gameCount,
+					(result.solverSeconds * 1e9) / (double)result.frameCount);
+			}
+
+			// Compare pure cycle following with shortcuts on the same seeds
+			int run(sf::Vector2i fieldSize, int gameCount, const char* cacheDirectory) {
+				HamiltonianSolver cycleSolver(false);
+				HamiltonianSolver shortcutSolver(true);
+				if (!cycleSolver.prepare(fieldSize, cacheDirectory) || !shortcutSolver.prepare(fieldSize, cacheDirectory)) {
+					fprintf(stderr, "A %dx%d field has no Hamiltonian cycle, one side inside the walls must be even\n", fieldSize.x, fieldSize.y);
+					return 1;
+				}
+
+				SolverBenchResult cycleResult = playGames(cycleSolver, fieldSize, gameCount);
+				SolverBenchResult shortcutResult = playGames(shortcutSolver, fieldSize, gameCount);
+
+				printf("%dx%d field, %d cells, %d game(s)\n", fieldSize.x, fieldSize.y, cycleSolver.getCycleLength(), gameCount);
+				printResult("cycle", cycleResult, gameCount);
+				printResult("shortcuts", shortcutResult, gameCount);
+				printf("shortcuts fill the field in %.2fx fewer moves\n", (double)cycleResult.moveCount / (double)shortcutResult.moveCount);
+
+				bool allFilledFlag = (cycleResult.filledCount == gameCount) && (shortcutResult.filledCount == gameCount);
+				return allFilledFlag ? 0 : 1;
+			}
+
+			void printUsage() {
+				fprintf(stderr, "usage: snake-solver-bench [--field <width>x<height>] [--games <count>] [--cache <directory>]\n");
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	sf::Vector2i fieldSize = snake::SolverBench::DEFAULT_FIELD_SIZE;
+	int gameCount = snake::SolverBench::DEFAULT_GAME_COUNT;
+	const char* cacheDirectory = snake::SolverBench::DEFAULT_CACHE_DIRECTORY;
+
+	for (int argIndex = 1; argIndex < argc; argIndex++) {
+		if ((strcmp(argv[argIndex], "--field") == 0) && (argIndex + 1 < argc)) {
+			if (sscanf(argv[++argIndex], "%dx%d", &fieldSize.x, &fieldSize.y) != 2) {
+				snake::SolverBench::printUsage();
+				return 1;
+			}
+		} else if ((strcmp(argv[argIndex], "--games") == 0) && (argIndex + 1 < argc)) {
+			gameCount = atoi(argv[++argIndex]);
+		} else if ((strcmp(argv[argIndex], "--cache") == 0) && (argIndex + 1 < argc)) {
+			cacheDirectory = argv[++argIndex];
+		} else {
+			snake::SolverBench::printUsage();
+			return 1;
+		}
+	}
+
+	return snake::SolverBench::run(fieldSize, gameCount, cacheDirectory);
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SFML/Graphics.hpp>
+#include "../src/includes/utils.hpp"
+#include "../src/includes/quickgamescene.hpp"
+#include "../src/includes/spectatorbroadcast.hpp"
+
+
+	namespace snake {
+
+		namespace SpectatorViewer {
+
+			// Window the viewer opens, the same shape as the game's so the field is laid out alike
+			const unsigned int WINDOW_INITIAL_WIDTH = 800;
+			const unsigned int WINDOW_INITIAL_HEIGHT = 450;
+			const unsigned int FRAMES_PER_SECOND = 60;
+
+			// Frames between looks for a broadcast while there is none, once a second
+			const int REOPEN_INTERVAL_FRAMES = 60;
+
+			// Draw whatever the game window is showing, or the waiting screen while no game is being followed
+			void render(sf::RenderWindow& window, QuickGameRenderer& renderer, const SpectatorSubscriber& subscriber) {
+				QuickGameRenderState renderState;
+				renderState.game = subscriber.getGame();
+				renderState.longestSnake = subscriber.getLongestSnakeLength();
+				renderState.lastGameBeatLongestSnakeLength = subscriber.getLastGameBeatLongestSnakeLength();
+
+				if (renderState.game == nullptr) {
+					renderer.renderWaitToStart(window, renderState);
+				} else if (subscriber.getPhase() == SpectatorPhase::DONE) {
+					renderer.renderGameDoneSummary(window, renderState);
+				} else {
+					renderer.renderGameRunning(window, renderState);
+				}
+				window.display();
+			}
+
+			// Follow the broadcast until the window is closed, opening it again whenever the game goes away and comes back
+			int run(const char* name) {
+				char title[64];
+				snprintf(title, sizeof(title), "Snake spectator: %s", name);
+				sf::RenderWindow window(sf::VideoMode(WINDOW_INITIAL_WIDTH, WINDOW_INITIAL_HEIGHT), title);
+				window.setFramerateLimit(FRAMES_PER_SECOND);
+				window.setView(ViewUtils::createView(WINDOW_INITIAL_WIDTH, WINDOW_INITIAL_HEIGHT));
+
+				QuickGameRenderer renderer;
+				SpectatorSubscriber subscriber;
+				if (!subscriber.open(name)) {
+					printf("Waiting for a game broadcasting as %s\n", name);
+				}
+
+				int framesSinceOpenAttempt = 0;
+				while (window.isOpen()) {
+					sf::Event event;
+					while (window.pollEvent(event)) {
+						if (event.type == sf::Event::Closed) {
+							window.close();
+						} else if (event.type == sf::Event::Resized) {
+							window.setView(ViewUtils::createView(event.size.width, event.size.height));
+						} else if ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::Key::Escape)) {
+							window.close();
+						}
+					}
+					if (!window.isOpen()) {
+						break;
+					}
+
+					if (subscriber.getPhase() == SpectatorPhase::CLOSED) {
+						framesSinceOpenAttempt++;
+						if (framesSinceOpenAttempt >= REOPEN_INTERVAL_FRAMES) {
+							framesSinceOpenAttempt = 0;
+							subscriber.open(name);
+						}
+					}
+					subscriber.poll();
+					render(window, renderer, subscriber);
+				}
+
+				const SpectatorStats& stats = subscriber.getStats();
+				printf("%lld tick(s) of %d game(s) followed, %d game(s) missed, %d hash mismatch(es)\n",
+					stats.appliedTickCount, stats.followedGameCount, stats.missedGameCount, stats.hashMismatchCount);
+				return (stats.hashMismatchCount > 0) ? 1 : 0;
+			}
+
+			void printUsage() {
+				fprintf(stderr, "usage: snake-spectator [<name>]\n");
+				fprintf(stderr, "       shows the quick games of an app started with --broadcast <name>, %s by default\n", SPECTATOR_DEFAULT_NAME);
+			}
+
+		}
+
+	}
+
+
+int main(int argc, char** argv) {
+	const char* name = snake::SPECTATOR_DEFAULT_NAME;
+	if (argc > 2) {
+		snake::SpectatorViewer::printUsage();
+		return 1;
+	}
+	if (argc == 2) {
+		if ((argv[1][0] == '-') || (strlen(argv[1]) > 32)) {
+			snake::SpectatorViewer::printUsage();
+			return 1;
+		}
+		name = argv[1];
+	}
+
+	return snake::SpectatorViewer::run(name);
+}